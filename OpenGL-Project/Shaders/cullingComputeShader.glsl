@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// cullingComputeShader.glsl
+// ============
+// frustum cull the scene objects and write their indirect draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 430 core
+
+layout(local_size_x = 64) in;
+
+// must match GpuCulling::OBJECT_DATA
+struct ObjectData
+{
+	mat4 model;
+	vec4 boundsMinimum;   // xyz corner of the local bounding box
+	vec4 boundsMaximum;
+	uvec4 drawInfo;       // x mesh, y draw group, z first command of the group
+	vec4 objectColor;
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	vec4 textureScale;
+};
+
+// layout of glMultiDrawElementsIndirect commands
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 3) readonly buffer ObjectBuffer
+{
+	ObjectData objects[];
+};
+
+// index count, first index and base vertex of every mesh
+layout(std430, binding = 4) readonly buffer MeshBuffer
+{
+	ivec4 meshes[];
+};
+
+layout(std430, binding = 5) writeonly buffer CommandBuffer
+{
+	DrawCommand commands[];
+};
+
+// number of commands written for every draw group
+layout(std430, binding = 6) buffer DrawCountBuffer
+{
+	uint drawCounts[];
+};
+
+uniform uint objectCount;
+// planes of the view frustum, pointing inwards
+uniform vec4 frustumPlanes[6];
+
+void main()
+{
+	uint objectIndex = gl_GlobalInvocationID.x;
+	if (objectIndex >= objectCount)
+	{
+		return;
+	}
+
+	ObjectData object = objects[objectIndex];
+
+	// world space box around the transformed local box
+	vec3 localCenter = (object.boundsMinimum.xyz + object.boundsMaximum.xyz) * 0.5f;
+	vec3 localExtent = (object.boundsMaximum.xyz - object.boundsMinimum.xyz) * 0.5f;
+	vec3 center = vec3(object.model * vec4(localCenter, 1.0f));
+	mat3 absolute = mat3(abs(object.model[0].xyz), abs(object.model[1].xyz), abs(object.model[2].xyz));
+	vec3 extent = absolute * localExtent;
+
+	for (int i = 0; i < 6; i++)
+	{
+		vec4 plane = frustumPlanes[i];
+		float radius = dot(abs(plane.xyz), extent);
+		if (dot(plane.xyz, center) + plane.w < -radius)
+		{
+			return;
+		}
+	}
+
+	// append the draw to the command range of its group
+	uint group = object.drawInfo.y;
+	uint slot = atomicAdd(drawCounts[group], 1u);
+	ivec4 mesh = meshes[object.drawInfo.x];
+
+	DrawCommand command;
+	command.count = uint(mesh.x);
+	command.instanceCount = 1u;
+	command.firstIndex = uint(mesh.y);
+	command.baseVertex = mesh.z;
+	command.baseInstance = objectIndex;
+	commands[object.drawInfo.z + slot] = command;
+}
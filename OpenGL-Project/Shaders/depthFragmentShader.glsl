@@ -0,0 +1,13 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthFragmentShader.glsl
+// ============
+// write nothing but depth for the depth pre-pass
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+void main()
+{
+}
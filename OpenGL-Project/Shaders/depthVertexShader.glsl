@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////
+// depthVertexShader.glsl
+// ============
+// transform only the positions of the scene meshes for the depth pre-pass
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+layout (location = 0) in vec3 inVertexPosition;
+
+// must match vertexShader.glsl exactly, so the lit pass can
+// test for equal depth
+invariant gl_Position;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// set by MeshGeometry for meshes in the compact vertex format
+uniform bool bCompactVertices;
+uniform vec3 positionBoundsMinimum;
+uniform vec3 positionBoundsExtent;
+
+// must match the decode in vertexShader.glsl exactly
+vec3 DecodePosition(vec3 position)
+{
+	if (bCompactVertices)
+	{
+		return(positionBoundsMinimum + position * positionBoundsExtent);
+	}
+	return(position);
+}
+
+void main()
+{
+	vec4 worldPosition = model * vec4(DecodePosition(inVertexPosition), 1.0f);
+	vec4 viewPosition = view * worldPosition;
+
+	gl_Position = projection * viewPosition;
+}
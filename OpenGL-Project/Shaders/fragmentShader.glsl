@@ -0,0 +1,273 @@
+///////////////////////////////////////////////////////////////////////////////
+// fragmentShader.glsl
+// ============
+// phong shading of the scene meshes using clustered forward lighting
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+// ShaderVariants injects SHADER_VARIANT and these feature defines for
+// specialized programs - without them the shader branches on uniforms
+#ifndef USE_TEXTURE
+#define USE_TEXTURE 0
+#endif
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 0
+#endif
+// a non-zero light count loops over that many lights directly
+// instead of looking up the light cluster
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 0
+#endif
+#ifndef USE_OBJECT_BUFFER
+#define USE_OBJECT_BUFFER 0
+#endif
+#ifndef USE_LIGHTMAP
+#define USE_LIGHTMAP 0
+#endif
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+in float fragmentViewDepth;
+
+out vec4 fragmentColor;
+
+struct Material
+{
+	vec3 ambientColor;
+	float ambientStrength;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float shininess;
+};
+
+// must match ClusteredLighting::LIGHT_SOURCE
+struct LightSource
+{
+	vec4 position;        // xyz position, w range (0 lights everything)
+	vec4 direction;       // xyz spot direction, w cosine of the outer cone
+	vec4 ambientColor;    // w focal strength
+	vec4 diffuseColor;    // w specular intensity
+	vec4 specularColor;   // w cosine of the inner cone
+};
+
+layout(std430, binding = 0) readonly buffer LightBuffer
+{
+	LightSource lightSources[];
+};
+
+// offset and count into lightIndices for every cluster
+layout(std430, binding = 1) readonly buffer ClusterBuffer
+{
+	uvec2 clusterLights[];
+};
+
+layout(std430, binding = 2) readonly buffer LightIndexBuffer
+{
+	uint lightIndices[];
+};
+
+#if USE_OBJECT_BUFFER
+// must match GpuCulling::OBJECT_DATA
+struct ObjectData
+{
+	mat4 model;
+	vec4 boundsMinimum;
+	vec4 boundsMaximum;
+	uvec4 drawInfo;
+	vec4 objectColor;
+	vec4 ambientColor;    // w ambient strength
+	vec4 diffuseColor;
+	vec4 specularColor;   // w shininess
+	vec4 textureScale;    // xy UV scale
+};
+
+layout(std430, binding = 3) readonly buffer ObjectBuffer
+{
+	ObjectData objects[];
+};
+
+flat in uint fragmentObjectIndex;
+#endif
+
+#if USE_LIGHTMAP
+in vec2 fragmentLightmapCoordinate;
+
+// diffuse lighting with the material already applied, baked
+// offline for the static objects
+uniform sampler2D lightmapTexture;
+#endif
+
+#ifdef SHADER_VARIANT
+// the features are compile-time constants, so the unused paths
+// are stripped from the program
+const bool bUseTexture = (USE_TEXTURE != 0);
+const bool bUseLighting = (USE_LIGHTING != 0);
+#else
+uniform bool bUseTexture = false;
+uniform bool bUseLighting = false;
+#endif
+uniform sampler2D objectTexture;
+uniform vec3 viewPosition;
+#if USE_OBJECT_BUFFER
+// filled in from the object buffer at the start of main()
+vec4 objectColor;
+vec2 UVscale;
+Material material;
+#else
+uniform vec4 objectColor = vec4(1.0f);
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+uniform Material material;
+#endif
+
+// cluster grid layout, set by ClusteredLighting::BindToShader()
+uniform vec3 clusterDimensions;
+uniform vec2 clusterScreenSize;
+// depth slice = log(viewDepth) * scale + bias
+uniform vec2 clusterDepthScaleBias;
+
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+uint FindCluster();
+
+void main()
+{
+#if USE_OBJECT_BUFFER
+	ObjectData object = objects[fragmentObjectIndex];
+	objectColor = object.objectColor;
+	UVscale = object.textureScale.xy;
+	material.ambientColor = object.ambientColor.rgb;
+	material.ambientStrength = object.ambientColor.w;
+	material.diffuseColor = object.diffuseColor.rgb;
+	material.specularColor = object.specularColor.rgb;
+	material.shininess = object.specularColor.w;
+#endif
+
+#if USE_LIGHTMAP
+	// a single fetch replaces the loop over the lights
+	vec3 bakedLight = texture(lightmapTexture, fragmentLightmapCoordinate).rgb;
+	if (bUseTexture == true)
+	{
+		vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+		fragmentColor = vec4(bakedLight * textureColor.xyz, textureColor.w);
+	}
+	else
+	{
+		fragmentColor = vec4(bakedLight * objectColor.xyz, objectColor.w);
+	}
+	return;
+#endif
+
+	if (bUseLighting == true)
+	{
+		vec3 lightNormal = normalize(fragmentVertexNormal);
+		vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+		vec3 phongResult = vec3(0.0f);
+
+#if LIGHT_COUNT > 0
+		// a few lights that reach everything - no cluster lookup
+		for (int i = 0; i < LIGHT_COUNT; i++)
+		{
+			phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection);
+		}
+#else
+		// only evaluate the lights that reach this fragment's cluster
+		uvec2 cluster = clusterLights[FindCluster()];
+		for (uint i = 0; i < cluster.y; i++)
+		{
+			uint lightIndex = lightIndices[cluster.x + i];
+			phongResult += CalcLightSource(lightSources[lightIndex], lightNormal, fragmentPosition, viewDirection);
+		}
+#endif
+
+		if (bUseTexture == true)
+		{
+			vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+			fragmentColor = vec4(phongResult * textureColor.xyz, textureColor.w);
+		}
+		else
+		{
+			fragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+		}
+	}
+	else
+	{
+		if (bUseTexture == true)
+		{
+			fragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+		}
+		else
+		{
+			fragmentColor = objectColor;
+		}
+	}
+}
+
+/***********************************************************
+ *  FindCluster()
+ *
+ *  Find the index of the light cluster that contains the
+ *  current fragment from its screen position and depth.
+ ***********************************************************/
+uint FindCluster()
+{
+	uvec3 dimensions = uvec3(clusterDimensions);
+	uvec2 tile = uvec2(gl_FragCoord.xy / clusterScreenSize * clusterDimensions.xy);
+	float slice = log(max(fragmentViewDepth, 0.0001f)) * clusterDepthScaleBias.x + clusterDepthScaleBias.y;
+
+	uvec3 cluster = min(
+		uvec3(tile, uint(max(slice, 0.0f))),
+		dimensions - uvec3(1));
+
+	return(cluster.x + (cluster.y * dimensions.x) + (cluster.z * dimensions.x * dimensions.y));
+}
+
+/***********************************************************
+ *  CalcLightSource()
+ *
+ *  Calculate the ambient, diffuse and specular contribution
+ *  of one light source, fading ranged lights towards their
+ *  range and spot lights towards the edge of their cone.
+ ***********************************************************/
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+	vec3 lightOffset = light.position.xyz - vertexPosition;
+	vec3 lightDirection = normalize(lightOffset);
+
+	// ambient lighting
+	ambient = light.ambientColor.rgb * material.ambientStrength * material.ambientColor;
+
+	// diffuse lighting
+	float impact = max(dot(lightNormal, lightDirection), 0.0f);
+	diffuse = impact * light.diffuseColor.rgb * material.diffuseColor;
+
+	// specular lighting
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.ambientColor.w);
+	specular = light.diffuseColor.w * specularComponent * material.specularColor * light.specularColor.rgb;
+
+	float attenuation = 1.0f;
+	float spotFactor = 1.0f;
+
+	// ranged lights fade out smoothly at the edge of their range so
+	// nothing pops when they drop out of a cluster
+	if (light.position.w > 0.0f)
+	{
+		float falloff = clamp(1.0f - pow(length(lightOffset) / light.position.w, 2.0f), 0.0f, 1.0f);
+		attenuation = falloff * falloff;
+	}
+
+	// spot lights fade out between the inner and outer cone
+	if (light.direction.w > -1.0f)
+	{
+		float theta = dot(-lightDirection, normalize(light.direction.xyz));
+		spotFactor = smoothstep(light.direction.w, light.specularColor.w, theta);
+	}
+
+	return((ambient + ((diffuse + specular) * spotFactor)) * attenuation);
+}
@@ -0,0 +1,39 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostorFragmentShader.glsl
+// ============
+// blend the two baked views of an impostor nearest to the camera
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+in vec2 fragmentTextureCoordinate;
+
+out vec4 fragmentColor;
+
+uniform sampler2D impostorAtlas;
+// size of one cell of the atlas in texture coordinates
+uniform vec2 cellScale;
+// row of the impostor and columns of the two views
+uniform float impostorRow;
+uniform vec2 viewCells;
+// weight of the second view
+uniform float viewBlend;
+
+void main()
+{
+	vec4 first = texture(impostorAtlas, (vec2(viewCells.x, impostorRow) + fragmentTextureCoordinate) * cellScale);
+	vec4 second = texture(impostorAtlas, (vec2(viewCells.y, impostorRow) + fragmentTextureCoordinate) * cellScale);
+
+	// the cells hold premultiplied color, which blends linearly
+	vec4 color = mix(first, second, viewBlend);
+
+	// the empty corners of the quad must not write depth
+	if (color.a < 0.02f)
+	{
+		discard;
+	}
+
+	fragmentColor = color;
+}
@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostorVertexShader.glsl
+// ============
+// place the quad of an impostor facing the camera
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+out vec2 fragmentTextureCoordinate;
+
+uniform mat4 view;
+uniform mat4 projection;
+// middle of the object and the camera facing horizontal axis
+uniform vec3 impostorCenter;
+uniform vec3 impostorRight;
+// half the width and height of the square the object fits
+uniform float impostorHalfSize;
+
+void main()
+{
+	// vertices 0 to 3 are the corners of a triangle strip
+	vec2 corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1);
+	vec2 offset = (corner * 2.0f - 1.0f) * impostorHalfSize;
+	vec3 position = impostorCenter + impostorRight * offset.x + vec3(0.0f, offset.y, 0.0f);
+
+	fragmentTextureCoordinate = corner;
+	gl_Position = projection * view * vec4(position, 1.0f);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// upscaleFragmentShader.glsl
+// ============
+// stretch the scene rendered at a lower resolution over the window
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+in vec2 fragmentTextureCoordinate;
+
+out vec4 fragmentColor;
+
+uniform sampler2D sourceTexture;
+// part of the texture the scene was rendered into
+uniform vec2 sourceScale;
+// size of one texel in texture coordinates
+uniform vec2 texelSize;
+// 0 for a plain bilinear upscale, up to 1 for the sharpest
+uniform float sharpness;
+
+// keep a coordinate half a texel inside the rendered corner, so
+// the bilinear filter never blends in the unused texels
+vec3 SampleSource(vec2 coordinate)
+{
+	coordinate = clamp(coordinate, texelSize * 0.5f, sourceScale - texelSize * 0.5f);
+	return(texture(sourceTexture, coordinate).rgb);
+}
+
+void main()
+{
+	vec2 coordinate = fragmentTextureCoordinate * sourceScale;
+	vec3 color = SampleSource(coordinate);
+
+	if (sharpness > 0.0f)
+	{
+		vec3 north = SampleSource(coordinate + vec2(0.0f, texelSize.y));
+		vec3 south = SampleSource(coordinate - vec2(0.0f, texelSize.y));
+		vec3 east = SampleSource(coordinate + vec2(texelSize.x, 0.0f));
+		vec3 west = SampleSource(coordinate - vec2(texelSize.x, 0.0f));
+
+		// push the color away from the average of its neighbors,
+		// limited to their range so the edges do not ring
+		vec3 blurred = (north + south + east + west) * 0.25f;
+		vec3 sharpened = color + (color - blurred) * (sharpness * 2.0f);
+		vec3 darkest = min(min(min(north, south), min(east, west)), color);
+		vec3 brightest = max(max(max(north, south), max(east, west)), color);
+		color = clamp(sharpened, darkest, brightest);
+	}
+
+	fragmentColor = vec4(color, 1.0f);
+}
@@ -0,0 +1,21 @@
+///////////////////////////////////////////////////////////////////////////////
+// upscaleVertexShader.glsl
+// ============
+// cover the window with one triangle for the resolution upscale
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+	// vertices 0, 1 and 2 make a triangle twice the size of the
+	// window, so every pixel is covered by exactly one triangle
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+
+	fragmentTextureCoordinate = corner;
+	gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -0,0 +1,120 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexShader.glsl
+// ============
+// transform the scene meshes and pass the lighting inputs to the fragments
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#version 440 core
+
+// ShaderVariants injects these for specialized programs
+#ifndef USE_OBJECT_BUFFER
+#define USE_OBJECT_BUFFER 0
+#endif
+#ifndef USE_LIGHTMAP
+#define USE_LIGHTMAP 0
+#endif
+
+// compact meshes store fractions of their bounds and an
+// octahedral normal in x and y, see MeshGeometry
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+#if USE_OBJECT_BUFFER
+// index into the object buffer, fed per draw by the base instance
+// of the indirect draw commands
+layout (location = 3) in uint inObjectIndex;
+
+// must match GpuCulling::OBJECT_DATA
+struct ObjectData
+{
+	mat4 model;
+	vec4 boundsMinimum;
+	vec4 boundsMaximum;
+	uvec4 drawInfo;
+	vec4 objectColor;
+	vec4 ambientColor;
+	vec4 diffuseColor;
+	vec4 specularColor;
+	vec4 textureScale;
+};
+
+layout(std430, binding = 3) readonly buffer ObjectBuffer
+{
+	ObjectData objects[];
+};
+
+flat out uint fragmentObjectIndex;
+#endif
+#if USE_LIGHTMAP
+// coordinate into the atlas baked by LightmapBaker
+layout (location = 4) in vec2 inLightmapCoordinate;
+
+out vec2 fragmentLightmapCoordinate;
+#endif
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+// distance in front of the camera, used to find the light cluster
+out float fragmentViewDepth;
+
+// must match depthVertexShader.glsl exactly, so this pass can
+// test for equal depth after the pre-pass
+invariant gl_Position;
+
+#if !USE_OBJECT_BUFFER
+uniform mat4 model;
+#endif
+uniform mat4 view;
+uniform mat4 projection;
+
+// set by MeshGeometry for meshes in the compact vertex format
+uniform bool bCompactVertices;
+uniform vec3 positionBoundsMinimum;
+uniform vec3 positionBoundsExtent;
+
+// must match the decode in depthVertexShader.glsl exactly
+vec3 DecodePosition(vec3 position)
+{
+	if (bCompactVertices)
+	{
+		return(positionBoundsMinimum + position * positionBoundsExtent);
+	}
+	return(position);
+}
+
+// unfold a normal from the octahedron it was flattened onto
+vec3 DecodeNormal(vec3 normal)
+{
+	if (bCompactVertices)
+	{
+		vec3 unfolded = vec3(normal.xy, 1.0f - abs(normal.x) - abs(normal.y));
+		float fold = max(-unfolded.z, 0.0f);
+		unfolded.x += (unfolded.x >= 0.0f) ? -fold : fold;
+		unfolded.y += (unfolded.y >= 0.0f) ? -fold : fold;
+		return(normalize(unfolded));
+	}
+	return(normal);
+}
+
+void main()
+{
+#if USE_OBJECT_BUFFER
+	mat4 model = objects[inObjectIndex].model;
+	fragmentObjectIndex = inObjectIndex;
+#endif
+	vec4 worldPosition = model * vec4(DecodePosition(inVertexPosition), 1.0f);
+	vec4 viewPosition = view * worldPosition;
+
+	gl_Position = projection * viewPosition;
+
+	fragmentPosition = vec3(worldPosition);
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * DecodeNormal(inVertexNormal);
+	fragmentTextureCoordinate = inTextureCoordinate;
+#if USE_LIGHTMAP
+	fragmentLightmapCoordinate = inLightmapCoordinate;
+#endif
+	fragmentViewDepth = -viewPosition.z;
+}
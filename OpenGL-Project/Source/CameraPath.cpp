@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.cpp
+// ============
+// camera keyframes that a flythrough is rendered along
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  CatmullRom()
+	 *
+	 *  Interpolate between p1 and p2 with the tangents given by
+	 *  their neighbours p0 and p3.
+	 ***********************************************************/
+	template <typename T>
+	T CatmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		return(0.5f * (
+			(2.0f * p1) +
+			(p2 - p0) * t +
+			(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+			(3.0f * p1 - p0 - 3.0f * p2 + p3) * t3));
+	}
+
+	/***********************************************************
+	 *  SafeNormalize()
+	 *
+	 *  Normalize a direction, keeping a fallback when it has
+	 *  no length.
+	 ***********************************************************/
+	glm::vec3 SafeNormalize(const glm::vec3& direction, const glm::vec3& fallback)
+	{
+		float length = glm::length(direction);
+		return((length > 0.0f) ? direction / length : fallback);
+	}
+}
+
+/***********************************************************
+ *  CameraPath()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraPath::CameraPath()
+{
+}
+
+/***********************************************************
+ *  ~CameraPath()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CameraPath::~CameraPath()
+{
+}
+
+/***********************************************************
+ *  AddKeyframe()
+ *
+ *  This method adds a keyframe after every keyframe that is
+ *  not later than it.
+ ***********************************************************/
+void CameraPath::AddKeyframe(const CAMERA_KEYFRAME& keyframe)
+{
+	std::vector<CAMERA_KEYFRAME>::iterator position = m_keyframes.begin();
+	while ((position != m_keyframes.end()) && (position->time <= keyframe.time))
+	{
+		++position;
+	}
+
+	m_keyframes.insert(position, keyframe);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method removes all the keyframes.
+ ***********************************************************/
+void CameraPath::Clear()
+{
+	m_keyframes.clear();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method reads a path file.  Every line that is not
+ *  empty or a # comment holds one keyframe:
+ *
+ *      time  px py pz  fx fy fz  ux uy uz  zoom
+ ***********************************************************/
+bool CameraPath::Load(const char* filePath)
+{
+	std::ifstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not open camera path:" << filePath << std::endl;
+		return(false);
+	}
+
+	m_keyframes.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t first = line.find_first_not_of(" \t\r");
+		if ((first == std::string::npos) || (line[first] == '#'))
+		{
+			continue;
+		}
+
+		CAMERA_KEYFRAME keyframe;
+		std::istringstream values(line);
+		values >> keyframe.time
+			>> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+			>> keyframe.front.x >> keyframe.front.y >> keyframe.front.z
+			>> keyframe.up.x >> keyframe.up.y >> keyframe.up.z
+			>> keyframe.zoom;
+		if (values.fail())
+		{
+			std::cout << "Camera path " << filePath << " line " << lineNumber
+				<< " needs time, position, front, up and zoom" << std::endl;
+			m_keyframes.clear();
+			return(false);
+		}
+
+		AddKeyframe(keyframe);
+	}
+
+	if (m_keyframes.empty() == true)
+	{
+		std::cout << "Camera path has no keyframes:" << filePath << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method writes the path in the format Load() reads.
+ ***********************************************************/
+bool CameraPath::Save(const char* filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write camera path:" << filePath << std::endl;
+		return(false);
+	}
+
+	file << "# time  position  front  up  zoom" << std::endl;
+	for (size_t i = 0; i < m_keyframes.size(); i++)
+	{
+		const CAMERA_KEYFRAME& keyframe = m_keyframes[i];
+		file << keyframe.time << "  "
+			<< keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << "  "
+			<< keyframe.front.x << " " << keyframe.front.y << " " << keyframe.front.z << "  "
+			<< keyframe.up.x << " " << keyframe.up.y << " " << keyframe.up.z << "  "
+			<< keyframe.zoom << std::endl;
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  Evaluate()
+ *
+ *  This method returns the camera at a time along the path.
+ *  The directions are normalized before they are blended,
+ *  since the camera does not keep them at unit length.
+ ***********************************************************/
+CameraPath::CAMERA_KEYFRAME CameraPath::Evaluate(float time) const
+{
+	CAMERA_KEYFRAME result;
+	if (m_keyframes.empty() == true)
+	{
+		result.time = time;
+		result.position = glm::vec3(0.0f);
+		result.front = glm::vec3(0.0f, 0.0f, -1.0f);
+		result.up = glm::vec3(0.0f, 1.0f, 0.0f);
+		result.zoom = 45.0f;
+		return(result);
+	}
+
+	int count = (int)m_keyframes.size();
+	if ((count == 1) || (time <= m_keyframes[0].time))
+	{
+		result = m_keyframes[0];
+		result.time = time;
+		return(result);
+	}
+	if (time >= m_keyframes[count - 1].time)
+	{
+		result = m_keyframes[count - 1];
+		result.time = time;
+		return(result);
+	}
+
+	// the segment from keyframe i to i + 1 holds the time
+	int i = 0;
+	while ((i + 2 < count) && (m_keyframes[i + 1].time <= time))
+	{
+		i++;
+	}
+
+	const CAMERA_KEYFRAME& k0 = m_keyframes[std::max(i - 1, 0)];
+	const CAMERA_KEYFRAME& k1 = m_keyframes[i];
+	const CAMERA_KEYFRAME& k2 = m_keyframes[i + 1];
+	const CAMERA_KEYFRAME& k3 = m_keyframes[std::min(i + 2, count - 1)];
+
+	float span = k2.time - k1.time;
+	float t = (span > 0.0f) ? (time - k1.time) / span : 0.0f;
+
+	glm::vec3 front1 = SafeNormalize(k1.front, glm::vec3(0.0f, 0.0f, -1.0f));
+	glm::vec3 up1 = SafeNormalize(k1.up, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	result.time = time;
+	result.position = CatmullRom(k0.position, k1.position, k2.position, k3.position, t);
+	result.front = SafeNormalize(CatmullRom(
+		SafeNormalize(k0.front, front1),
+		front1,
+		SafeNormalize(k2.front, front1),
+		SafeNormalize(k3.front, front1), t), front1);
+	result.up = SafeNormalize(CatmullRom(
+		SafeNormalize(k0.up, up1),
+		up1,
+		SafeNormalize(k2.up, up1),
+		SafeNormalize(k3.up, up1), t), up1);
+	result.zoom = CatmullRom(k0.zoom, k1.zoom, k2.zoom, k3.zoom, t);
+
+	return(result);
+}
+
+/***********************************************************
+ *  GetDuration()
+ *
+ *  This method returns the time of the last keyframe.
+ ***********************************************************/
+float CameraPath::GetDuration() const
+{
+	return(m_keyframes.empty() ? 0.0f : m_keyframes.back().time);
+}
+
+/***********************************************************
+ *  GetKeyframeCount()
+ *
+ *  This method returns the number of keyframes.
+ ***********************************************************/
+int CameraPath::GetKeyframeCount() const
+{
+	return((int)m_keyframes.size());
+}
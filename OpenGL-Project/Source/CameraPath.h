@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerapath.h
+// ============
+// camera keyframes that a flythrough is rendered along
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  CameraPath
+ *
+ *  This class holds timed keyframes of the camera position,
+ *  front and up directions and zoom.  Between the keyframes
+ *  the camera follows a Catmull-Rom spline, so a path made
+ *  of a few keyframes moves smoothly through all of them.
+ *  Paths are stored as text, one keyframe per line.
+ ***********************************************************/
+class CameraPath
+{
+public:
+	struct CAMERA_KEYFRAME
+	{
+		// seconds from the start of the path
+		float time;
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+		// vertical field of view in degrees
+		float zoom;
+	};
+
+	// constructor
+	CameraPath();
+	// destructor
+	~CameraPath();
+
+	// add a keyframe, keyframes are kept sorted by time
+	void AddKeyframe(const CAMERA_KEYFRAME& keyframe);
+	// remove all the keyframes
+	void Clear();
+
+	// read a path written by Save() or by hand
+	bool Load(const char* filePath);
+	// write the path as text
+	bool Save(const char* filePath) const;
+
+	// camera at a time along the path, clamped to its ends
+	CAMERA_KEYFRAME Evaluate(float time) const;
+	// time of the last keyframe
+	float GetDuration() const;
+	int GetKeyframeCount() const;
+
+private:
+	std::vector<CAMERA_KEYFRAME> m_keyframes;
+};
@@ -0,0 +1,477 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusteredlighting.cpp
+// ============
+// bin the scene lights into view-space clusters for the fragment shader
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ClusteredLighting.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// size of the cluster grid - these must stay in sync with the
+	// values passed to the shader in BindToShader()
+	const int CLUSTER_COUNT_X = 16;
+	const int CLUSTER_COUNT_Y = 8;
+	const int CLUSTER_COUNT_Z = 24;
+	const int CLUSTER_COUNT = CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z;
+
+	// lights beyond this count in one cluster are dropped, and
+	// the clusters that drop any are counted
+	const int MAX_LIGHTS_PER_CLUSTER = 128;
+
+	// shader storage binding points used by fragmentShader.glsl
+	const GLuint LIGHT_BUFFER_BINDING = 0;
+	const GLuint CLUSTER_BUFFER_BINDING = 1;
+	const GLuint LIGHT_INDEX_BUFFER_BINDING = 2;
+
+	// the names are set every frame and are too long for a
+	// short string, so they are made once here rather than on
+	// the heap for every call
+	const std::string g_ClusterDimensionsName = "clusterDimensions";
+	const std::string g_ClusterScreenSizeName = "clusterScreenSize";
+	const std::string g_ClusterDepthScaleBiasName = "clusterDepthScaleBias";
+}
+
+/***********************************************************
+ *  ClusteredLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ClusteredLighting::ClusteredLighting(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_clusterProjection = glm::mat4(0.0f);
+	m_nearPlane = 0.1f;
+	m_farPlane = 100.0f;
+	m_viewportWidth = 1;
+	m_viewportHeight = 1;
+	m_maxLightsPerCluster = 0;
+	m_fullClusterCount = 0;
+	m_bFullClustersReported = false;
+
+	m_clusterBounds.resize(CLUSTER_COUNT);
+	m_clusterScratch.resize(CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+	m_clusterLights.resize(CLUSTER_COUNT * 2);
+
+	// the buffers are created by the first upload, so the lights
+	// can be set up without an OpenGL context
+	m_lightBuffer = 0;
+	m_clusterBuffer = 0;
+	m_lightIndexBuffer = 0;
+}
+
+/***********************************************************
+ *  ~ClusteredLighting()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ClusteredLighting::~ClusteredLighting()
+{
+	m_pJobSystem = NULL;
+
+	if (m_lightBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		glDeleteBuffers(1, &m_clusterBuffer);
+		glDeleteBuffers(1, &m_lightIndexBuffer);
+	}
+}
+
+/***********************************************************
+ *  AddPointLight()
+ *
+ *  This method adds a light that shines in every direction.
+ *  A range of zero keeps the light in every cluster, which
+ *  matches the unattenuated lights of the original scene.
+ ***********************************************************/
+int ClusteredLighting::AddPointLight(
+	glm::vec3 position,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float range)
+{
+	LIGHT_SOURCE light;
+	light.position = position;
+	light.range = range;
+	light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	light.outerConeCosine = -1.0f;
+	light.ambientColor = ambientColor;
+	light.focalStrength = focalStrength;
+	light.diffuseColor = diffuseColor;
+	light.specularIntensity = specularIntensity;
+	light.specularColor = specularColor;
+	light.innerConeCosine = -1.0f;
+
+	m_lights.push_back(light);
+
+	return((int)m_lights.size() - 1);
+}
+
+/***********************************************************
+ *  AddSpotLight()
+ *
+ *  This method adds a light that shines in a cone around the
+ *  passed in direction, fading out between the inner and
+ *  outer cone angles.
+ ***********************************************************/
+int ClusteredLighting::AddSpotLight(
+	glm::vec3 position,
+	glm::vec3 direction,
+	float innerConeDegrees,
+	float outerConeDegrees,
+	glm::vec3 ambientColor,
+	glm::vec3 diffuseColor,
+	glm::vec3 specularColor,
+	float focalStrength,
+	float specularIntensity,
+	float range)
+{
+	int index = AddPointLight(
+		position,
+		ambientColor,
+		diffuseColor,
+		specularColor,
+		focalStrength,
+		specularIntensity,
+		range);
+
+	m_lights[index].direction = glm::normalize(direction);
+	m_lights[index].outerConeCosine = cos(glm::radians(outerConeDegrees));
+	m_lights[index].innerConeCosine = cos(glm::radians(innerConeDegrees));
+
+	return(index);
+}
+
+/***********************************************************
+ *  GetLight()
+ *
+ *  This method returns a previously added light so that its
+ *  values can be changed.  Changes are picked up the next
+ *  time the clusters are updated.
+ ***********************************************************/
+ClusteredLighting::LIGHT_SOURCE& ClusteredLighting::GetLight(int index)
+{
+	return(m_lights[index]);
+}
+
+/***********************************************************
+ *  GetLightCount()
+ *
+ *  This method returns the number of lights in the scene.
+ ***********************************************************/
+int ClusteredLighting::GetLightCount() const
+{
+	return((int)m_lights.size());
+}
+
+/***********************************************************
+ *  ClearLights()
+ *
+ *  This method removes all the lights from the scene.
+ ***********************************************************/
+void ClusteredLighting::ClearLights()
+{
+	m_lights.clear();
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method replaces all the lights with a list that is
+ *  already in the layout of the light buffer, such as the
+ *  lights of a compiled scene file.
+ ***********************************************************/
+void ClusteredLighting::SetLights(const LIGHT_SOURCE* pLights, int count)
+{
+	m_lights.assign(pLights, pLights + count);
+}
+
+/***********************************************************
+ *  GetMaxLightsPerCluster()
+ *
+ *  This method returns the largest number of lights that
+ *  were binned into a single cluster in the last update.
+ ***********************************************************/
+int ClusteredLighting::GetMaxLightsPerCluster() const
+{
+	return(m_maxLightsPerCluster);
+}
+
+/***********************************************************
+ *  GetFullClusterCount()
+ *
+ *  This method returns how many clusters were reached by
+ *  more lights than they can hold in the last update.
+ ***********************************************************/
+int ClusteredLighting::GetFullClusterCount() const
+{
+	return(m_fullClusterCount);
+}
+
+/***********************************************************
+ *  BuildClusterBounds()
+ *
+ *  This method calculates the view-space bounding box of
+ *  every cluster.  The depth range is split exponentially so
+ *  that clusters near the camera are not stretched.  The
+ *  bounds only depend on the projection, so they are only
+ *  rebuilt when it changes.
+ ***********************************************************/
+void ClusteredLighting::BuildClusterBounds(const glm::mat4& projection)
+{
+	// recover the clip planes from the projection matrix
+	if (projection[2][3] != 0.0f)
+	{
+		m_nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+		m_farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+	}
+	else
+	{
+		m_nearPlane = (projection[3][2] + 1.0f) / projection[2][2];
+		m_farPlane = (projection[3][2] - 1.0f) / projection[2][2];
+	}
+
+	glm::mat4 inverseProjection = glm::inverse(projection);
+	float depthRatio = m_farPlane / m_nearPlane;
+
+	for (int z = 0; z < CLUSTER_COUNT_Z; z++)
+	{
+		float sliceDepths[2];
+		float sliceNDC[2];
+
+		sliceDepths[0] = m_nearPlane * pow(depthRatio, (float)z / CLUSTER_COUNT_Z);
+		sliceDepths[1] = m_nearPlane * pow(depthRatio, (float)(z + 1) / CLUSTER_COUNT_Z);
+
+		// convert the slice depths into normalized device depths
+		for (int i = 0; i < 2; i++)
+		{
+			glm::vec4 clip = projection * glm::vec4(0.0f, 0.0f, -sliceDepths[i], 1.0f);
+			sliceNDC[i] = clip.z / clip.w;
+		}
+
+		for (int y = 0; y < CLUSTER_COUNT_Y; y++)
+		{
+			for (int x = 0; x < CLUSTER_COUNT_X; x++)
+			{
+				CLUSTER_BOUNDS bounds;
+				bounds.minimum = glm::vec3(1.0e30f);
+				bounds.maximum = glm::vec3(-1.0e30f);
+
+				// unproject the eight corners of the cluster
+				for (int corner = 0; corner < 8; corner++)
+				{
+					glm::vec4 ndc(
+						-1.0f + (2.0f * (x + (corner & 1)) / CLUSTER_COUNT_X),
+						-1.0f + (2.0f * (y + ((corner >> 1) & 1)) / CLUSTER_COUNT_Y),
+						sliceNDC[corner >> 2],
+						1.0f);
+
+					glm::vec4 viewPoint = inverseProjection * ndc;
+					glm::vec3 point = glm::vec3(viewPoint) / viewPoint.w;
+
+					bounds.minimum = glm::min(bounds.minimum, point);
+					bounds.maximum = glm::max(bounds.maximum, point);
+				}
+
+				m_clusterBounds[x + (y * CLUSTER_COUNT_X) + (z * CLUSTER_COUNT_X * CLUSTER_COUNT_Y)] = bounds;
+			}
+		}
+	}
+
+	m_clusterProjection = projection;
+}
+
+/***********************************************************
+ *  UpdateClusters()
+ *
+ *  This method finds the lights that reach each cluster for
+ *  the current view.  The clusters are binned in parallel
+ *  into fixed-size scratch lists, which are then packed into
+ *  one index list for the shader.
+ ***********************************************************/
+void ClusteredLighting::UpdateClusters(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportWidth,
+	int viewportHeight)
+{
+	if (memcmp(&projection, &m_clusterProjection, sizeof(glm::mat4)) != 0)
+	{
+		BuildClusterBounds(projection);
+	}
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+
+	// move the light spheres into view space once per frame
+	m_viewSpaceLights.resize(m_lights.size());
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		glm::vec4 position = view * glm::vec4(m_lights[i].position, 1.0f);
+		m_viewSpaceLights[i] = glm::vec4(glm::vec3(position), m_lights[i].range);
+	}
+
+	std::atomic<int> fullClusters(0);
+	m_pJobSystem->ParallelFor(
+		"BinClusterLights",
+		CLUSTER_COUNT,
+		64,
+		[this, &fullClusters](unsigned int begin, unsigned int end)
+		{
+			int fullCount = 0;
+			for (unsigned int cluster = begin; cluster < end; cluster++)
+			{
+				const CLUSTER_BOUNDS& bounds = m_clusterBounds[cluster];
+				unsigned int* lightList = &m_clusterScratch[cluster * MAX_LIGHTS_PER_CLUSTER];
+				unsigned int lightCount = 0;
+
+				for (size_t i = 0; i < m_viewSpaceLights.size(); i++)
+				{
+					const glm::vec4& light = m_viewSpaceLights[i];
+					bool bInside = true;
+
+					// unranged lights reach every cluster, ranged ones
+					// are tested as a sphere against the cluster box
+					if (light.w > 0.0f)
+					{
+						glm::vec3 center = glm::vec3(light);
+						glm::vec3 closest = glm::min(glm::max(center, bounds.minimum), bounds.maximum);
+						glm::vec3 offset = closest - center;
+
+						bInside = glm::dot(offset, offset) <= (light.w * light.w);
+					}
+
+					if (bInside == true)
+					{
+						// one more light than fits is enough to know
+						// the cluster drops lights
+						if (lightCount == MAX_LIGHTS_PER_CLUSTER)
+						{
+							fullCount++;
+							break;
+						}
+						lightList[lightCount] = (unsigned int)i;
+						lightCount++;
+					}
+				}
+
+				m_clusterLights[(cluster * 2) + 1] = lightCount;
+			}
+
+			if (fullCount > 0)
+			{
+				fullClusters.fetch_add(fullCount, std::memory_order_relaxed);
+			}
+		});
+
+	// the lights past the limit go unlit in those clusters, which
+	// is told once rather than every frame
+	m_fullClusterCount = fullClusters.load(std::memory_order_relaxed);
+	if ((m_fullClusterCount > 0) && (m_bFullClustersReported == false))
+	{
+		m_bFullClustersReported = true;
+		std::cout << "WARNING: " << m_fullClusterCount << " light clusters are reached by more than "
+			<< MAX_LIGHTS_PER_CLUSTER << " lights, the lights past that are dropped" << std::endl;
+	}
+
+	// pack the per-cluster lists into one index list
+	unsigned int offset = 0;
+	m_maxLightsPerCluster = 0;
+	m_lightIndices.clear();
+	for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+	{
+		unsigned int lightCount = m_clusterLights[(cluster * 2) + 1];
+
+		m_clusterLights[cluster * 2] = offset;
+		m_lightIndices.insert(
+			m_lightIndices.end(),
+			m_clusterScratch.begin() + (cluster * MAX_LIGHTS_PER_CLUSTER),
+			m_clusterScratch.begin() + (cluster * MAX_LIGHTS_PER_CLUSTER) + lightCount);
+		offset += lightCount;
+
+		if ((int)lightCount > m_maxLightsPerCluster)
+		{
+			m_maxLightsPerCluster = lightCount;
+		}
+	}
+
+	UploadBuffers();
+}
+
+/***********************************************************
+ *  UploadBuffers()
+ *
+ *  This method copies the light, cluster and light index
+ *  lists into their shader storage buffers.  The buffers are
+ *  re-specified every frame so the driver can orphan the
+ *  storage still in use by the previous frame.
+ ***********************************************************/
+void ClusteredLighting::UploadBuffers()
+{
+	// the buffers always hold at least one element so that they
+	// can be bound even when there are no lights
+	LIGHT_SOURCE emptyLight = {};
+	unsigned int emptyIndex = 0;
+
+	const LIGHT_SOURCE* lights = m_lights.empty() ? &emptyLight : m_lights.data();
+	size_t lightCount = m_lights.empty() ? 1 : m_lights.size();
+	const unsigned int* indices = m_lightIndices.empty() ? &emptyIndex : m_lightIndices.data();
+	size_t indexCount = m_lightIndices.empty() ? 1 : m_lightIndices.size();
+
+	if (m_lightBuffer == 0)
+	{
+		glGenBuffers(1, &m_lightBuffer);
+		glGenBuffers(1, &m_clusterBuffer);
+		glGenBuffers(1, &m_lightIndexBuffer);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, lightCount * sizeof(LIGHT_SOURCE), lights, GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_clusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_clusterLights.size() * sizeof(unsigned int), m_clusterLights.data(), GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightIndexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, indexCount * sizeof(unsigned int), indices, GL_DYNAMIC_DRAW);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  BindToShader()
+ *
+ *  This method binds the light buffers to their storage
+ *  binding points and passes the cluster grid layout to the
+ *  shader so that fragments can find their cluster.
+ ***********************************************************/
+void ClusteredLighting::BindToShader(ShaderManager* pShaderManager)
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BUFFER_BINDING, m_lightBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BUFFER_BINDING, m_clusterBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_INDEX_BUFFER_BINDING, m_lightIndexBuffer);
+
+	if (NULL != pShaderManager)
+	{
+		float logDepthRatio = log(m_farPlane / m_nearPlane);
+
+		pShaderManager->setVec3Value(g_ClusterDimensionsName,
+			glm::vec3((float)CLUSTER_COUNT_X, (float)CLUSTER_COUNT_Y, (float)CLUSTER_COUNT_Z));
+		pShaderManager->setVec2Value(g_ClusterScreenSizeName,
+			glm::vec2((float)m_viewportWidth, (float)m_viewportHeight));
+		pShaderManager->setVec2Value(g_ClusterDepthScaleBiasName,
+			glm::vec2(
+				CLUSTER_COUNT_Z / logDepthRatio,
+				-(CLUSTER_COUNT_Z * log(m_nearPlane)) / logDepthRatio));
+	}
+}
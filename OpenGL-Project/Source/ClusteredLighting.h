@@ -0,0 +1,140 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusteredlighting.h
+// ============
+// bin the scene lights into view-space clusters for the fragment shader
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "JobSystem.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  ClusteredLighting
+ *
+ *  This class holds any number of point and spot lights in a
+ *  shader storage buffer.  Every frame the view frustum is
+ *  split into a grid of clusters (screen tiles times
+ *  exponential depth slices) and each cluster gets the list
+ *  of lights whose range touches it, so the fragment shader
+ *  only loops over the lights that can affect it.
+ ***********************************************************/
+class ClusteredLighting
+{
+public:
+	// layout matches the LightSource struct in fragmentShader.glsl
+	// and the light records of compiled scene files
+	struct LIGHT_SOURCE
+	{
+		glm::vec3 position;
+		float range;               // zero or less lights every cluster
+		glm::vec3 direction;
+		float outerConeCosine;     // -1 for point lights
+		glm::vec3 ambientColor;
+		float focalStrength;
+		glm::vec3 diffuseColor;
+		float specularIntensity;
+		glm::vec3 specularColor;
+		float innerConeCosine;
+	};
+
+	// constructor
+	ClusteredLighting(JobSystem* pJobSystem);
+	// destructor
+	~ClusteredLighting();
+
+	// add a light that shines in every direction
+	int AddPointLight(
+		glm::vec3 position,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float range);
+	// add a light that shines in a cone
+	int AddSpotLight(
+		glm::vec3 position,
+		glm::vec3 direction,
+		float innerConeDegrees,
+		float outerConeDegrees,
+		glm::vec3 ambientColor,
+		glm::vec3 diffuseColor,
+		glm::vec3 specularColor,
+		float focalStrength,
+		float specularIntensity,
+		float range);
+	// access a previously added light for changes
+	LIGHT_SOURCE& GetLight(int index);
+	// number of lights in the scene
+	int GetLightCount() const;
+	// remove all the lights
+	void ClearLights();
+	// replace all the lights with a list in the buffer layout
+	void SetLights(const LIGHT_SOURCE* pLights, int count);
+
+	// bin the lights into the clusters for the current view
+	void UpdateClusters(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		int viewportWidth,
+		int viewportHeight);
+	// bind the light buffers and grid uniforms for drawing
+	void BindToShader(ShaderManager* pShaderManager);
+
+	// largest number of lights that reached a single cluster
+	int GetMaxLightsPerCluster() const;
+	// clusters that had to drop lights in the last update
+	int GetFullClusterCount() const;
+
+private:
+	struct CLUSTER_BOUNDS
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	// pointer to job system used to bin the clusters in parallel
+	JobSystem* m_pJobSystem;
+	// all the lights in the scene
+	std::vector<LIGHT_SOURCE> m_lights;
+	// view-space bounding box of every cluster
+	std::vector<CLUSTER_BOUNDS> m_clusterBounds;
+	// projection the cluster bounds were built for
+	glm::mat4 m_clusterProjection;
+	// per-cluster light lists before they are packed
+	std::vector<unsigned int> m_clusterScratch;
+	// offset and count into the light index list per cluster
+	std::vector<unsigned int> m_clusterLights;
+	// packed light index list
+	std::vector<unsigned int> m_lightIndices;
+	// lights transformed into view space for this frame
+	std::vector<glm::vec4> m_viewSpaceLights;
+
+	// shader storage buffers
+	GLuint m_lightBuffer;
+	GLuint m_clusterBuffer;
+	GLuint m_lightIndexBuffer;
+
+	// view parameters used by the fragment shader
+	float m_nearPlane;
+	float m_farPlane;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	int m_maxLightsPerCluster;
+	int m_fullClusterCount;
+	// whether the dropped lights have been warned about
+	bool m_bFullClustersReported;
+
+	// rebuild the cluster bounds for a new projection
+	void BuildClusterBounds(const glm::mat4& projection);
+	// upload the light, cluster and index lists
+	void UploadBuffers();
+};
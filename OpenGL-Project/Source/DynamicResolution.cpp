@@ -0,0 +1,302 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// scale the render resolution to hold a target GPU frame time
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_UpscaleVertexShaderPath = "Shaders/upscaleVertexShader.glsl";
+	const char* g_UpscaleFragmentShaderPath = "Shaders/upscaleFragmentShader.glsl";
+
+	// changes of the scale smaller than this are ignored, so
+	// the noise of the GPU times does not move the resolution
+	const float g_ScaleHysteresis = 0.04f;
+	// parts of the way to the ideal scale taken per change,
+	// down fast to catch up with a heavy scene and up slowly
+	const float g_ScaleDownRate = 0.75f;
+	const float g_ScaleUpRate = 0.2f;
+}
+
+/***********************************************************
+ *  GetDefaultSettings()
+ *
+ *  This method returns a GPU budget that leaves a 60 Hz
+ *  frame some time for the CPU and the swap, with the render
+ *  size between half and all of the window.
+ ***********************************************************/
+DynamicResolution::RESOLUTION_SETTINGS DynamicResolution::GetDefaultSettings()
+{
+	RESOLUTION_SETTINGS settings;
+	settings.targetMilliseconds = 14.0;
+	settings.minScale = 0.5f;
+	settings.maxScale = 1.0f;
+	settings.sharpness = 0.3f;
+
+	return(settings);
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pUpscaleShader = NULL;
+	m_settings = GetDefaultSettings();
+	m_emptyVertexArray = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_scale = 1.0f;
+	m_renderWidth = 1;
+	m_renderHeight = 1;
+	m_framesSinceChange = 0;
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	if (m_emptyVertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_emptyVertexArray);
+		m_emptyVertexArray = 0;
+	}
+	if (NULL != m_pUpscaleShader)
+	{
+		delete m_pUpscaleShader;
+		m_pUpscaleShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method keeps the settings and loads the upscale
+ *  program.
+ ***********************************************************/
+bool DynamicResolution::Create(const RESOLUTION_SETTINGS& settings)
+{
+	m_settings = settings;
+	if (m_settings.minScale <= 0.0f)
+	{
+		m_settings.minScale = 0.1f;
+	}
+	if (m_settings.maxScale < m_settings.minScale)
+	{
+		m_settings.maxScale = m_settings.minScale;
+	}
+	m_scale = m_settings.maxScale;
+
+	m_pUpscaleShader = new ShaderManager();
+	m_pUpscaleShader->LoadShaders(g_UpscaleVertexShaderPath, g_UpscaleFragmentShaderPath);
+	if (m_pUpscaleShader->m_programID == 0)
+	{
+		std::cout << "Dynamic resolution is off, the upscale program did not load" << std::endl;
+		delete m_pUpscaleShader;
+		m_pUpscaleShader = NULL;
+		return(false);
+	}
+
+	glGenVertexArrays(1, &m_emptyVertexArray);
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsUpscaling()
+ *
+ *  This method returns whether the upscale program loaded.
+ ***********************************************************/
+bool DynamicResolution::IsUpscaling() const
+{
+	return(NULL != m_pUpscaleShader);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is called at the start of every frame.  The
+ *  GPU time grows with the number of pixels, the square of
+ *  the scale, so the scale that would just hold the target
+ *  is the current one times the square root of the time
+ *  ratio.  The scale moves part of the way there and then
+ *  waits for the GPU times of the new size, which arrive a
+ *  few frames late.
+ ***********************************************************/
+void DynamicResolution::Update(int windowWidth, int windowHeight, double gpuMilliseconds)
+{
+	// a minimized window has no size, keep the last one
+	if ((windowWidth <= 0) || (windowHeight <= 0))
+	{
+		return;
+	}
+
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+	if (IsUpscaling() == false)
+	{
+		m_targetWidth = windowWidth;
+		m_targetHeight = windowHeight;
+		m_renderWidth = windowWidth;
+		m_renderHeight = windowHeight;
+		return;
+	}
+
+	m_targetWidth = (int)std::ceil(windowWidth * m_settings.maxScale);
+	m_targetHeight = (int)std::ceil(windowHeight * m_settings.maxScale);
+
+	m_framesSinceChange++;
+	if ((m_framesSinceChange >= SETTLE_FRAMES) && (gpuMilliseconds > 0.0))
+	{
+		float idealScale = m_scale * (float)std::sqrt(m_settings.targetMilliseconds / gpuMilliseconds);
+		if (idealScale < m_settings.minScale)
+		{
+			idealScale = m_settings.minScale;
+		}
+		if (idealScale > m_settings.maxScale)
+		{
+			idealScale = m_settings.maxScale;
+		}
+
+		if (std::fabs(idealScale - m_scale) >= g_ScaleHysteresis)
+		{
+			float rate = (idealScale < m_scale) ? g_ScaleDownRate : g_ScaleUpRate;
+			m_scale += (idealScale - m_scale) * rate;
+			m_framesSinceChange = 0;
+		}
+	}
+
+	m_renderWidth = (int)(windowWidth * m_scale + 0.5f);
+	m_renderHeight = (int)(windowHeight * m_scale + 0.5f);
+	m_renderWidth = (m_renderWidth < 1) ? 1 : ((m_renderWidth > m_targetWidth) ? m_targetWidth : m_renderWidth);
+	m_renderHeight = (m_renderHeight < 1) ? 1 : ((m_renderHeight > m_targetHeight) ? m_targetHeight : m_renderHeight);
+}
+
+/***********************************************************
+ *  AddUpscalePass()
+ *
+ *  This method declares the pass that covers the window with
+ *  the scene rendered at the current size.
+ ***********************************************************/
+void DynamicResolution::AddUpscalePass(RenderGraph* pGraph, int source, int destination)
+{
+	int pass = pGraph->AddPass("Upscale", [this, pGraph, source]()
+		{
+			Upscale(pGraph->GetTexture(source));
+		});
+	pGraph->ReadTexture(pass, source);
+	pGraph->WriteTexture(pass, destination);
+	pGraph->SetViewport(pass, m_windowWidth, m_windowHeight);
+}
+
+/***********************************************************
+ *  Upscale()
+ *
+ *  This method covers the bound target with one triangle
+ *  that samples the rendered corner of the source texture.
+ *  The program that was current before is made current
+ *  again, since the view manager sets its uniforms on it.
+ ***********************************************************/
+void DynamicResolution::Upscale(GLuint sourceTexture)
+{
+	GLint previousProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+	m_pStateCache->Disable(GL_DEPTH_TEST);
+	m_pStateCache->Disable(GL_BLEND);
+	m_pStateCache->UseProgram(m_pUpscaleShader->m_programID);
+	m_pStateCache->BindTextureUnit(0, GL_TEXTURE_2D, sourceTexture);
+	m_pUpscaleShader->setSampler2DValue("sourceTexture", 0);
+	m_pUpscaleShader->setVec2Value("sourceScale", glm::vec2(
+		(float)m_renderWidth / (float)m_targetWidth,
+		(float)m_renderHeight / (float)m_targetHeight));
+	m_pUpscaleShader->setVec2Value("texelSize", glm::vec2(
+		1.0f / (float)m_targetWidth,
+		1.0f / (float)m_targetHeight));
+	m_pUpscaleShader->setFloatValue("sharpness", m_settings.sharpness);
+
+	m_pStateCache->BindVertexArray(m_emptyVertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	m_pStateCache->Enable(GL_DEPTH_TEST);
+	m_pStateCache->UseProgram((GLuint)previousProgram);
+}
+
+/***********************************************************
+ *  GetRenderWidth()
+ *
+ *  This method returns the width the scene is rendered at.
+ ***********************************************************/
+int DynamicResolution::GetRenderWidth() const
+{
+	return(m_renderWidth);
+}
+
+/***********************************************************
+ *  GetRenderHeight()
+ *
+ *  This method returns the height the scene is rendered at.
+ ***********************************************************/
+int DynamicResolution::GetRenderHeight() const
+{
+	return(m_renderHeight);
+}
+
+/***********************************************************
+ *  GetTargetWidth()
+ *
+ *  This method returns the width of the scene targets.
+ ***********************************************************/
+int DynamicResolution::GetTargetWidth() const
+{
+	return(m_targetWidth);
+}
+
+/***********************************************************
+ *  GetTargetHeight()
+ *
+ *  This method returns the height of the scene targets.
+ ***********************************************************/
+int DynamicResolution::GetTargetHeight() const
+{
+	return(m_targetHeight);
+}
+
+/***********************************************************
+ *  GetScale()
+ *
+ *  This method returns the render size as a fraction of the
+ *  window size.
+ ***********************************************************/
+float DynamicResolution::GetScale() const
+{
+	return(IsUpscaling() ? m_scale : 1.0f);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method prints the size the scene is rendered at.
+ ***********************************************************/
+void DynamicResolution::Report() const
+{
+	std::cout << "INFO: Render Resolution: " << m_renderWidth << "x" << m_renderHeight
+		<< " (" << (int)(GetScale() * 100.0f + 0.5f) << "% of " << m_windowWidth << "x" << m_windowHeight << ")" << std::endl;
+}
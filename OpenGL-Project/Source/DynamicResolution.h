@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// scale the render resolution to hold a target GPU frame time
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "RenderGraph.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class picks the size the scene is rendered at off
+ *  the screen and adds the pass that stretches it over the
+ *  window.  The size follows the GPU time of the recent
+ *  frames - it drops quickly when the frames are too slow
+ *  and climbs back slowly once there is time to spare,
+ *  always between the configured bounds.  The scene targets
+ *  keep the size of the largest scale and the scene is
+ *  rendered into their lower left corner, so changing the
+ *  size never reallocates.  The upscale is bilinear, with
+ *  an optional sharpening filter against the blur.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	struct RESOLUTION_SETTINGS
+	{
+		// GPU milliseconds the scene should be rendered in
+		double targetMilliseconds;
+		// bounds of the render size as a fraction of the window
+		float minScale;
+		float maxScale;
+		// 0 upscales bilinear, up to 1 sharpens the upscaled image
+		float sharpness;
+	};
+
+	// settings that hold 60 Hz with time left for the CPU
+	static RESOLUTION_SETTINGS GetDefaultSettings();
+
+	// constructor
+	DynamicResolution(GLStateCache* pStateCache);
+	// destructor
+	~DynamicResolution();
+
+	// load the upscale program, without it the scene is simply
+	// rendered to the window at full size
+	bool Create(const RESOLUTION_SETTINGS& settings);
+	// whether the scene is rendered off the screen and upscaled
+	bool IsUpscaling() const;
+
+	// pick the render size of the next frame from the window
+	// size and the latest GPU time of the scene
+	void Update(int windowWidth, int windowHeight, double gpuMilliseconds);
+	// add the pass that upscales the rendered corner of the
+	// source texture to the destination
+	void AddUpscalePass(RenderGraph* pGraph, int source, int destination);
+
+	// size the scene is rendered at this frame
+	int GetRenderWidth() const;
+	int GetRenderHeight() const;
+	// size of the scene targets, which fits the largest scale
+	int GetTargetWidth() const;
+	int GetTargetHeight() const;
+	float GetScale() const;
+	// print the current render size
+	void Report() const;
+
+private:
+	// frames to wait after a change before the GPU times show it
+	static const int SETTLE_FRAMES = 5;
+
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	ShaderManager* m_pUpscaleShader;
+	RESOLUTION_SETTINGS m_settings;
+
+	// the upscale triangle is made in the vertex shader, but a
+	// vertex array still has to be bound to draw it
+	GLuint m_emptyVertexArray;
+	int m_targetWidth;
+	int m_targetHeight;
+
+	int m_windowWidth;
+	int m_windowHeight;
+	float m_scale;
+	int m_renderWidth;
+	int m_renderHeight;
+	int m_framesSinceChange;
+
+	// draw the rendered corner of a texture over the window
+	void Upscale(GLuint sourceTexture);
+};
@@ -0,0 +1,395 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// hand out the memory that only lives for one frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// calls of operator new from every thread, set up before any
+	// code runs since it is constant initialized
+	std::atomic<unsigned long long> g_HeapAllocations(0);
+
+	// take heap memory and count it
+	void* AllocateCounted(size_t size)
+	{
+		g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		return(malloc((size > 0) ? size : 1));
+	}
+
+#ifdef __cpp_aligned_new
+	// take heap memory with an alignment beyond what malloc()
+	// gives and count it, freed with FreeAligned()
+	void* AllocateCountedAligned(size_t size, std::align_val_t alignment)
+	{
+		g_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		size = (size > 0) ? size : 1;
+#ifdef _WIN32
+		return(_aligned_malloc(size, (size_t)alignment));
+#else
+		void* pMemory = NULL;
+		if (posix_memalign(&pMemory, (size_t)alignment, size) != 0)
+		{
+			return(NULL);
+		}
+		return(pMemory);
+#endif
+	}
+
+	void FreeAligned(void* pMemory)
+	{
+#ifdef _WIN32
+		_aligned_free(pMemory);
+#else
+		free(pMemory);
+#endif
+	}
+#endif
+}
+
+// the global allocation operators are replaced to count the
+// heap allocations, the memory still comes from malloc()
+void* operator new(size_t size)
+{
+	void* pMemory = AllocateCounted(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	void* pMemory = AllocateCounted(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return(AllocateCounted(size));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(AllocateCounted(size));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+#ifdef __cpp_aligned_new
+// over-aligned types are allocated through these, which need
+// their own allocation since malloc() does not align that far
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	void* pMemory = AllocateCountedAligned(size, alignment);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	void* pMemory = AllocateCountedAligned(size, alignment);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+
+	return(pMemory);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return(AllocateCountedAligned(size, alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return(AllocateCountedAligned(size, alignment));
+}
+
+void operator delete(void* pMemory, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete(void* pMemory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete(void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pMemory);
+}
+
+void operator delete[](void* pMemory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pMemory);
+}
+#endif
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t frameBytes)
+{
+	m_capacity = frameBytes;
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		m_blocks[i].pMemory = new char[m_capacity];
+		m_blocks[i].capacity = m_capacity;
+		m_blocks[i].requested = 0;
+	}
+
+	m_frame = 0;
+	m_pNext = m_blocks[0].pMemory;
+	m_pEnd = m_blocks[0].pMemory + m_blocks[0].capacity;
+	m_peakBytes = 0;
+	m_frameStartAllocations = GetHeapAllocationCount();
+	m_frameHeapAllocations = 0;
+	m_overflowFrames = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		for (size_t j = 0; j < m_blocks[i].overflow.size(); j++)
+		{
+			::operator delete(m_blocks[i].overflow[j]);
+		}
+		delete[] m_blocks[i].pMemory;
+		m_blocks[i].pMemory = NULL;
+	}
+	m_pNext = NULL;
+	m_pEnd = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method moves on to the block of the frame before
+ *  last, which is no longer used, and points back at its
+ *  start.  A block that was too small for its last frame is
+ *  grown first, so only the frames after a larger one was
+ *  seen take memory from the heap.
+ ***********************************************************/
+void FrameArena::BeginFrame()
+{
+	m_frameStartAllocations = GetHeapAllocationCount();
+
+	m_frame = (m_frame + 1) % FRAME_COUNT;
+	FRAME_BLOCK& block = m_blocks[m_frame];
+	if (block.overflow.empty() == false)
+	{
+		ResetBlock(block);
+	}
+	block.requested = 0;
+
+	m_pNext = block.pMemory;
+	m_pEnd = block.pMemory + block.capacity;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method records how much of the arena and the heap
+ *  the frame used.
+ ***********************************************************/
+void FrameArena::EndFrame()
+{
+	const FRAME_BLOCK& block = m_blocks[m_frame];
+	if (block.requested > m_peakBytes)
+	{
+		m_peakBytes = block.requested;
+	}
+	if (block.overflow.empty() == false)
+	{
+		m_overflowFrames++;
+	}
+
+	m_frameHeapAllocations = GetHeapAllocationCount() - m_frameStartAllocations;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method bumps the next free byte of the block past
+ *  the memory it hands out.  What does not fit is taken
+ *  from the heap and kept until the block is used again.
+ *  The alignment has to be a power of two.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	FRAME_BLOCK& block = m_blocks[m_frame];
+
+	uintptr_t address = ((uintptr_t)m_pNext + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+	if ((address <= (uintptr_t)m_pEnd) && (size <= (size_t)((uintptr_t)m_pEnd - address)))
+	{
+		block.requested += (address - (uintptr_t)m_pNext) + size;
+		m_pNext = (char*)(address + size);
+		return((void*)address);
+	}
+
+	// aligned inside a larger allocation, which is what is freed
+	void* pMemory = ::operator new(size + alignment);
+	block.overflow.push_back(pMemory);
+	block.requested += size + alignment;
+
+	return((void*)(((uintptr_t)pMemory + (alignment - 1)) & ~(uintptr_t)(alignment - 1)));
+}
+
+/***********************************************************
+ *  ResetBlock()
+ *
+ *  This method frees the allocations that did not fit in a
+ *  block and gives the block room for everything its last
+ *  frame asked for, with some to spare.
+ ***********************************************************/
+void FrameArena::ResetBlock(FRAME_BLOCK& block)
+{
+	for (size_t i = 0; i < block.overflow.size(); i++)
+	{
+		::operator delete(block.overflow[i]);
+	}
+	block.overflow.clear();
+
+	if (block.requested > block.capacity)
+	{
+		block.capacity = block.requested + block.requested / 2;
+		delete[] block.pMemory;
+		block.pMemory = new char[block.capacity];
+	}
+	if (block.capacity > m_capacity)
+	{
+		m_capacity = block.capacity;
+	}
+}
+
+/***********************************************************
+ *  GetCapacity()
+ *
+ *  This method returns the bytes of the largest frame block.
+ ***********************************************************/
+size_t FrameArena::GetCapacity() const
+{
+	return(m_capacity);
+}
+
+/***********************************************************
+ *  GetPeakBytes()
+ *
+ *  This method returns the most bytes a frame has asked
+ *  for, alignment included.
+ ***********************************************************/
+size_t FrameArena::GetPeakBytes() const
+{
+	return(m_peakBytes);
+}
+
+/***********************************************************
+ *  GetFrameHeapAllocations()
+ *
+ *  This method returns the heap allocations made during the
+ *  last complete frame.
+ ***********************************************************/
+unsigned long long FrameArena::GetFrameHeapAllocations() const
+{
+	return(m_frameHeapAllocations);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method prints the peak use of the arena and the
+ *  heap allocations of the last frame.
+ ***********************************************************/
+void FrameArena::Report() const
+{
+	std::cout << "INFO: Frame Arena: " << (m_peakBytes / 1024.0) << " KB peak of "
+		<< (m_capacity / 1024.0) << " KB per frame, " << m_overflowFrames << " frames overflowed, "
+		<< m_frameHeapAllocations << " heap allocations in the last frame" << std::endl;
+}
+
+/***********************************************************
+ *  GetHeapAllocationCount()
+ *
+ *  This method returns the calls of operator new so far.
+ ***********************************************************/
+unsigned long long FrameArena::GetHeapAllocationCount()
+{
+	return(g_HeapAllocations.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// hand out the memory that only lives for one frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class hands out memory for data that is built and
+ *  dropped within a frame - the passes of the render graph
+ *  and the lists they are scheduled with.  Allocating bumps
+ *  a pointer through a block, and nothing is freed on its
+ *  own: starting a frame points back at the start of the
+ *  block, which drops everything the block held at once.
+ *  There is one block per frame that can be alive at the
+ *  same time, so the data of the last frame stays valid
+ *  while the next one is declared.  Anything that does not
+ *  fit is taken from the heap, counted, and grows the block
+ *  the next time it is used.
+ *
+ *  The arena also counts the heap allocations of the whole
+ *  program, so the ones made during a frame can be reported
+ *  - in steady state there should be none.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// frames whose data can be alive at once
+	static const int FRAME_COUNT = 2;
+
+	// constructor, with the bytes of every frame block
+	FrameArena(size_t frameBytes);
+	// destructor
+	~FrameArena();
+
+	// start a frame, dropping what its block held before
+	void BeginFrame();
+	// end the frame and count its heap allocations
+	void EndFrame();
+
+	// memory of the current frame, never NULL
+	void* Allocate(size_t size, size_t alignment);
+	// uninitialized array of the current frame, for types that
+	// need no constructor or destructor
+	template <typename T>
+	T* AllocateArray(int count)
+	{
+		return((T*)Allocate(sizeof(T) * (size_t)count, alignof(T)));
+	}
+
+	// bytes of every frame block
+	size_t GetCapacity() const;
+	// most bytes a frame has asked for
+	size_t GetPeakBytes() const;
+	// heap allocations between the start and end of the last
+	// complete frame, on every thread
+	unsigned long long GetFrameHeapAllocations() const;
+	// print the use of the arena and the heap per frame
+	void Report() const;
+
+	// heap allocations the program has made so far
+	static unsigned long long GetHeapAllocationCount();
+
+private:
+	struct FRAME_BLOCK
+	{
+		char* pMemory;
+		size_t capacity;
+		// bytes the frame asked for, including what did not fit
+		size_t requested;
+		// allocations that did not fit, freed with the block
+		std::vector<void*> overflow;
+	};
+
+	FRAME_BLOCK m_blocks[FRAME_COUNT];
+	// block of the current frame, and its next free byte
+	int m_frame;
+	char* m_pNext;
+	char* m_pEnd;
+
+	size_t m_capacity;
+	size_t m_peakBytes;
+	// heap allocation count when the frame started
+	unsigned long long m_frameStartAllocations;
+	unsigned long long m_frameHeapAllocations;
+	// frames that did not fit their block
+	int m_overflowFrames;
+
+	// free what did not fit and grow the block to the bytes it
+	// was asked for
+	void ResetBlock(FRAME_BLOCK& block);
+};
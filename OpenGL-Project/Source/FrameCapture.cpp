@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// render frames off the screen and read them back without stalls
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// nanoseconds to wait for a fence before checking again
+	const GLuint64 g_FenceTimeout = 1000000;
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameCapture::FrameCapture(FrameEncoder* pEncoder)
+{
+	m_pEncoder = pEncoder;
+	m_width = 0;
+	m_height = 0;
+	m_bHalfFloat = false;
+	m_framebuffer = 0;
+	m_colorBuffer = 0;
+	m_depthBuffer = 0;
+	for (int i = 0; i < BUFFER_COUNT; i++)
+	{
+		m_packBuffers[i] = 0;
+		m_fences[i] = 0;
+	}
+	m_nextBuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	Finish();
+	Destroy();
+	m_pEncoder = NULL;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method frees the framebuffer and the pack buffers.
+ ***********************************************************/
+void FrameCapture::Destroy()
+{
+	for (int i = 0; i < BUFFER_COUNT; i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+		if (m_packBuffers[i] != 0)
+		{
+			glDeleteBuffers(1, &m_packBuffers[i]);
+			m_packBuffers[i] = 0;
+		}
+	}
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_colorBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_colorBuffer);
+		m_colorBuffer = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method creates a framebuffer with color and depth
+ *  render buffers of the passed in size, and the pack
+ *  buffers the frames are copied into.
+ ***********************************************************/
+bool FrameCapture::Create(int width, int height, bool bHalfFloat)
+{
+	Finish();
+	Destroy();
+
+	m_width = width;
+	m_height = height;
+	m_bHalfFloat = bHalfFloat;
+	m_nextBuffer = 0;
+
+	glGenRenderbuffers(1, &m_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, bHalfFloat ? GL_RGBA16F : GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Capture framebuffer of " << width << "x" << height << " is not complete" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	// four bytes or four half floats per pixel
+	GLsizeiptr frameBytes = (GLsizeiptr)width * height * (bHalfFloat ? 8 : 4);
+	glGenBuffers(BUFFER_COUNT, m_packBuffers);
+	for (int i = 0; i < BUFFER_COUNT; i++)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_packBuffers[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method binds the capture framebuffer and sets the
+ *  viewport to its size.
+ ***********************************************************/
+void FrameCapture::Begin()
+{
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, m_width, m_height);
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method goes back to the window and queues the copy
+ *  of the frame into the next pack buffer, followed by a
+ *  fence that tells when the copy is done.  Only when all
+ *  the buffers are still being copied is the oldest one
+ *  waited on, which means the GPU is behind, not the disk.
+ ***********************************************************/
+void FrameCapture::End(const std::string& filePath)
+{
+	CollectFrames(false);
+	if (m_fences[m_nextBuffer] != 0)
+	{
+		HandOver(m_nextBuffer);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_packBuffers[m_nextBuffer]);
+	glReadPixels(0, 0, m_width, m_height, GL_RGBA, m_bHalfFloat ? GL_HALF_FLOAT : GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+
+	m_fences[m_nextBuffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_filePaths[m_nextBuffer] = filePath;
+	m_nextBuffer = (m_nextBuffer + 1) % BUFFER_COUNT;
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method waits for every copy still in flight and
+ *  hands the frames to the encoder.
+ ***********************************************************/
+void FrameCapture::Finish()
+{
+	CollectFrames(true);
+}
+
+/***********************************************************
+ *  CollectFrames()
+ *
+ *  This method hands over the frames in the order they were
+ *  rendered, stopping at the first copy that has not
+ *  finished unless asked to wait for it.
+ ***********************************************************/
+void FrameCapture::CollectFrames(bool bWait)
+{
+	for (int i = 0; i < BUFFER_COUNT; i++)
+	{
+		int index = (m_nextBuffer + i) % BUFFER_COUNT;
+		if (m_fences[index] == 0)
+		{
+			continue;
+		}
+
+		if (bWait == false)
+		{
+			GLenum result = glClientWaitSync(m_fences[index], 0, 0);
+			if ((result != GL_ALREADY_SIGNALED) && (result != GL_CONDITION_SATISFIED))
+			{
+				return;
+			}
+		}
+
+		HandOver(index);
+	}
+}
+
+/***********************************************************
+ *  HandOver()
+ *
+ *  This method waits for the copy into a pack buffer if it
+ *  has not finished, then copies the pixels into a frame
+ *  for the encoder.  GL has the bottom row first, so the
+ *  rows are flipped on the way.
+ ***********************************************************/
+void FrameCapture::HandOver(int index)
+{
+	GLenum result = glClientWaitSync(m_fences[index], GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(m_fences[index], 0, g_FenceTimeout);
+	}
+	glDeleteSync(m_fences[index]);
+	m_fences[index] = 0;
+
+	if (result == GL_WAIT_FAILED)
+	{
+		std::cout << "Reading back frame failed:" << m_filePaths[index] << std::endl;
+		return;
+	}
+
+	FrameEncoder::FRAME_IMAGE image;
+	image.filePath = m_filePaths[index];
+	image.width = m_width;
+	image.height = m_height;
+
+	size_t rowBytes = (size_t)m_width * (m_bHalfFloat ? 8 : 4);
+	unsigned char* destination = NULL;
+	if (m_bHalfFloat == true)
+	{
+		image.halfColors.resize((size_t)m_width * m_height * 4);
+		destination = (unsigned char*)image.halfColors.data();
+	}
+	else
+	{
+		image.colors.resize((size_t)m_width * m_height);
+		destination = (unsigned char*)image.colors.data();
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_packBuffers[index]);
+	const unsigned char* source = (const unsigned char*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowBytes * m_height, GL_MAP_READ_BIT);
+	if (NULL != source)
+	{
+		for (int y = 0; y < m_height; y++)
+		{
+			memcpy(destination + (size_t)y * rowBytes, source + (size_t)(m_height - 1 - y) * rowBytes, rowBytes);
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (NULL == source)
+	{
+		std::cout << "Could not map the frame read back for:" << m_filePaths[index] << std::endl;
+		return;
+	}
+
+	m_pEncoder->Submit(image);
+}
+
+/***********************************************************
+ *  GetWidth()
+ *
+ *  This method returns the width of the captured frames.
+ ***********************************************************/
+int FrameCapture::GetWidth() const
+{
+	return(m_width);
+}
+
+/***********************************************************
+ *  GetHeight()
+ *
+ *  This method returns the height of the captured frames.
+ ***********************************************************/
+int FrameCapture::GetHeight() const
+{
+	return(m_height);
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// render frames off the screen and read them back without stalls
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameEncoder.h"
+
+#include <GL/glew.h>
+
+#include <string>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class renders frames into its own framebuffer at any
+ *  resolution and copies them into pixel pack buffers.  The
+ *  copies run on the GPU while the next frames are drawn,
+ *  and a buffer is only mapped once its fence has passed, so
+ *  reading a frame back does not stall the pipeline.  The
+ *  mapped pixels are copied straight into a frame for the
+ *  encoder, which frees the buffer again before anything is
+ *  compressed or written.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// constructor
+	FrameCapture(FrameEncoder* pEncoder);
+	// destructor
+	~FrameCapture();
+
+	// create the framebuffer and the pack buffers, half float
+	// color keeps the values above one for EXR files
+	bool Create(int width, int height, bool bHalfFloat);
+
+	// draw the following commands into the capture framebuffer
+	void Begin();
+	// go back to the window and start reading the frame back
+	void End(const std::string& filePath);
+	// hand every frame still being read back to the encoder
+	void Finish();
+
+	int GetWidth() const;
+	int GetHeight() const;
+
+private:
+	// frames read back at once before the oldest is waited on
+	static const int BUFFER_COUNT = 3;
+
+	FrameEncoder* m_pEncoder;
+	int m_width;
+	int m_height;
+	bool m_bHalfFloat;
+
+	GLuint m_framebuffer;
+	GLuint m_colorBuffer;
+	GLuint m_depthBuffer;
+	GLuint m_packBuffers[BUFFER_COUNT];
+	GLsync m_fences[BUFFER_COUNT];
+	std::string m_filePaths[BUFFER_COUNT];
+	int m_nextBuffer;
+	// viewport of the window, restored by End()
+	GLint m_savedViewport[4];
+
+	// hand over the frames whose copies have finished
+	void CollectFrames(bool bWait);
+	// map a finished buffer and queue its frame
+	void HandOver(int index);
+	// free the GL objects
+	void Destroy();
+};
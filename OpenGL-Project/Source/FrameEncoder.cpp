@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameencoder.cpp
+// ============
+// write rendered frames to image files on a pool of threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameEncoder.h"
+#include "ImageWriter.h"
+
+#include <chrono>
+#include <iostream>
+
+/***********************************************************
+ *  FrameEncoder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameEncoder::FrameEncoder(unsigned int threadCount, size_t maxQueuedBytes)
+{
+	m_activeCount = 0;
+	m_bStopping = false;
+	m_writtenCount = 0;
+	m_failedCount = 0;
+	m_queuedBytes = 0;
+	m_maxQueuedBytes = (maxQueuedBytes > 0) ? maxQueuedBytes : DEFAULT_QUEUE_BYTES;
+	m_fullQueueCount = 0;
+	m_fullQueueSeconds = 0.0;
+
+	// leave a hardware thread to the render loop
+	if (threadCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&FrameEncoder::EncoderThread, this));
+	}
+}
+
+/***********************************************************
+ *  ~FrameEncoder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameEncoder::~FrameEncoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_frameQueued.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method queues a frame for writing.  The pixels are
+ *  swapped into the queue instead of copied, so the caller
+ *  gets an empty image back.  While the frame would take
+ *  the queue past its limit, it waits for the encoders to
+ *  take frames off - an empty queue takes any frame.
+ ***********************************************************/
+void FrameEncoder::Submit(FRAME_IMAGE& image)
+{
+	size_t imageBytes = GetImageBytes(image);
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		if ((m_queue.empty() == false) && (m_queuedBytes + imageBytes > m_maxQueuedBytes))
+		{
+			std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+			m_frameTaken.wait(lock, [this, imageBytes]()
+				{
+					return(m_queue.empty() || (m_queuedBytes + imageBytes <= m_maxQueuedBytes));
+				});
+			m_fullQueueCount++;
+			m_fullQueueSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+		}
+
+		m_queuedBytes += imageBytes;
+		m_queue.push_back(FRAME_IMAGE());
+		FRAME_IMAGE& queued = m_queue.back();
+		queued.filePath.swap(image.filePath);
+		queued.width = image.width;
+		queued.height = image.height;
+		queued.colors.swap(image.colors);
+		queued.halfColors.swap(image.halfColors);
+	}
+	m_frameQueued.notify_one();
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method waits until every queued frame is written.
+ ***********************************************************/
+void FrameEncoder::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_frameWritten.wait(lock, [this]() { return(m_queue.empty() && (m_activeCount == 0)); });
+}
+
+/***********************************************************
+ *  EncoderThread()
+ *
+ *  This method is run by every encoder thread.  When asked
+ *  to stop, a thread still writes what is left in the queue.
+ ***********************************************************/
+void FrameEncoder::EncoderThread()
+{
+	while (true)
+	{
+		FRAME_IMAGE image;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_frameQueued.wait(lock, [this]() { return(m_bStopping || !m_queue.empty()); });
+			if (m_queue.empty() == true)
+			{
+				return;
+			}
+
+			image.filePath.swap(m_queue.front().filePath);
+			image.width = m_queue.front().width;
+			image.height = m_queue.front().height;
+			image.colors.swap(m_queue.front().colors);
+			image.halfColors.swap(m_queue.front().halfColors);
+			m_queue.pop_front();
+			m_queuedBytes -= GetImageBytes(image);
+			m_activeCount++;
+		}
+		m_frameTaken.notify_one();
+
+		if (WriteFrame(image) == true)
+		{
+			m_writtenCount++;
+		}
+		else
+		{
+			m_failedCount++;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_activeCount--;
+		}
+		m_frameWritten.notify_all();
+	}
+}
+
+/***********************************************************
+ *  WriteFrame()
+ *
+ *  This method writes an EXR file for a .exr path and a PNG
+ *  file for anything else.
+ ***********************************************************/
+bool FrameEncoder::WriteFrame(const FRAME_IMAGE& image)
+{
+	size_t extension = image.filePath.rfind('.');
+	bool bExr = (extension != std::string::npos) &&
+		((image.filePath.compare(extension, std::string::npos, ".exr") == 0) ||
+		(image.filePath.compare(extension, std::string::npos, ".EXR") == 0));
+
+	if (bExr == true)
+	{
+		if (image.halfColors.size() != (size_t)image.width * image.height * 4)
+		{
+			std::cout << "EXR frame was not read back as half floats:" << image.filePath << std::endl;
+			return(false);
+		}
+		return(ImageWriter::WriteEXR(image.filePath.c_str(), image.halfColors, image.width, image.height));
+	}
+
+	if (image.colors.size() != (size_t)image.width * image.height)
+	{
+		std::cout << "PNG frame was not read back as 8-bit colors:" << image.filePath << std::endl;
+		return(false);
+	}
+	return(ImageWriter::WritePNG(image.filePath.c_str(), image.colors, image.width, image.height));
+}
+
+/***********************************************************
+ *  GetImageBytes()
+ *
+ *  This method returns the bytes the pixels of a frame take
+ *  in the queue.
+ ***********************************************************/
+size_t FrameEncoder::GetImageBytes(const FRAME_IMAGE& image)
+{
+	return(image.colors.size() * sizeof(unsigned int) + image.halfColors.size() * sizeof(unsigned short));
+}
+
+/***********************************************************
+ *  GetThreadCount()
+ *
+ *  This method returns the number of encoder threads.
+ ***********************************************************/
+int FrameEncoder::GetThreadCount() const
+{
+	return((int)m_threads.size());
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  This method returns the number of frames waiting in the
+ *  queue or being written.
+ ***********************************************************/
+int FrameEncoder::GetPendingCount()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return((int)m_queue.size() + m_activeCount);
+}
+
+/***********************************************************
+ *  GetWrittenCount()
+ *
+ *  This method returns the number of frames written.
+ ***********************************************************/
+int FrameEncoder::GetWrittenCount() const
+{
+	return(m_writtenCount);
+}
+
+/***********************************************************
+ *  GetFailedCount()
+ *
+ *  This method returns the number of frames that could not
+ *  be written.
+ ***********************************************************/
+int FrameEncoder::GetFailedCount() const
+{
+	return(m_failedCount);
+}
+
+/***********************************************************
+ *  GetFullQueueCount()
+ *
+ *  This method returns the number of frames that had to
+ *  wait for room in the queue.
+ ***********************************************************/
+int FrameEncoder::GetFullQueueCount() const
+{
+	return(m_fullQueueCount);
+}
+
+/***********************************************************
+ *  GetFullQueueSeconds()
+ *
+ *  This method returns the seconds frames waited for room
+ *  in the queue, all together.
+ ***********************************************************/
+double FrameEncoder::GetFullQueueSeconds() const
+{
+	return(m_fullQueueSeconds);
+}
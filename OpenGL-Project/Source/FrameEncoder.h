@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// frameencoder.h
+// ============
+// write rendered frames to image files on a pool of threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FrameEncoder
+ *
+ *  This class compresses and writes frames on its own
+ *  threads, so the render loop only hands a frame over and
+ *  goes on with the next one.  The pixels of the queued
+ *  frames are limited to a number of bytes, and a frame
+ *  handed over while the queue is full waits until the
+ *  encoders have taken enough off it, so a long sequence
+ *  that is rendered faster than it is compressed does not
+ *  fill the memory.  The threads are separate from the job
+ *  system, whose workers the renderer needs every frame.
+ ***********************************************************/
+class FrameEncoder
+{
+public:
+	// a frame read back from the GPU, top row first
+	struct FRAME_IMAGE
+	{
+		// the extension picks PNG or EXR
+		std::string filePath;
+		int width;
+		int height;
+		// RGBA8 pixels for PNG
+		std::vector<unsigned int> colors;
+		// RGBA half floats for EXR
+		std::vector<unsigned short> halfColors;
+	};
+
+	// bytes of pixels the queue holds by default, a few dozen
+	// full HD frames
+	static const size_t DEFAULT_QUEUE_BYTES = 256 * 1024 * 1024;
+
+	// constructor, zero threads uses all but one hardware thread
+	// and zero bytes the default queue limit
+	FrameEncoder(unsigned int threadCount = 0, size_t maxQueuedBytes = 0);
+	// destructor, writes every queued frame first
+	~FrameEncoder();
+
+	// queue a frame, its pixels are moved out of the passed in
+	// image - waits while the queue is full
+	void Submit(FRAME_IMAGE& image);
+	// wait until every queued frame is written
+	void Flush();
+
+	int GetThreadCount() const;
+	// frames waiting for or being written
+	int GetPendingCount();
+	int GetWrittenCount() const;
+	int GetFailedCount() const;
+	// frames that waited for room in the queue, and the seconds
+	// they waited in total
+	int GetFullQueueCount() const;
+	double GetFullQueueSeconds() const;
+
+private:
+	std::vector<std::thread> m_threads;
+	std::deque<FRAME_IMAGE> m_queue;
+	std::mutex m_mutex;
+	std::condition_variable m_frameQueued;
+	std::condition_variable m_frameWritten;
+	std::condition_variable m_frameTaken;
+	// bytes of pixels in the queue, and the most it may hold
+	size_t m_queuedBytes;
+	size_t m_maxQueuedBytes;
+	int m_fullQueueCount;
+	double m_fullQueueSeconds;
+	// frames taken off the queue that are still being written
+	int m_activeCount;
+	bool m_bStopping;
+	std::atomic<int> m_writtenCount;
+	std::atomic<int> m_failedCount;
+
+	// take frames off the queue and write them
+	void EncoderThread();
+	// compress and write one frame in the format of its extension
+	static bool WriteFrame(const FRAME_IMAGE& image);
+	// bytes of the pixels of a frame
+	static size_t GetImageBytes(const FRAME_IMAGE& image);
+};
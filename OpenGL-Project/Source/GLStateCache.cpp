@@ -0,0 +1,410 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// filter out OpenGL state changes that would not change anything
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+/***********************************************************
+ *  GLStateCache()
+ *
+ *  The constructor for the class.  The state is read from
+ *  the context, so settings made before the cache existed,
+ *  like the blending enabled with the window, are known.
+ ***********************************************************/
+GLStateCache::GLStateCache()
+{
+	m_issued = 0;
+	m_filtered = 0;
+	m_lastIssued = 0;
+	m_lastFiltered = 0;
+
+	Invalidate();
+}
+
+/***********************************************************
+ *  ~GLStateCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLStateCache::~GLStateCache()
+{
+}
+
+/***********************************************************
+ *  FindCapability()
+ *
+ *  This method returns the cache slot of a capability, or -1
+ *  for capabilities that are passed through every time.
+ ***********************************************************/
+int GLStateCache::FindCapability(GLenum capability)
+{
+	switch (capability)
+	{
+	case GL_BLEND:
+		return(CAPABILITY_BLEND);
+	case GL_DEPTH_TEST:
+		return(CAPABILITY_DEPTH_TEST);
+	case GL_CULL_FACE:
+		return(CAPABILITY_CULL_FACE);
+	case GL_POLYGON_OFFSET_FILL:
+		return(CAPABILITY_POLYGON_OFFSET_FILL);
+	case GL_SCISSOR_TEST:
+		return(CAPABILITY_SCISSOR_TEST);
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  Changed()
+ *
+ *  This method counts a call as issued or filtered and
+ *  passes the result through.
+ ***********************************************************/
+bool GLStateCache::Changed(bool bChanged)
+{
+	if (bChanged == true)
+	{
+		m_issued++;
+	}
+	else
+	{
+		m_filtered++;
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method makes a shader program current.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (Changed(m_program != program))
+	{
+		glUseProgram(program);
+		m_program = program;
+	}
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method selects the texture unit for the following
+ *  texture binds, passed as GL_TEXTURE0 + unit.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(GLenum textureUnit)
+{
+	if (Changed(m_activeTexture != textureUnit))
+	{
+		glActiveTexture(textureUnit);
+		m_activeTexture = textureUnit;
+	}
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method binds a texture to the active texture unit.
+ *  Only 2D bindings are cached, other targets are always
+ *  passed on.
+ ***********************************************************/
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+	int unit = (int)(m_activeTexture - GL_TEXTURE0);
+
+	if ((target != GL_TEXTURE_2D) ||
+		(m_activeTexture == UNKNOWN) ||
+		(unit < 0) || (unit >= MAX_TEXTURE_UNITS))
+	{
+		m_issued++;
+		glBindTexture(target, texture);
+		return;
+	}
+
+	if (Changed(m_boundTextures2D[unit] != texture))
+	{
+		glBindTexture(target, texture);
+		m_boundTextures2D[unit] = texture;
+	}
+}
+
+/***********************************************************
+ *  BindTextureUnit()
+ *
+ *  This method binds a texture to the passed in texture
+ *  unit, selecting the unit only when the binding changes.
+ ***********************************************************/
+void GLStateCache::BindTextureUnit(int unit, GLenum target, GLuint texture)
+{
+	if ((target == GL_TEXTURE_2D) &&
+		(unit >= 0) && (unit < MAX_TEXTURE_UNITS) &&
+		(m_boundTextures2D[unit] == texture))
+	{
+		m_filtered++;
+		return;
+	}
+
+	ActiveTexture(GL_TEXTURE0 + unit);
+	BindTexture(target, texture);
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method binds a vertex array object.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if (Changed(m_vertexArray != vertexArray))
+	{
+		glBindVertexArray(vertexArray);
+		m_vertexArray = vertexArray;
+	}
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method enables an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Enable(GLenum capability)
+{
+	int index = FindCapability(capability);
+	if (index < 0)
+	{
+		m_issued++;
+		glEnable(capability);
+		return;
+	}
+
+	if (Changed(m_capabilities[index] != 1))
+	{
+		glEnable(capability);
+		m_capabilities[index] = 1;
+	}
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method disables an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Disable(GLenum capability)
+{
+	int index = FindCapability(capability);
+	if (index < 0)
+	{
+		m_issued++;
+		glDisable(capability);
+		return;
+	}
+
+	if (Changed(m_capabilities[index] != 0))
+	{
+		glDisable(capability);
+		m_capabilities[index] = 0;
+	}
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method sets the blend factors.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (Changed((m_blendSource != sourceFactor) || (m_blendDestination != destinationFactor)))
+	{
+		glBlendFunc(sourceFactor, destinationFactor);
+		m_blendSource = sourceFactor;
+		m_blendDestination = destinationFactor;
+	}
+}
+
+/***********************************************************
+ *  DepthFunc()
+ *
+ *  This method sets the depth comparison.
+ ***********************************************************/
+void GLStateCache::DepthFunc(GLenum function)
+{
+	if (Changed(m_depthFunction != function))
+	{
+		glDepthFunc(function);
+		m_depthFunction = function;
+	}
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This method turns writing to the depth buffer on or off.
+ ***********************************************************/
+void GLStateCache::DepthMask(GLboolean bWrite)
+{
+	int mask = (bWrite == GL_TRUE) ? 1 : 0;
+
+	if (Changed(m_depthMask != mask))
+	{
+		glDepthMask(bWrite);
+		m_depthMask = mask;
+	}
+}
+
+/***********************************************************
+ *  ColorMask()
+ *
+ *  This method turns writing to the color channels on or off.
+ ***********************************************************/
+void GLStateCache::ColorMask(GLboolean bRed, GLboolean bGreen, GLboolean bBlue, GLboolean bAlpha)
+{
+	int mask =
+		((bRed == GL_TRUE) ? 1 : 0) |
+		((bGreen == GL_TRUE) ? 2 : 0) |
+		((bBlue == GL_TRUE) ? 4 : 0) |
+		((bAlpha == GL_TRUE) ? 8 : 0);
+
+	if (Changed(m_colorMask != mask))
+	{
+		glColorMask(bRed, bGreen, bBlue, bAlpha);
+		m_colorMask = mask;
+	}
+}
+
+/***********************************************************
+ *  CullFace()
+ *
+ *  This method selects the faces that are culled.
+ ***********************************************************/
+void GLStateCache::CullFace(GLenum mode)
+{
+	if (Changed(m_cullFace != mode))
+	{
+		glCullFace(mode);
+		m_cullFace = mode;
+	}
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method forgets the bound vertex array, for code such
+ *  as the basic shape meshes that binds its own.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	m_vertexArray = UNKNOWN;
+}
+
+/***********************************************************
+ *  InvalidateTextures()
+ *
+ *  This method forgets the texture unit and bindings.
+ ***********************************************************/
+void GLStateCache::InvalidateTextures()
+{
+	m_activeTexture = UNKNOWN;
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		m_boundTextures2D[i] = UNKNOWN;
+	}
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method reads the whole tracked state back from the
+ *  context.  It is meant for startup and for recovering after
+ *  code that changes the state directly, not for every frame.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	GLint value = 0;
+
+	glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+	m_program = (GLuint)value;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+	m_vertexArray = (GLuint)value;
+
+	// only the binding of the active unit can be read without
+	// switching units, the rest are picked up on first use
+	InvalidateTextures();
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &value);
+	m_activeTexture = (GLuint)value;
+	int unit = (int)(m_activeTexture - GL_TEXTURE0);
+	if ((unit >= 0) && (unit < MAX_TEXTURE_UNITS))
+	{
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+		m_boundTextures2D[unit] = (GLuint)value;
+	}
+
+	m_capabilities[CAPABILITY_BLEND] = glIsEnabled(GL_BLEND) ? 1 : 0;
+	m_capabilities[CAPABILITY_DEPTH_TEST] = glIsEnabled(GL_DEPTH_TEST) ? 1 : 0;
+	m_capabilities[CAPABILITY_CULL_FACE] = glIsEnabled(GL_CULL_FACE) ? 1 : 0;
+	m_capabilities[CAPABILITY_POLYGON_OFFSET_FILL] = glIsEnabled(GL_POLYGON_OFFSET_FILL) ? 1 : 0;
+	m_capabilities[CAPABILITY_SCISSOR_TEST] = glIsEnabled(GL_SCISSOR_TEST) ? 1 : 0;
+
+	glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+	m_blendSource = (GLenum)value;
+	glGetIntegerv(GL_BLEND_DST_RGB, &value);
+	m_blendDestination = (GLenum)value;
+	glGetIntegerv(GL_DEPTH_FUNC, &value);
+	m_depthFunction = (GLenum)value;
+	glGetIntegerv(GL_CULL_FACE_MODE, &value);
+	m_cullFace = (GLenum)value;
+
+	GLboolean depthMask = GL_TRUE;
+	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+	m_depthMask = (depthMask == GL_TRUE) ? 1 : 0;
+
+	GLboolean colorMask[4] = { GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE };
+	glGetBooleanv(GL_COLOR_WRITEMASK, colorMask);
+	m_colorMask =
+		((colorMask[0] == GL_TRUE) ? 1 : 0) |
+		((colorMask[1] == GL_TRUE) ? 2 : 0) |
+		((colorMask[2] == GL_TRUE) ? 4 : 0) |
+		((colorMask[3] == GL_TRUE) ? 8 : 0);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method keeps the counts of the frame that just ended
+ *  and starts counting the next one.
+ ***********************************************************/
+void GLStateCache::BeginFrame()
+{
+	m_lastIssued = m_issued;
+	m_lastFiltered = m_filtered;
+	m_issued = 0;
+	m_filtered = 0;
+}
+
+/***********************************************************
+ *  GetIssuedCount()
+ *
+ *  This method returns the number of calls that were passed
+ *  on to the driver in the last complete frame.
+ ***********************************************************/
+int GLStateCache::GetIssuedCount() const
+{
+	return(m_lastIssued);
+}
+
+/***********************************************************
+ *  GetFilteredCount()
+ *
+ *  This method returns the number of calls that were skipped
+ *  in the last complete frame because they changed nothing.
+ ***********************************************************/
+int GLStateCache::GetFilteredCount() const
+{
+	return(m_lastFiltered);
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// filter out OpenGL state changes that would not change anything
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class remembers the OpenGL state it has set - the
+ *  program, texture bindings, vertex array and the blend,
+ *  depth and cull settings - and only passes a call on to
+ *  the driver when it changes that state.  Every call is
+ *  counted as issued or filtered so the savings per frame
+ *  can be reported.  Code that changes the state behind the
+ *  cache's back has to invalidate the matching entries.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// number of texture units that bindings are tracked for
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	// constructor, reads the current state of the context
+	GLStateCache();
+	// destructor
+	~GLStateCache();
+
+	// program
+	void UseProgram(GLuint program);
+	// textures
+	void ActiveTexture(GLenum textureUnit);
+	void BindTexture(GLenum target, GLuint texture);
+	void BindTextureUnit(int unit, GLenum target, GLuint texture);
+	// vertex arrays
+	void BindVertexArray(GLuint vertexArray);
+	// capabilities such as GL_BLEND or GL_DEPTH_TEST
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+	// fixed function settings
+	void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	void DepthFunc(GLenum function);
+	void DepthMask(GLboolean bWrite);
+	void ColorMask(GLboolean bRed, GLboolean bGreen, GLboolean bBlue, GLboolean bAlpha);
+	void CullFace(GLenum mode);
+
+	// forget cached values after code outside the cache changed them
+	void InvalidateVertexArray();
+	void InvalidateTextures();
+	void Invalidate();
+
+	// start counting the calls of a new frame
+	void BeginFrame();
+	// calls passed to the driver in the last complete frame
+	int GetIssuedCount() const;
+	// calls skipped in the last complete frame
+	int GetFilteredCount() const;
+
+private:
+	// capabilities with a cached enabled flag
+	enum CAPABILITY
+	{
+		CAPABILITY_BLEND,
+		CAPABILITY_DEPTH_TEST,
+		CAPABILITY_CULL_FACE,
+		CAPABILITY_POLYGON_OFFSET_FILL,
+		CAPABILITY_SCISSOR_TEST,
+		CAPABILITY_COUNT
+	};
+
+	// value used for state that is not known
+	static const GLuint UNKNOWN = 0xFFFFFFFF;
+
+	GLuint m_program;
+	GLuint m_activeTexture;
+	GLuint m_boundTextures2D[MAX_TEXTURE_UNITS];
+	GLuint m_vertexArray;
+	int m_capabilities[CAPABILITY_COUNT];
+	GLenum m_blendSource;
+	GLenum m_blendDestination;
+	GLenum m_depthFunction;
+	int m_depthMask;
+	int m_colorMask;
+	GLenum m_cullFace;
+
+	// call counters of the current and the last frame
+	int m_issued;
+	int m_filtered;
+	int m_lastIssued;
+	int m_lastFiltered;
+
+	// index of a tracked capability, or -1 for others
+	static int FindCapability(GLenum capability);
+	// count a call and return whether it has to be issued
+	bool Changed(bool bChanged);
+};
@@ -0,0 +1,483 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculling.cpp
+// ============
+// cull the scene objects in a compute shader and draw them indirectly
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuCulling.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// threads per work group of the culling compute shader
+	const GLuint g_CullGroupSize = 64;
+
+	// layout of the commands read by glMultiDrawElementsIndirect
+	struct DRAW_ELEMENTS_COMMAND
+	{
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+}
+
+/***********************************************************
+ *  GpuCulling()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuCulling::GpuCulling(GLStateCache* pStateCache, MeshGeometry* pMeshGeometry)
+{
+	m_pStateCache = pStateCache;
+	m_pMeshGeometry = pMeshGeometry;
+	m_cullProgram = 0;
+	m_objectCountLocation = -1;
+	m_frustumPlanesLocation = -1;
+	m_objectCount = 0;
+	m_bIndirectCount = false;
+	m_readbackFrame = 0;
+	m_visibleCount = 0;
+
+	glGenBuffers(1, &m_objectBuffer);
+	glGenBuffers(1, &m_meshBuffer);
+	glGenBuffers(1, &m_commandBuffer);
+	glGenBuffers(1, &m_drawCountBuffer);
+	glGenBuffers(1, &m_objectIndexBuffer);
+	glGenBuffers(READBACK_FRAMES, m_readbackBuffers);
+
+	for (int i = 0; i < READBACK_FRAMES; i++)
+	{
+		m_readbackFences[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~GpuCulling()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuCulling::~GpuCulling()
+{
+	for (int i = 0; i < READBACK_FRAMES; i++)
+	{
+		if (m_readbackFences[i] != 0)
+		{
+			glDeleteSync(m_readbackFences[i]);
+		}
+	}
+
+	glDeleteBuffers(READBACK_FRAMES, m_readbackBuffers);
+	glDeleteBuffers(1, &m_objectIndexBuffer);
+	glDeleteBuffers(1, &m_drawCountBuffer);
+	glDeleteBuffers(1, &m_commandBuffer);
+	glDeleteBuffers(1, &m_meshBuffer);
+	glDeleteBuffers(1, &m_objectBuffer);
+
+	if (m_cullProgram != 0)
+	{
+		glDeleteProgram(m_cullProgram);
+	}
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method returns whether the context has everything
+ *  the culling pass needs.  Compute shaders, shader storage
+ *  buffers and multi-draw indirect are all core in OpenGL
+ *  4.3, which software drivers like Mesa's llvmpipe offer.
+ ***********************************************************/
+bool GpuCulling::IsSupported()
+{
+	return(GLEW_VERSION_4_3 ? true : false);
+}
+
+/***********************************************************
+ *  BuildProgram()
+ *
+ *  This method compiles and links the culling compute shader.
+ ***********************************************************/
+GLuint GpuCulling::BuildProgram(const char* computeFilePath)
+{
+	std::ifstream file(computeFilePath, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader source:" << computeFilePath << std::endl;
+		return(0);
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	std::string source = stream.str();
+	const char* sourceText = source.c_str();
+
+	GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shader, 1, &sourceText, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char infoLog[1024];
+		glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+		std::cout << "ERROR: culling compute shader failed to compile:" << std::endl << infoLog << std::endl;
+		glDeleteShader(shader);
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char infoLog[1024];
+		glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+		std::cout << "ERROR: culling compute shader failed to link:" << std::endl << infoLog << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+
+	return(program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method builds the culling program and uploads the
+ *  index range of every mesh, which the compute shader copies
+ *  into the draw commands.
+ ***********************************************************/
+bool GpuCulling::Initialize(const char* computeFilePath)
+{
+	if (IsSupported() == false)
+	{
+		std::cout << "INFO: GPU culling needs OpenGL 4.3 - not available" << std::endl;
+		return(false);
+	}
+
+	m_cullProgram = BuildProgram(computeFilePath);
+	if (m_cullProgram == 0)
+	{
+		return(false);
+	}
+
+	m_objectCountLocation = glGetUniformLocation(m_cullProgram, "objectCount");
+	m_frustumPlanesLocation = glGetUniformLocation(m_cullProgram, "frustumPlanes");
+
+	// index count, first index and base vertex of every mesh
+	std::vector<GLint> meshes;
+	for (int i = 0; i < m_pMeshGeometry->GetMeshCount(); i++)
+	{
+		const MeshGeometry::MESH_RANGE& range = m_pMeshGeometry->GetMesh(i);
+		meshes.push_back((GLint)range.indexCount);
+		meshes.push_back((GLint)range.firstIndex);
+		meshes.push_back(range.baseVertex);
+		meshes.push_back(0);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_meshBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(GLint), meshes.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// without the draw count in a buffer every command slot is
+	// drawn, so the unused ones are cleared to zero instances
+	m_bIndirectCount = GLEW_ARB_indirect_parameters ? true : false;
+
+	std::cout << "INFO: GPU culling ready, draw count read "
+		<< (m_bIndirectCount ? "by the GPU" : "from cleared command slots") << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetObjects()
+ *
+ *  This method gives every draw group a range of command
+ *  slots large enough for all of its objects, records the
+ *  start of the range in each object and uploads them.  It
+ *  also points the object index attribute of the mesh
+ *  vertex array at a buffer of 0, 1, 2 ... so that the base
+ *  instance of a command selects its object.
+ ***********************************************************/
+void GpuCulling::SetObjects(const std::vector<OBJECT_DATA>& objects, int groupCount)
+{
+	m_objectCount = (int)objects.size();
+	m_groupOffsets.assign(groupCount, 0);
+	m_groupCapacities.assign(groupCount, 0);
+
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		m_groupCapacities[objects[i].drawInfo[1]]++;
+	}
+
+	GLuint offset = 0;
+	for (int group = 0; group < groupCount; group++)
+	{
+		m_groupOffsets[group] = offset;
+		offset += m_groupCapacities[group];
+	}
+
+	std::vector<OBJECT_DATA> laidOut = objects;
+	for (size_t i = 0; i < laidOut.size(); i++)
+	{
+		laidOut[i].drawInfo[2] = m_groupOffsets[laidOut[i].drawInfo[1]];
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, laidOut.size() * sizeof(OBJECT_DATA), laidOut.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, m_objectCount * sizeof(DRAW_ELEMENTS_COMMAND), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCountBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, groupCount * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	for (int i = 0; i < READBACK_FRAMES; i++)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_readbackBuffers[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, groupCount * sizeof(GLuint), NULL, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	std::vector<GLuint> objectIndices(m_objectCount);
+	for (int i = 0; i < m_objectCount; i++)
+	{
+		objectIndices[i] = (GLuint)i;
+	}
+
+	m_pStateCache->BindVertexArray(m_pMeshGeometry->GetVertexArray());
+	glBindBuffer(GL_ARRAY_BUFFER, m_objectIndexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, objectIndices.size() * sizeof(GLuint), objectIndices.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(3);
+	glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+	glVertexAttribDivisor(3, 1);
+	m_pStateCache->BindVertexArray(0);
+}
+
+/***********************************************************
+ *  UpdateObjects()
+ *
+ *  This method uploads new transforms or materials for the
+ *  objects passed to SetObjects(), keeping their layout.
+ ***********************************************************/
+void GpuCulling::UpdateObjects(const std::vector<OBJECT_DATA>& objects)
+{
+	if ((int)objects.size() != m_objectCount)
+	{
+		SetObjects(objects, (int)m_groupOffsets.size());
+		return;
+	}
+
+	std::vector<OBJECT_DATA> laidOut = objects;
+	for (size_t i = 0; i < laidOut.size(); i++)
+	{
+		laidOut[i].drawInfo[2] = m_groupOffsets[laidOut[i].drawInfo[1]];
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, laidOut.size() * sizeof(OBJECT_DATA), laidOut.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method resets the draw counts, dispatches one thread
+ *  per object against the frustum planes of the camera and
+ *  makes the written commands visible to the indirect draws.
+ ***********************************************************/
+void GpuCulling::Cull(const glm::mat4& viewProjection)
+{
+	if ((m_cullProgram == 0) || (m_objectCount == 0))
+	{
+		return;
+	}
+
+	CollectReadback();
+
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCountBuffer);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	if (m_bIndirectCount == false)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	}
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	// the planes of the frustum from the rows of the combined
+	// matrix, glm stores the matrix by column
+	glm::vec4 rowX(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 rowY(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 rowZ(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 rowW(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	glm::vec4 planes[6] =
+	{
+		rowW + rowX, rowW - rowX,
+		rowW + rowY, rowW - rowY,
+		rowW + rowZ, rowW - rowZ
+	};
+
+	for (int i = 0; i < 6; i++)
+	{
+		planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+	}
+
+	m_pStateCache->UseProgram(m_cullProgram);
+	glUniform1ui(m_objectCountLocation, (GLuint)m_objectCount);
+	glUniform4fv(m_frustumPlanesLocation, 6, &planes[0][0]);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BUFFER_BINDING, m_objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_BUFFER_BINDING, m_meshBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BUFFER_BINDING, m_commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BUFFER_BINDING, m_drawCountBuffer);
+
+	glDispatchCompute((m_objectCount + g_CullGroupSize - 1) / g_CullGroupSize, 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// keep a copy of the draw counts to read once the GPU is done
+	int slot = m_readbackFrame % READBACK_FRAMES;
+	if (m_readbackFences[slot] == 0)
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, m_drawCountBuffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_readbackBuffers[slot]);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_groupOffsets.size() * sizeof(GLuint));
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		m_readbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_readbackFrame++;
+	}
+}
+
+/***********************************************************
+ *  CollectReadback()
+ *
+ *  This method reads the oldest copied draw counts, but only
+ *  if its fence says the GPU has already written them.
+ ***********************************************************/
+void GpuCulling::CollectReadback()
+{
+	int slot = m_readbackFrame % READBACK_FRAMES;
+	if (m_readbackFences[slot] == 0)
+	{
+		return;
+	}
+
+	if (glClientWaitSync(m_readbackFences[slot], 0, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		return;
+	}
+
+	glDeleteSync(m_readbackFences[slot]);
+	m_readbackFences[slot] = 0;
+
+	std::vector<GLuint> counts(m_groupOffsets.size(), 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, m_readbackBuffers[slot]);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, counts.size() * sizeof(GLuint), counts.data());
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	m_visibleCount = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		m_visibleCount += (int)counts[i];
+	}
+}
+
+/***********************************************************
+ *  BeginDraws()
+ *
+ *  This method binds the shared mesh vertex array and the
+ *  buffers the indirect draws read from.
+ ***********************************************************/
+void GpuCulling::BeginDraws()
+{
+	m_pStateCache->BindVertexArray(m_pMeshGeometry->GetVertexArray());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BUFFER_BINDING, m_objectBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	if (m_bIndirectCount == true)
+	{
+		glBindBuffer(GL_PARAMETER_BUFFER_ARB, m_drawCountBuffer);
+	}
+}
+
+/***********************************************************
+ *  DrawGroup()
+ *
+ *  This method draws the commands the culling pass wrote for
+ *  one draw group.  With the draw count in a buffer only the
+ *  written commands are read, otherwise the whole range is
+ *  submitted and the cleared slots draw nothing.
+ ***********************************************************/
+void GpuCulling::DrawGroup(int group)
+{
+	GLsizei capacity = (GLsizei)m_groupCapacities[group];
+	if (capacity == 0)
+	{
+		return;
+	}
+
+	const void* commands = (const void*)(m_groupOffsets[group] * sizeof(DRAW_ELEMENTS_COMMAND));
+
+	if (m_bIndirectCount == true)
+	{
+		glMultiDrawElementsIndirectCountARB(
+			GL_TRIANGLES,
+			GL_UNSIGNED_INT,
+			commands,
+			(GLintptr)(group * sizeof(GLuint)),
+			capacity,
+			0);
+	}
+	else
+	{
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, capacity, 0);
+	}
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method returns the number of objects being culled.
+ ***********************************************************/
+int GpuCulling::GetObjectCount() const
+{
+	return(m_objectCount);
+}
+
+/***********************************************************
+ *  GetGroupCount()
+ *
+ *  This method returns the number of draw groups.
+ ***********************************************************/
+int GpuCulling::GetGroupCount() const
+{
+	return((int)m_groupOffsets.size());
+}
+
+/***********************************************************
+ *  GetVisibleCount()
+ *
+ *  This method returns how many objects passed the culling
+ *  in the most recent frame that could be read back.
+ ***********************************************************/
+int GpuCulling::GetVisibleCount() const
+{
+	return(m_visibleCount);
+}
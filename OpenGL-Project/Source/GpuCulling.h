@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuculling.h
+// ============
+// cull the scene objects in a compute shader and draw them indirectly
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "MeshGeometry.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  GpuCulling
+ *
+ *  This class keeps the transforms, bounds and materials of
+ *  the scene objects in a shader storage buffer.  Every frame
+ *  a compute shader tests the objects against the view
+ *  frustum and appends a draw command for each visible one
+ *  to the command range of its draw group, so every group -
+ *  the objects sharing one texture - is drawn with a single
+ *  glMultiDrawElementsIndirect call and the CPU never looks
+ *  at the individual objects.  The object index reaches the
+ *  vertex shader through the base instance of the command.
+ ***********************************************************/
+class GpuCulling
+{
+public:
+	// per-object data, must match ObjectData in the shaders
+	struct OBJECT_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 boundsMinimum;
+		glm::vec4 boundsMaximum;
+		// mesh, draw group, first command of the group, unused
+		GLuint drawInfo[4];
+		glm::vec4 objectColor;
+		// w ambient strength
+		glm::vec4 ambientColor;
+		glm::vec4 diffuseColor;
+		// w shininess
+		glm::vec4 specularColor;
+		// xy UV scale
+		glm::vec4 textureScale;
+	};
+
+	// shader storage buffer bindings used by the culling pass,
+	// the lighting uses the bindings below these
+	static const GLuint OBJECT_BUFFER_BINDING = 3;
+	static const GLuint MESH_BUFFER_BINDING = 4;
+	static const GLuint COMMAND_BUFFER_BINDING = 5;
+	static const GLuint DRAW_COUNT_BUFFER_BINDING = 6;
+
+	// constructor
+	GpuCulling(GLStateCache* pStateCache, MeshGeometry* pMeshGeometry);
+	// destructor
+	~GpuCulling();
+
+	// whether the context has compute shaders and indirect draws
+	static bool IsSupported();
+
+	// build the culling program and the mesh table
+	bool Initialize(const char* computeFilePath);
+	// lay out the objects and their draw groups, the mesh and draw
+	// group of each object are taken from its drawInfo
+	void SetObjects(const std::vector<OBJECT_DATA>& objects, int groupCount);
+	// upload changed object data in the layout set before
+	void UpdateObjects(const std::vector<OBJECT_DATA>& objects);
+	// run the culling compute shader for a camera
+	void Cull(const glm::mat4& viewProjection);
+	// bind the mesh and object buffers for the draws
+	void BeginDraws();
+	// draw the visible objects of one group with the current program
+	void DrawGroup(int group);
+
+	int GetObjectCount() const;
+	int GetGroupCount() const;
+	// visible objects of a recent frame, read back without stalling
+	int GetVisibleCount() const;
+
+private:
+	// number of frames the draw counts are read back behind
+	static const int READBACK_FRAMES = 3;
+
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	// shared buffers of all the meshes
+	MeshGeometry* m_pMeshGeometry;
+
+	GLuint m_cullProgram;
+	GLint m_objectCountLocation;
+	GLint m_frustumPlanesLocation;
+
+	GLuint m_objectBuffer;
+	GLuint m_meshBuffer;
+	GLuint m_commandBuffer;
+	GLuint m_drawCountBuffer;
+	// identity object indices read through the base instance
+	GLuint m_objectIndexBuffer;
+
+	int m_objectCount;
+	// command range of every draw group
+	std::vector<GLuint> m_groupOffsets;
+	std::vector<GLuint> m_groupCapacities;
+	// whether the draw count can be read by the GPU directly
+	bool m_bIndirectCount;
+
+	// delayed copies of the draw counts for the statistics
+	GLuint m_readbackBuffers[READBACK_FRAMES];
+	GLsync m_readbackFences[READBACK_FRAMES];
+	int m_readbackFrame;
+	int m_visibleCount;
+
+	// pick up the draw counts of an older frame if the GPU is done
+	void CollectReadback();
+	// compile and link the compute shader
+	static GLuint BuildProgram(const char* computeFilePath);
+};
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// gputimer.cpp
+// ============
+// measure how long the GPU spends on a block of draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GpuTimer.h"
+
+// declaration of global variables
+namespace
+{
+	// weight of a new sample in the smoothed time
+	const double g_AverageWeight = 0.1;
+}
+
+/***********************************************************
+ *  GpuTimer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GpuTimer::GpuTimer()
+{
+	glGenQueries(QUERY_COUNT, m_queries);
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_bPending[i] = false;
+	}
+
+	m_nextQuery = 0;
+	m_bActive = false;
+	m_milliseconds = 0.0;
+	m_averageMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~GpuTimer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GpuTimer::~GpuTimer()
+{
+	glDeleteQueries(QUERY_COUNT, m_queries);
+}
+
+/***********************************************************
+ *  CollectResults()
+ *
+ *  This method reads every finished query, oldest first, so
+ *  the latest time is the one that is kept.
+ ***********************************************************/
+void GpuTimer::CollectResults()
+{
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		int index = (m_nextQuery + i) % QUERY_COUNT;
+		if (m_bPending[index] == false)
+		{
+			continue;
+		}
+
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != GL_TRUE)
+		{
+			continue;
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &nanoseconds);
+		m_bPending[index] = false;
+
+		m_milliseconds = (double)nanoseconds / 1000000.0;
+		if (m_averageMilliseconds == 0.0)
+		{
+			m_averageMilliseconds = m_milliseconds;
+		}
+		else
+		{
+			m_averageMilliseconds += (m_milliseconds - m_averageMilliseconds) * g_AverageWeight;
+		}
+	}
+}
+
+/***********************************************************
+ *  Begin()
+ *
+ *  This method starts timing the commands that follow.  When
+ *  every query is still waiting on the GPU, this frame is
+ *  simply not timed.
+ ***********************************************************/
+void GpuTimer::Begin()
+{
+	CollectResults();
+
+	if (m_bPending[m_nextQuery] == true)
+	{
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_nextQuery]);
+	m_bActive = true;
+}
+
+/***********************************************************
+ *  End()
+ *
+ *  This method stops timing.
+ ***********************************************************/
+void GpuTimer::End()
+{
+	if (m_bActive == false)
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bPending[m_nextQuery] = true;
+	m_nextQuery = (m_nextQuery + 1) % QUERY_COUNT;
+	m_bActive = false;
+}
+
+/***********************************************************
+ *  GetMilliseconds()
+ *
+ *  This method returns the latest time the GPU reported.
+ ***********************************************************/
+double GpuTimer::GetMilliseconds() const
+{
+	return(m_milliseconds);
+}
+
+/***********************************************************
+ *  GetAverageMilliseconds()
+ *
+ *  This method returns the time smoothed over recent frames.
+ ***********************************************************/
+double GpuTimer::GetAverageMilliseconds() const
+{
+	return(m_averageMilliseconds);
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// gputimer.h
+// ============
+// measure how long the GPU spends on a block of draw commands
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  GpuTimer
+ *
+ *  This class wraps GL_TIME_ELAPSED queries.  The queries
+ *  are used round robin and a result is only read once the
+ *  GPU has made it available, so timing a pass never stalls
+ *  the pipeline - the reported time lags a few frames
+ *  behind.  Timers can not be nested, since only one elapsed
+ *  time query may be active at once.
+ ***********************************************************/
+class GpuTimer
+{
+public:
+	// constructor
+	GpuTimer();
+	// destructor
+	~GpuTimer();
+
+	// start timing the following commands
+	void Begin();
+	// stop timing
+	void End();
+
+	// most recent available GPU time in milliseconds
+	double GetMilliseconds() const;
+	// smoothed GPU time in milliseconds
+	double GetAverageMilliseconds() const;
+
+private:
+	// queries in flight before the oldest one is reused
+	static const int QUERY_COUNT = 4;
+
+	GLuint m_queries[QUERY_COUNT];
+	bool m_bPending[QUERY_COUNT];
+	int m_nextQuery;
+	bool m_bActive;
+	double m_milliseconds;
+	double m_averageMilliseconds;
+
+	// read the results of the queries that have finished
+	void CollectResults();
+};
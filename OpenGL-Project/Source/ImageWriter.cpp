@@ -0,0 +1,596 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagewriter.cpp
+// ============
+// write rendered images to files
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// LZ77 window and longest match deflate allows
+	const int g_WindowSize = 32768;
+	const int g_MaxMatch = 258;
+	const int g_MinMatch = 3;
+	// hash table of three byte sequences and how many earlier
+	// positions of a sequence are tried
+	const int g_HashBits = 15;
+	const int g_MaxChainLength = 32;
+
+	// base lengths and distances of the deflate codes and the
+	// extra bits that follow them
+	const unsigned short g_LengthBase[29] = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const unsigned char g_LengthExtra[29] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const unsigned short g_DistanceBase[30] = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const unsigned char g_DistanceExtra[30] = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	/***********************************************************
+	 *  BIT_WRITER
+	 *
+	 *  Appends bit fields to a byte stream, least significant
+	 *  bit first as deflate packs them.
+	 ***********************************************************/
+	struct BIT_WRITER
+	{
+		std::vector<unsigned char>& bytes;
+		unsigned int buffer;
+		int count;
+
+		BIT_WRITER(std::vector<unsigned char>& stream) : bytes(stream)
+		{
+			buffer = 0;
+			count = 0;
+		}
+
+		void Write(unsigned int bits, int bitCount)
+		{
+			buffer |= bits << count;
+			count += bitCount;
+			while (count >= 8)
+			{
+				bytes.push_back((unsigned char)(buffer & 0xFF));
+				buffer >>= 8;
+				count -= 8;
+			}
+		}
+
+		// Huffman codes are defined most significant bit first
+		void WriteCode(unsigned int code, int bitCount)
+		{
+			unsigned int reversed = 0;
+			for (int i = 0; i < bitCount; i++)
+			{
+				reversed = (reversed << 1) | ((code >> i) & 1);
+			}
+			Write(reversed, bitCount);
+		}
+
+		void Flush()
+		{
+			if (count > 0)
+			{
+				bytes.push_back((unsigned char)(buffer & 0xFF));
+			}
+			buffer = 0;
+			count = 0;
+		}
+	};
+
+	/***********************************************************
+	 *  WriteLiteral()
+	 *
+	 *  Write a literal, length or end of block symbol with the
+	 *  fixed Huffman code of deflate.
+	 ***********************************************************/
+	void WriteLiteral(BIT_WRITER& writer, int symbol)
+	{
+		if (symbol < 144)
+		{
+			writer.WriteCode(0x30 + symbol, 8);
+		}
+		else if (symbol < 256)
+		{
+			writer.WriteCode(0x190 + (symbol - 144), 9);
+		}
+		else if (symbol < 280)
+		{
+			writer.WriteCode(symbol - 256, 7);
+		}
+		else
+		{
+			writer.WriteCode(0xC0 + (symbol - 280), 8);
+		}
+	}
+
+	/***********************************************************
+	 *  WriteMatch()
+	 *
+	 *  Write the length and distance codes of an LZ77 match.
+	 ***********************************************************/
+	void WriteMatch(BIT_WRITER& writer, int length, int distance)
+	{
+		int lengthCode = 28;
+		while (g_LengthBase[lengthCode] > length)
+		{
+			lengthCode--;
+		}
+		WriteLiteral(writer, 257 + lengthCode);
+		writer.Write(length - g_LengthBase[lengthCode], g_LengthExtra[lengthCode]);
+
+		int distanceCode = 29;
+		while (g_DistanceBase[distanceCode] > distance)
+		{
+			distanceCode--;
+		}
+		writer.WriteCode(distanceCode, 5);
+		writer.Write(distance - g_DistanceBase[distanceCode], g_DistanceExtra[distanceCode]);
+	}
+
+	// lookup table of the CRC-32 of every byte value
+	struct CRC_TABLE
+	{
+		unsigned int values[256];
+	};
+
+	/***********************************************************
+	 *  MakeCrcTable()
+	 *
+	 *  Work out the CRC-32 of every byte value.
+	 ***********************************************************/
+	CRC_TABLE MakeCrcTable()
+	{
+		CRC_TABLE table;
+		for (unsigned int n = 0; n < 256; n++)
+		{
+			unsigned int c = n;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			table.values[n] = c;
+		}
+
+		return(table);
+	}
+
+	/***********************************************************
+	 *  Crc32()
+	 *
+	 *  CRC-32 of the bytes as PNG chunks store it, continued
+	 *  from the passed in value.  The encoder threads write
+	 *  PNGs at the same time, and the table is made by the
+	 *  first of them while the others wait for it.
+	 ***********************************************************/
+	unsigned int Crc32(const unsigned char* data, size_t length, unsigned int crc)
+	{
+		static const CRC_TABLE table = MakeCrcTable();
+
+		crc = ~crc;
+		for (size_t i = 0; i < length; i++)
+		{
+			crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+
+		return(~crc);
+	}
+
+	/***********************************************************
+	 *  PutBigEndian()
+	 *
+	 *  Append a 32-bit value most significant byte first.
+	 ***********************************************************/
+	void PutBigEndian(std::vector<unsigned char>& bytes, unsigned int value)
+	{
+		bytes.push_back((unsigned char)(value >> 24));
+		bytes.push_back((unsigned char)(value >> 16));
+		bytes.push_back((unsigned char)(value >> 8));
+		bytes.push_back((unsigned char)value);
+	}
+
+	/***********************************************************
+	 *  PutLittleEndian()
+	 *
+	 *  Append a value of a number of bytes least significant
+	 *  byte first.
+	 ***********************************************************/
+	void PutLittleEndian(std::vector<unsigned char>& bytes, unsigned long long value, int byteCount)
+	{
+		for (int i = 0; i < byteCount; i++)
+		{
+			bytes.push_back((unsigned char)(value >> (i * 8)));
+		}
+	}
+
+	/***********************************************************
+	 *  WriteChunk()
+	 *
+	 *  Append a PNG chunk with its length and checksum.
+	 ***********************************************************/
+	void WriteChunk(std::vector<unsigned char>& file, const char* type, const std::vector<unsigned char>& data)
+	{
+		PutBigEndian(file, (unsigned int)data.size());
+
+		size_t start = file.size();
+		file.insert(file.end(), type, type + 4);
+		file.insert(file.end(), data.begin(), data.end());
+
+		PutBigEndian(file, Crc32(file.data() + start, file.size() - start, 0));
+	}
+
+	/***********************************************************
+	 *  PaethPredictor()
+	 *
+	 *  The neighbour closest to left + up - upper left.
+	 ***********************************************************/
+	int PaethPredictor(int left, int up, int upperLeft)
+	{
+		int estimate = left + up - upperLeft;
+		int distanceLeft = abs(estimate - left);
+		int distanceUp = abs(estimate - up);
+		int distanceUpperLeft = abs(estimate - upperLeft);
+
+		if ((distanceLeft <= distanceUp) && (distanceLeft <= distanceUpperLeft))
+		{
+			return(left);
+		}
+		return((distanceUp <= distanceUpperLeft) ? up : upperLeft);
+	}
+}
+
+/***********************************************************
+ *  WriteTGA()
+ *
+ *  This method writes an uncompressed 32-bit TGA file, which
+ *  any image viewer opens.
+ ***********************************************************/
+bool ImageWriter::WriteTGA(const char* filePath, const std::vector<unsigned int>& pixels, int width, int height)
+{
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Could not write image:" << filePath << std::endl;
+		return(false);
+	}
+
+	unsigned char header[18] = {};
+	// uncompressed true color, 32 bits with 8 alpha bits and the
+	// first row at the top
+	header[2] = 2;
+	header[12] = (unsigned char)(width & 0xFF);
+	header[13] = (unsigned char)((width >> 8) & 0xFF);
+	header[14] = (unsigned char)(height & 0xFF);
+	header[15] = (unsigned char)((height >> 8) & 0xFF);
+	header[16] = 32;
+	header[17] = 0x28;
+	file.write((const char*)header, sizeof(header));
+
+	// TGA stores blue, green, red, alpha
+	std::vector<unsigned char> bytes(pixels.size() * 4);
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		unsigned int color = pixels[i];
+		bytes[i * 4 + 0] = (unsigned char)((color >> 16) & 0xFF);
+		bytes[i * 4 + 1] = (unsigned char)((color >> 8) & 0xFF);
+		bytes[i * 4 + 2] = (unsigned char)(color & 0xFF);
+		bytes[i * 4 + 3] = (unsigned char)(color >> 24);
+	}
+	file.write((const char*)bytes.data(), bytes.size());
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  Deflate()
+ *
+ *  This method compresses data into a zlib stream with one
+ *  deflate block of fixed Huffman codes.  Matches are found
+ *  through hash chains of three byte sequences, which gets
+ *  rendered images to roughly the size of a fast zlib level
+ *  without the code tables of the dynamic Huffman blocks.
+ ***********************************************************/
+void ImageWriter::Deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& stream)
+{
+	stream.clear();
+	stream.reserve(data.size() / 2 + 64);
+
+	// zlib header, deflate with a 32K window and no dictionary
+	stream.push_back(0x78);
+	stream.push_back(0x01);
+
+	BIT_WRITER writer(stream);
+	// final block with fixed Huffman codes
+	writer.Write(1, 1);
+	writer.Write(1, 2);
+
+	const int hashSize = 1 << g_HashBits;
+	std::vector<int> head(hashSize, -1);
+	std::vector<int> previous(g_WindowSize, -1);
+	int size = (int)data.size();
+
+	int position = 0;
+	while (position < size)
+	{
+		int bestLength = 0;
+		int bestDistance = 0;
+
+		if (position + g_MinMatch <= size)
+		{
+			unsigned int hash = ((data[position] << 10) ^ (data[position + 1] << 5) ^ data[position + 2]) & (hashSize - 1);
+			int candidate = head[hash];
+			int maxLength = std::min(g_MaxMatch, size - position);
+			int chain = 0;
+
+			while ((candidate >= 0) && (position - candidate <= g_WindowSize) && (chain < g_MaxChainLength))
+			{
+				if (data[candidate + bestLength] == data[position + bestLength])
+				{
+					int length = 0;
+					while ((length < maxLength) && (data[candidate + length] == data[position + length]))
+					{
+						length++;
+					}
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = position - candidate;
+						if (length == maxLength)
+						{
+							break;
+						}
+					}
+				}
+
+				candidate = previous[candidate % g_WindowSize];
+				chain++;
+			}
+		}
+
+		int advance = 1;
+		if (bestLength >= g_MinMatch)
+		{
+			WriteMatch(writer, bestLength, bestDistance);
+			advance = bestLength;
+		}
+		else
+		{
+			WriteLiteral(writer, data[position]);
+		}
+
+		// every position a match covers goes into the chains
+		int end = position + advance;
+		while (position < end)
+		{
+			if (position + g_MinMatch <= size)
+			{
+				unsigned int hash = ((data[position] << 10) ^ (data[position + 1] << 5) ^ data[position + 2]) & (hashSize - 1);
+				previous[position % g_WindowSize] = head[hash];
+				head[hash] = position;
+			}
+			position++;
+		}
+	}
+
+	WriteLiteral(writer, 256);
+	writer.Flush();
+
+	// Adler-32 of the uncompressed data
+	unsigned int a = 1;
+	unsigned int b = 0;
+	for (int i = 0; i < size; i++)
+	{
+		a = (a + data[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	PutBigEndian(stream, (b << 16) | a);
+}
+
+/***********************************************************
+ *  WritePNG()
+ *
+ *  This method writes a 24-bit PNG file.  Every row is
+ *  filtered with whichever of the sub, up and Paeth filters
+ *  leaves the smallest residuals, before the whole image is
+ *  deflated.  The alpha channel is dropped, since a frame of
+ *  the window is opaque.
+ ***********************************************************/
+bool ImageWriter::WritePNG(const char* filePath, const std::vector<unsigned int>& pixels, int width, int height)
+{
+	int rowBytes = width * 3;
+	std::vector<unsigned char> rows((size_t)height * rowBytes);
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		rows[i * 3 + 0] = (unsigned char)(pixels[i] & 0xFF);
+		rows[i * 3 + 1] = (unsigned char)((pixels[i] >> 8) & 0xFF);
+		rows[i * 3 + 2] = (unsigned char)((pixels[i] >> 16) & 0xFF);
+	}
+
+	std::vector<unsigned char> filtered((size_t)height * (rowBytes + 1));
+	std::vector<unsigned char> candidate[3];
+	for (int f = 0; f < 3; f++)
+	{
+		candidate[f].resize(rowBytes);
+	}
+	std::vector<unsigned char> zeroRow(rowBytes, 0);
+
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* row = rows.data() + (size_t)y * rowBytes;
+		const unsigned char* above = (y > 0) ? row - rowBytes : zeroRow.data();
+
+		long long bestScore = -1;
+		int bestFilter = 0;
+		for (int f = 0; f < 3; f++)
+		{
+			long long score = 0;
+			for (int x = 0; x < rowBytes; x++)
+			{
+				int left = (x >= 3) ? row[x - 3] : 0;
+				int upperLeft = (x >= 3) ? above[x - 3] : 0;
+				int prediction = (f == 0) ? left : ((f == 1) ? above[x] : PaethPredictor(left, above[x], upperLeft));
+				unsigned char residual = (unsigned char)(row[x] - prediction);
+				candidate[f][x] = residual;
+				score += (residual < 128) ? residual : 256 - residual;
+			}
+			if ((bestScore < 0) || (score < bestScore))
+			{
+				bestScore = score;
+				bestFilter = f;
+			}
+		}
+
+		// PNG numbers the filters sub 1, up 2 and Paeth 4
+		unsigned char* destination = filtered.data() + (size_t)y * (rowBytes + 1);
+		destination[0] = (unsigned char)((bestFilter == 2) ? 4 : bestFilter + 1);
+		memcpy(destination + 1, candidate[bestFilter].data(), rowBytes);
+	}
+
+	std::vector<unsigned char> file;
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	file.insert(file.end(), signature, signature + 8);
+
+	std::vector<unsigned char> header;
+	PutBigEndian(header, (unsigned int)width);
+	PutBigEndian(header, (unsigned int)height);
+	// 8 bits per channel, true color, deflate, adaptive filters,
+	// not interlaced
+	header.push_back(8);
+	header.push_back(2);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	WriteChunk(file, "IHDR", header);
+
+	std::vector<unsigned char> compressed;
+	Deflate(filtered, compressed);
+	WriteChunk(file, "IDAT", compressed);
+	WriteChunk(file, "IEND", std::vector<unsigned char>());
+
+	std::ofstream output(filePath, std::ios::binary);
+	if (!output)
+	{
+		std::cout << "Could not write image:" << filePath << std::endl;
+		return(false);
+	}
+	output.write((const char*)file.data(), file.size());
+
+	return(output.good());
+}
+
+/***********************************************************
+ *  WriteEXR()
+ *
+ *  This method writes a scanline OpenEXR file with half
+ *  float B, G and R channels and no compression, which keeps
+ *  the values above one that an 8-bit format would clamp.
+ ***********************************************************/
+bool ImageWriter::WriteEXR(const char* filePath, const std::vector<unsigned short>& pixels, int width, int height)
+{
+	std::vector<unsigned char> file;
+
+	// magic number and version 2 with single part scanlines
+	PutLittleEndian(file, 20000630, 4);
+	PutLittleEndian(file, 2, 4);
+
+	// channels are listed in alphabetical order
+	const char* channelNames[3] = { "B", "G", "R" };
+	std::vector<unsigned char> channels;
+	for (int c = 0; c < 3; c++)
+	{
+		channels.push_back((unsigned char)channelNames[c][0]);
+		channels.push_back(0);
+		// half float, linear, reserved, no subsampling
+		PutLittleEndian(channels, 1, 4);
+		PutLittleEndian(channels, 0, 4);
+		PutLittleEndian(channels, 1, 4);
+		PutLittleEndian(channels, 1, 4);
+	}
+	channels.push_back(0);
+
+	std::vector<unsigned char> window;
+	PutLittleEndian(window, 0, 4);
+	PutLittleEndian(window, 0, 4);
+	PutLittleEndian(window, (unsigned int)(width - 1), 4);
+	PutLittleEndian(window, (unsigned int)(height - 1), 4);
+
+	float one = 1.0f;
+	unsigned int oneBits = 0;
+	memcpy(&oneBits, &one, sizeof(oneBits));
+	std::vector<unsigned char> floatOne;
+	PutLittleEndian(floatOne, oneBits, 4);
+
+	struct ATTRIBUTE
+	{
+		const char* name;
+		const char* type;
+		std::vector<unsigned char> value;
+	};
+	ATTRIBUTE attributes[8] = {
+		{ "channels", "chlist", channels },
+		{ "compression", "compression", std::vector<unsigned char>(1, 0) },
+		{ "dataWindow", "box2i", window },
+		{ "displayWindow", "box2i", window },
+		{ "lineOrder", "lineOrder", std::vector<unsigned char>(1, 0) },
+		{ "pixelAspectRatio", "float", floatOne },
+		{ "screenWindowCenter", "v2f", std::vector<unsigned char>(8, 0) },
+		{ "screenWindowWidth", "float", floatOne } };
+
+	for (int i = 0; i < 8; i++)
+	{
+		file.insert(file.end(), attributes[i].name, attributes[i].name + strlen(attributes[i].name) + 1);
+		file.insert(file.end(), attributes[i].type, attributes[i].type + strlen(attributes[i].type) + 1);
+		PutLittleEndian(file, attributes[i].value.size(), 4);
+		file.insert(file.end(), attributes[i].value.begin(), attributes[i].value.end());
+	}
+	file.push_back(0);
+
+	// offsets of the scanlines, which follow the table
+	size_t lineBytes = 8 + (size_t)width * 3 * 2;
+	size_t firstLine = file.size() + (size_t)height * 8;
+	for (int y = 0; y < height; y++)
+	{
+		PutLittleEndian(file, firstLine + (size_t)y * lineBytes, 8);
+	}
+
+	for (int y = 0; y < height; y++)
+	{
+		PutLittleEndian(file, (unsigned int)y, 4);
+		PutLittleEndian(file, (unsigned int)(width * 3 * 2), 4);
+
+		// the values of each channel follow each other, B first
+		const unsigned short* row = pixels.data() + (size_t)y * width * 4;
+		for (int c = 2; c >= 0; c--)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				PutLittleEndian(file, row[x * 4 + c], 2);
+			}
+		}
+	}
+
+	std::ofstream output(filePath, std::ios::binary);
+	if (!output)
+	{
+		std::cout << "Could not write image:" << filePath << std::endl;
+		return(false);
+	}
+	output.write((const char*)file.data(), file.size());
+
+	return(output.good());
+}
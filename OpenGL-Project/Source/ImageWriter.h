@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagewriter.h
+// ============
+// write rendered images to files
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <vector>
+
+/***********************************************************
+ *  ImageWriter
+ *
+ *  This class writes images rendered off the screen to files
+ *  without an encoder library.  The pixels are RGBA8 with
+ *  red in the low byte, or four 16-bit floats for EXR, with
+ *  the top row first.  The writers only read their inputs,
+ *  so any number of threads can write images at once.
+ ***********************************************************/
+class ImageWriter
+{
+public:
+	// write an uncompressed 32-bit TGA file
+	static bool WriteTGA(const char* filePath, const std::vector<unsigned int>& pixels, int width, int height);
+	// write a deflate compressed 24-bit PNG file, alpha is dropped
+	static bool WritePNG(const char* filePath, const std::vector<unsigned int>& pixels, int width, int height);
+	// write an uncompressed half float RGB OpenEXR file from RGBA
+	// half floats, alpha is dropped
+	static bool WriteEXR(const char* filePath, const std::vector<unsigned short>& pixels, int width, int height);
+
+private:
+	// zlib stream of the data, LZ77 matches with fixed Huffman codes
+	static void Deflate(const std::vector<unsigned char>& data, std::vector<unsigned char>& stream);
+};
@@ -0,0 +1,338 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostoratlas.cpp
+// ============
+// bake composite objects into billboards drawn in their place far away
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImpostorAtlas.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ImpostorVertexShaderPath = "Shaders/impostorVertexShader.glsl";
+	const char* g_ImpostorFragmentShaderPath = "Shaders/impostorFragmentShader.glsl";
+	// set for every impostor drawn, and too long to be kept in
+	// a short string
+	const std::string g_ImpostorHalfSizeName = "impostorHalfSize";
+
+	const float g_Pi = 3.14159265358979f;
+	// the bake cameras look through a narrow cone from far away,
+	// which is close to the flat projection of the billboard
+	// but keeps the clustered lights working
+	const float g_BakeFieldOfView = 10.0f;
+	// smallest size of a cell in the last mipmap level, so the
+	// filtering never reaches into the neighbouring cells
+	const int g_SmallestMipCell = 4;
+}
+
+/***********************************************************
+ *  GetDefaultSettings()
+ *
+ *  This method returns eight views, one every 45 degrees,
+ *  in cells that are sharp up to about a quarter of a 1080p
+ *  screen, well past the distance impostors are used at.
+ ***********************************************************/
+ImpostorAtlas::IMPOSTOR_SETTINGS ImpostorAtlas::GetDefaultSettings()
+{
+	IMPOSTOR_SETTINGS settings;
+	settings.viewCount = 8;
+	settings.cellSize = 256;
+
+	return(settings);
+}
+
+/***********************************************************
+ *  ImpostorAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ImpostorAtlas::ImpostorAtlas(GLStateCache* pStateCache)
+{
+	m_pStateCache = pStateCache;
+	m_pImpostorShader = NULL;
+	m_settings = GetDefaultSettings();
+	m_impostorCount = 0;
+	m_atlasTexture = 0;
+	m_depthBuffer = 0;
+	m_framebuffer = 0;
+	m_emptyVertexArray = 0;
+}
+
+/***********************************************************
+ *  ~ImpostorAtlas()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ImpostorAtlas::~ImpostorAtlas()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+		m_framebuffer = 0;
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+		m_depthBuffer = 0;
+	}
+	if (m_atlasTexture != 0)
+	{
+		glDeleteTextures(1, &m_atlasTexture);
+		m_atlasTexture = 0;
+	}
+	if (m_emptyVertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_emptyVertexArray);
+		m_emptyVertexArray = 0;
+	}
+	if (NULL != m_pImpostorShader)
+	{
+		delete m_pImpostorShader;
+		m_pImpostorShader = NULL;
+	}
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method loads the program the impostors are drawn
+ *  with and allocates the atlas, with the views of an
+ *  impostor side by side in its row, and the framebuffer
+ *  the views are baked through.
+ ***********************************************************/
+bool ImpostorAtlas::Create(int impostorCount, const IMPOSTOR_SETTINGS& settings)
+{
+	if ((impostorCount <= 0) || (settings.viewCount <= 0) || (settings.cellSize <= 0))
+	{
+		return(false);
+	}
+	m_settings = settings;
+	m_impostorCount = impostorCount;
+
+	m_pImpostorShader = new ShaderManager();
+	m_pImpostorShader->LoadShaders(g_ImpostorVertexShaderPath, g_ImpostorFragmentShaderPath);
+	if (m_pImpostorShader->m_programID == 0)
+	{
+		std::cout << "Impostors are off, the impostor program did not load" << std::endl;
+		delete m_pImpostorShader;
+		m_pImpostorShader = NULL;
+		return(false);
+	}
+
+	int width = m_settings.cellSize * m_settings.viewCount;
+	int height = m_settings.cellSize * m_impostorCount;
+	int levels = 1;
+	while ((m_settings.cellSize >> levels) >= g_SmallestMipCell)
+	{
+		levels++;
+	}
+
+	glGenTextures(1, &m_atlasTexture);
+	m_pStateCache->BindTexture(GL_TEXTURE_2D, m_atlasTexture);
+	glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_atlasTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (bComplete == false)
+	{
+		std::cout << "Impostors are off, the atlas framebuffer is incomplete" << std::endl;
+		delete m_pImpostorShader;
+		m_pImpostorShader = NULL;
+		return(false);
+	}
+
+	glGenVertexArrays(1, &m_emptyVertexArray);
+
+	std::cout << "INFO: Impostor Atlas: " << width << "x" << height << " for "
+		<< m_impostorCount << " impostors of " << m_settings.viewCount << " views" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetBakeCamera()
+ *
+ *  This method returns the camera of one baked view.  View
+ *  zero looks at the object from +Z, the others follow at
+ *  even steps around the vertical axis, always level, and
+ *  the object's square fills the cell exactly.
+ ***********************************************************/
+void ImpostorAtlas::GetBakeCamera(
+	int view,
+	const glm::vec3& center,
+	float halfSize,
+	glm::mat4& viewMatrix,
+	glm::mat4& projection,
+	glm::vec3& viewPosition) const
+{
+	float angle = 2.0f * g_Pi * (float)view / (float)m_settings.viewCount;
+	glm::vec3 direction = glm::vec3(std::sin(angle), 0.0f, std::cos(angle));
+
+	float fieldOfView = glm::radians(g_BakeFieldOfView);
+	float distance = halfSize / std::tan(fieldOfView * 0.5f);
+
+	viewPosition = center + direction * distance;
+	viewMatrix = glm::lookAt(viewPosition, center, glm::vec3(0.0f, 1.0f, 0.0f));
+	projection = glm::perspective(fieldOfView, 1.0f, distance - halfSize * 2.0f, distance + halfSize * 2.0f);
+}
+
+/***********************************************************
+ *  BeginBake()
+ *
+ *  This method binds the atlas with the viewport and scissor
+ *  on one cell and clears it to transparent black.  Color is
+ *  blended as usual while alpha adds up the coverage, which
+ *  leaves premultiplied color in the cell.
+ ***********************************************************/
+void ImpostorAtlas::BeginBake(int impostor, int view)
+{
+	int x = view * m_settings.cellSize;
+	int y = impostor * m_settings.cellSize;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(x, y, m_settings.cellSize, m_settings.cellSize);
+	glScissor(x, y, m_settings.cellSize, m_settings.cellSize);
+	m_pStateCache->Enable(GL_SCISSOR_TEST);
+
+	m_pStateCache->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	m_pStateCache->DepthMask(GL_TRUE);
+	const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const GLfloat clearDepth = 1.0f;
+	glClearBufferfv(GL_COLOR, 0, clearColor);
+	glClearBufferfv(GL_DEPTH, 0, &clearDepth);
+
+	m_pStateCache->Enable(GL_DEPTH_TEST);
+	m_pStateCache->DepthFunc(GL_LESS);
+	m_pStateCache->Enable(GL_BLEND);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+/***********************************************************
+ *  EndBake()
+ *
+ *  This method goes back to the window framebuffer, builds
+ *  the mipmaps of the baked atlas and puts the blend factors
+ *  back to the ones the state cache knows.
+ ***********************************************************/
+void ImpostorAtlas::EndBake()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	m_pStateCache->Disable(GL_SCISSOR_TEST);
+
+	m_pStateCache->BindTexture(GL_TEXTURE_2D, m_atlasTexture);
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	m_pStateCache->Invalidate();
+}
+
+/***********************************************************
+ *  BeginDraws()
+ *
+ *  This method makes the impostor program current with the
+ *  camera and atlas of the frame.  The cells hold
+ *  premultiplied color, so they are blended with one.
+ ***********************************************************/
+void ImpostorAtlas::BeginDraws(const glm::mat4& viewMatrix, const glm::mat4& projection)
+{
+	m_pStateCache->UseProgram(m_pImpostorShader->m_programID);
+	m_pImpostorShader->setMat4Value("view", viewMatrix);
+	m_pImpostorShader->setMat4Value("projection", projection);
+	m_pImpostorShader->setVec2Value("cellScale", glm::vec2(
+		1.0f / (float)m_settings.viewCount,
+		1.0f / (float)m_impostorCount));
+	m_pStateCache->BindTextureUnit(0, GL_TEXTURE_2D, m_atlasTexture);
+	m_pImpostorShader->setSampler2DValue("impostorAtlas", 0);
+
+	m_pStateCache->Enable(GL_BLEND);
+	m_pStateCache->BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	m_pStateCache->DepthFunc(GL_LESS);
+	m_pStateCache->DepthMask(GL_TRUE);
+	m_pStateCache->BindVertexArray(m_emptyVertexArray);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method draws the quad of an impostor turned around
+ *  the vertical axis to face the camera.  The camera's angle
+ *  around the object falls between two baked views, which
+ *  are blended by how close it is to each.
+ ***********************************************************/
+void ImpostorAtlas::Draw(int impostor, const glm::vec3& center, float halfSize, const glm::vec3& viewPosition)
+{
+	glm::vec3 direction = viewPosition - center;
+	direction.y = 0.0f;
+	if (glm::length(direction) < 0.0001f)
+	{
+		direction = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+	direction = glm::normalize(direction);
+
+	float view = std::atan2(direction.x, direction.z) / (2.0f * g_Pi) * (float)m_settings.viewCount;
+	if (view < 0.0f)
+	{
+		view += (float)m_settings.viewCount;
+	}
+	float firstView = std::floor(view);
+	float blend = view - firstView;
+	int first = (int)firstView % m_settings.viewCount;
+	int second = (first + 1) % m_settings.viewCount;
+
+	// the right vector of the bake camera looking from the
+	// same direction
+	glm::vec3 right = glm::vec3(direction.z, 0.0f, -direction.x);
+
+	m_pImpostorShader->setVec3Value("impostorCenter", center);
+	m_pImpostorShader->setVec3Value("impostorRight", right);
+	m_pImpostorShader->setFloatValue(g_ImpostorHalfSizeName, halfSize);
+	m_pImpostorShader->setFloatValue("impostorRow", (float)impostor);
+	m_pImpostorShader->setVec2Value("viewCells", glm::vec2((float)first, (float)second));
+	m_pImpostorShader->setFloatValue("viewBlend", blend);
+
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+/***********************************************************
+ *  GetViewCount()
+ *
+ *  This method returns the number of baked views.
+ ***********************************************************/
+int ImpostorAtlas::GetViewCount() const
+{
+	return(m_settings.viewCount);
+}
+
+/***********************************************************
+ *  GetCellSize()
+ *
+ *  This method returns the size of one view in texels.
+ ***********************************************************/
+int ImpostorAtlas::GetCellSize() const
+{
+	return(m_settings.cellSize);
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// impostoratlas.h
+// ============
+// bake composite objects into billboards drawn in their place far away
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  ImpostorAtlas
+ *
+ *  This class holds one row of an atlas texture for every
+ *  impostor, with one cell for each of the views baked at
+ *  even angles around the vertical axis.  The scene renders
+ *  an object into the cells at load time, with the cameras
+ *  this class hands out, and far away the object is replaced
+ *  by a quad that turns around the vertical axis to face the
+ *  camera and blends the two baked views nearest to the
+ *  camera's angle.  The cells hold premultiplied color, so
+ *  glass stays see-through and the views blend without dark
+ *  fringes.
+ ***********************************************************/
+class ImpostorAtlas
+{
+public:
+	struct IMPOSTOR_SETTINGS
+	{
+		// views baked around the vertical axis
+		int viewCount;
+		// width and height of one view in texels
+		int cellSize;
+	};
+
+	// eight views in cells of 256 texels
+	static IMPOSTOR_SETTINGS GetDefaultSettings();
+
+	// constructor
+	ImpostorAtlas(GLStateCache* pStateCache);
+	// destructor
+	~ImpostorAtlas();
+
+	// load the impostor program and allocate the atlas with a
+	// row for each impostor
+	bool Create(int impostorCount, const IMPOSTOR_SETTINGS& settings);
+
+	// camera that bakes a view of an object whose bounds fit a
+	// square of the passed in half size around its center
+	void GetBakeCamera(
+		int view,
+		const glm::vec3& center,
+		float halfSize,
+		glm::mat4& viewMatrix,
+		glm::mat4& projection,
+		glm::vec3& viewPosition) const;
+	// render into the cell of one view, until EndBake()
+	void BeginBake(int impostor, int view);
+	// go back to the window and filter the baked atlas
+	void EndBake();
+
+	// set up the program for the impostors of a frame
+	void BeginDraws(const glm::mat4& viewMatrix, const glm::mat4& projection);
+	// draw the quad of one impostor facing the camera
+	void Draw(int impostor, const glm::vec3& center, float halfSize, const glm::vec3& viewPosition);
+
+	int GetViewCount() const;
+	int GetCellSize() const;
+
+private:
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	ShaderManager* m_pImpostorShader;
+	IMPOSTOR_SETTINGS m_settings;
+	int m_impostorCount;
+
+	GLuint m_atlasTexture;
+	GLuint m_depthBuffer;
+	GLuint m_framebuffer;
+	// the quad is made in the vertex shader, but a vertex array
+	// still has to be bound to draw it
+	GLuint m_emptyVertexArray;
+};
@@ -0,0 +1,471 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.cpp
+// ============
+// gather the input once per frame, record it and replay it deterministically
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputRecorder.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// GLFW callbacks are plain functions, so they reach the
+	// recorder through this pointer
+	InputRecorder* g_pRecorder = NULL;
+}
+
+/***********************************************************
+ *  InputRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InputRecorder::InputRecorder()
+{
+	m_pWindow = NULL;
+	m_cursorHandler = NULL;
+	m_scrollHandler = NULL;
+	m_mode = INPUT_LIVE;
+	m_nextEvent = 0;
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		m_keyDown[i] = false;
+	}
+	m_startTime = 0.0;
+	m_time = 0.0;
+	m_timestep = 0.0;
+	m_deltaTime = 0.0f;
+	m_frameCount = 0;
+	m_totalFrameMilliseconds = 0.0;
+	m_worstFrameMilliseconds = 0.0;
+	m_frameInputTime = -1.0;
+	m_latencyFrameCount = 0;
+	m_totalLatencyMilliseconds = 0.0;
+	m_worstLatencyMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~InputRecorder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InputRecorder::~InputRecorder()
+{
+	if (g_pRecorder == this)
+	{
+		g_pRecorder = NULL;
+	}
+	m_pWindow = NULL;
+}
+
+/***********************************************************
+ *  Attach()
+ *
+ *  This method installs the recorder's callbacks on the
+ *  window.  The handlers get the cursor and scroll events,
+ *  live or replayed, from inside PollInput().
+ ***********************************************************/
+void InputRecorder::Attach(GLFWwindow* window, GLFWcursorposfun cursorHandler, GLFWscrollfun scrollHandler)
+{
+	m_pWindow = window;
+	m_cursorHandler = cursorHandler;
+	m_scrollHandler = scrollHandler;
+	g_pRecorder = this;
+
+	glfwSetKeyCallback(window, &InputRecorder::KeyCallback);
+	glfwSetCursorPosCallback(window, &InputRecorder::CursorCallback);
+	glfwSetScrollCallback(window, &InputRecorder::ScrollCallback);
+
+	m_startTime = glfwGetTime();
+	m_time = 0.0;
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method starts keeping the live events, which are
+ *  written to the file by Stop().
+ ***********************************************************/
+void InputRecorder::StartRecording(const char* filePath)
+{
+	m_mode = INPUT_RECORD;
+	m_filePath = filePath;
+	m_events.clear();
+	m_startTime = glfwGetTime();
+	m_time = 0.0;
+
+	std::cout << "INFO: Recording Input: " << filePath << std::endl;
+}
+
+/***********************************************************
+ *  StartReplay()
+ *
+ *  This method loads a recording and switches from the live
+ *  input to it.
+ ***********************************************************/
+bool InputRecorder::StartReplay(const char* filePath, double timestep)
+{
+	if (Load(filePath) == false)
+	{
+		return(false);
+	}
+
+	m_mode = INPUT_REPLAY;
+	m_filePath = filePath;
+	m_nextEvent = 0;
+	m_pendingEvents.clear();
+	m_timestep = (timestep > 0.0) ? timestep : 1.0 / 60.0;
+	m_time = 0.0;
+	m_frameCount = 0;
+	m_totalFrameMilliseconds = 0.0;
+	m_worstFrameMilliseconds = 0.0;
+
+	std::cout << "INFO: Replaying Input: " << filePath << ", " << m_events.size() << " events, "
+		<< (m_timestep * 1000.0) << " ms per frame" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method writes the recording, or prints the frame
+ *  times of the replay, which are the numbers to compare
+ *  between builds.
+ ***********************************************************/
+void InputRecorder::Stop()
+{
+	if (m_mode == INPUT_RECORD)
+	{
+		if (Save(m_filePath.c_str()) == true)
+		{
+			std::cout << "INFO: Input Recorded: " << m_events.size() << " events, "
+				<< m_time << " s to " << m_filePath << std::endl;
+		}
+	}
+	else if ((m_mode == INPUT_REPLAY) && (m_frameCount > 1))
+	{
+		// the first frame has no previous frame to be timed from
+		int timedFrames = m_frameCount - 1;
+		std::cout << "INFO: Replay Finished: " << m_frameCount << " frames, "
+			<< (m_totalFrameMilliseconds / timedFrames) << " ms average, "
+			<< m_worstFrameMilliseconds << " ms worst" << std::endl;
+	}
+
+	m_mode = INPUT_LIVE;
+}
+
+/***********************************************************
+ *  PollInput()
+ *
+ *  This method is called once every frame, right before the
+ *  camera is updated, so the frame sees the newest input.
+ *  GLFW is polled and the frame advances by the wall clock
+ *  time since the last one, then the queued events are
+ *  applied in the order they arrived.  On replay it advances
+ *  by the fixed step instead, the key, cursor and scroll
+ *  events of the recording up to the new time are applied,
+ *  and the window is closed once the recording has run out.
+ ***********************************************************/
+void InputRecorder::PollInput()
+{
+	glfwPollEvents();
+	m_frameInputTime = -1.0;
+
+	if (m_mode != INPUT_REPLAY)
+	{
+		double now = glfwGetTime() - m_startTime;
+		m_deltaTime = (float)(now - m_time);
+		m_time = now;
+
+		for (size_t i = 0; i < m_pendingEvents.size(); i++)
+		{
+			const INPUT_EVENT& event = m_pendingEvents[i];
+			if (m_mode == INPUT_RECORD)
+			{
+				m_events.push_back(event);
+			}
+			ApplyEvent(event);
+		}
+		// the events are queued in order, so the first is the oldest
+		if (m_pendingEvents.empty() == false)
+		{
+			m_frameInputTime = m_pendingEvents[0].time + m_startTime;
+		}
+		m_pendingEvents.clear();
+		return;
+	}
+
+	std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+	if (m_frameCount > 0)
+	{
+		double milliseconds = std::chrono::duration<double, std::milli>(frameStart - m_lastFrameStart).count();
+		m_totalFrameMilliseconds += milliseconds;
+		if (milliseconds > m_worstFrameMilliseconds)
+		{
+			m_worstFrameMilliseconds = milliseconds;
+		}
+	}
+	m_lastFrameStart = frameStart;
+	m_frameCount++;
+
+	m_time += m_timestep;
+	m_deltaTime = (float)m_timestep;
+
+	// replayed events have no real arrival time, so their
+	// latency is counted from the moment they are applied
+	if ((m_nextEvent < m_events.size()) && (m_events[m_nextEvent].time <= m_time))
+	{
+		m_frameInputTime = glfwGetTime();
+	}
+	while ((m_nextEvent < m_events.size()) && (m_events[m_nextEvent].time <= m_time))
+	{
+		ApplyEvent(m_events[m_nextEvent]);
+		m_nextEvent++;
+	}
+
+	if ((m_nextEvent >= m_events.size()) && (NULL != m_pWindow))
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is called right after the buffers are
+ *  swapped.  For a frame that applied any input, the time
+ *  from the arrival of its oldest event to the swap is the
+ *  latency the user feels.  GLFW only delivers events while
+ *  it is polled, so the arrival is the poll that found the
+ *  event, which polling late keeps close to the real one.
+ ***********************************************************/
+void InputRecorder::EndFrame()
+{
+	if (m_frameInputTime < 0.0)
+	{
+		return;
+	}
+
+	double milliseconds = (glfwGetTime() - m_frameInputTime) * 1000.0;
+	m_totalLatencyMilliseconds += milliseconds;
+	if (milliseconds > m_worstLatencyMilliseconds)
+	{
+		m_worstLatencyMilliseconds = milliseconds;
+	}
+	m_latencyFrameCount++;
+	m_frameInputTime = -1.0;
+}
+
+/***********************************************************
+ *  ReportLatency()
+ *
+ *  This method prints the input to swap latency of the
+ *  frames since the last report and starts counting again.
+ ***********************************************************/
+void InputRecorder::ReportLatency()
+{
+	if (m_latencyFrameCount > 0)
+	{
+		std::cout << "INFO: Input To Swap Latency: "
+			<< (m_totalLatencyMilliseconds / m_latencyFrameCount) << " ms average, "
+			<< m_worstLatencyMilliseconds << " ms worst over "
+			<< m_latencyFrameCount << " frames with input" << std::endl;
+	}
+
+	m_latencyFrameCount = 0;
+	m_totalLatencyMilliseconds = 0.0;
+	m_worstLatencyMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  IsKeyDown()
+ *
+ *  This method returns whether a key is held, as the live or
+ *  replayed key events applied so far left it.
+ ***********************************************************/
+bool InputRecorder::IsKeyDown(int key) const
+{
+	return((key >= 0) && (key < KEY_COUNT) && m_keyDown[key]);
+}
+
+/***********************************************************
+ *  GetDeltaTime()
+ *
+ *  This method returns the seconds the current frame
+ *  advances the simulation by.
+ ***********************************************************/
+float InputRecorder::GetDeltaTime() const
+{
+	return(m_deltaTime);
+}
+
+/***********************************************************
+ *  GetMode()
+ *
+ *  This method returns whether the input is live, recorded
+ *  or replayed.
+ ***********************************************************/
+InputRecorder::INPUT_MODE InputRecorder::GetMode() const
+{
+	return(m_mode);
+}
+
+/***********************************************************
+ *  QueueEvent()
+ *
+ *  This method keeps a live event with the time since the
+ *  input started, until the next PollInput() applies it.
+ ***********************************************************/
+void InputRecorder::QueueEvent(int type, int key, int action, double x, double y)
+{
+	// a replay owns the input, live events are dropped
+	if (m_mode == INPUT_REPLAY)
+	{
+		return;
+	}
+
+	INPUT_EVENT event;
+	event.time = glfwGetTime() - m_startTime;
+	event.type = type;
+	event.key = key;
+	event.action = action;
+	event.x = x;
+	event.y = y;
+	m_pendingEvents.push_back(event);
+}
+
+/***********************************************************
+ *  ApplyEvent()
+ *
+ *  This method updates the key state with a key event, or
+ *  passes a cursor or scroll event on to its handler.
+ ***********************************************************/
+void InputRecorder::ApplyEvent(const INPUT_EVENT& event)
+{
+	if ((event.type == EVENT_KEY) && (event.key >= 0) && (event.key < KEY_COUNT))
+	{
+		m_keyDown[event.key] = (event.action != GLFW_RELEASE);
+	}
+	else if ((event.type == EVENT_CURSOR) && (NULL != m_cursorHandler))
+	{
+		m_cursorHandler(m_pWindow, event.x, event.y);
+	}
+	else if ((event.type == EVENT_SCROLL) && (NULL != m_scrollHandler))
+	{
+		m_scrollHandler(m_pWindow, event.x, event.y);
+	}
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method reads a recording, one event per line:
+ *
+ *      time  type  key  action  x  y
+ ***********************************************************/
+bool InputRecorder::Load(const char* filePath)
+{
+	std::ifstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not open input recording:" << filePath << std::endl;
+		return(false);
+	}
+
+	m_events.clear();
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		INPUT_EVENT event;
+		std::istringstream values(line);
+		values >> event.time >> event.type >> event.key >> event.action >> event.x >> event.y;
+		if (values.fail())
+		{
+			std::cout << "Input recording " << filePath << " has a broken line: " << line << std::endl;
+			m_events.clear();
+			return(false);
+		}
+		m_events.push_back(event);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method writes the recorded events with enough digits
+ *  that the cursor positions read back exactly.
+ ***********************************************************/
+bool InputRecorder::Save(const char* filePath) const
+{
+	std::ofstream file(filePath);
+	if (!file)
+	{
+		std::cout << "Could not write input recording:" << filePath << std::endl;
+		return(false);
+	}
+
+	file << "# time  type (0 key, 1 cursor, 2 scroll)  key  action  x  y" << std::endl;
+	file << std::setprecision(17);
+	for (size_t i = 0; i < m_events.size(); i++)
+	{
+		const INPUT_EVENT& event = m_events[i];
+		file << event.time << " " << event.type << " " << event.key << " " << event.action
+			<< " " << event.x << " " << event.y << std::endl;
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  KeyCallback()
+ *
+ *  This method queues live key presses and releases.
+ ***********************************************************/
+void InputRecorder::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	// key repeats do not change the state
+	if ((NULL != g_pRecorder) && (action != GLFW_REPEAT))
+	{
+		g_pRecorder->QueueEvent(EVENT_KEY, key, action, 0.0, 0.0);
+	}
+}
+
+/***********************************************************
+ *  CursorCallback()
+ *
+ *  This method queues live cursor movement.
+ ***********************************************************/
+void InputRecorder::CursorCallback(GLFWwindow* window, double x, double y)
+{
+	if (NULL != g_pRecorder)
+	{
+		g_pRecorder->QueueEvent(EVENT_CURSOR, 0, 0, x, y);
+	}
+}
+
+/***********************************************************
+ *  ScrollCallback()
+ *
+ *  This method queues live scrolling.
+ ***********************************************************/
+void InputRecorder::ScrollCallback(GLFWwindow* window, double x, double y)
+{
+	if (NULL != g_pRecorder)
+	{
+		g_pRecorder->QueueEvent(EVENT_SCROLL, 0, 0, x, y);
+	}
+}
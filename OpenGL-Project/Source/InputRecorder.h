@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.h
+// ============
+// gather the input once per frame, record it and replay it deterministically
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  InputRecorder
+ *
+ *  This class is the one input layer between GLFW and the
+ *  camera.  The GLFW callbacks only queue timestamped events,
+ *  which PollInput() drains once per frame, as late as it can
+ *  before the camera is used, into the key state and the
+ *  cursor and scroll handlers.  Live, every event can also be
+ *  written to a file.  On replay, the events of the file are
+ *  fed back instead of the real ones, and time advances by a
+ *  fixed step every frame, so two replays of one recording
+ *  render exactly the same frames.  EndFrame() measures how
+ *  long the oldest input of the frame took to be swapped to
+ *  the screen.
+ ***********************************************************/
+class InputRecorder
+{
+public:
+	enum INPUT_MODE
+	{
+		INPUT_LIVE,
+		INPUT_RECORD,
+		INPUT_REPLAY
+	};
+
+	enum EVENT_TYPE
+	{
+		EVENT_KEY = 0,
+		EVENT_CURSOR = 1,
+		EVENT_SCROLL = 2
+	};
+
+	// one input event, the position is only set for cursor and
+	// scroll events
+	struct INPUT_EVENT
+	{
+		// seconds since recording started
+		double time;
+		int type;
+		int key;
+		int action;
+		double x;
+		double y;
+	};
+
+	// constructor
+	InputRecorder();
+	// destructor
+	~InputRecorder();
+
+	// take over the input callbacks of the window, the queued
+	// events are passed on to the handlers by PollInput()
+	void Attach(GLFWwindow* window, GLFWcursorposfun cursorHandler, GLFWscrollfun scrollHandler);
+	// write every event to a file when Stop() is called
+	void StartRecording(const char* filePath);
+	// feed the events of a file back, advancing time by a fixed
+	// number of seconds every frame
+	bool StartReplay(const char* filePath, double timestep);
+	// save the recording or report the replay
+	void Stop();
+
+	// poll GLFW, advance time and apply the queued events, or on
+	// replay the events that are due
+	void PollInput();
+	// measure the input latency after the frame was swapped
+	void EndFrame();
+	// print and restart the input latency statistics
+	void ReportLatency();
+	// whether a key is held, as the applied events left it
+	bool IsKeyDown(int key) const;
+	// seconds the frame advances the simulation by
+	float GetDeltaTime() const;
+	INPUT_MODE GetMode() const;
+
+private:
+	// number of key codes that are tracked
+	static const int KEY_COUNT = 512;
+
+	GLFWwindow* m_pWindow;
+	GLFWcursorposfun m_cursorHandler;
+	GLFWscrollfun m_scrollHandler;
+	INPUT_MODE m_mode;
+	std::string m_filePath;
+
+	std::vector<INPUT_EVENT> m_events;
+	// next event to replay
+	size_t m_nextEvent;
+	// live events waiting for the next PollInput()
+	std::vector<INPUT_EVENT> m_pendingEvents;
+	bool m_keyDown[KEY_COUNT];
+
+	double m_startTime;
+	double m_time;
+	double m_timestep;
+	float m_deltaTime;
+	int m_frameCount;
+
+	// wall clock time of the replayed frames
+	std::chrono::steady_clock::time_point m_lastFrameStart;
+	double m_totalFrameMilliseconds;
+	double m_worstFrameMilliseconds;
+
+	// GLFW time the oldest input of the frame arrived, negative
+	// when the frame had none
+	double m_frameInputTime;
+	int m_latencyFrameCount;
+	double m_totalLatencyMilliseconds;
+	double m_worstLatencyMilliseconds;
+
+	// queue a live event until the next PollInput()
+	void QueueEvent(int type, int key, int action, double x, double y);
+	// pass one event on to the key state or the handlers
+	void ApplyEvent(const INPUT_EVENT& event);
+	// read and write recordings
+	bool Load(const char* filePath);
+	bool Save(const char* filePath) const;
+
+	// GLFW callbacks, forwarded to the attached recorder
+	static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void CursorCallback(GLFWwindow* window, double x, double y);
+	static void ScrollCallback(GLFWwindow* window, double x, double y);
+};
@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// work-stealing scheduler for spreading per-frame engine work over all cores
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+// declaration of global variables
+namespace
+{
+	// number of jobs each worker can have allocated before the
+	// pool wraps around - slots of jobs that have not finished
+	// are skipped when it does
+	const unsigned int MAX_JOBS_PER_WORKER = 4096;
+	// chunks a parallel loop is split into for every worker, at
+	// most, which is plenty to balance the load and keeps large
+	// loops far from wrapping the job pool
+	const unsigned int MAX_CHUNKS_PER_WORKER = 8;
+
+	// index of the worker that the current thread represents
+	thread_local unsigned int t_workerIndex = 0;
+}
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	if (workerCount == 0)
+	{
+		workerCount = std::thread::hardware_concurrency();
+	}
+	if (workerCount == 0)
+	{
+		workerCount = 1;
+	}
+
+	m_bRunning = true;
+	m_queuedJobs = 0;
+	m_startTime = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		std::unique_ptr<WORKER> worker(new WORKER());
+		worker->jobPool.reset(new JOB[MAX_JOBS_PER_WORKER]);
+		for (unsigned int j = 0; j < MAX_JOBS_PER_WORKER; j++)
+		{
+			worker->jobPool[j].unfinishedJobs = 0;
+		}
+		worker->allocatedJobs = 0;
+		m_workers.push_back(std::move(worker));
+	}
+
+	// the creating thread acts as worker 0, so only spawn the rest
+	for (unsigned int i = 1; i < workerCount; i++)
+	{
+		m_threads.push_back(std::thread(&JobSystem::WorkerThread, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepLock);
+		m_bRunning = false;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  GetWorkerCount()
+ *
+ *  This method returns the number of threads that execute
+ *  jobs, including the main thread.
+ ***********************************************************/
+unsigned int JobSystem::GetWorkerCount() const
+{
+	return((unsigned int)m_workers.size());
+}
+
+/***********************************************************
+ *  SetTimingCallback()
+ *
+ *  This method installs a hook that is called with the name,
+ *  worker and duration of every executed job.  It should be
+ *  set before any jobs are scheduled.
+ ***********************************************************/
+void JobSystem::SetTimingCallback(JOB_TIMING_CALLBACK callback)
+{
+	m_timingCallback = callback;
+}
+
+/***********************************************************
+ *  GetWorkerIndex()
+ *
+ *  This method returns the worker index of the calling
+ *  thread.  Threads that are not workers share index 0.
+ ***********************************************************/
+unsigned int JobSystem::GetWorkerIndex() const
+{
+	return(t_workerIndex);
+}
+
+/***********************************************************
+ *  AllocateJob()
+ *
+ *  This method takes the next job from the calling worker's
+ *  ring of preallocated jobs so that scheduling does not
+ *  touch the heap.  Once the ring has wrapped, jobs that have
+ *  not finished - queued, running, or a parent still being
+ *  given children - keep their slots and are skipped.  When
+ *  a whole lap is in use, queued jobs are run until one is
+ *  free, rather than overwriting it.
+ ***********************************************************/
+JobSystem::JOB* JobSystem::AllocateJob()
+{
+	unsigned int workerIndex = GetWorkerIndex();
+	WORKER* worker = m_workers[workerIndex].get();
+
+	unsigned int skipped = 0;
+	JOB* job = &worker->jobPool[worker->allocatedJobs++ % MAX_JOBS_PER_WORKER];
+	while (IsComplete(job) == false)
+	{
+		skipped++;
+		if ((skipped % MAX_JOBS_PER_WORKER) == 0)
+		{
+			JOB* queuedJob = GetJob(workerIndex);
+			if (NULL != queuedJob)
+			{
+				Execute(queuedJob, workerIndex);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		job = &worker->jobPool[worker->allocatedJobs++ % MAX_JOBS_PER_WORKER];
+	}
+
+	return(job);
+}
+
+/***********************************************************
+ *  CreateJob()
+ *
+ *  This method is used for creating a job that has no parent.
+ *  The job does not run until it is passed to Run().
+ ***********************************************************/
+JobSystem::JOB* JobSystem::CreateJob(const char* name, std::function<void()> task)
+{
+	JOB* job = AllocateJob();
+	job->name = name;
+	job->task = std::move(task);
+	job->parent = NULL;
+	job->unfinishedJobs = 1;
+
+	return(job);
+}
+
+/***********************************************************
+ *  CreateChildJob()
+ *
+ *  This method is used for creating a job that the passed
+ *  in parent job will wait for before it is complete.
+ ***********************************************************/
+JobSystem::JOB* JobSystem::CreateChildJob(JOB* parent, const char* name, std::function<void()> task)
+{
+	if (NULL != parent)
+	{
+		parent->unfinishedJobs++;
+	}
+
+	JOB* job = AllocateJob();
+	job->name = name;
+	job->task = std::move(task);
+	job->parent = parent;
+	job->unfinishedJobs = 1;
+
+	return(job);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method pushes the job onto the calling worker's
+ *  deque and wakes a sleeping worker to pick it up.
+ ***********************************************************/
+void JobSystem::Run(JOB* job)
+{
+	WORKER* worker = m_workers[GetWorkerIndex()].get();
+	{
+		std::lock_guard<std::mutex> lock(worker->queueLock);
+		worker->queue.push_back(job);
+	}
+	m_queuedJobs++;
+
+	m_wakeCondition.notify_one();
+}
+
+/***********************************************************
+ *  IsComplete()
+ *
+ *  This method returns true once the job and all of its
+ *  children have finished executing.
+ ***********************************************************/
+bool JobSystem::IsComplete(const JOB* job) const
+{
+	return(job->unfinishedJobs.load() <= 0);
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method keeps the calling thread busy executing jobs
+ *  until the passed in job has completed.
+ ***********************************************************/
+void JobSystem::Wait(JOB* job)
+{
+	unsigned int workerIndex = GetWorkerIndex();
+
+	while (IsComplete(job) == false)
+	{
+		JOB* nextJob = GetJob(workerIndex);
+		if (NULL != nextJob)
+		{
+			Execute(nextJob, workerIndex);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  GetJob()
+ *
+ *  This method pops a job from the back of the worker's own
+ *  deque, or steals one from the front of another worker's
+ *  deque when the local one is empty.
+ ***********************************************************/
+JobSystem::JOB* JobSystem::GetJob(unsigned int workerIndex)
+{
+	JOB* job = NULL;
+	WORKER* worker = m_workers[workerIndex].get();
+
+	{
+		std::lock_guard<std::mutex> lock(worker->queueLock);
+		if (worker->queue.empty() == false)
+		{
+			job = worker->queue.back();
+			worker->queue.pop_back();
+		}
+	}
+
+	// try each of the other workers, starting with the neighbor
+	size_t workerCount = m_workers.size();
+	for (size_t i = 1; (i < workerCount) && (NULL == job); i++)
+	{
+		WORKER* victim = m_workers[(workerIndex + i) % workerCount].get();
+
+		std::lock_guard<std::mutex> lock(victim->queueLock);
+		if (victim->queue.empty() == false)
+		{
+			job = victim->queue.front();
+			victim->queue.pop_front();
+		}
+	}
+
+	if (NULL != job)
+	{
+		m_queuedJobs--;
+	}
+
+	return(job);
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method runs the job's task, reports its timing to
+ *  the installed hook and then marks it finished.
+ ***********************************************************/
+void JobSystem::Execute(JOB* job, unsigned int workerIndex)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (job->task)
+	{
+		job->task();
+	}
+
+	if (m_timingCallback)
+	{
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		JOB_TIMING timing;
+		timing.name = job->name;
+		timing.workerIndex = workerIndex;
+		timing.startMilliseconds = std::chrono::duration<double, std::milli>(start - m_startTime).count();
+		timing.durationMilliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+		m_timingCallback(timing);
+	}
+
+	Finish(job);
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method decrements the job's unfinished count and,
+ *  once it reaches zero, notifies the parent job.  The
+ *  parent is read first, since a finished job's slot can be
+ *  handed out again straight away.
+ ***********************************************************/
+void JobSystem::Finish(JOB* job)
+{
+	JOB* parent = job->parent;
+	int unfinishedJobs = --job->unfinishedJobs;
+
+	if ((unfinishedJobs == 0) && (NULL != parent))
+	{
+		Finish(parent);
+	}
+}
+
+/***********************************************************
+ *  WorkerThread()
+ *
+ *  This method is the main loop of every spawned worker.  It
+ *  executes jobs while there are any and otherwise sleeps
+ *  until new work is scheduled.
+ ***********************************************************/
+void JobSystem::WorkerThread(unsigned int workerIndex)
+{
+	t_workerIndex = workerIndex;
+
+	while (m_bRunning)
+	{
+		JOB* job = GetJob(workerIndex);
+		if (NULL != job)
+		{
+			Execute(job, workerIndex);
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lock(m_sleepLock);
+			m_wakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]
+				{
+					return((m_queuedJobs.load() > 0) || (m_bRunning == false));
+				});
+		}
+	}
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method splits the range [0, count) into chunks of
+ *  grainSize elements, runs them as child jobs of a common
+ *  parent and waits for all of them.  Small ranges are run
+ *  directly on the calling thread.  The chunks are made
+ *  larger than grainSize when there would be more than
+ *  MAX_CHUNKS_PER_WORKER for every worker.
+ ***********************************************************/
+void JobSystem::ParallelFor(
+	const char* name,
+	unsigned int count,
+	unsigned int grainSize,
+	const std::function<void(unsigned int, unsigned int)>& body)
+{
+	if (grainSize == 0)
+	{
+		grainSize = 1;
+	}
+
+	unsigned int maxChunks = (unsigned int)m_workers.size() * MAX_CHUNKS_PER_WORKER;
+	unsigned int smallestGrain = count / maxChunks + ((count % maxChunks != 0) ? 1 : 0);
+	if (grainSize < smallestGrain)
+	{
+		grainSize = smallestGrain;
+	}
+
+	// not worth scheduling when there is only one chunk
+	if ((count <= grainSize) || (m_workers.size() == 1))
+	{
+		if (count > 0)
+		{
+			body(0, count);
+		}
+		return;
+	}
+
+	JOB* root = CreateJob(name, std::function<void()>());
+	for (unsigned int begin = 0; begin < count; begin += grainSize)
+	{
+		unsigned int end = (count - begin > grainSize) ? begin + grainSize : count;
+
+		Run(CreateChildJob(root, name, [&body, begin, end]()
+			{
+				body(begin, end);
+			}));
+	}
+	Run(root);
+	Wait(root);
+}
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// work-stealing scheduler for spreading per-frame engine work over all cores
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class owns a set of worker threads, each with its
+ *  own job deque.  A worker pushes and pops jobs at the back
+ *  of its own deque and steals from the front of the other
+ *  deques when it runs dry.  Jobs can be grouped under a
+ *  parent job, which is only complete once all of its
+ *  children have finished.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	struct JOB
+	{
+		const char* name;
+		std::function<void()> task;
+		JOB* parent;
+		std::atomic<int> unfinishedJobs;
+	};
+
+	struct JOB_TIMING
+	{
+		const char* name;
+		unsigned int workerIndex;
+		double startMilliseconds;
+		double durationMilliseconds;
+	};
+
+	// callback invoked after every executed job
+	typedef std::function<void(const JOB_TIMING&)> JOB_TIMING_CALLBACK;
+
+	// constructor - zero workers means one per hardware thread
+	JobSystem(unsigned int workerCount = 0);
+	// destructor
+	~JobSystem();
+
+	// create a job that is not yet scheduled
+	JOB* CreateJob(const char* name, std::function<void()> task);
+	// create a job that its parent will wait for
+	JOB* CreateChildJob(JOB* parent, const char* name, std::function<void()> task);
+	// schedule a job on the calling thread's deque
+	void Run(JOB* job);
+	// execute other jobs until the passed in job has completed
+	void Wait(JOB* job);
+	// check whether a job and all of its children have finished
+	bool IsComplete(const JOB* job) const;
+
+	// split [0, count) into chunks of grainSize and run them in parallel
+	void ParallelFor(
+		const char* name,
+		unsigned int count,
+		unsigned int grainSize,
+		const std::function<void(unsigned int, unsigned int)>& body);
+
+	// install a hook that receives per-job timing
+	void SetTimingCallback(JOB_TIMING_CALLBACK callback);
+	// total number of threads executing jobs, including the main thread
+	unsigned int GetWorkerCount() const;
+
+private:
+	struct WORKER
+	{
+		std::deque<JOB*> queue;
+		std::mutex queueLock;
+		std::unique_ptr<JOB[]> jobPool;
+		std::atomic<unsigned int> allocatedJobs;
+	};
+
+	// workers, index 0 is the thread that created the job system
+	std::vector<std::unique_ptr<WORKER>> m_workers;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_bRunning;
+	std::atomic<int> m_queuedJobs;
+	std::mutex m_sleepLock;
+	std::condition_variable m_wakeCondition;
+	JOB_TIMING_CALLBACK m_timingCallback;
+	std::chrono::steady_clock::time_point m_startTime;
+
+	// the worker loop for the spawned threads
+	void WorkerThread(unsigned int workerIndex);
+	// find the worker index for the calling thread
+	unsigned int GetWorkerIndex() const;
+	// take a job from the local deque or steal one
+	JOB* GetJob(unsigned int workerIndex);
+	// run a job and propagate its completion
+	void Execute(JOB* job, unsigned int workerIndex);
+	// mark a job finished and notify its parent
+	void Finish(JOB* job);
+	// take the next free job from the worker's pool
+	JOB* AllocateJob();
+};
@@ -0,0 +1,593 @@
+///////////////////////////////////////////////////////////////////////////////
+// jsondocument.cpp
+// ============
+// parse JSON text into a tree of values that can be walked by index
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JsonDocument.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// longest number text that is parsed
+	const int g_MaxNumberLength = 63;
+
+	/***********************************************************
+	 *  AppendUtf8()
+	 *
+	 *  Append a code point to a string in UTF-8.
+	 ***********************************************************/
+	void AppendUtf8(std::string& text, unsigned int codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			text += (char)codePoint;
+		}
+		else if (codePoint < 0x800)
+		{
+			text += (char)(0xC0 | (codePoint >> 6));
+			text += (char)(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			text += (char)(0xE0 | (codePoint >> 12));
+			text += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			text += (char)(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			text += (char)(0xF0 | (codePoint >> 18));
+			text += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+			text += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+			text += (char)(0x80 | (codePoint & 0x3F));
+		}
+	}
+}
+
+/***********************************************************
+ *  JsonDocument()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JsonDocument::JsonDocument()
+{
+	m_pText = NULL;
+	m_pEnd = NULL;
+	m_pCursor = NULL;
+	m_bError = false;
+}
+
+/***********************************************************
+ *  ~JsonDocument()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JsonDocument::~JsonDocument()
+{
+}
+
+/***********************************************************
+ *  Parse()
+ *
+ *  This method parses a complete JSON text.  Anything but
+ *  whitespace after the first value is an error.
+ ***********************************************************/
+bool JsonDocument::Parse(const char* text, size_t length)
+{
+	m_values.clear();
+	m_pText = text;
+	m_pEnd = text + length;
+	m_pCursor = text;
+	m_bError = false;
+
+	ParseValue(0);
+	if (m_bError == false)
+	{
+		SkipWhitespace();
+		if (m_pCursor != m_pEnd)
+		{
+			ReportError("text after the end of the document");
+		}
+	}
+	if (m_bError == true)
+	{
+		m_values.clear();
+	}
+
+	m_pText = NULL;
+	m_pEnd = NULL;
+	m_pCursor = NULL;
+
+	return(m_bError == false);
+}
+
+/***********************************************************
+ *  ParseValue()
+ *
+ *  This method parses the value at the cursor and returns
+ *  its index, or -1 after an error.
+ ***********************************************************/
+int JsonDocument::ParseValue(int depth)
+{
+	SkipWhitespace();
+	if (m_pCursor == m_pEnd)
+	{
+		ReportError("unexpected end of the document");
+		return(-1);
+	}
+	if (depth > MAX_DEPTH)
+	{
+		ReportError("values are nested too deep");
+		return(-1);
+	}
+
+	char first = *m_pCursor;
+	if (first == '{')
+	{
+		int object = AddValue(JSON_OBJECT);
+		m_pCursor++;
+		SkipWhitespace();
+		if ((m_pCursor != m_pEnd) && (*m_pCursor == '}'))
+		{
+			m_pCursor++;
+			return(object);
+		}
+
+		while (m_bError == false)
+		{
+			SkipWhitespace();
+			std::string name;
+			if ((m_pCursor == m_pEnd) || (*m_pCursor != '"') || (ParseString(name) == false))
+			{
+				ReportError("expected a member name");
+				return(-1);
+			}
+			SkipWhitespace();
+			if ((m_pCursor == m_pEnd) || (*m_pCursor != ':'))
+			{
+				ReportError("expected ':' after a member name");
+				return(-1);
+			}
+			m_pCursor++;
+
+			int member = ParseValue(depth + 1);
+			if (member < 0)
+			{
+				return(-1);
+			}
+			m_values[object].names.push_back(name);
+			m_values[object].children.push_back(member);
+
+			SkipWhitespace();
+			if ((m_pCursor != m_pEnd) && (*m_pCursor == ','))
+			{
+				m_pCursor++;
+			}
+			else if ((m_pCursor != m_pEnd) && (*m_pCursor == '}'))
+			{
+				m_pCursor++;
+				return(object);
+			}
+			else
+			{
+				ReportError("expected ',' or '}' in an object");
+			}
+		}
+		return(-1);
+	}
+
+	if (first == '[')
+	{
+		int array = AddValue(JSON_ARRAY);
+		m_pCursor++;
+		SkipWhitespace();
+		if ((m_pCursor != m_pEnd) && (*m_pCursor == ']'))
+		{
+			m_pCursor++;
+			return(array);
+		}
+
+		while (m_bError == false)
+		{
+			int element = ParseValue(depth + 1);
+			if (element < 0)
+			{
+				return(-1);
+			}
+			m_values[array].children.push_back(element);
+
+			SkipWhitespace();
+			if ((m_pCursor != m_pEnd) && (*m_pCursor == ','))
+			{
+				m_pCursor++;
+			}
+			else if ((m_pCursor != m_pEnd) && (*m_pCursor == ']'))
+			{
+				m_pCursor++;
+				return(array);
+			}
+			else
+			{
+				ReportError("expected ',' or ']' in an array");
+			}
+		}
+		return(-1);
+	}
+
+	if (first == '"')
+	{
+		std::string text;
+		if (ParseString(text) == false)
+		{
+			return(-1);
+		}
+		int value = AddValue(JSON_STRING);
+		m_values[value].text.swap(text);
+		return(value);
+	}
+
+	if ((first == '-') || ((first >= '0') && (first <= '9')))
+	{
+		double number = 0.0;
+		if (ParseNumber(number) == false)
+		{
+			return(-1);
+		}
+		int value = AddValue(JSON_NUMBER);
+		m_values[value].number = number;
+		return(value);
+	}
+
+	// the literals
+	const char* literals[3] = { "true", "false", "null" };
+	for (int i = 0; i < 3; i++)
+	{
+		size_t length = strlen(literals[i]);
+		if (((size_t)(m_pEnd - m_pCursor) >= length) && (strncmp(m_pCursor, literals[i], length) == 0))
+		{
+			m_pCursor += length;
+			int value = AddValue((i == 2) ? JSON_NULL : JSON_BOOL);
+			m_values[value].number = (i == 0) ? 1.0 : 0.0;
+			return(value);
+		}
+	}
+
+	ReportError("unexpected character");
+	return(-1);
+}
+
+/***********************************************************
+ *  ParseString()
+ *
+ *  This method parses the string at the cursor, which starts
+ *  with its opening quote, and decodes its escapes.
+ ***********************************************************/
+bool JsonDocument::ParseString(std::string& text)
+{
+	m_pCursor++;
+	text.clear();
+
+	while (m_pCursor != m_pEnd)
+	{
+		char c = *m_pCursor++;
+		if (c == '"')
+		{
+			return(true);
+		}
+		if (c != '\\')
+		{
+			text += c;
+			continue;
+		}
+
+		if (m_pCursor == m_pEnd)
+		{
+			break;
+		}
+		char escape = *m_pCursor++;
+		switch (escape)
+		{
+		case '"': text += '"'; break;
+		case '\\': text += '\\'; break;
+		case '/': text += '/'; break;
+		case 'b': text += '\b'; break;
+		case 'f': text += '\f'; break;
+		case 'n': text += '\n'; break;
+		case 'r': text += '\r'; break;
+		case 't': text += '\t'; break;
+		case 'u':
+		{
+			// a code point above the first plane comes as a pair
+			// of surrogates, each in its own escape
+			unsigned int codePoint = 0;
+			for (int pair = 0; pair < 2; pair++)
+			{
+				if (m_pEnd - m_pCursor < 4)
+				{
+					ReportError("incomplete unicode escape");
+					return(false);
+				}
+				unsigned int unit = (unsigned int)strtoul(std::string(m_pCursor, 4).c_str(), NULL, 16);
+				m_pCursor += 4;
+
+				if (pair == 0)
+				{
+					codePoint = unit;
+					bool bHighSurrogate = (unit >= 0xD800) && (unit < 0xDC00);
+					if ((bHighSurrogate == false) || (m_pEnd - m_pCursor < 6) ||
+						(m_pCursor[0] != '\\') || (m_pCursor[1] != 'u'))
+					{
+						break;
+					}
+					m_pCursor += 2;
+				}
+				else
+				{
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (unit - 0xDC00);
+				}
+			}
+			AppendUtf8(text, codePoint);
+			break;
+		}
+		default:
+			ReportError("unknown escape in a string");
+			return(false);
+		}
+	}
+
+	ReportError("unterminated string");
+	return(false);
+}
+
+/***********************************************************
+ *  ParseNumber()
+ *
+ *  This method parses the number at the cursor.  The text
+ *  is not terminated where the number ends, so its
+ *  characters are copied out before they are converted.
+ ***********************************************************/
+bool JsonDocument::ParseNumber(double& number)
+{
+	char buffer[g_MaxNumberLength + 1];
+	int length = 0;
+	while ((m_pCursor != m_pEnd) && (length < g_MaxNumberLength) &&
+		(strchr("+-0123456789.eE", *m_pCursor) != NULL))
+	{
+		buffer[length++] = *m_pCursor++;
+	}
+	buffer[length] = '\0';
+
+	char* pEnd = NULL;
+	number = strtod(buffer, &pEnd);
+	if ((length == 0) || (pEnd != buffer + length))
+	{
+		ReportError("malformed number");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SkipWhitespace()
+ *
+ *  This method moves the cursor past spaces, tabs and line
+ *  breaks.
+ ***********************************************************/
+void JsonDocument::SkipWhitespace()
+{
+	while ((m_pCursor != m_pEnd) &&
+		((*m_pCursor == ' ') || (*m_pCursor == '\t') || (*m_pCursor == '\n') || (*m_pCursor == '\r')))
+	{
+		m_pCursor++;
+	}
+}
+
+/***********************************************************
+ *  ReportError()
+ *
+ *  This method prints the first error of a parse with the
+ *  line it was found on.
+ ***********************************************************/
+void JsonDocument::ReportError(const char* message)
+{
+	if (m_bError == true)
+	{
+		return;
+	}
+	m_bError = true;
+
+	int line = 1;
+	for (const char* p = m_pText; p < m_pCursor; p++)
+	{
+		if (*p == '\n')
+		{
+			line++;
+		}
+	}
+	std::cout << "JSON error on line " << line << ": " << message << std::endl;
+}
+
+/***********************************************************
+ *  AddValue()
+ *
+ *  This method appends an empty value of a type.
+ ***********************************************************/
+int JsonDocument::AddValue(VALUE_TYPE type)
+{
+	VALUE value;
+	value.type = type;
+	value.number = 0.0;
+	m_values.push_back(value);
+
+	return((int)m_values.size() - 1);
+}
+
+/***********************************************************
+ *  GetRoot()
+ *
+ *  This method returns the value the text consists of.
+ ***********************************************************/
+int JsonDocument::GetRoot() const
+{
+	return(m_values.empty() ? -1 : 0);
+}
+
+/***********************************************************
+ *  GetType()
+ *
+ *  This method returns the type of a value.
+ ***********************************************************/
+JsonDocument::VALUE_TYPE JsonDocument::GetType(int value) const
+{
+	if ((value < 0) || (value >= (int)m_values.size()))
+	{
+		return(JSON_NULL);
+	}
+
+	return(m_values[value].type);
+}
+
+/***********************************************************
+ *  GetMember()
+ *
+ *  This method finds the member of an object by its name.
+ ***********************************************************/
+int JsonDocument::GetMember(int object, const char* name) const
+{
+	if (GetType(object) != JSON_OBJECT)
+	{
+		return(-1);
+	}
+
+	const VALUE& value = m_values[object];
+	for (size_t i = 0; i < value.names.size(); i++)
+	{
+		if (value.names[i] == name)
+		{
+			return(value.children[i]);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method returns the number of elements of an array
+ *  or of members of an object, 0 for any other value.
+ ***********************************************************/
+int JsonDocument::GetCount(int value) const
+{
+	VALUE_TYPE type = GetType(value);
+	if ((type != JSON_ARRAY) && (type != JSON_OBJECT))
+	{
+		return(0);
+	}
+
+	return((int)m_values[value].children.size());
+}
+
+/***********************************************************
+ *  GetElement()
+ *
+ *  This method returns an element of an array or a member
+ *  of an object by its position.
+ ***********************************************************/
+int JsonDocument::GetElement(int value, int index) const
+{
+	if ((index < 0) || (index >= GetCount(value)))
+	{
+		return(-1);
+	}
+
+	return(m_values[value].children[index]);
+}
+
+/***********************************************************
+ *  GetMemberName()
+ *
+ *  This method returns the name of a member of an object by
+ *  its position.
+ ***********************************************************/
+const char* JsonDocument::GetMemberName(int object, int index) const
+{
+	if ((GetType(object) != JSON_OBJECT) || (index < 0) || (index >= GetCount(object)))
+	{
+		return("");
+	}
+
+	return(m_values[object].names[index].c_str());
+}
+
+/***********************************************************
+ *  GetBool()
+ *
+ *  This method returns the value of a boolean.
+ ***********************************************************/
+bool JsonDocument::GetBool(int value, bool bFallback) const
+{
+	if (GetType(value) != JSON_BOOL)
+	{
+		return(bFallback);
+	}
+
+	return(m_values[value].number != 0.0);
+}
+
+/***********************************************************
+ *  GetNumber()
+ *
+ *  This method returns the value of a number.
+ ***********************************************************/
+double JsonDocument::GetNumber(int value, double fallback) const
+{
+	if (GetType(value) != JSON_NUMBER)
+	{
+		return(fallback);
+	}
+
+	return(m_values[value].number);
+}
+
+/***********************************************************
+ *  GetFloat()
+ *
+ *  This method returns the value of a number as a float.
+ ***********************************************************/
+float JsonDocument::GetFloat(int value, float fallback) const
+{
+	return((float)GetNumber(value, (double)fallback));
+}
+
+/***********************************************************
+ *  GetInt()
+ *
+ *  This method returns the value of a number as an int.
+ ***********************************************************/
+int JsonDocument::GetInt(int value, int fallback) const
+{
+	return((int)GetNumber(value, (double)fallback));
+}
+
+/***********************************************************
+ *  GetString()
+ *
+ *  This method returns the text of a string.
+ ***********************************************************/
+const char* JsonDocument::GetString(int value, const char* fallback) const
+{
+	if (GetType(value) != JSON_STRING)
+	{
+		return(fallback);
+	}
+
+	return(m_values[value].text.c_str());
+}
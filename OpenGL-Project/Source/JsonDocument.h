@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// jsondocument.h
+// ============
+// parse JSON text into a tree of values that can be walked by index
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  JsonDocument
+ *
+ *  This class parses a JSON text into a flat list of values
+ *  and hands out their indices, with -1 standing for a value
+ *  that is not there.  Every accessor takes -1 and returns
+ *  its fallback then, so lookups can be chained without a
+ *  check at every step, and optional members simply end up
+ *  with their default.
+ ***********************************************************/
+class JsonDocument
+{
+public:
+	enum VALUE_TYPE
+	{
+		JSON_NULL,
+		JSON_BOOL,
+		JSON_NUMBER,
+		JSON_STRING,
+		JSON_ARRAY,
+		JSON_OBJECT
+	};
+
+	// constructor
+	JsonDocument();
+	// destructor
+	~JsonDocument();
+
+	// parse a text, replacing the values of any earlier text -
+	// errors are printed with their line and return false
+	bool Parse(const char* text, size_t length);
+
+	// the value the text consists of, -1 before a parse
+	int GetRoot() const;
+	// type of a value, JSON_NULL for -1
+	VALUE_TYPE GetType(int value) const;
+
+	// member of an object by name, -1 when it has none
+	int GetMember(int object, const char* name) const;
+	// number of elements of an array or members of an object
+	int GetCount(int value) const;
+	// element of an array or member of an object by position
+	int GetElement(int value, int index) const;
+	// name of a member of an object by position
+	const char* GetMemberName(int object, int index) const;
+
+	// contents of a value, or the fallback when the value is
+	// missing or of another type
+	bool GetBool(int value, bool bFallback) const;
+	double GetNumber(int value, double fallback) const;
+	float GetFloat(int value, float fallback) const;
+	int GetInt(int value, int fallback) const;
+	const char* GetString(int value, const char* fallback) const;
+
+private:
+	struct VALUE
+	{
+		VALUE_TYPE type;
+		double number;
+		std::string text;
+		// values of an array or object, and the names of the
+		// members of an object
+		std::vector<int> children;
+		std::vector<std::string> names;
+	};
+
+	// nesting deeper than this is rejected instead of running
+	// out of stack
+	static const int MAX_DEPTH = 256;
+
+	std::vector<VALUE> m_values;
+
+	// parse state
+	const char* m_pText;
+	const char* m_pEnd;
+	const char* m_pCursor;
+	bool m_bError;
+
+	int ParseValue(int depth);
+	bool ParseString(std::string& text);
+	bool ParseNumber(double& number);
+	void SkipWhitespace();
+	void ReportError(const char* message);
+	int AddValue(VALUE_TYPE type);
+};
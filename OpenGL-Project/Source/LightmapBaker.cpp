@@ -0,0 +1,901 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.cpp
+// ============
+// bake the static scene lighting into a lightmap atlas on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightmapBaker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// identifies a lightmap file and the layout of its header
+	const unsigned int g_LightmapMagic = 0x50414D4C;   // "LMAP"
+	const unsigned int g_LightmapVersion = 1;
+	const float g_Pi = 3.14159265358979f;
+
+	struct LIGHTMAP_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long sceneHash;
+		unsigned int width;
+		unsigned int height;
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  64-bit FNV-1a hash, continued from the passed in value.
+	 ***********************************************************/
+	unsigned long long HashBytes(const void* data, size_t length, unsigned long long hash)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  FloatToHalf()
+	 *
+	 *  Convert a float to a 16-bit float, flushing values too
+	 *  small for it to zero and clamping large ones.
+	 ***********************************************************/
+	unsigned short FloatToHalf(float value)
+	{
+		unsigned int bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		unsigned int sign = (bits >> 16) & 0x8000;
+		int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+		unsigned int mantissa = bits & 0x7FFFFF;
+
+		if (exponent <= 0)
+		{
+			return((unsigned short)sign);
+		}
+		if (exponent >= 31)
+		{
+			return((unsigned short)(sign | 0x7BFF));
+		}
+
+		return((unsigned short)(sign | (exponent << 10) | (mantissa >> 13)));
+	}
+
+	/***********************************************************
+	 *  RANDOM
+	 *
+	 *  Small xorshift generator, seeded per texel so a bake
+	 *  gives the same result on every run and thread count.
+	 ***********************************************************/
+	struct RANDOM
+	{
+		unsigned int state;
+
+		RANDOM(unsigned int seed)
+		{
+			state = (seed * 747796405u) + 2891336453u;
+			if (state == 0)
+			{
+				state = 1;
+			}
+		}
+
+		float Next()
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return((float)(state >> 8) * (1.0f / 16777216.0f));
+		}
+	};
+
+	/***********************************************************
+	 *  SampleHemisphere()
+	 *
+	 *  Return a direction around the normal, distributed by the
+	 *  cosine to it so the samples can simply be averaged.
+	 ***********************************************************/
+	glm::vec3 SampleHemisphere(const glm::vec3& normal, RANDOM& random)
+	{
+		float angle = 2.0f * g_Pi * random.Next();
+		float radius2 = random.Next();
+		float radius = sqrt(radius2);
+
+		glm::vec3 helper = (fabs(normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(helper, normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		return(glm::normalize(
+			tangent * (radius * cos(angle)) +
+			bitangent * (radius * sin(angle)) +
+			normal * sqrt(std::max(0.0f, 1.0f - radius2))));
+	}
+}
+
+/***********************************************************
+ *  GetDefaultSettings()
+ *
+ *  This method returns settings that bake this scene in a
+ *  few seconds on a desktop processor.
+ ***********************************************************/
+LightmapBaker::BAKE_SETTINGS LightmapBaker::GetDefaultSettings()
+{
+	BAKE_SETTINGS settings;
+	settings.atlasSize = 1024;
+	settings.texelsPerUnit = 4.0f;
+	settings.occlusionSamples = 32;
+	settings.occlusionDistance = 2.0f;
+	settings.bounceSamples = 32;
+	settings.bounceStrength = 1.0f;
+	settings.rayBias = 0.005f;
+
+	return(settings);
+}
+
+/***********************************************************
+ *  LightmapBaker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightmapBaker::LightmapBaker(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_settings = GetDefaultSettings();
+	m_sceneHash = 0;
+}
+
+/***********************************************************
+ *  ~LightmapBaker()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightmapBaker::~LightmapBaker()
+{
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method adds a static object with its transform and
+ *  material.  Every added object is lit and casts shadows.
+ ***********************************************************/
+int LightmapBaker::AddObject(const MeshGeometry::MESH_DATA& mesh, const glm::mat4& model, const BAKE_MATERIAL& material)
+{
+	BAKE_OBJECT object;
+	object.mesh = mesh;
+	object.model = model;
+	object.material = material;
+	object.cellTexels = 0;
+	object.tileSize = 0;
+	object.tileX = 0;
+	object.tileY = 0;
+	m_objects.push_back(object);
+
+	return((int)m_objects.size() - 1);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method sets the lights that are baked.
+ ***********************************************************/
+void LightmapBaker::SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights)
+{
+	m_lights = lights;
+}
+
+/***********************************************************
+ *  Layout()
+ *
+ *  This method packs the objects into the atlas, lowering
+ *  the texel density until they fit, then builds the ray
+ *  tracer over the scene and finds the covered texels.
+ ***********************************************************/
+bool LightmapBaker::Layout(const BAKE_SETTINGS& settings)
+{
+	m_settings = settings;
+
+	float texelsPerUnit = settings.texelsPerUnit;
+	bool bPacked = false;
+	for (int attempt = 0; (attempt < 16) && (bPacked == false); attempt++)
+	{
+		bPacked = PackTiles(texelsPerUnit);
+		if (bPacked == false)
+		{
+			texelsPerUnit *= 0.8f;
+		}
+	}
+
+	if (bPacked == false)
+	{
+		std::cout << "ERROR: the scene does not fit into a " << settings.atlasSize << " lightmap atlas" << std::endl;
+		return(false);
+	}
+
+	m_rayTracer.Clear();
+	m_triangleObjects.clear();
+	m_firstTriangles.clear();
+
+	for (int i = 0; i < (int)m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		m_firstTriangles.push_back(m_rayTracer.GetTriangleCount());
+
+		for (size_t t = 0; t + 2 < object.mesh.indices.size(); t += 3)
+		{
+			glm::vec3 corners[3];
+			for (int c = 0; c < 3; c++)
+			{
+				corners[c] = glm::vec3(object.model * glm::vec4(object.mesh.vertices[object.mesh.indices[t + c]].position, 1.0f));
+			}
+
+			m_rayTracer.AddTriangle(corners[0], corners[1], corners[2]);
+			m_triangleObjects.push_back(i);
+		}
+	}
+
+	m_rayTracer.Build();
+	RasterizeTexels();
+	m_sceneHash = HashScene();
+
+	std::cout << "INFO: Lightmap layout: " << m_objects.size() << " objects, "
+		<< m_texels.size() << " texels at " << texelsPerUnit << " texels per unit" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  PackTiles()
+ *
+ *  This method gives every triangle of an object its own
+ *  half of a square cell, two triangles to a cell, so any
+ *  mesh is unwrapped without overlaps.  The quads of the
+ *  basic shapes are split along the same diagonal as their
+ *  cell and stay seamless.  A cell keeps a texel of padding
+ *  on every side so filtering does not bleed between cells.
+ *  The cells of an object form a square tile, sized by its
+ *  world surface area, and the tiles are packed into rows.
+ ***********************************************************/
+bool LightmapBaker::PackTiles(float texelsPerUnit)
+{
+	int atlasSize = m_settings.atlasSize;
+	std::vector<int> order;
+
+	for (int i = 0; i < (int)m_objects.size(); i++)
+	{
+		BAKE_OBJECT& object = m_objects[i];
+		int triangleCount = (int)object.mesh.indices.size() / 3;
+		int cellCount = (triangleCount + 1) / 2;
+		int grid = std::max(1, (int)ceil(sqrt((double)cellCount)));
+
+		float area = 0.0f;
+		for (int t = 0; t < triangleCount; t++)
+		{
+			glm::vec3 a = glm::vec3(object.model * glm::vec4(object.mesh.vertices[object.mesh.indices[t * 3]].position, 1.0f));
+			glm::vec3 b = glm::vec3(object.model * glm::vec4(object.mesh.vertices[object.mesh.indices[t * 3 + 1]].position, 1.0f));
+			glm::vec3 c = glm::vec3(object.model * glm::vec4(object.mesh.vertices[object.mesh.indices[t * 3 + 2]].position, 1.0f));
+			area += glm::length(glm::cross(b - a, c - a)) * 0.5f;
+		}
+
+		float cellSide = sqrt((2.0f * area) / (float)std::max(1, triangleCount));
+		object.cellTexels = std::min(512, std::max(4, (int)ceil(cellSide * texelsPerUnit) + 2));
+		object.tileSize = grid * object.cellTexels;
+
+		if (object.tileSize > atlasSize)
+		{
+			return(false);
+		}
+
+		order.push_back(i);
+	}
+
+	// tallest tiles first keeps the rows tight
+	std::sort(order.begin(), order.end(),
+		[this](int a, int b) { return(m_objects[a].tileSize > m_objects[b].tileSize); });
+
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		BAKE_OBJECT& object = m_objects[order[i]];
+		if (x + object.tileSize > atlasSize)
+		{
+			x = 0;
+			y += rowHeight;
+			rowHeight = 0;
+		}
+		if (y + object.tileSize > atlasSize)
+		{
+			return(false);
+		}
+
+		object.tileX = x;
+		object.tileY = y;
+		x += object.tileSize;
+		rowHeight = std::max(rowHeight, object.tileSize);
+	}
+
+	// one vertex per triangle corner with its atlas coordinate
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		BAKE_OBJECT& object = m_objects[i];
+		int triangleCount = (int)object.mesh.indices.size() / 3;
+		int grid = object.tileSize / object.cellTexels;
+		object.lightmapMesh.vertices.clear();
+		object.lightmapMesh.indices.clear();
+
+		for (int t = 0; t < triangleCount; t++)
+		{
+			int cell = t / 2;
+			float x0 = (float)(object.tileX + ((cell % grid) * object.cellTexels) + 1);
+			float y0 = (float)(object.tileY + ((cell / grid) * object.cellTexels) + 1);
+			float x1 = x0 + (float)(object.cellTexels - 2);
+			float y1 = y0 + (float)(object.cellTexels - 2);
+
+			glm::vec2 corners[3];
+			if ((t % 2) == 0)
+			{
+				corners[0] = glm::vec2(x0, y0);
+				corners[1] = glm::vec2(x1, y0);
+				corners[2] = glm::vec2(x1, y1);
+			}
+			else
+			{
+				corners[0] = glm::vec2(x0, y0);
+				corners[1] = glm::vec2(x1, y1);
+				corners[2] = glm::vec2(x0, y1);
+			}
+
+			for (int c = 0; c < 3; c++)
+			{
+				MeshGeometry::VERTEX vertex = object.mesh.vertices[object.mesh.indices[t * 3 + c]];
+				vertex.lightmapCoordinate = corners[c] / (float)atlasSize;
+				object.lightmapMesh.indices.push_back((GLuint)object.lightmapMesh.vertices.size());
+				object.lightmapMesh.vertices.push_back(vertex);
+			}
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  RasterizeTexels()
+ *
+ *  This method walks the texels under every triangle in the
+ *  atlas and records the world position and normal at each
+ *  texel center.
+ ***********************************************************/
+void LightmapBaker::RasterizeTexels()
+{
+	int atlasSize = m_settings.atlasSize;
+	std::vector<unsigned char> covered(atlasSize * atlasSize, 0);
+	m_texels.clear();
+
+	for (int i = 0; i < (int)m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		const std::vector<MeshGeometry::VERTEX>& vertices = object.lightmapMesh.vertices;
+		glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(object.model)));
+
+		for (size_t t = 0; t + 2 < vertices.size(); t += 3)
+		{
+			glm::vec2 p0 = vertices[t].lightmapCoordinate * (float)atlasSize;
+			glm::vec2 e1 = vertices[t + 1].lightmapCoordinate * (float)atlasSize - p0;
+			glm::vec2 e2 = vertices[t + 2].lightmapCoordinate * (float)atlasSize - p0;
+			float determinant = (e1.x * e2.y) - (e1.y * e2.x);
+			if (fabs(determinant) < 1e-8f)
+			{
+				continue;
+			}
+
+			glm::vec2 minimum = glm::min(p0, glm::min(p0 + e1, p0 + e2));
+			glm::vec2 maximum = glm::max(p0, glm::max(p0 + e1, p0 + e2));
+			int xStart = std::max(0, (int)floor(minimum.x));
+			int yStart = std::max(0, (int)floor(minimum.y));
+			int xEnd = std::min(atlasSize - 1, (int)ceil(maximum.x));
+			int yEnd = std::min(atlasSize - 1, (int)ceil(maximum.y));
+
+			for (int y = yStart; y <= yEnd; y++)
+			{
+				for (int x = xStart; x <= xEnd; x++)
+				{
+					int pixel = (y * atlasSize) + x;
+					if (covered[pixel] != 0)
+					{
+						continue;
+					}
+
+					glm::vec2 q = glm::vec2((float)x + 0.5f, (float)y + 0.5f) - p0;
+					float u = ((q.x * e2.y) - (q.y * e2.x)) / determinant;
+					float v = ((e1.x * q.y) - (e1.y * q.x)) / determinant;
+					if ((u < -1e-4f) || (v < -1e-4f) || (u + v > 1.0001f))
+					{
+						continue;
+					}
+
+					float w = 1.0f - u - v;
+					glm::vec3 position = (vertices[t].position * w) + (vertices[t + 1].position * u) + (vertices[t + 2].position * v);
+					glm::vec3 normal = (vertices[t].normal * w) + (vertices[t + 1].normal * u) + (vertices[t + 2].normal * v);
+
+					TEXEL texel;
+					texel.pixel = pixel;
+					texel.object = i;
+					texel.position = glm::vec3(object.model * glm::vec4(position, 1.0f));
+					texel.normal = normalMatrix * normal;
+					if (glm::length(texel.normal) < 1e-6f)
+					{
+						texel.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+					}
+					texel.normal = glm::normalize(texel.normal);
+
+					covered[pixel] = 1;
+					m_texels.push_back(texel);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BakeDirectTexel()
+ *
+ *  This method lights one texel the way the fragment shader
+ *  does, minus the specular term, with a shadow ray to each
+ *  light.  The ambient light is scaled by the share of
+ *  hemisphere rays that leave the surface unblocked.
+ ***********************************************************/
+void LightmapBaker::BakeDirectTexel(const TEXEL& texel, glm::vec3& light, glm::vec3& directDiffuse, float& occlusion) const
+{
+	const BAKE_MATERIAL& material = m_objects[texel.object].material;
+	glm::vec3 origin = texel.position + (texel.normal * m_settings.rayBias);
+	glm::vec3 ambientLight(0.0f);
+	glm::vec3 diffuseLight(0.0f);
+
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		const ClusteredLighting::LIGHT_SOURCE& source = m_lights[i];
+		glm::vec3 offset = source.position - texel.position;
+		float distance = glm::length(offset);
+		if (distance <= 0.0f)
+		{
+			continue;
+		}
+		glm::vec3 direction = offset / distance;
+
+		float attenuation = 1.0f;
+		if (source.range > 0.0f)
+		{
+			float falloff = glm::clamp(1.0f - pow(distance / source.range, 2.0f), 0.0f, 1.0f);
+			attenuation = falloff * falloff;
+		}
+		if (attenuation <= 0.0f)
+		{
+			continue;
+		}
+
+		ambientLight += source.ambientColor * attenuation;
+
+		float impact = std::max(glm::dot(texel.normal, direction), 0.0f);
+		if (impact <= 0.0f)
+		{
+			continue;
+		}
+
+		float spotFactor = 1.0f;
+		if (source.outerConeCosine > -1.0f)
+		{
+			float theta = glm::dot(-direction, glm::normalize(source.direction));
+			spotFactor = glm::smoothstep(source.outerConeCosine, source.innerConeCosine, theta);
+		}
+		if (spotFactor <= 0.0f)
+		{
+			continue;
+		}
+
+		if (m_rayTracer.IsOccluded(origin, direction, distance - m_settings.rayBias) == true)
+		{
+			continue;
+		}
+
+		diffuseLight += impact * source.diffuseColor * spotFactor * attenuation;
+	}
+
+	occlusion = 1.0f;
+	if (m_settings.occlusionSamples > 0)
+	{
+		RANDOM random((unsigned int)texel.pixel);
+		int unblocked = 0;
+		for (int i = 0; i < m_settings.occlusionSamples; i++)
+		{
+			glm::vec3 direction = SampleHemisphere(texel.normal, random);
+			if (m_rayTracer.IsOccluded(origin, direction, m_settings.occlusionDistance) == false)
+			{
+				unblocked++;
+			}
+		}
+		occlusion = (float)unblocked / (float)m_settings.occlusionSamples;
+	}
+
+	directDiffuse = diffuseLight * material.diffuseColor;
+	light = (ambientLight * material.ambientStrength * material.ambientColor * occlusion) + directDiffuse;
+}
+
+/***********************************************************
+ *  BakeBounceTexel()
+ *
+ *  This method averages the direct light of the surfaces the
+ *  hemisphere rays of a texel hit, which with cosine
+ *  distributed rays is the light bounced onto the texel.
+ ***********************************************************/
+glm::vec3 LightmapBaker::BakeBounceTexel(const TEXEL& texel) const
+{
+	const BAKE_MATERIAL& material = m_objects[texel.object].material;
+	glm::vec3 origin = texel.position + (texel.normal * m_settings.rayBias);
+	glm::vec3 gathered(0.0f);
+	int atlasSize = m_settings.atlasSize;
+
+	RANDOM random((unsigned int)texel.pixel ^ 0x9E3779B9u);
+	for (int i = 0; i < m_settings.bounceSamples; i++)
+	{
+		glm::vec3 direction = SampleHemisphere(texel.normal, random);
+
+		RayTracer::RAY_HIT hit;
+		if (m_rayTracer.Intersect(origin, direction, 1e30f, hit) == false)
+		{
+			continue;
+		}
+
+		// the lightmap coordinate of the hit point
+		int object = m_triangleObjects[hit.triangle];
+		int corner = (hit.triangle - m_firstTriangles[object]) * 3;
+		const std::vector<MeshGeometry::VERTEX>& vertices = m_objects[object].lightmapMesh.vertices;
+		glm::vec2 coordinate =
+			(vertices[corner].lightmapCoordinate * (1.0f - hit.u - hit.v)) +
+			(vertices[corner + 1].lightmapCoordinate * hit.u) +
+			(vertices[corner + 2].lightmapCoordinate * hit.v);
+
+		int x = glm::clamp((int)(coordinate.x * (float)atlasSize), 0, atlasSize - 1);
+		int y = glm::clamp((int)(coordinate.y * (float)atlasSize), 0, atlasSize - 1);
+		gathered += m_directLight[(y * atlasSize) + x];
+	}
+
+	if (m_settings.bounceSamples == 0)
+	{
+		return(glm::vec3(0.0f));
+	}
+
+	return((gathered / (float)m_settings.bounceSamples) * material.diffuseColor * m_settings.bounceStrength);
+}
+
+/***********************************************************
+ *  DilateLightmap()
+ *
+ *  This method grows the covered texels outwards, so the
+ *  padding around every cell holds the color of the nearest
+ *  surface and bilinear filtering at the cell edges stays
+ *  on the right color.
+ ***********************************************************/
+void LightmapBaker::DilateLightmap(std::vector<glm::vec4>& texels, std::vector<unsigned char>& coverage, int size, int passes)
+{
+	for (int pass = 0; pass < passes; pass++)
+	{
+		std::vector<glm::vec4> source = texels;
+		std::vector<unsigned char> sourceCoverage = coverage;
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				if (sourceCoverage[(y * size) + x] != 0)
+				{
+					continue;
+				}
+
+				glm::vec4 sum(0.0f);
+				int count = 0;
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						int nx = x + dx;
+						int ny = y + dy;
+						if ((nx >= 0) && (ny >= 0) && (nx < size) && (ny < size) &&
+							(sourceCoverage[(ny * size) + nx] != 0))
+						{
+							sum += source[(ny * size) + nx];
+							count++;
+						}
+					}
+				}
+
+				if (count > 0)
+				{
+					texels[(y * size) + x] = sum / (float)count;
+					coverage[(y * size) + x] = 1;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method lights every covered texel on the job system
+ *  workers - first the direct light and occlusion, then the
+ *  bounce, which reads the direct light of the first pass.
+ ***********************************************************/
+void LightmapBaker::Bake()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int atlasSize = m_settings.atlasSize;
+	int texelCount = atlasSize * atlasSize;
+
+	std::vector<glm::vec4> lightmap(texelCount, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	std::vector<glm::vec4> directLight(texelCount, glm::vec4(0.0f));
+	std::vector<unsigned char> coverage(texelCount, 0);
+
+	// every texel is written by exactly one job
+	m_pJobSystem->ParallelFor(
+		"BakeDirectLight",
+		(unsigned int)m_texels.size(),
+		64,
+		[this, &lightmap, &directLight](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				glm::vec3 light;
+				glm::vec3 directDiffuse;
+				float occlusion = 1.0f;
+				BakeDirectTexel(m_texels[i], light, directDiffuse, occlusion);
+				lightmap[m_texels[i].pixel] = glm::vec4(light, occlusion);
+				directLight[m_texels[i].pixel] = glm::vec4(directDiffuse, 1.0f);
+			}
+		});
+
+	for (size_t i = 0; i < m_texels.size(); i++)
+	{
+		coverage[m_texels[i].pixel] = 1;
+	}
+
+	// bounce rays may land in the padding next to a cell edge
+	std::vector<unsigned char> directCoverage = coverage;
+	DilateLightmap(directLight, directCoverage, atlasSize, 2);
+	m_directLight.resize(texelCount);
+	for (int i = 0; i < texelCount; i++)
+	{
+		m_directLight[i] = glm::vec3(directLight[i]);
+	}
+
+	if (m_settings.bounceSamples > 0)
+	{
+		m_pJobSystem->ParallelFor(
+			"BakeBounceLight",
+			(unsigned int)m_texels.size(),
+			64,
+			[this, &lightmap](unsigned int begin, unsigned int end)
+			{
+				for (unsigned int i = begin; i < end; i++)
+				{
+					glm::vec3 bounce = BakeBounceTexel(m_texels[i]);
+					lightmap[m_texels[i].pixel] += glm::vec4(bounce, 0.0f);
+				}
+			});
+	}
+
+	DilateLightmap(lightmap, coverage, atlasSize, 4);
+
+	m_lightmap.resize(texelCount * 4);
+	for (int i = 0; i < texelCount; i++)
+	{
+		m_lightmap[(i * 4)] = FloatToHalf(lightmap[i].r);
+		m_lightmap[(i * 4) + 1] = FloatToHalf(lightmap[i].g);
+		m_lightmap[(i * 4) + 2] = FloatToHalf(lightmap[i].b);
+		m_lightmap[(i * 4) + 3] = FloatToHalf(lightmap[i].a);
+	}
+
+	// the bounce lookups are not needed after the bake
+	std::vector<glm::vec3>().swap(m_directLight);
+
+	std::cout << "INFO: Lightmap baked in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+		<< " ms - " << m_texels.size() << " texels, " << m_rayTracer.GetTriangleCount() << " triangles, "
+		<< m_pJobSystem->GetWorkerCount() << " threads" << std::endl;
+}
+
+/***********************************************************
+ *  HashScene()
+ *
+ *  This method hashes the settings, meshes, transforms,
+ *  materials and lights, so a saved lightmap is only used
+ *  for the scene it was baked from.
+ ***********************************************************/
+unsigned long long LightmapBaker::HashScene() const
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	hash = HashBytes(&g_LightmapVersion, sizeof(g_LightmapVersion), hash);
+	hash = HashBytes(&m_settings, sizeof(m_settings), hash);
+
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		hash = HashBytes(object.mesh.vertices.data(), object.mesh.vertices.size() * sizeof(MeshGeometry::VERTEX), hash);
+		hash = HashBytes(object.mesh.indices.data(), object.mesh.indices.size() * sizeof(GLuint), hash);
+		hash = HashBytes(&object.model, sizeof(object.model), hash);
+		hash = HashBytes(&object.material, sizeof(object.material), hash);
+	}
+
+	if (m_lights.empty() == false)
+	{
+		hash = HashBytes(m_lights.data(), m_lights.size() * sizeof(ClusteredLighting::LIGHT_SOURCE), hash);
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method reads a saved lightmap.  It has to be called
+ *  after Layout(), and fails when the file was baked from a
+ *  different scene or with different settings.
+ ***********************************************************/
+bool LightmapBaker::Load(const char* filePath)
+{
+	std::ifstream file(filePath, std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return(false);
+	}
+
+	LIGHTMAP_HEADER header = {};
+	file.read((char*)&header, sizeof(header));
+
+	if ((!file) ||
+		(header.magic != g_LightmapMagic) ||
+		(header.version != g_LightmapVersion) ||
+		(header.sceneHash != m_sceneHash) ||
+		(header.width != (unsigned int)m_settings.atlasSize) ||
+		(header.height != (unsigned int)m_settings.atlasSize))
+	{
+		return(false);
+	}
+
+	std::vector<unsigned short> texels(header.width * header.height * 4);
+	file.read((char*)texels.data(), texels.size() * sizeof(unsigned short));
+	if (!file)
+	{
+		return(false);
+	}
+
+	m_lightmap.swap(texels);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Save()
+ *
+ *  This method writes the baked lightmap with the scene hash,
+ *  creating the directory of the file if needed.
+ ***********************************************************/
+bool LightmapBaker::Save(const char* filePath) const
+{
+	if (m_lightmap.empty())
+	{
+		return(false);
+	}
+
+	std::string path = filePath;
+	size_t separator = path.find_last_of("/\\");
+	if (separator != std::string::npos)
+	{
+#ifdef _WIN32
+		_mkdir(path.substr(0, separator).c_str());
+#else
+		mkdir(path.substr(0, separator).c_str(), 0755);
+#endif
+	}
+
+	std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write lightmap:" << filePath << std::endl;
+		return(false);
+	}
+
+	LIGHTMAP_HEADER header = {};
+	header.magic = g_LightmapMagic;
+	header.version = g_LightmapVersion;
+	header.sceneHash = m_sceneHash;
+	header.width = (unsigned int)m_settings.atlasSize;
+	header.height = (unsigned int)m_settings.atlasSize;
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)m_lightmap.data(), m_lightmap.size() * sizeof(unsigned short));
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method uploads the lightmap as a half float texture.
+ *  It has no mipmaps, since every cell is only a few texels.
+ ***********************************************************/
+GLuint LightmapBaker::CreateTexture(GLStateCache* pStateCache) const
+{
+	if (m_lightmap.empty())
+	{
+		return(0);
+	}
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	pStateCache->BindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, m_settings.atlasSize, m_settings.atlasSize, 0, GL_RGBA, GL_HALF_FLOAT, m_lightmap.data());
+
+	pStateCache->BindTexture(GL_TEXTURE_2D, 0);
+
+	return(texture);
+}
+
+/***********************************************************
+ *  GetLightmapMesh()
+ *
+ *  This method returns the unwrapped mesh of an object, in
+ *  the object's own space, to draw with the lightmap.
+ ***********************************************************/
+const MeshGeometry::MESH_DATA& LightmapBaker::GetLightmapMesh(int object) const
+{
+	return(m_objects[object].lightmapMesh);
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method returns the number of added objects.
+ ***********************************************************/
+int LightmapBaker::GetObjectCount() const
+{
+	return((int)m_objects.size());
+}
+
+/***********************************************************
+ *  GetAtlasSize()
+ *
+ *  This method returns the width and height of the atlas.
+ ***********************************************************/
+int LightmapBaker::GetAtlasSize() const
+{
+	return(m_settings.atlasSize);
+}
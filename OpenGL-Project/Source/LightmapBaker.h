@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.h
+// ============
+// bake the static scene lighting into a lightmap atlas on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "GLStateCache.h"
+#include "JobSystem.h"
+#include "MeshGeometry.h"
+#include "RayTracer.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  LightmapBaker
+ *
+ *  This class gives every static object its own region of a
+ *  lightmap atlas and computes the diffuse lighting of each
+ *  texel with a ray tracer over the whole scene - direct
+ *  light with shadows, ambient occlusion and one bounce of
+ *  indirect light.  The material colors are baked in, so the
+ *  runtime shader only has to multiply one texture fetch
+ *  with the surface texture.  View dependent specular light
+ *  is left out.  The result is saved with a hash of the
+ *  scene and only baked again when something changes.
+ ***********************************************************/
+class LightmapBaker
+{
+public:
+	struct BAKE_SETTINGS
+	{
+		// width and height of the lightmap atlas in texels
+		int atlasSize;
+		// texel density aimed for, lowered until everything fits
+		float texelsPerUnit;
+		// hemisphere rays per texel for the ambient occlusion
+		int occlusionSamples;
+		float occlusionDistance;
+		// hemisphere rays per texel for the bounced light
+		int bounceSamples;
+		float bounceStrength;
+		// offset along the normal that keeps rays off the surface
+		float rayBias;
+	};
+
+	// the parts of an object's material that diffuse light needs
+	struct BAKE_MATERIAL
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+	};
+
+	// settings that bake the scene in a few seconds
+	static BAKE_SETTINGS GetDefaultSettings();
+
+	// constructor
+	LightmapBaker(JobSystem* pJobSystem);
+	// destructor
+	~LightmapBaker();
+
+	// add a static object that receives and blocks light
+	int AddObject(const MeshGeometry::MESH_DATA& mesh, const glm::mat4& model, const BAKE_MATERIAL& material);
+	// set the lights the scene is lit by
+	void SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights);
+
+	// unwrap the objects and pack them into the atlas
+	bool Layout(const BAKE_SETTINGS& settings);
+	// trace the lighting of every texel in the atlas
+	void Bake();
+	// read a lightmap baked for the same scene and settings
+	bool Load(const char* filePath);
+	// write the baked lightmap
+	bool Save(const char* filePath) const;
+
+	// create a texture from the baked lightmap
+	GLuint CreateTexture(GLStateCache* pStateCache) const;
+	// an object's mesh with a vertex per triangle corner and
+	// the lightmap coordinates filled in
+	const MeshGeometry::MESH_DATA& GetLightmapMesh(int object) const;
+	int GetObjectCount() const;
+	int GetAtlasSize() const;
+
+private:
+	struct BAKE_OBJECT
+	{
+		MeshGeometry::MESH_DATA mesh;
+		glm::mat4 model;
+		BAKE_MATERIAL material;
+		MeshGeometry::MESH_DATA lightmapMesh;
+		// texels per unwrap cell and the size of the square tile
+		int cellTexels;
+		int tileSize;
+		int tileX;
+		int tileY;
+	};
+
+	// a covered atlas texel and the surface point it stands for
+	struct TEXEL
+	{
+		int pixel;
+		int object;
+		glm::vec3 position;
+		glm::vec3 normal;
+	};
+
+	// pointer to job system used to trace the texels in parallel
+	JobSystem* m_pJobSystem;
+	BAKE_SETTINGS m_settings;
+	std::vector<BAKE_OBJECT> m_objects;
+	std::vector<ClusteredLighting::LIGHT_SOURCE> m_lights;
+
+	// all the object triangles in world space
+	RayTracer m_rayTracer;
+	// object and first ray tracer triangle of every object
+	std::vector<int> m_triangleObjects;
+	std::vector<int> m_firstTriangles;
+
+	std::vector<TEXEL> m_texels;
+	// direct diffuse light per atlas texel, read by the bounce
+	std::vector<glm::vec3> m_directLight;
+	// final lighting per atlas texel as half floats, RGBA with
+	// the ambient occlusion in alpha
+	std::vector<unsigned short> m_lightmap;
+	unsigned long long m_sceneHash;
+
+	// give every object a tile and fill in its lightmap mesh
+	bool PackTiles(float texelsPerUnit);
+	// find the atlas texels covered by every triangle
+	void RasterizeTexels();
+	// light one texel directly and measure its occlusion
+	void BakeDirectTexel(const TEXEL& texel, glm::vec3& light, glm::vec3& directDiffuse, float& occlusion) const;
+	// gather the light bounced onto one texel
+	glm::vec3 BakeBounceTexel(const TEXEL& texel) const;
+	// fill the padding around the charts from covered neighbours
+	static void DilateLightmap(std::vector<glm::vec4>& texels, std::vector<unsigned char>& coverage, int size, int passes);
+	// hash everything the lightmap depends on
+	unsigned long long HashScene() const;
+};
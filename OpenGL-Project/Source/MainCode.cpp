@@ -1,5 +1,10 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <chrono>           // startup timing
+#include <cstring>          // command line options
+#include <cstdio>           // image sequence file names
+#include <string>
+#include <vector>
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +18,19 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "JobSystem.h"
+#include "GLStateCache.h"
+#include "MeshImporter.h"
+#include "CameraPath.h"
+#include "DynamicResolution.h"
+#include "FrameArena.h"
+#include "FrameCapture.h"
+#include "FrameEncoder.h"
+#include "InputRecorder.h"
+#include "PathTracer.h"
+#include "RenderGraph.h"
+#include "SceneCompiler.h"
+#include "SoftwareRasterizer.h"
 
 
 // Namespace for declaring global variables
@@ -30,26 +48,29 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
-
-	// Camera parameters
-	glm::vec3 cameraPosition = glm::vec3(12.0f, 10.0f, 10.0f);
-	glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, 1.0f);
-	glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-
-	// Camera control variables
-	float cameraSpeed = 6.0f;
-	float cameraSensitivity = 0.2f;
-
-	// Mouse movement
-	double lastMouseX = 400.0;
-	double lastMouseY = 300.0;  // Initial mouse position (center of window)
-
-	// Camera angles
-	float yaw = -90.0f;
-	float pitch = 0.0f;
-
-	// Mouse scroll
-	float scrollSpeed = 0.1f;
+	// job system object for spreading per-frame work over all cores
+	JobSystem* g_JobSystem = nullptr;
+	// filter for redundant OpenGL state changes
+	GLStateCache* g_StateCache = nullptr;
+	// source of the input, live, recorded or replayed
+	InputRecorder* g_InputRecorder = nullptr;
+	// render size that follows the GPU time of the scene
+	DynamicResolution* g_DynamicResolution = nullptr;
+	// passes and render targets of the frame
+	RenderGraph* g_RenderGraph = nullptr;
+	// memory of the data that only lives for one frame, and the
+	// bytes it starts with for every frame
+	FrameArena* g_FrameArena = nullptr;
+	const size_t FRAME_ARENA_BYTES = 64 * 1024;
+	// seconds between printing the state change counters
+	const double STATE_REPORT_INTERVAL = 5.0;
+
+	// camera keyframes recorded with the 'K' key, and the file
+	// they are saved to after every new keyframe
+	CameraPath g_RecordedPath;
+	const char* const CAMERA_PATH_FILE = "CameraPath.txt";
+	// seconds between recorded keyframes
+	const float KEYFRAME_INTERVAL = 2.0f;
 
 }
 
@@ -57,10 +78,15 @@ namespace
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+int RenderSoftwareImage(const char* imagePath, int frameCount);
+int BenchmarkGLFrames(int frameCount);
+int RenderPathTracedImage(const char* imagePath, int width, int passCount);
+int RenderCameraPath(const char* pathFile, const char* outputPattern, int width, int height, int framesPerSecond);
+bool IsFramePattern(const char* pattern);
+int BenchmarkImport(const char* modelPath, int runCount);
 
 void ProcessInput(GLFWwindow* window);
-static void MouseCallback(GLFWwindow* window, double xpos, double ypos);
-void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+void RenderFrameGraph(int windowWidth, int windowHeight);
 
 
 
@@ -72,6 +98,118 @@ void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// "--software image.tga [frames]" renders the scene on the CPU
+	// into an image, for machines without a GPU
+	if ((argc >= 3) && (strcmp(argv[1], "--software") == 0))
+	{
+		int frameCount = (argc >= 4) ? atoi(argv[3]) : 1;
+		return(RenderSoftwareImage(argv[2], (frameCount > 0) ? frameCount : 1));
+	}
+
+	// "--gl-benchmark [frames]" times the same frames through
+	// OpenGL in a hidden window, which is llvmpipe when run with
+	// LIBGL_ALWAYS_SOFTWARE=1, to compare against "--software"
+	if ((argc >= 2) && (strcmp(argv[1], "--gl-benchmark") == 0))
+	{
+		int frameCount = (argc >= 3) ? atoi(argv[2]) : 1;
+		return(BenchmarkGLFrames((frameCount > 0) ? frameCount : 1));
+	}
+
+	// "--pathtrace image.tga [width] [passes]" path traces a
+	// reference still of the scene on the CPU
+	if ((argc >= 3) && (strcmp(argv[1], "--pathtrace") == 0))
+	{
+		int width = (argc >= 4) ? atoi(argv[3]) : 0;
+		int passCount = (argc >= 5) ? atoi(argv[4]) : 0;
+		return(RenderPathTracedImage(argv[2], width, passCount));
+	}
+
+	// "--import-benchmark model.obj [runs]" imports a model file
+	// several times and prints the throughput
+	if ((argc >= 3) && (strcmp(argv[1], "--import-benchmark") == 0))
+	{
+		int runCount = (argc >= 4) ? atoi(argv[3]) : 5;
+		return(BenchmarkImport(argv[2], (runCount > 0) ? runCount : 1));
+	}
+
+	// "--compile-scene scene.json scene.bin" compiles an authored
+	// scene into a scene file for "--scene"
+	if ((argc >= 4) && (strcmp(argv[1], "--compile-scene") == 0))
+	{
+		SceneCompiler compiler;
+		return((compiler.Compile(argv[2], argv[3]) == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// "--flythrough path.txt frames/frame_%04d.png [width height]
+	// [fps]" renders a camera path to an image sequence, EXR when
+	// the pattern ends in .exr
+	if ((argc >= 4) && (strcmp(argv[1], "--flythrough") == 0))
+	{
+		int width = (argc >= 6) ? atoi(argv[4]) : 1920;
+		int height = (argc >= 6) ? atoi(argv[5]) : 1080;
+		int framesPerSecond = (argc >= 7) ? atoi(argv[6]) : 30;
+		return(RenderCameraPath(argv[2], argv[3], width, height, framesPerSecond));
+	}
+
+	// "--record-input input.txt" writes the input of the session
+	// to a file, "--replay-input input.txt [ms]" plays it back on
+	// a fixed timestep and quits at its end
+	// "--resolution-scale min max [sharpness]" bounds the render
+	// size as a fraction of the window, "--gpu-budget ms" sets the
+	// GPU time the render size is scaled to hold
+	// "--tessellation slices" sets how finely the round shapes
+	// are built, 32 slices by default, and "--model file" places
+	// an .obj, .gltf or .glb model in the scene
+	// "--scene scene.bin" builds the scene from a compiled scene
+	// file instead of the scene defined in code
+	const char* recordPath = NULL;
+	const char* scenePath = NULL;
+	const char* replayPath = NULL;
+	double replayTimestep = 1.0 / 60.0;
+	int tessellation = 0;
+	std::vector<const char*> modelPaths;
+	DynamicResolution::RESOLUTION_SETTINGS resolutionSettings = DynamicResolution::GetDefaultSettings();
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], "--record-input") == 0)
+		{
+			recordPath = argv[i + 1];
+		}
+		else if (strcmp(argv[i], "--replay-input") == 0)
+		{
+			replayPath = argv[i + 1];
+			if ((i + 2 < argc) && (atof(argv[i + 2]) > 0.0))
+			{
+				replayTimestep = atof(argv[i + 2]) / 1000.0;
+			}
+		}
+		else if ((strcmp(argv[i], "--resolution-scale") == 0) && (i + 2 < argc))
+		{
+			resolutionSettings.minScale = (float)atof(argv[i + 1]);
+			resolutionSettings.maxScale = (float)atof(argv[i + 2]);
+			if ((i + 3 < argc) && (argv[i + 3][0] != '-'))
+			{
+				resolutionSettings.sharpness = (float)atof(argv[i + 3]);
+			}
+		}
+		else if ((strcmp(argv[i], "--gpu-budget") == 0) && (atof(argv[i + 1]) > 0.0))
+		{
+			resolutionSettings.targetMilliseconds = atof(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--tessellation") == 0)
+		{
+			tessellation = atoi(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--model") == 0)
+		{
+			modelPaths.push_back(argv[i + 1]);
+		}
+		else if (strcmp(argv[i], "--scene") == 0)
+		{
+			scenePath = argv[i + 1];
+		}
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -93,20 +231,69 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
+	// load the shader code from the project's GLSL files
+	std::chrono::steady_clock::time_point shaderStart = std::chrono::steady_clock::now();
 	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl");
 	g_ShaderManager->use();
+	std::cout << "INFO: Base Shader Program: "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count()
+		<< " ms" << std::endl;
+
+	// try to create a new job system with one worker per hardware thread
+	g_JobSystem = new JobSystem();
+	std::cout << "INFO: Job System Workers: " << g_JobSystem->GetWorkerCount() << std::endl;
+
+	// try to create a new state cache, which reads the state the
+	// window and shader setup left behind
+	g_StateCache = new GLStateCache();
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(g_ShaderManager, g_JobSystem, g_StateCache);
+	if (tessellation > 0)
+	{
+		g_SceneManager->SetTessellation(tessellation);
+	}
+	for (size_t i = 0; i < modelPaths.size(); i++)
+	{
+		g_SceneManager->AddModelFile(modelPaths[i]);
+	}
+	if ((NULL != scenePath) && (g_SceneManager->LoadSceneFile(scenePath) == false))
+	{
+		return(EXIT_FAILURE);
+	}
 	g_SceneManager->PrepareScene();
 
-	// My added input functions
+	// Enable z-depth, it stays on for the whole run
+	g_StateCache->Enable(GL_DEPTH_TEST);
+	double lastStateReport = glfwGetTime();
+
+	// render the scene off the screen at a size that holds the
+	// GPU budget, and upscale it to the window
+	g_DynamicResolution = new DynamicResolution(g_StateCache);
+	g_DynamicResolution->Create(resolutionSettings);
+	g_FrameArena = new FrameArena(FRAME_ARENA_BYTES);
+	g_RenderGraph = new RenderGraph(g_StateCache, g_FrameArena);
+
+	// all the input goes through the input recorder, which drains
+	// it once per frame into the view manager's camera and can
+	// record and replay it
 	glfwSetInputMode(g_Window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-	glfwSetCursorPosCallback(g_Window, MouseCallback);
-	glfwSetScrollCallback(g_Window, ScrollCallback);
+	g_InputRecorder = new InputRecorder();
+	g_InputRecorder->Attach(g_Window, &ViewManager::Mouse_Position_Callback, &ViewManager::Mouse_Scroll_Callback);
+	if (NULL != replayPath)
+	{
+		if (g_InputRecorder->StartReplay(replayPath, replayTimestep) == false)
+		{
+			return(EXIT_FAILURE);
+		}
+	}
+	else if (NULL != recordPath)
+	{
+		g_InputRecorder->StartRecording(recordPath);
+	}
+	g_ViewManager->SetInputRecorder(g_InputRecorder);
 
 
 
@@ -114,27 +301,67 @@ int main(int argc, char* argv[])
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
+		// start counting the state changes of this frame
+		g_StateCache->BeginFrame();
+		if ((glfwGetTime() - lastStateReport) >= STATE_REPORT_INTERVAL)
+		{
+			lastStateReport = glfwGetTime();
+			std::cout << "INFO: GL State Calls Per Frame: " << g_StateCache->GetIssuedCount()
+				<< " issued, " << g_StateCache->GetFilteredCount() << " filtered" << std::endl;
+			g_SceneManager->ReportPassTimings();
+			g_SceneManager->ReportCullingStatistics();
+			g_SceneManager->ReportBatchingStatistics();
+			g_InputRecorder->ReportLatency();
+			g_DynamicResolution->Report();
+			g_RenderGraph->Report();
+			g_FrameArena->Report();
+		}
+
+		// drop the frame data of the frame before last, the
+		// reports above are not counted as part of the frame
+		g_FrameArena->BeginFrame();
+
+		// pick the render size from the latest GPU times
+		int windowWidth = 0;
+		int windowHeight = 0;
+		glfwGetFramebufferSize(g_Window, &windowWidth, &windowHeight);
+		g_DynamicResolution->Update(windowWidth, windowHeight, g_SceneManager->GetGpuFrameMilliseconds());
+		g_ViewManager->SetViewportSize(g_DynamicResolution->GetRenderWidth(), g_DynamicResolution->GetRenderHeight());
+
+		// sample the input as late as possible, right before the
+		// camera is updated with it
+		g_InputRecorder->PollInput();
 		// Process input
 		ProcessInput(g_Window);
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
+		g_SceneManager->SetViewParameters(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition(),
+			g_ViewManager->GetViewportWidth(),
+			g_ViewManager->GetViewportHeight());
+
+		// refresh the 3D scene, a minimized window has nothing
+		// to render into
+		if ((windowWidth > 0) && (windowHeight > 0))
+		{
+			RenderFrameGraph(windowWidth, windowHeight);
+		}
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
-		// query the latest GLFW events
-		glfwPollEvents();
+		// measure the latency from the frame's input to the swap
+		g_InputRecorder->EndFrame();
+		g_FrameArena->EndFrame();
+	}
+
+	// save the recorded input or report the replay
+	if (NULL != g_InputRecorder)
+	{
+		g_InputRecorder->Stop();
 	}
 
 	// clear the allocated manager objects from memory
@@ -153,12 +380,514 @@ int main(int argc, char* argv[])
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
+	if (NULL != g_RenderGraph)
+	{
+		delete g_RenderGraph;
+		g_RenderGraph = NULL;
+	}
+	if (NULL != g_FrameArena)
+	{
+		delete g_FrameArena;
+		g_FrameArena = NULL;
+	}
+	if (NULL != g_DynamicResolution)
+	{
+		delete g_DynamicResolution;
+		g_DynamicResolution = NULL;
+	}
+	if (NULL != g_StateCache)
+	{
+		delete g_StateCache;
+		g_StateCache = NULL;
+	}
+	if (NULL != g_JobSystem)
+	{
+		delete g_JobSystem;
+		g_JobSystem = NULL;
+	}
+	if (NULL != g_InputRecorder)
+	{
+		delete g_InputRecorder;
+		g_InputRecorder = NULL;
+	}
 
 	// Terminates the program successfully
 	glfwTerminate();
 	exit(EXIT_SUCCESS);
 }
 
+/***********************************************************
+ *	RenderFrameGraph()
+ *
+ *  This function declares the passes of a frame and renders
+ *  them.  With dynamic resolution the scene goes into frame
+ *  textures that the upscale pass stretches over the window,
+ *  otherwise it is rendered into the window directly.
+ ***********************************************************/
+void RenderFrameGraph(int windowWidth, int windowHeight)
+{
+	g_RenderGraph->Reset();
+
+	RenderGraph::TEXTURE_DESC windowDesc;
+	windowDesc.width = windowWidth;
+	windowDesc.height = windowHeight;
+	windowDesc.format = GL_RGBA8;
+	int backbuffer = g_RenderGraph->ImportBackbuffer("Backbuffer", windowDesc);
+
+	int sceneColor = backbuffer;
+	int sceneDepth = -1;
+	if (g_DynamicResolution->IsUpscaling() == true)
+	{
+		RenderGraph::TEXTURE_DESC targetDesc;
+		targetDesc.width = g_DynamicResolution->GetTargetWidth();
+		targetDesc.height = g_DynamicResolution->GetTargetHeight();
+		targetDesc.format = GL_RGBA8;
+		sceneColor = g_RenderGraph->CreateTexture("SceneColor", targetDesc);
+		targetDesc.format = GL_DEPTH_COMPONENT24;
+		sceneDepth = g_RenderGraph->CreateTexture("SceneDepth", targetDesc);
+	}
+	else
+	{
+		windowDesc.format = GL_DEPTH_COMPONENT24;
+		sceneDepth = g_RenderGraph->ImportBackbuffer("BackbufferDepth", windowDesc);
+	}
+
+	g_SceneManager->AddScenePasses(g_RenderGraph, sceneColor, sceneDepth,
+		g_DynamicResolution->GetRenderWidth(), g_DynamicResolution->GetRenderHeight());
+	if (g_DynamicResolution->IsUpscaling() == true)
+	{
+		g_DynamicResolution->AddUpscalePass(g_RenderGraph, sceneColor, backbuffer);
+	}
+
+	if (g_RenderGraph->Compile() == true)
+	{
+		g_RenderGraph->Execute();
+	}
+}
+
+/***********************************************************
+ *	RenderSoftwareImage()
+ *
+ *  This function renders the scene from the default camera
+ *  with the software rasterizer, without creating a window
+ *  or an OpenGL context, and saves the last frame.  Several
+ *  frames are rendered to measure a steady frame time.
+ ***********************************************************/
+int RenderSoftwareImage(const char* imagePath, int frameCount)
+{
+	g_JobSystem = new JobSystem();
+	std::cout << "INFO: Job System Workers: " << g_JobSystem->GetWorkerCount() << std::endl;
+
+	// the view manager is only used for its camera
+	g_ViewManager = new ViewManager(NULL);
+	g_ViewManager->UpdateViewMatrices();
+
+	SoftwareRasterizer* pRasterizer = new SoftwareRasterizer(g_JobSystem);
+	g_SceneManager = new SceneManager(NULL, g_JobSystem, NULL);
+	g_SceneManager->PrepareSoftwareScene();
+	g_SceneManager->SetViewParameters(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix(),
+		g_ViewManager->GetCameraPosition(),
+		g_ViewManager->GetViewportWidth(),
+		g_ViewManager->GetViewportHeight());
+
+	double totalMilliseconds = 0.0;
+	for (int i = 0; i < frameCount; i++)
+	{
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+		g_SceneManager->RenderSoftwareScene(pRasterizer);
+		totalMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+	}
+	std::cout << "INFO: Software Frame: " << (totalMilliseconds / frameCount) << " ms, "
+		<< pRasterizer->GetTriangleCount() << " triangles at "
+		<< pRasterizer->GetWidth() << "x" << pRasterizer->GetHeight() << std::endl;
+
+	bool bSaved = pRasterizer->SaveImage(imagePath);
+	if (bSaved == true)
+	{
+		std::cout << "INFO: Software Image: " << imagePath << std::endl;
+	}
+
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete pRasterizer;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	delete g_JobSystem;
+	g_JobSystem = NULL;
+
+	return(bSaved ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	BenchmarkGLFrames()
+ *
+ *  This function renders the frames "--software" renders,
+ *  from the default camera at the default viewport size,
+ *  through OpenGL in a hidden window.  Every frame waits for
+ *  the GL to finish, so the printed time is the whole frame
+ *  on whichever renderer the driver picked, and it is printed
+ *  next to the renderer's name.
+ ***********************************************************/
+int BenchmarkGLFrames(int frameCount)
+{
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	g_ShaderManager = new ShaderManager();
+	g_ViewManager = new ViewManager(g_ShaderManager);
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	if ((NULL == g_Window) || (InitializeGLEW() == false))
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+	std::cout << "INFO: OpenGL Renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+	g_ShaderManager->LoadShaders(
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl");
+	g_ShaderManager->use();
+
+	g_JobSystem = new JobSystem();
+	std::cout << "INFO: Job System Workers: " << g_JobSystem->GetWorkerCount() << std::endl;
+	g_StateCache = new GLStateCache();
+	g_SceneManager = new SceneManager(g_ShaderManager, g_JobSystem, g_StateCache);
+	g_SceneManager->PrepareScene();
+	g_StateCache->Enable(GL_DEPTH_TEST);
+
+	g_ViewManager->UpdateViewMatrices();
+	int width = g_ViewManager->GetViewportWidth();
+	int height = g_ViewManager->GetViewportHeight();
+	glViewport(0, 0, width, height);
+
+	// build the shader variants up front, so the timed frames do
+	// not include the background compiles
+	g_SceneManager->WaitForShaderVariants();
+
+	double totalMilliseconds = 0.0;
+	for (int i = 0; i < frameCount; i++)
+	{
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+		g_StateCache->BeginFrame();
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		g_SceneManager->SetViewParameters(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition(),
+			width,
+			height);
+		g_SceneManager->RenderScene();
+		glFinish();
+		totalMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+		glfwPollEvents();
+	}
+	std::cout << "INFO: OpenGL Frame: " << (totalMilliseconds / frameCount) << " ms at "
+		<< width << "x" << height << std::endl;
+
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	delete g_ShaderManager;
+	g_ShaderManager = NULL;
+	delete g_StateCache;
+	g_StateCache = NULL;
+	delete g_JobSystem;
+	g_JobSystem = NULL;
+
+	glfwTerminate();
+	return(EXIT_SUCCESS);
+}
+
+/***********************************************************
+ *	BenchmarkImport()
+ *
+ *  This function imports a model file several times without
+ *  a window and prints the throughput of every run and of
+ *  the fastest one.  The first run reads the file from disk
+ *  and the later ones from the file cache, so both the cold
+ *  and the parsing speed show.
+ ***********************************************************/
+int BenchmarkImport(const char* modelPath, int runCount)
+{
+	g_JobSystem = new JobSystem();
+	std::cout << "INFO: Job System Workers: " << g_JobSystem->GetWorkerCount() << std::endl;
+
+	MeshImporter importer(g_JobSystem);
+	MeshGeometry::MESH_DATA mesh;
+	double fastestMilliseconds = 0.0;
+	bool bImported = true;
+	for (int i = 0; (i < runCount) && (bImported == true); i++)
+	{
+		bImported = importer.Import(modelPath, mesh);
+		if (bImported == true)
+		{
+			importer.Report(modelPath);
+			double milliseconds = importer.GetStatistics().milliseconds;
+			fastestMilliseconds = ((i == 0) || (milliseconds < fastestMilliseconds)) ? milliseconds : fastestMilliseconds;
+		}
+	}
+
+	if ((bImported == true) && (fastestMilliseconds > 0.0))
+	{
+		double megabytes = (double)importer.GetStatistics().fileBytes / (1024.0 * 1024.0);
+		std::cout << "INFO: Fastest Import: " << fastestMilliseconds << " ms ("
+			<< megabytes / (fastestMilliseconds / 1000.0) << " MB/s)" << std::endl;
+	}
+
+	delete g_JobSystem;
+	g_JobSystem = NULL;
+
+	return(bImported ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	RenderPathTracedImage()
+ *
+ *  This function path traces the scene from the default
+ *  camera without a window or an OpenGL context.  The image
+ *  keeps the aspect of the window and is saved after every
+ *  pass, so it can be looked at while it converges.
+ ***********************************************************/
+int RenderPathTracedImage(const char* imagePath, int width, int passCount)
+{
+	g_JobSystem = new JobSystem();
+	std::cout << "INFO: Job System Workers: " << g_JobSystem->GetWorkerCount() << std::endl;
+
+	// the view manager is only used for its camera
+	g_ViewManager = new ViewManager(NULL);
+	g_ViewManager->UpdateViewMatrices();
+
+	g_SceneManager = new SceneManager(NULL, g_JobSystem, NULL);
+	g_SceneManager->PrepareSoftwareScene();
+	g_SceneManager->SetViewParameters(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix(),
+		g_ViewManager->GetCameraPosition(),
+		g_ViewManager->GetViewportWidth(),
+		g_ViewManager->GetViewportHeight());
+
+	PathTracer* pPathTracer = new PathTracer(g_JobSystem);
+	g_SceneManager->BuildPathTracedScene(pPathTracer);
+
+	PathTracer::TRACE_SETTINGS settings = PathTracer::GetDefaultSettings();
+	if (width > 0)
+	{
+		settings.width = width;
+	}
+	settings.height = (settings.width * g_ViewManager->GetViewportHeight()) / g_ViewManager->GetViewportWidth();
+	pPathTracer->Reset(settings);
+
+	if (passCount <= 0)
+	{
+		passCount = 16;
+	}
+
+	bool bSaved = false;
+	for (int i = 0; i < passCount; i++)
+	{
+		pPathTracer->RenderPass();
+		bSaved = pPathTracer->SaveImage(imagePath);
+		std::cout << "INFO: Path Tracer: " << pPathTracer->GetSampleCount() << " samples per pixel, "
+			<< pPathTracer->GetSamplesPerSecondPerCore() << " samples/s per core" << std::endl;
+	}
+	if (bSaved == true)
+	{
+		std::cout << "INFO: Path Traced Image: " << imagePath << " at "
+			<< settings.width << "x" << settings.height << std::endl;
+	}
+
+	delete pPathTracer;
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	delete g_JobSystem;
+	g_JobSystem = NULL;
+
+	return(bSaved ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	RenderCameraPath()
+ *
+ *  This function renders every frame of a camera path off
+ *  the screen at the passed in resolution and writes them as
+ *  numbered images.  The window is hidden and only provides
+ *  the OpenGL context.  Frames are read back asynchronously
+ *  and written by the encoder threads, so the frame loop
+ *  runs as fast as the GPU renders.
+ ***********************************************************/
+int RenderCameraPath(const char* pathFile, const char* outputPattern, int width, int height, int framesPerSecond)
+{
+	CameraPath path;
+	if (path.Load(pathFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	if ((width <= 0) || (height <= 0) || (framesPerSecond <= 0))
+	{
+		std::cout << "Flythrough needs a positive size and frame rate" << std::endl;
+		return(EXIT_FAILURE);
+	}
+	// the pattern is the format string of the frame file names
+	if (IsFramePattern(outputPattern) == false)
+	{
+		std::cout << "Flythrough output needs exactly one frame number, like %04d:" << outputPattern << std::endl;
+		return(EXIT_FAILURE);
+	}
+
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	g_ShaderManager = new ShaderManager();
+	g_ViewManager = new ViewManager(g_ShaderManager);
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	if ((NULL == g_Window) || (InitializeGLEW() == false))
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+		glfwTerminate();
+		return(EXIT_FAILURE);
+	}
+
+	g_ShaderManager->LoadShaders(
+		"Shaders/vertexShader.glsl",
+		"Shaders/fragmentShader.glsl");
+	g_ShaderManager->use();
+
+	g_JobSystem = new JobSystem();
+	g_StateCache = new GLStateCache();
+	g_SceneManager = new SceneManager(g_ShaderManager, g_JobSystem, g_StateCache);
+	g_SceneManager->PrepareScene();
+	g_StateCache->Enable(GL_DEPTH_TEST);
+
+	std::string pattern = outputPattern;
+	bool bExr = (pattern.size() >= 4) && (pattern.compare(pattern.size() - 4, 4, ".exr") == 0);
+
+	FrameEncoder* pEncoder = new FrameEncoder();
+	FrameCapture* pCapture = new FrameCapture(pEncoder);
+	bool bCreated = pCapture->Create(width, height, bExr);
+	g_ViewManager->SetViewportSize(width, height);
+
+	int frameCount = (int)(path.GetDuration() * (float)framesPerSecond) + 1;
+	std::cout << "INFO: Flythrough: " << frameCount << " frames at " << width << "x" << height
+		<< ", " << pEncoder->GetThreadCount() << " encoder threads" << std::endl;
+
+	std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+	for (int frame = 0; (frame < frameCount) && (bCreated == true); frame++)
+	{
+		CameraPath::CAMERA_KEYFRAME camera = path.Evaluate((float)frame / (float)framesPerSecond);
+		g_ViewManager->SetCamera(camera.position, camera.front, camera.up, camera.zoom);
+		g_ViewManager->UpdateViewMatrices();
+
+		g_StateCache->BeginFrame();
+		pCapture->Begin();
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		g_SceneManager->SetViewParameters(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition(),
+			width,
+			height);
+		g_SceneManager->RenderScene();
+
+		char filePath[1024];
+		snprintf(filePath, sizeof(filePath), outputPattern, frame);
+		pCapture->End(filePath);
+
+		glfwPollEvents();
+	}
+	pCapture->Finish();
+	double renderSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+
+	pEncoder->Flush();
+	double totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+	std::cout << "INFO: Flythrough Rendered: " << (renderSeconds * 1000.0 / frameCount) << " ms per frame, "
+		<< pEncoder->GetWrittenCount() << " images written after " << totalSeconds << " s, "
+		<< pEncoder->GetFailedCount() << " failed, " << pEncoder->GetFullQueueCount()
+		<< " frames waited " << pEncoder->GetFullQueueSeconds() << " s for a full encoder queue" << std::endl;
+	bool bSuccess = (bCreated == true) && (pEncoder->GetFailedCount() == 0);
+
+	// the capture hands its last frames to the encoder, so it
+	// goes first
+	delete pCapture;
+	delete pEncoder;
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	delete g_ShaderManager;
+	g_ShaderManager = NULL;
+	delete g_StateCache;
+	g_StateCache = NULL;
+	delete g_JobSystem;
+	g_JobSystem = NULL;
+
+	glfwTerminate();
+	return(bSuccess ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *	IsFramePattern()
+ *
+ *  This function checks that an image sequence pattern has
+ *  exactly one conversion and that it takes the int frame
+ *  number, like %d or %04d, so it is safe to pass to
+ *  snprintf().  A %% is a literal percent sign.
+ ***********************************************************/
+bool IsFramePattern(const char* pattern)
+{
+	int conversionCount = 0;
+	for (const char* p = pattern; *p != '\0'; p++)
+	{
+		if (*p != '%')
+		{
+			continue;
+		}
+		p++;
+		if (*p == '%')
+		{
+			continue;
+		}
+
+		while ((*p == '0') || (*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#'))
+		{
+			p++;
+		}
+		int widthDigits = 0;
+		while ((*p >= '0') && (*p <= '9'))
+		{
+			widthDigits++;
+			p++;
+		}
+		if ((widthDigits > 2) || ((*p != 'd') && (*p != 'i')))
+		{
+			return(false);
+		}
+		conversionCount++;
+	}
+
+	return(conversionCount == 1);
+}
+
 /***********************************************************
  *	InitializeGLFW()
  *
@@ -213,64 +942,77 @@ bool InitializeGLEW()
 	return(true);
 }
 
-// Function to handle mouse movement
-static void MouseCallback(GLFWwindow* window, double xpos, double ypos) {
-	// void cursorEnterCallback( GLFWindow* window, int entered);
-	float xoffset = static_cast<float>(xpos) - lastMouseX;
-	float yoffset = lastMouseY - static_cast<float>(ypos);
+// Function to handle the application keys, the camera keys
+// are handled by the view manager
 
-	lastMouseX = xpos;
-	lastMouseY = ypos;
+void ProcessInput(GLFWwindow* window) {
+	// Toggle the depth pre-pass with the 'Z' key
+	static bool zKeyPressedLastFrame = false;
+	bool zKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_Z);
 
-	xoffset *= cameraSensitivity;
-	yoffset *= cameraSensitivity;
+	if (zKeyPressedThisFrame && !zKeyPressedLastFrame && (NULL != g_SceneManager)) {
+		g_SceneManager->SetDepthPrepass(!g_SceneManager->IsDepthPrepassEnabled());
+		std::cout << "INFO: Depth Pre-pass " << (g_SceneManager->IsDepthPrepassEnabled() ? "on" : "off") << std::endl;
+	}
 
-	yaw += xoffset;
-	pitch += yoffset;
+	zKeyPressedLastFrame = zKeyPressedThisFrame;
 
-	if (pitch > 89.0f) pitch = 89.0f;
-	if (pitch < -89.0f) pitch = -89.0f;
+	// Toggle the compute shader culling with the 'G' key
+	static bool gKeyPressedLastFrame = false;
+	bool gKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_G);
 
-	glm::vec3 front;
-	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-	front.y = sin(glm::radians(pitch));
-	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-	cameraFront = glm::normalize(front);
-}
+	if (gKeyPressedThisFrame && !gKeyPressedLastFrame && (NULL != g_SceneManager)) {
+		g_SceneManager->SetGpuCulling(!g_SceneManager->IsGpuCullingEnabled());
+		std::cout << "INFO: GPU Culling " << (g_SceneManager->IsGpuCullingEnabled() ? "on" : "off") << std::endl;
+	}
 
-// Function to handle mouse scroll
-void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-	scrollSpeed -= yoffset;
-	if (scrollSpeed < 0.1f) scrollSpeed = 0.1f;
-	cameraSpeed = scrollSpeed * 0.1f;
-}
+	gKeyPressedLastFrame = gKeyPressedThisFrame;
 
-// Function to handle keyboard and mouse input
+	// Toggle the baked lightmap with the 'L' key
+	static bool lKeyPressedLastFrame = false;
+	bool lKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_L);
 
-void ProcessInput(GLFWwindow* window) {
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
-		glfwSetWindowShouldClose(window, true);
+	if (lKeyPressedThisFrame && !lKeyPressedLastFrame && (NULL != g_SceneManager)) {
+		g_SceneManager->SetLightmaps(!g_SceneManager->IsLightmapEnabled());
+		std::cout << "INFO: Baked Lightmap " << (g_SceneManager->IsLightmapEnabled() ? "on" : "off") << std::endl;
 	}
-	// Keyboard controls
 
-	float deltaTime = 0.1f; // adjusted as needed
+	lKeyPressedLastFrame = lKeyPressedThisFrame;
 
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-		cameraPosition += cameraSpeed * cameraFront;
-	}
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-		cameraPosition -= cameraSpeed * cameraFront;
-	}
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-		cameraPosition -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-	}
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-		cameraPosition += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
+	// Toggle the static batches with the 'B' key
+	static bool bKeyPressedLastFrame = false;
+	bool bKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_B);
+
+	if (bKeyPressedThisFrame && !bKeyPressedLastFrame && (NULL != g_SceneManager)) {
+		g_SceneManager->SetStaticBatching(!g_SceneManager->IsStaticBatchingEnabled());
+		std::cout << "INFO: Static Batching " << (g_SceneManager->IsStaticBatchingEnabled() ? "on" : "off") << std::endl;
 	}
-	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-		cameraPosition -= cameraSpeed * cameraUp;
+
+	bKeyPressedLastFrame = bKeyPressedThisFrame;
+
+	// Toggle the impostors of far composite objects with the 'I' key
+	static bool iKeyPressedLastFrame = false;
+	bool iKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_I);
+
+	if (iKeyPressedThisFrame && !iKeyPressedLastFrame && (NULL != g_SceneManager)) {
+		g_SceneManager->SetImpostors(!g_SceneManager->IsImpostorEnabled());
+		std::cout << "INFO: Impostors " << (g_SceneManager->IsImpostorEnabled() ? "on" : "off") << std::endl;
 	}
-	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) {
-		cameraPosition += cameraSpeed * cameraUp;
+
+	iKeyPressedLastFrame = iKeyPressedThisFrame;
+
+	// Record the camera as a keyframe of a flythrough with the 'K' key
+	static bool kKeyPressedLastFrame = false;
+	bool kKeyPressedThisFrame = g_InputRecorder->IsKeyDown(GLFW_KEY_K);
+
+	if (kKeyPressedThisFrame && !kKeyPressedLastFrame && (NULL != g_ViewManager)) {
+		CameraPath::CAMERA_KEYFRAME keyframe;
+		g_ViewManager->GetCamera(keyframe.position, keyframe.front, keyframe.up, keyframe.zoom);
+		keyframe.time = (g_RecordedPath.GetKeyframeCount() > 0) ? g_RecordedPath.GetDuration() + KEYFRAME_INTERVAL : 0.0f;
+		g_RecordedPath.AddKeyframe(keyframe);
+		g_RecordedPath.Save(CAMERA_PATH_FILE);
+		std::cout << "INFO: Camera Keyframe " << g_RecordedPath.GetKeyframeCount() << " saved to " << CAMERA_PATH_FILE << std::endl;
 	}
+
+	kKeyPressedLastFrame = kKeyPressedThisFrame;
 }
\ No newline at end of file
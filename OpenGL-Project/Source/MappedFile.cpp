@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file into memory to read it in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mappingHandle = NULL;
+#else
+	m_fileDescriptor = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method maps the whole passed in file read-only.  An
+ *  empty file opens with no data, since an empty mapping
+ *  can not be made.
+ ***********************************************************/
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+
+#ifdef _WIN32
+	m_fileHandle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open file:" << filename << std::endl;
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(m_fileHandle, &fileSize) == FALSE)
+	{
+		std::cout << "Could not read the size of file:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+	m_size = (size_t)fileSize.QuadPart;
+
+	if (m_size > 0)
+	{
+		m_mappingHandle = CreateFileMappingA(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (NULL != m_mappingHandle)
+		{
+			m_pData = (const char*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (NULL == m_pData)
+		{
+			std::cout << "Could not map file:" << filename << std::endl;
+			Close();
+			return(false);
+		}
+	}
+#else
+	m_fileDescriptor = open(filename, O_RDONLY);
+	if (m_fileDescriptor < 0)
+	{
+		std::cout << "Could not open file:" << filename << std::endl;
+		return(false);
+	}
+
+	struct stat status;
+	if (fstat(m_fileDescriptor, &status) != 0)
+	{
+		std::cout << "Could not read the size of file:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+	m_size = (size_t)status.st_size;
+
+	if (m_size > 0)
+	{
+		void* pMapping = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+		if (pMapping == MAP_FAILED)
+		{
+			std::cout << "Could not map file:" << filename << std::endl;
+			Close();
+			return(false);
+		}
+		m_pData = (const char*)pMapping;
+		// the parsers read front to back
+		madvise(pMapping, m_size, MADV_SEQUENTIAL);
+	}
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method unmaps the file and closes its handles.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = NULL;
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (NULL != m_pData)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+		m_fileDescriptor = -1;
+	}
+#endif
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method returns whether a file is mapped.
+ ***********************************************************/
+bool MappedFile::IsOpen() const
+{
+#ifdef _WIN32
+	return(m_fileHandle != INVALID_HANDLE_VALUE);
+#else
+	return(m_fileDescriptor >= 0);
+#endif
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method returns the first byte of the mapped file.
+ ***********************************************************/
+const char* MappedFile::GetData() const
+{
+	return(m_pData);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method returns the size of the mapped file in bytes.
+ ***********************************************************/
+size_t MappedFile::GetSize() const
+{
+	return(m_size);
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file into memory to read it in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a whole file read-only into the address
+ *  space of the process.  The pages are only read from disk
+ *  when they are touched, and then straight out of the file
+ *  cache without being copied into a buffer first, so large
+ *  files can be parsed in place and by several threads at
+ *  once.  The mapping lasts until Close() or destruction.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file, closing any file mapped before
+	bool Open(const char* filename);
+	// unmap the file
+	void Close();
+
+	bool IsOpen() const;
+	const char* GetData() const;
+	size_t GetSize() const;
+
+private:
+	const char* m_pData;
+	size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+
+	// a mapping can not be shared between two owners
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
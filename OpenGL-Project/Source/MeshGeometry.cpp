@@ -0,0 +1,1149 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgeometry.cpp
+// ============
+// build the basic shapes on the CPU and pack them into shared buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const float g_Pi = 3.14159265358979f;
+
+	// uniforms of the compact vertices, set for every draw -
+	// names this long would be copied to the heap each time
+	const std::string g_PositionBoundsMinimumName = "positionBoundsMinimum";
+	const std::string g_PositionBoundsExtentName = "positionBoundsExtent";
+
+	// scoring of the vertex cache optimization, the values Tom
+	// Forsyth tuned his linear-speed optimizer with - it models
+	// a larger cache than it is measured with, which keeps it
+	// working on hardware with caches of any size
+	const int g_ScoredCacheSize = 32;
+	const float g_CacheDecayPower = 1.5f;
+	const float g_LastTriangleScore = 0.75f;
+	const float g_ValenceBoostScale = 2.0f;
+	const float g_ValenceBoostPower = 0.5f;
+
+	/***********************************************************
+	 *  MakeVertex()
+	 *
+	 *  Build a vertex from its parts.
+	 ***********************************************************/
+	MeshGeometry::VERTEX MakeVertex(glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinate)
+	{
+		MeshGeometry::VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.textureCoordinate = textureCoordinate;
+		vertex.lightmapCoordinate = glm::vec2(0.0f);
+
+		return(vertex);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  Add the two triangles of a quad given counter-clockwise.
+	 ***********************************************************/
+	void AddQuad(MeshGeometry::MESH_DATA& mesh, GLuint a, GLuint b, GLuint c, GLuint d)
+	{
+		mesh.indices.push_back(a);
+		mesh.indices.push_back(b);
+		mesh.indices.push_back(c);
+		mesh.indices.push_back(a);
+		mesh.indices.push_back(c);
+		mesh.indices.push_back(d);
+	}
+
+	/***********************************************************
+	 *  ScoreVertex()
+	 *
+	 *  Score a vertex by its place in the modeled cache and the
+	 *  number of triangles still to be drawn with it.  Vertices
+	 *  with few triangles left score higher, so they are used
+	 *  up instead of leaving lone triangles behind.
+	 ***********************************************************/
+	float ScoreVertex(int cachePosition, int remainingTriangles)
+	{
+		if (remainingTriangles <= 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			// the last triangle's vertices get a fixed score, so
+			// the order does not favor one of its edges
+			if (cachePosition < 3)
+			{
+				score = g_LastTriangleScore;
+			}
+			else
+			{
+				float scale = 1.0f / (float)(g_ScoredCacheSize - 3);
+				score = pow(1.0f - ((float)(cachePosition - 3) * scale), g_CacheDecayPower);
+			}
+		}
+		score += g_ValenceBoostScale * pow((float)remainingTriangles, -g_ValenceBoostPower);
+
+		return(score);
+	}
+}
+
+/***********************************************************
+ *  MeshGeometry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshGeometry::MeshGeometry()
+{
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+	m_positionMinimum = glm::vec3(0.0f);
+	m_positionExtent = glm::vec3(1.0f);
+	m_vertexArray = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+}
+
+/***********************************************************
+ *  ~MeshGeometry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshGeometry::~MeshGeometry()
+{
+	if (m_vertexArray != 0)
+	{
+		glDeleteVertexArrays(1, &m_vertexArray);
+		glDeleteBuffers(1, &m_vertexBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+}
+
+/***********************************************************
+ *  BuildPlane()
+ *
+ *  This method builds a plane from -1 to 1 on the X and Z
+ *  axes, facing up.
+ ***********************************************************/
+void MeshGeometry::BuildPlane(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	glm::vec3 up(0.0f, 1.0f, 0.0f);
+	mesh.vertices.push_back(MakeVertex(glm::vec3(-1.0f, 0.0f, 1.0f), up, glm::vec2(0.0f, 0.0f)));
+	mesh.vertices.push_back(MakeVertex(glm::vec3(1.0f, 0.0f, 1.0f), up, glm::vec2(1.0f, 0.0f)));
+	mesh.vertices.push_back(MakeVertex(glm::vec3(1.0f, 0.0f, -1.0f), up, glm::vec2(1.0f, 1.0f)));
+	mesh.vertices.push_back(MakeVertex(glm::vec3(-1.0f, 0.0f, -1.0f), up, glm::vec2(0.0f, 1.0f)));
+
+	AddQuad(mesh, 0, 1, 2, 3);
+}
+
+/***********************************************************
+ *  BuildBox()
+ *
+ *  This method builds a box from -0.5 to 0.5 on every axis,
+ *  with its own vertices per face for flat normals.
+ ***********************************************************/
+void MeshGeometry::BuildBox(MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	// normal, then the two axes spanning the face
+	const glm::vec3 faces[6][3] =
+	{
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec3 normal = faces[face][0];
+		glm::vec3 right = faces[face][1];
+		glm::vec3 up = faces[face][2];
+		GLuint first = (GLuint)mesh.vertices.size();
+
+		mesh.vertices.push_back(MakeVertex((normal - right - up) * 0.5f, normal, glm::vec2(0.0f, 0.0f)));
+		mesh.vertices.push_back(MakeVertex((normal + right - up) * 0.5f, normal, glm::vec2(1.0f, 0.0f)));
+		mesh.vertices.push_back(MakeVertex((normal + right + up) * 0.5f, normal, glm::vec2(1.0f, 1.0f)));
+		mesh.vertices.push_back(MakeVertex((normal - right + up) * 0.5f, normal, glm::vec2(0.0f, 1.0f)));
+
+		AddQuad(mesh, first, first + 1, first + 2, first + 3);
+	}
+}
+
+/***********************************************************
+ *  AddLathe()
+ *
+ *  This method adds the side of a shape of revolution from
+ *  height 0 to 1, with the radius changing linearly.  The
+ *  seam has doubled vertices so the texture wraps once.
+ ***********************************************************/
+void MeshGeometry::AddLathe(MESH_DATA& mesh, int slices, float bottomRadius, float topRadius)
+{
+	GLuint first = (GLuint)mesh.vertices.size();
+
+	// the side normal leans by the slope of the radius
+	float slope = bottomRadius - topRadius;
+
+	for (int i = 0; i <= slices; i++)
+	{
+		float u = (float)i / (float)slices;
+		float angle = u * 2.0f * g_Pi;
+		glm::vec3 direction(cos(angle), 0.0f, -sin(angle));
+		glm::vec3 normal = glm::normalize(direction + glm::vec3(0.0f, slope, 0.0f));
+
+		mesh.vertices.push_back(MakeVertex(direction * bottomRadius, normal, glm::vec2(u, 0.0f)));
+		mesh.vertices.push_back(MakeVertex(direction * topRadius + glm::vec3(0.0f, 1.0f, 0.0f), normal, glm::vec2(u, 1.0f)));
+	}
+
+	for (int i = 0; i < slices; i++)
+	{
+		GLuint bottom = first + (i * 2);
+		AddQuad(mesh, bottom, bottom + 2, bottom + 3, bottom + 1);
+	}
+}
+
+/***********************************************************
+ *  AddDisc()
+ *
+ *  This method adds a flat cap at the passed in height.
+ ***********************************************************/
+void MeshGeometry::AddDisc(MESH_DATA& mesh, int slices, float radius, float height, bool bFacingUp)
+{
+	GLuint center = (GLuint)mesh.vertices.size();
+	glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+
+	mesh.vertices.push_back(MakeVertex(glm::vec3(0.0f, height, 0.0f), normal, glm::vec2(0.5f, 0.5f)));
+	for (int i = 0; i <= slices; i++)
+	{
+		float angle = ((float)i / (float)slices) * 2.0f * g_Pi;
+		glm::vec3 direction(cos(angle), 0.0f, -sin(angle));
+
+		mesh.vertices.push_back(MakeVertex(
+			direction * radius + glm::vec3(0.0f, height, 0.0f),
+			normal,
+			glm::vec2(0.5f + direction.x * 0.5f, 0.5f - direction.z * 0.5f)));
+	}
+
+	for (int i = 0; i < slices; i++)
+	{
+		GLuint a = center + 1 + i;
+		GLuint b = a + 1;
+
+		mesh.indices.push_back(center);
+		if (bFacingUp == true)
+		{
+			mesh.indices.push_back(a);
+			mesh.indices.push_back(b);
+		}
+		else
+		{
+			mesh.indices.push_back(b);
+			mesh.indices.push_back(a);
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildCylinder()
+ *
+ *  This method builds a closed cylinder of radius 1 from
+ *  height 0 to 1.
+ ***********************************************************/
+void MeshGeometry::BuildCylinder(MESH_DATA& mesh, int slices)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	AddLathe(mesh, slices, 1.0f, 1.0f);
+	AddDisc(mesh, slices, 1.0f, 0.0f, false);
+	AddDisc(mesh, slices, 1.0f, 1.0f, true);
+}
+
+/***********************************************************
+ *  BuildCone()
+ *
+ *  This method builds a cone with a base of radius 1 at
+ *  height 0 and its tip at height 1.
+ ***********************************************************/
+void MeshGeometry::BuildCone(MESH_DATA& mesh, int slices)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	AddLathe(mesh, slices, 1.0f, 0.0f);
+	AddDisc(mesh, slices, 1.0f, 0.0f, false);
+}
+
+/***********************************************************
+ *  BuildTaperedCylinder()
+ *
+ *  This method builds a closed cylinder of radius 1 at the
+ *  bottom narrowing to the passed in radius at height 1.
+ ***********************************************************/
+void MeshGeometry::BuildTaperedCylinder(MESH_DATA& mesh, int slices, float topRadius)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	AddLathe(mesh, slices, 1.0f, topRadius);
+	AddDisc(mesh, slices, 1.0f, 0.0f, false);
+	AddDisc(mesh, slices, topRadius, 1.0f, true);
+}
+
+/***********************************************************
+ *  BuildSphere()
+ *
+ *  This method builds a sphere of radius 1 around the origin.
+ ***********************************************************/
+void MeshGeometry::BuildSphere(MESH_DATA& mesh, int slices, int stacks)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float v = (float)stack / (float)stacks;
+		float polar = v * g_Pi;
+
+		for (int slice = 0; slice <= slices; slice++)
+		{
+			float u = (float)slice / (float)slices;
+			float azimuth = u * 2.0f * g_Pi;
+
+			glm::vec3 normal(
+				sin(polar) * cos(azimuth),
+				-cos(polar),
+				-sin(polar) * sin(azimuth));
+
+			mesh.vertices.push_back(MakeVertex(normal, normal, glm::vec2(u, v)));
+		}
+	}
+
+	GLuint rowLength = (GLuint)slices + 1;
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int slice = 0; slice < slices; slice++)
+		{
+			GLuint a = (stack * rowLength) + slice;
+			AddQuad(mesh, a, a + 1, a + 1 + rowLength, a + rowLength);
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildTorus()
+ *
+ *  This method builds a torus lying in the XY plane around
+ *  the origin.
+ ***********************************************************/
+void MeshGeometry::BuildTorus(MESH_DATA& mesh, int rings, int sides, float mainRadius, float tubeRadius)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	for (int ring = 0; ring <= rings; ring++)
+	{
+		float u = (float)ring / (float)rings;
+		float ringAngle = u * 2.0f * g_Pi;
+		glm::vec3 ringDirection(cos(ringAngle), sin(ringAngle), 0.0f);
+
+		for (int side = 0; side <= sides; side++)
+		{
+			float v = (float)side / (float)sides;
+			float sideAngle = v * 2.0f * g_Pi;
+			glm::vec3 normal = ringDirection * cos(sideAngle) + glm::vec3(0.0f, 0.0f, sin(sideAngle));
+
+			mesh.vertices.push_back(MakeVertex(
+				ringDirection * mainRadius + normal * tubeRadius,
+				normal,
+				glm::vec2(u, v)));
+		}
+	}
+
+	GLuint rowLength = (GLuint)sides + 1;
+	for (int ring = 0; ring < rings; ring++)
+	{
+		for (int side = 0; side < sides; side++)
+		{
+			GLuint a = (ring * rowLength) + side;
+			AddQuad(mesh, a, a + rowLength, a + rowLength + 1, a + 1);
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeBounds()
+ *
+ *  This method finds the bounding box of a mesh's vertices.
+ ***********************************************************/
+void MeshGeometry::ComputeBounds(const MESH_DATA& mesh, glm::vec3& minimum, glm::vec3& maximum)
+{
+	minimum = glm::vec3(0.0f);
+	maximum = glm::vec3(0.0f);
+
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		if (i == 0)
+		{
+			minimum = mesh.vertices[i].position;
+			maximum = mesh.vertices[i].position;
+		}
+		else
+		{
+			minimum = glm::min(minimum, mesh.vertices[i].position);
+			maximum = glm::max(maximum, mesh.vertices[i].position);
+		}
+	}
+}
+
+/***********************************************************
+ *  AppendTransformed()
+ *
+ *  This method appends the vertices of a mesh with the model
+ *  matrix applied, the normals through its inverse transpose
+ *  so they stay correct under uneven scales.  A mirroring
+ *  matrix turns the triangles inside out, so their winding
+ *  is reversed to keep them facing the same way.
+ ***********************************************************/
+void MeshGeometry::AppendTransformed(MESH_DATA& destination, const MESH_DATA& source, const glm::mat4& model)
+{
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+	bool bMirrored = glm::determinant(glm::mat3(model)) < 0.0f;
+	GLuint baseVertex = (GLuint)destination.vertices.size();
+
+	for (size_t i = 0; i < source.vertices.size(); i++)
+	{
+		VERTEX vertex = source.vertices[i];
+		vertex.position = glm::vec3(model * glm::vec4(vertex.position, 1.0f));
+		vertex.normal = glm::normalize(normalMatrix * vertex.normal);
+		destination.vertices.push_back(vertex);
+	}
+
+	for (size_t i = 0; i + 2 < source.indices.size(); i += 3)
+	{
+		destination.indices.push_back(baseVertex + source.indices[i]);
+		if (bMirrored == true)
+		{
+			destination.indices.push_back(baseVertex + source.indices[i + 2]);
+			destination.indices.push_back(baseVertex + source.indices[i + 1]);
+		}
+		else
+		{
+			destination.indices.push_back(baseVertex + source.indices[i + 1]);
+			destination.indices.push_back(baseVertex + source.indices[i + 2]);
+		}
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method reorders the triangles of a mesh with Tom
+ *  Forsyth's linear-speed vertex cache optimization.  Every
+ *  vertex is scored by how recently it was used and how many
+ *  triangles it still has, and the next triangle drawn is
+ *  the one with the best sum among those touching the cache,
+ *  so the order grows like a patch instead of running down
+ *  long rings that have left the cache by the time the next
+ *  ring comes back to them.
+ ***********************************************************/
+void MeshGeometry::OptimizeVertexCache(MESH_DATA& mesh)
+{
+	int triangleCount = (int)mesh.indices.size() / 3;
+	int vertexCount = (int)mesh.vertices.size();
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	// triangles of every vertex, one list after the other, with
+	// the triangles already drawn moved past the end of a list
+	std::vector<int> remaining(vertexCount, 0);
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		remaining[mesh.indices[i]]++;
+	}
+	std::vector<int> firstTriangle(vertexCount + 1, 0);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+	}
+	std::vector<int> vertexTriangles(triangleCount * 3);
+	std::vector<int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		vertexTriangles[fill[mesh.indices[i]]++] = i / 3;
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (int v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = ScoreVertex(-1, remaining[v]);
+	}
+	std::vector<float> triangleScores(triangleCount);
+	for (int t = 0; t < triangleCount; t++)
+	{
+		triangleScores[t] = vertexScores[mesh.indices[t * 3]]
+			+ vertexScores[mesh.indices[t * 3 + 1]]
+			+ vertexScores[mesh.indices[t * 3 + 2]];
+	}
+
+	std::vector<bool> drawn(triangleCount, false);
+	std::vector<GLuint> optimized;
+	optimized.reserve(mesh.indices.size());
+	// modeled cache, the most recently used vertex first
+	std::vector<GLuint> cache;
+	std::vector<GLuint> nextCache;
+	int nextUndrawn = 0;
+	int best = -1;
+
+	while ((int)optimized.size() < triangleCount * 3)
+	{
+		// nothing in the cache has triangles left, so start again
+		// at the first triangle that was not drawn yet
+		if (best < 0)
+		{
+			while (drawn[nextUndrawn] == true)
+			{
+				nextUndrawn++;
+			}
+			best = nextUndrawn;
+		}
+
+		drawn[best] = true;
+		nextCache.clear();
+		for (int c = 0; c < 3; c++)
+		{
+			GLuint vertex = mesh.indices[best * 3 + c];
+			optimized.push_back(vertex);
+			nextCache.push_back(vertex);
+
+			// take the triangle out of the vertex's live list
+			int first = firstTriangle[vertex];
+			int last = first + remaining[vertex] - 1;
+			for (int i = first; i <= last; i++)
+			{
+				if (vertexTriangles[i] == best)
+				{
+					std::swap(vertexTriangles[i], vertexTriangles[last]);
+					break;
+				}
+			}
+			remaining[vertex]--;
+		}
+
+		// the drawn triangle's vertices move to the front of the
+		// cache, the rest keep their order behind them
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			if (std::find(nextCache.begin(), nextCache.begin() + 3, cache[i]) == nextCache.begin() + 3)
+			{
+				nextCache.push_back(cache[i]);
+			}
+		}
+
+		// rescore the vertices whose place changed, including the
+		// ones pushed out of the cache, and pass the change on
+		// to their triangles
+		for (int i = 0; i < (int)nextCache.size(); i++)
+		{
+			GLuint vertex = nextCache[i];
+			float score = ScoreVertex((i < g_ScoredCacheSize) ? i : -1, remaining[vertex]);
+			float change = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+			for (int j = 0; j < remaining[vertex]; j++)
+			{
+				triangleScores[vertexTriangles[firstTriangle[vertex] + j]] += change;
+			}
+		}
+		if ((int)nextCache.size() > g_ScoredCacheSize)
+		{
+			nextCache.resize(g_ScoredCacheSize);
+		}
+		cache.swap(nextCache);
+
+		// the next triangle is the best one touching the cache
+		best = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			GLuint vertex = cache[i];
+			for (int j = 0; j < remaining[vertex]; j++)
+			{
+				int triangle = vertexTriangles[firstTriangle[vertex] + j];
+				if (triangleScores[triangle] > bestScore)
+				{
+					bestScore = triangleScores[triangle];
+					best = triangle;
+				}
+			}
+		}
+	}
+
+	mesh.indices.swap(optimized);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method cuts the cache optimized triangles into
+ *  clusters and draws the clusters facing most outwards
+ *  first, since they tend to hide the others and the depth
+ *  test then rejects more of the hidden fragments before
+ *  they are shaded.  A cluster ends where the cache order
+ *  starts over anyway, or as soon as its own misses, counted
+ *  from an empty cache, stay within the threshold times the
+ *  ratio of the whole mesh, so any order of the clusters
+ *  keeps the cache miss ratio within the threshold.
+ ***********************************************************/
+void MeshGeometry::OptimizeOverdraw(MESH_DATA& mesh, float threshold)
+{
+	int triangleCount = (int)mesh.indices.size() / 3;
+	if (triangleCount < 2)
+	{
+		return;
+	}
+
+	float targetRatio = ComputeACMR(mesh, VERTEX_CACHE_SIZE) * threshold;
+
+	// a vertex is in the first-in first-out cache while fewer
+	// than a cache size of vertices were shaded after it
+	std::vector<unsigned int> shadedAt(mesh.vertices.size(), 0);
+	unsigned int time = VERTEX_CACHE_SIZE + 1;
+
+	std::vector<int> clusterStarts;
+	int clusterStart = 0;
+	int clusterMisses = 0;
+	for (int t = 0; t < triangleCount; t++)
+	{
+		int misses = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			GLuint vertex = mesh.indices[t * 3 + c];
+			if (time - shadedAt[vertex] > (unsigned int)VERTEX_CACHE_SIZE)
+			{
+				shadedAt[vertex] = time++;
+				misses++;
+			}
+		}
+
+		// all three vertices missed, the order starts over here
+		if ((misses == 3) && (t > clusterStart))
+		{
+			clusterStarts.push_back(clusterStart);
+			clusterStart = t;
+			clusterMisses = 0;
+		}
+		clusterMisses += misses;
+
+		if (((float)clusterMisses / (float)(t - clusterStart + 1) <= targetRatio) && (t + 1 < triangleCount))
+		{
+			clusterStarts.push_back(clusterStart);
+			clusterStart = t + 1;
+			clusterMisses = 0;
+			// the next cluster is measured from an empty cache
+			time += VERTEX_CACHE_SIZE + 1;
+		}
+	}
+	clusterStarts.push_back(clusterStart);
+	clusterStarts.push_back(triangleCount);
+
+	// area weighted center and normal of every cluster and the
+	// center of the whole mesh
+	int clusterCount = (int)clusterStarts.size() - 1;
+	std::vector<glm::vec3> clusterCenters(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> clusterAreas(clusterCount, 0.0f);
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	for (int cluster = 0; cluster < clusterCount; cluster++)
+	{
+		for (int t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++)
+		{
+			const glm::vec3& p0 = mesh.vertices[mesh.indices[t * 3]].position;
+			const glm::vec3& p1 = mesh.vertices[mesh.indices[t * 3 + 1]].position;
+			const glm::vec3& p2 = mesh.vertices[mesh.indices[t * 3 + 2]].position;
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			glm::vec3 center = (p0 + p1 + p2) / 3.0f;
+
+			clusterCenters[cluster] += center * area;
+			clusterNormals[cluster] += normal;
+			clusterAreas[cluster] += area;
+			meshCenter += center * area;
+			meshArea += area;
+		}
+	}
+	if (meshArea > 0.0f)
+	{
+		meshCenter /= meshArea;
+	}
+
+	// how far out of the mesh center a cluster faces
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	std::vector<int> order(clusterCount);
+	for (int cluster = 0; cluster < clusterCount; cluster++)
+	{
+		order[cluster] = cluster;
+		float normalLength = glm::length(clusterNormals[cluster]);
+		if ((clusterAreas[cluster] > 0.0f) && (normalLength > 0.0f))
+		{
+			glm::vec3 center = clusterCenters[cluster] / clusterAreas[cluster];
+			sortKeys[cluster] = glm::dot(center - meshCenter, clusterNormals[cluster] / normalLength);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](int a, int b)
+		{
+			return(sortKeys[a] > sortKeys[b]);
+		});
+
+	std::vector<GLuint> sorted;
+	sorted.reserve(mesh.indices.size());
+	for (int i = 0; i < clusterCount; i++)
+	{
+		int cluster = order[i];
+		sorted.insert(sorted.end(),
+			mesh.indices.begin() + (clusterStarts[cluster] * 3),
+			mesh.indices.begin() + (clusterStarts[cluster + 1] * 3));
+	}
+	mesh.indices.swap(sorted);
+}
+
+/***********************************************************
+ *  ComputeACMR()
+ *
+ *  This method simulates a first-in first-out cache of the
+ *  passed in size over the triangles of a mesh and returns
+ *  the average number of vertices shaded per triangle, from
+ *  3 with no reuse down to about 0.5 on a regular grid.
+ ***********************************************************/
+float MeshGeometry::ComputeACMR(const MESH_DATA& mesh, int cacheSize)
+{
+	int triangleCount = (int)mesh.indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return(0.0f);
+	}
+
+	std::vector<unsigned int> shadedAt(mesh.vertices.size(), 0);
+	unsigned int time = (unsigned int)cacheSize + 1;
+	int misses = 0;
+	for (int i = 0; i < triangleCount * 3; i++)
+	{
+		GLuint vertex = mesh.indices[i];
+		if (time - shadedAt[vertex] > (unsigned int)cacheSize)
+		{
+			shadedAt[vertex] = time++;
+			misses++;
+		}
+	}
+
+	return((float)misses / (float)triangleCount);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method appends a mesh to the shared buffers and
+ *  returns the index it can be drawn with.  The indices stay
+ *  relative to the mesh, the base vertex offsets them.
+ ***********************************************************/
+int MeshGeometry::AddMesh(const MESH_DATA& mesh)
+{
+	MESH_RANGE range;
+	range.firstIndex = m_indexCount;
+	range.indexCount = (GLuint)mesh.indices.size();
+	range.baseVertex = (GLint)m_vertexCount;
+	range.vertexCount = (GLuint)mesh.vertices.size();
+	ComputeBounds(mesh, range.boundsMinimum, range.boundsMaximum);
+
+	m_meshData.push_back(mesh);
+	m_meshes.push_back(range);
+	m_vertexCount += range.vertexCount;
+	m_indexCount += range.indexCount;
+
+	return((int)m_meshes.size() - 1);
+}
+
+/***********************************************************
+ *  EncodeOctahedral()
+ *
+ *  This method folds a unit normal onto the octahedron with
+ *  corners on the axes and flattens it to two values from -1
+ *  to 1, the lower half unfolded over the corners of the
+ *  square.  The error stays evenly small in all directions,
+ *  unlike storing two of the components.
+ ***********************************************************/
+glm::vec2 MeshGeometry::EncodeOctahedral(const glm::vec3& normal)
+{
+	float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (length <= 0.0f)
+	{
+		return(glm::vec2(0.0f));
+	}
+
+	glm::vec3 folded = normal / length;
+	glm::vec2 encoded = glm::vec2(folded.x, folded.y);
+	if (folded.z < 0.0f)
+	{
+		encoded.x = (1.0f - std::fabs(folded.y)) * ((folded.x >= 0.0f) ? 1.0f : -1.0f);
+		encoded.y = (1.0f - std::fabs(folded.x)) * ((folded.y >= 0.0f) ? 1.0f : -1.0f);
+	}
+
+	return(encoded);
+}
+
+/***********************************************************
+ *  EncodeHalfFloat()
+ *
+ *  This method converts a float to the bits of a half float,
+ *  rounded to nearest, with the values too large for a half
+ *  turned into infinity and the values too small into zero
+ *  or a denormal.
+ ***********************************************************/
+GLushort MeshGeometry::EncodeHalfFloat(float value)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t floatExponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	int exponent = (int)floatExponent - 127 + 15;
+
+	if (floatExponent == 0xFF)
+	{
+		return((GLushort)(sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0)));
+	}
+	if (exponent >= 31)
+	{
+		return((GLushort)(sign | 0x7C00));
+	}
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return((GLushort)sign);
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		if (((mantissa >> (shift - 1)) & 1) != 0)
+		{
+			half++;
+		}
+		return((GLushort)(sign | half));
+	}
+
+	// a carry out of the mantissa rounds up into the exponent
+	uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+	if ((mantissa & 0x1000) != 0)
+	{
+		half++;
+	}
+
+	return((GLushort)(sign | half));
+}
+
+/***********************************************************
+ *  SetFloatVertexUniforms()
+ *
+ *  This method turns the decoding of the vertex shaders off
+ *  for meshes with float vertices that are not drawn from a
+ *  MeshGeometry, such as the basic shape meshes.
+ ***********************************************************/
+void MeshGeometry::SetFloatVertexUniforms(const ShaderManager* pShader)
+{
+	pShader->setBoolValue("bCompactVertices", false);
+}
+
+/***********************************************************
+ *  SetVertexFormat()
+ *
+ *  This method picks the layout of the vertex buffer, which
+ *  takes effect with the next Upload().
+ ***********************************************************/
+void MeshGeometry::SetVertexFormat(VERTEX_FORMAT format)
+{
+	m_vertexFormat = format;
+}
+
+/***********************************************************
+ *  GetVertexFormat()
+ *
+ *  This method returns the layout of the vertex buffer.
+ ***********************************************************/
+MeshGeometry::VERTEX_FORMAT MeshGeometry::GetVertexFormat() const
+{
+	return(m_vertexFormat);
+}
+
+/***********************************************************
+ *  BuildCompactVertices()
+ *
+ *  This method finds the bounds of all the vertices, which
+ *  the compact positions are fractions of, and packs every
+ *  vertex into the compact format.
+ ***********************************************************/
+void MeshGeometry::BuildCompactVertices(const std::vector<VERTEX>& vertices, std::vector<COMPACT_VERTEX>& compactVertices)
+{
+	glm::vec3 minimum = glm::vec3(0.0f);
+	glm::vec3 maximum = glm::vec3(0.0f);
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		minimum = (i == 0) ? vertices[i].position : glm::min(minimum, vertices[i].position);
+		maximum = (i == 0) ? vertices[i].position : glm::max(maximum, vertices[i].position);
+	}
+	m_positionMinimum = minimum;
+	m_positionExtent = maximum - minimum;
+
+	// a flat axis, such as the height of the plane, decodes to
+	// the minimum whatever is stored
+	glm::vec3 scale = glm::vec3(0.0f);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (m_positionExtent[axis] > 0.0f)
+		{
+			scale[axis] = 65535.0f / m_positionExtent[axis];
+		}
+	}
+
+	compactVertices.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const VERTEX& vertex = vertices[i];
+		COMPACT_VERTEX& compact = compactVertices[i];
+
+		glm::vec3 position = glm::clamp((vertex.position - minimum) * scale + 0.5f, 0.0f, 65535.0f);
+		compact.position[0] = (GLushort)position.x;
+		compact.position[1] = (GLushort)position.y;
+		compact.position[2] = (GLushort)position.z;
+		compact.position[3] = 0;
+
+		glm::vec2 normal = EncodeOctahedral(vertex.normal);
+		compact.normal[0] = (GLshort)std::floor(glm::clamp(normal.x, -1.0f, 1.0f) * 32767.0f + 0.5f);
+		compact.normal[1] = (GLshort)std::floor(glm::clamp(normal.y, -1.0f, 1.0f) * 32767.0f + 0.5f);
+
+		compact.textureCoordinate[0] = EncodeHalfFloat(vertex.textureCoordinate.x);
+		compact.textureCoordinate[1] = EncodeHalfFloat(vertex.textureCoordinate.y);
+
+		glm::vec2 lightmap = glm::clamp(vertex.lightmapCoordinate, 0.0f, 1.0f);
+		compact.lightmapCoordinate[0] = (GLushort)(lightmap.x * 65535.0f + 0.5f);
+		compact.lightmapCoordinate[1] = (GLushort)(lightmap.y * 65535.0f + 0.5f);
+	}
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method copies all the added meshes into one vertex
+ *  and one index buffer and sets up the vertex array with
+ *  the position, normal, texture and lightmap coordinate
+ *  attributes, in the float or the compact format.  The
+ *  compact attributes are normalized by the vertex fetch,
+ *  so the shaders read fractions and decode them.
+ ***********************************************************/
+bool MeshGeometry::Upload(GLStateCache* pStateCache)
+{
+	if (m_meshes.empty())
+	{
+		return(false);
+	}
+
+	std::vector<VERTEX> vertices;
+	std::vector<GLuint> indices;
+	vertices.reserve(m_vertexCount);
+	indices.reserve(m_indexCount);
+
+	for (size_t i = 0; i < m_meshData.size(); i++)
+	{
+		vertices.insert(vertices.end(), m_meshData[i].vertices.begin(), m_meshData[i].vertices.end());
+		indices.insert(indices.end(), m_meshData[i].indices.begin(), m_meshData[i].indices.end());
+	}
+
+	if (m_vertexArray == 0)
+	{
+		glGenVertexArrays(1, &m_vertexArray);
+		glGenBuffers(1, &m_vertexBuffer);
+		glGenBuffers(1, &m_indexBuffer);
+	}
+
+	pStateCache->BindVertexArray(m_vertexArray);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glEnableVertexAttribArray(4);
+
+	if (m_vertexFormat == VERTEX_FORMAT_COMPACT)
+	{
+		std::vector<COMPACT_VERTEX> compactVertices;
+		BuildCompactVertices(vertices, compactVertices);
+		glBufferData(GL_ARRAY_BUFFER, compactVertices.size() * sizeof(COMPACT_VERTEX), compactVertices.data(), GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(COMPACT_VERTEX), (void*)offsetof(COMPACT_VERTEX, position));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(COMPACT_VERTEX), (void*)offsetof(COMPACT_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(COMPACT_VERTEX), (void*)offsetof(COMPACT_VERTEX, textureCoordinate));
+		glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(COMPACT_VERTEX), (void*)offsetof(COMPACT_VERTEX, lightmapCoordinate));
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(VERTEX), vertices.data(), GL_STATIC_DRAW);
+
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, textureCoordinate));
+		glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, lightmapCoordinate));
+	}
+
+	pStateCache->BindVertexArray(0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetVertexUniforms()
+ *
+ *  This method tells the vertex shader of the current program
+ *  whether the buffers are compact, and the bounds that turn
+ *  the stored fractions back into positions.
+ ***********************************************************/
+void MeshGeometry::SetVertexUniforms(const ShaderManager* pShader) const
+{
+	if (m_vertexFormat == VERTEX_FORMAT_COMPACT)
+	{
+		pShader->setBoolValue("bCompactVertices", true);
+		pShader->setVec3Value(g_PositionBoundsMinimumName, m_positionMinimum);
+		pShader->setVec3Value(g_PositionBoundsExtentName, m_positionExtent);
+	}
+	else
+	{
+		pShader->setBoolValue("bCompactVertices", false);
+	}
+}
+
+/***********************************************************
+ *  GetVertexBufferBytes()
+ *
+ *  This method returns the size of the vertex buffer in the
+ *  format it is uploaded in.
+ ***********************************************************/
+size_t MeshGeometry::GetVertexBufferBytes() const
+{
+	size_t vertexSize = (m_vertexFormat == VERTEX_FORMAT_COMPACT) ? sizeof(COMPACT_VERTEX) : sizeof(VERTEX);
+	return(m_vertexCount * vertexSize);
+}
+
+/***********************************************************
+ *  GetFloatVertexBytes()
+ *
+ *  This method returns the size the vertex buffer has with
+ *  float vertices, to compare the compact format against.
+ ***********************************************************/
+size_t MeshGeometry::GetFloatVertexBytes() const
+{
+	return(m_vertexCount * sizeof(VERTEX));
+}
+
+/***********************************************************
+ *  GetMeshCount()
+ *
+ *  This method returns the number of added meshes.
+ ***********************************************************/
+int MeshGeometry::GetMeshCount() const
+{
+	return((int)m_meshes.size());
+}
+
+/***********************************************************
+ *  GetMesh()
+ *
+ *  This method returns where a mesh lives in the buffers.
+ ***********************************************************/
+const MeshGeometry::MESH_RANGE& MeshGeometry::GetMesh(int meshIndex) const
+{
+	return(m_meshes[meshIndex]);
+}
+
+/***********************************************************
+ *  GetMeshData()
+ *
+ *  This method returns the CPU copy of a mesh.
+ ***********************************************************/
+const MeshGeometry::MESH_DATA& MeshGeometry::GetMeshData(int meshIndex) const
+{
+	return(m_meshData[meshIndex]);
+}
+
+/***********************************************************
+ *  GetVertexArray()
+ *
+ *  This method returns the vertex array of all the meshes.
+ ***********************************************************/
+GLuint MeshGeometry::GetVertexArray() const
+{
+	return(m_vertexArray);
+}
+
+/***********************************************************
+ *  GetVertexBuffer()
+ *
+ *  This method returns the shared vertex buffer.
+ ***********************************************************/
+GLuint MeshGeometry::GetVertexBuffer() const
+{
+	return(m_vertexBuffer);
+}
+
+/***********************************************************
+ *  GetIndexBuffer()
+ *
+ *  This method returns the shared index buffer.
+ ***********************************************************/
+GLuint MeshGeometry::GetIndexBuffer() const
+{
+	return(m_indexBuffer);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method draws a single mesh from the shared buffers.
+ ***********************************************************/
+void MeshGeometry::Draw(int meshIndex) const
+{
+	const MESH_RANGE& range = m_meshes[meshIndex];
+
+	glDrawElementsBaseVertex(
+		GL_TRIANGLES,
+		range.indexCount,
+		GL_UNSIGNED_INT,
+		(void*)(range.firstIndex * sizeof(GLuint)),
+		range.baseVertex);
+}
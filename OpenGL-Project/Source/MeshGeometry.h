@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgeometry.h
+// ============
+// build the basic shapes on the CPU and pack them into shared buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLStateCache.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  MeshGeometry
+ *
+ *  This class generates the basic shapes - plane, box,
+ *  cylinder, cone, sphere, tapered cylinder and torus - as
+ *  indexed triangle lists with positions, normals and
+ *  texture coordinates, in the same unit sizes the scene
+ *  places the ShapeMeshes shapes with.  All the meshes added
+ *  to one object share a single vertex and index buffer, so
+ *  any of them can be drawn from one vertex array, which is
+ *  what multi-draw and batching need.  The buffers can hold
+ *  the full float vertices or a compact format of half the
+ *  size, which the vertex shaders decode.  The CPU copies
+ *  always keep the floats.  The triangles can be reordered
+ *  to reuse the post-transform vertex cache and to draw the
+ *  outward facing ones first.
+ ***********************************************************/
+class MeshGeometry
+{
+public:
+	// interleaved vertex, matches the attribute locations 0 to 2
+	// and 4 of vertexShader.glsl
+	struct VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 textureCoordinate;
+		// unique coordinate into a lightmap atlas, only set on
+		// meshes unwrapped by LightmapBaker
+		glm::vec2 lightmapCoordinate;
+	};
+
+	// layouts the vertex buffer can be uploaded in
+	enum VERTEX_FORMAT
+	{
+		// the VERTEX struct as it is, 40 bytes
+		VERTEX_FORMAT_FLOAT,
+		// COMPACT_VERTEX, 20 bytes
+		VERTEX_FORMAT_COMPACT
+	};
+
+	// compact vertex - position as 16-bit fractions of the
+	// bounds of all the meshes, the normal folded onto an
+	// octahedron in two 16-bit values, the texture coordinate
+	// in half floats and the lightmap coordinate, which is
+	// always inside the atlas, in 16-bit fractions
+	struct COMPACT_VERTEX
+	{
+		// the fourth value pads the position to four bytes
+		GLushort position[4];
+		GLshort normal[2];
+		GLushort textureCoordinate[2];
+		GLushort lightmapCoordinate[2];
+	};
+
+	// vertices and triangle indices of one mesh on the CPU
+	struct MESH_DATA
+	{
+		std::vector<VERTEX> vertices;
+		std::vector<GLuint> indices;
+	};
+
+	// where a mesh lives in the shared buffers
+	struct MESH_RANGE
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+		GLuint vertexCount;
+		glm::vec3 boundsMinimum;
+		glm::vec3 boundsMaximum;
+	};
+
+	// generators for the basic shapes
+	static void BuildPlane(MESH_DATA& mesh);
+	static void BuildBox(MESH_DATA& mesh);
+	static void BuildCylinder(MESH_DATA& mesh, int slices);
+	static void BuildCone(MESH_DATA& mesh, int slices);
+	static void BuildSphere(MESH_DATA& mesh, int slices, int stacks);
+	static void BuildTaperedCylinder(MESH_DATA& mesh, int slices, float topRadius);
+	static void BuildTorus(MESH_DATA& mesh, int rings, int sides, float mainRadius, float tubeRadius);
+
+	// bounding box of the vertices of a mesh
+	static void ComputeBounds(const MESH_DATA& mesh, glm::vec3& minimum, glm::vec3& maximum);
+	// add a mesh moved into world space by a model matrix to the
+	// end of another mesh
+	static void AppendTransformed(MESH_DATA& destination, const MESH_DATA& source, const glm::mat4& model);
+
+	// vertices of the post-transform cache the meshes are
+	// ordered for and measured against
+	static const int VERTEX_CACHE_SIZE = 16;
+	// reorder the triangles so their vertices are reused while
+	// they are still in the post-transform cache
+	static void OptimizeVertexCache(MESH_DATA& mesh);
+	// reorder runs of the cache optimized triangles so the ones
+	// facing outwards are drawn first, while the average cache
+	// miss ratio grows at most by the passed in factor
+	static void OptimizeOverdraw(MESH_DATA& mesh, float threshold);
+	// average number of vertices shaded per triangle with a
+	// first-in first-out cache of the passed in size
+	static float ComputeACMR(const MESH_DATA& mesh, int cacheSize);
+
+	// encoders of the compact vertex format
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+	static GLushort EncodeHalfFloat(float value);
+	// tell a vertex shader that the mesh it draws is not from
+	// a MeshGeometry and has float vertices
+	static void SetFloatVertexUniforms(const ShaderManager* pShader);
+
+	// constructor
+	MeshGeometry();
+	// destructor
+	~MeshGeometry();
+
+	// append a mesh to the shared buffers, returns its index
+	int AddMesh(const MESH_DATA& mesh);
+	// layout of the next Upload(), floats by default
+	void SetVertexFormat(VERTEX_FORMAT format);
+	VERTEX_FORMAT GetVertexFormat() const;
+	// create the GL buffers and vertex array from the added meshes
+	bool Upload(GLStateCache* pStateCache);
+	// set the uniforms a vertex shader decodes the uploaded
+	// vertex format with, before drawing from these buffers
+	void SetVertexUniforms(const ShaderManager* pShader) const;
+	// size of the uploaded vertex buffer
+	size_t GetVertexBufferBytes() const;
+	// size the vertex buffer has with float vertices
+	size_t GetFloatVertexBytes() const;
+
+	// access to the packed meshes
+	int GetMeshCount() const;
+	const MESH_RANGE& GetMesh(int meshIndex) const;
+	const MESH_DATA& GetMeshData(int meshIndex) const;
+	GLuint GetVertexArray() const;
+	GLuint GetVertexBuffer() const;
+	GLuint GetIndexBuffer() const;
+
+	// draw one mesh, the vertex array has to be bound
+	void Draw(int meshIndex) const;
+
+private:
+	// CPU copies of the added meshes
+	std::vector<MESH_DATA> m_meshData;
+	std::vector<MESH_RANGE> m_meshes;
+	// totals of all the added meshes
+	GLuint m_vertexCount;
+	GLuint m_indexCount;
+
+	// uploaded layout, and the bounds the compact positions
+	// are fractions of
+	VERTEX_FORMAT m_vertexFormat;
+	glm::vec3 m_positionMinimum;
+	glm::vec3 m_positionExtent;
+
+	// GL objects holding all the meshes
+	GLuint m_vertexArray;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+
+	// pack the vertices of all the meshes into the compact format
+	void BuildCompactVertices(const std::vector<VERTEX>& vertices, std::vector<COMPACT_VERTEX>& compactVertices);
+	// add a ring of side vertices and the quads between two rings
+	static void AddLathe(MESH_DATA& mesh, int slices, float bottomRadius, float topRadius);
+	// add a flat disc facing up or down
+	static void AddDisc(MESH_DATA& mesh, int slices, float radius, float height, bool bFacingUp);
+};
@@ -0,0 +1,1122 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.cpp
+// ============
+// import OBJ and glTF models into meshes the scene can draw
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshImporter.h"
+#include "JsonDocument.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// bytes of an OBJ file parsed by one job
+	const size_t g_OBJChunkBytes = 1 << 20;
+
+	// binary glTF container
+	const uint32_t g_GLBMagic = 0x46546C67;   // "glTF"
+	const uint32_t g_GLBChunkJSON = 0x4E4F534A;   // "JSON"
+	const uint32_t g_GLBChunkBinary = 0x004E4942;   // "BIN"
+
+	// glTF accessor component types and the triangle list mode
+	const int g_GLTFByte = 5120;
+	const int g_GLTFUnsignedByte = 5121;
+	const int g_GLTFShort = 5122;
+	const int g_GLTFUnsignedShort = 5123;
+	const int g_GLTFUnsignedInt = 5125;
+	const int g_GLTFFloat = 5126;
+	const int g_GLTFTriangles = 4;
+
+	// one corner of an OBJ face, each index either counted from
+	// the start of the file or, for the negative indices of the
+	// file, from the first element of the chunk it was read in
+	struct OBJ_CORNER
+	{
+		// position, texture coordinate and normal, -1 for none
+		int index[3];
+		// bit per index that is counted from the chunk
+		unsigned int chunkRelative;
+	};
+
+	// part of an OBJ file between two line breaks and what was
+	// read from it
+	struct OBJ_CHUNK
+	{
+		const char* pBegin;
+		const char* pEnd;
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec2> coordinates;
+		std::vector<glm::vec3> normals;
+		// corners of the triangles fanned out of the faces
+		std::vector<OBJ_CORNER> corners;
+		bool bError;
+	};
+
+	// a buffer of a glTF file
+	struct GLTF_BUFFER
+	{
+		const char* pData;
+		size_t size;
+	};
+
+	// a glTF primitive to decode and the world matrix of the
+	// node it is drawn by
+	struct GLTF_PRIMITIVE
+	{
+		int primitive;
+		glm::mat4 model;
+	};
+
+	// where the elements of a glTF accessor are in its buffer
+	struct GLTF_ACCESSOR
+	{
+		const char* pData;
+		size_t stride;
+		int count;
+		int components;
+		int componentType;
+		size_t componentSize;
+		bool bNormalized;
+	};
+
+	/***********************************************************
+	 *  SkipSpaces()
+	 *
+	 *  Move past the spaces and tabs within a line.
+	 ***********************************************************/
+	inline void SkipSpaces(const char*& p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  Parse a decimal number with an optional exponent.  The
+	 *  text of a mapped file has no terminator, which rules out
+	 *  strtod, and it would also look up the locale for every
+	 *  number.  The digits are gathered as a whole number and
+	 *  scaled once, which is exact for the usual OBJ precision.
+	 ***********************************************************/
+	float ParseFloat(const char*& p, const char* pEnd)
+	{
+		static const double powersOfTen[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		SkipSpaces(p, pEnd);
+
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		// digits past the 18th do not fit and no longer matter
+		uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			if (digits < 18)
+			{
+				mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+			p++;
+		}
+		if ((p < pEnd) && (*p == '.'))
+		{
+			p++;
+			while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+			{
+				if (digits < 18)
+				{
+					mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+					digits += (mantissa != 0) ? 1 : 0;
+					exponent--;
+				}
+				p++;
+			}
+		}
+		if ((p < pEnd) && ((*p == 'e') || (*p == 'E')))
+		{
+			p++;
+			bool bNegativeExponent = false;
+			if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+			{
+				bNegativeExponent = (*p == '-');
+				p++;
+			}
+			int written = 0;
+			while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+			{
+				written = (written < 10000) ? (written * 10) + (*p - '0') : written;
+				p++;
+			}
+			exponent += bNegativeExponent ? -written : written;
+		}
+
+		double value = (double)mantissa;
+		if ((exponent >= -22) && (exponent <= 22))
+		{
+			value = (exponent < 0) ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+		}
+		else
+		{
+			value *= pow(10.0, (double)exponent);
+		}
+
+		return((float)(bNegative ? -value : value));
+	}
+
+	/***********************************************************
+	 *  ParseInt()
+	 *
+	 *  Parse a whole number with an optional sign, 0 when there
+	 *  are no digits or it does not fit in an int, which is
+	 *  never a valid OBJ index.
+	 ***********************************************************/
+	int ParseInt(const char*& p, const char* pEnd)
+	{
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		// the digits past the int range are still read, but the
+		// value stops growing so it can not overflow
+		long long value = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			if (value <= INT_MAX)
+			{
+				value = (value * 10) + (*p - '0');
+			}
+			p++;
+		}
+		if (value > INT_MAX)
+		{
+			return(0);
+		}
+
+		return(bNegative ? -(int)value : (int)value);
+	}
+
+	/***********************************************************
+	 *  ParseOBJChunk()
+	 *
+	 *  Read the vertex elements and faces of one chunk of an OBJ
+	 *  file, fanning each face into triangles.  Statements other
+	 *  than v, vt, vn and f - objects, groups, materials and
+	 *  smoothing groups - are skipped.
+	 ***********************************************************/
+	void ParseOBJChunk(OBJ_CHUNK& chunk)
+	{
+		const char* p = chunk.pBegin;
+		const char* pEnd = chunk.pEnd;
+		std::vector<OBJ_CORNER> face;
+
+		while ((p < pEnd) && (chunk.bError == false))
+		{
+			SkipSpaces(p, pEnd);
+			if ((p + 1 < pEnd) && (p[0] == 'v') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 2;
+				glm::vec3 position;
+				position.x = ParseFloat(p, pEnd);
+				position.y = ParseFloat(p, pEnd);
+				position.z = ParseFloat(p, pEnd);
+				chunk.positions.push_back(position);
+			}
+			else if ((p + 2 < pEnd) && (p[0] == 'v') && (p[1] == 't') && ((p[2] == ' ') || (p[2] == '\t')))
+			{
+				p += 3;
+				glm::vec2 coordinate;
+				coordinate.x = ParseFloat(p, pEnd);
+				coordinate.y = ParseFloat(p, pEnd);
+				chunk.coordinates.push_back(coordinate);
+			}
+			else if ((p + 2 < pEnd) && (p[0] == 'v') && (p[1] == 'n') && ((p[2] == ' ') || (p[2] == '\t')))
+			{
+				p += 3;
+				glm::vec3 normal;
+				normal.x = ParseFloat(p, pEnd);
+				normal.y = ParseFloat(p, pEnd);
+				normal.z = ParseFloat(p, pEnd);
+				chunk.normals.push_back(normal);
+			}
+			else if ((p + 1 < pEnd) && (p[0] == 'f') && ((p[1] == ' ') || (p[1] == '\t')))
+			{
+				p += 2;
+				face.clear();
+				int counts[3] = { (int)chunk.positions.size(), (int)chunk.coordinates.size(), (int)chunk.normals.size() };
+
+				// corners are p, p/t, p//n or p/t/n
+				SkipSpaces(p, pEnd);
+				while ((p < pEnd) && (*p != '\n'))
+				{
+					OBJ_CORNER corner;
+					corner.chunkRelative = 0;
+					for (int k = 0; k < 3; k++)
+					{
+						corner.index[k] = -1;
+						if ((k > 0) && ((p >= pEnd) || (*p != '/')))
+						{
+							continue;
+						}
+						if (k > 0)
+						{
+							p++;
+						}
+						if ((p < pEnd) && (*p != '/') && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+						{
+							int value = ParseInt(p, pEnd);
+							if (value > 0)
+							{
+								corner.index[k] = value - 1;
+							}
+							else if (value < 0)
+							{
+								corner.index[k] = counts[k] + value;
+								corner.chunkRelative |= (1u << k);
+							}
+							else
+							{
+								chunk.bError = true;
+							}
+						}
+					}
+					// every corner needs a position
+					if ((corner.index[0] < 0) && ((corner.chunkRelative & 1u) == 0))
+					{
+						chunk.bError = true;
+					}
+					if (chunk.bError == true)
+					{
+						break;
+					}
+					face.push_back(corner);
+					SkipSpaces(p, pEnd);
+				}
+
+				for (size_t i = 2; i < face.size(); i++)
+				{
+					chunk.corners.push_back(face[0]);
+					chunk.corners.push_back(face[i - 1]);
+					chunk.corners.push_back(face[i]);
+				}
+			}
+
+			// on to the next line
+			while ((p < pEnd) && (*p != '\n'))
+			{
+				p++;
+			}
+			if (p < pEnd)
+			{
+				p++;
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AccumulateNormals()
+	 *
+	 *  Give the marked vertices of a mesh the average of the
+	 *  normals of the triangles around them, weighted by area.
+	 ***********************************************************/
+	void AccumulateNormals(MeshGeometry::MESH_DATA& mesh, const std::vector<bool>& needsNormal)
+	{
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			GLuint a = mesh.indices[i];
+			GLuint b = mesh.indices[i + 1];
+			GLuint c = mesh.indices[i + 2];
+			glm::vec3 normal = glm::cross(
+				mesh.vertices[b].position - mesh.vertices[a].position,
+				mesh.vertices[c].position - mesh.vertices[a].position);
+			GLuint corners[3] = { a, b, c };
+			for (int k = 0; k < 3; k++)
+			{
+				if (needsNormal[corners[k]] == true)
+				{
+					mesh.vertices[corners[k]].normal += normal;
+				}
+			}
+		}
+
+		for (size_t v = 0; v < mesh.vertices.size(); v++)
+		{
+			if (needsNormal[v] == true)
+			{
+				float length = glm::length(mesh.vertices[v].normal);
+				mesh.vertices[v].normal = (length > 0.0f) ? mesh.vertices[v].normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  GetAccessor()
+	 *
+	 *  Find the elements of a glTF accessor in its buffer view
+	 *  and check that they all lie inside the buffer.  Sparse
+	 *  accessors are not supported.
+	 ***********************************************************/
+	bool GetAccessor(
+		const JsonDocument& document,
+		const std::vector<GLTF_BUFFER>& buffers,
+		int accessorIndex,
+		GLTF_ACCESSOR& accessor)
+	{
+		int root = document.GetRoot();
+		int accessorValue = document.GetElement(document.GetMember(root, "accessors"), accessorIndex);
+		if (accessorValue < 0)
+		{
+			return(false);
+		}
+		if (document.GetMember(accessorValue, "sparse") >= 0)
+		{
+			std::cout << "Sparse glTF accessors are not supported" << std::endl;
+			return(false);
+		}
+
+		std::string type = document.GetString(document.GetMember(accessorValue, "type"), "");
+		accessor.components = (type == "SCALAR") ? 1 : (type == "VEC2") ? 2 : (type == "VEC3") ? 3 : (type == "VEC4") ? 4 : 0;
+		accessor.count = document.GetInt(document.GetMember(accessorValue, "count"), 0);
+		accessor.componentType = document.GetInt(document.GetMember(accessorValue, "componentType"), 0);
+		accessor.bNormalized = document.GetBool(document.GetMember(accessorValue, "normalized"), false);
+
+		accessor.componentSize = 0;
+		switch (accessor.componentType)
+		{
+		case g_GLTFByte:
+		case g_GLTFUnsignedByte:
+			accessor.componentSize = 1;
+			break;
+		case g_GLTFShort:
+		case g_GLTFUnsignedShort:
+			accessor.componentSize = 2;
+			break;
+		case g_GLTFUnsignedInt:
+		case g_GLTFFloat:
+			accessor.componentSize = 4;
+			break;
+		}
+		if ((accessor.components == 0) || (accessor.componentSize == 0) || (accessor.count < 0))
+		{
+			return(false);
+		}
+
+		int viewValue = document.GetElement(
+			document.GetMember(root, "bufferViews"),
+			document.GetInt(document.GetMember(accessorValue, "bufferView"), -1));
+		int bufferIndex = document.GetInt(document.GetMember(viewValue, "buffer"), -1);
+		if ((viewValue < 0) || (bufferIndex < 0) || (bufferIndex >= (int)buffers.size()))
+		{
+			return(false);
+		}
+
+		size_t viewOffset = (size_t)document.GetNumber(document.GetMember(viewValue, "byteOffset"), 0.0);
+		size_t viewLength = (size_t)document.GetNumber(document.GetMember(viewValue, "byteLength"), 0.0);
+		size_t offset = (size_t)document.GetNumber(document.GetMember(accessorValue, "byteOffset"), 0.0);
+		size_t elementSize = accessor.componentSize * (size_t)accessor.components;
+		accessor.stride = (size_t)document.GetNumber(document.GetMember(viewValue, "byteStride"), 0.0);
+		if (accessor.stride == 0)
+		{
+			accessor.stride = elementSize;
+		}
+
+		size_t end = offset + ((accessor.count > 0) ? (accessor.stride * (size_t)(accessor.count - 1)) + elementSize : 0);
+		if ((end > viewLength) || (viewOffset + viewLength > buffers[bufferIndex].size))
+		{
+			std::cout << "glTF accessor " << accessorIndex << " reaches past its buffer" << std::endl;
+			return(false);
+		}
+		accessor.pData = buffers[bufferIndex].pData + viewOffset + offset;
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadComponent()
+	 *
+	 *  Read one component of a glTF accessor element as a
+	 *  float, scaling normalized integers to their range.
+	 ***********************************************************/
+	float ReadComponent(const GLTF_ACCESSOR& accessor, int element, int component)
+	{
+		const char* pComponent = accessor.pData + (accessor.stride * (size_t)element) + (accessor.componentSize * (size_t)component);
+		switch (accessor.componentType)
+		{
+		case g_GLTFFloat:
+		{
+			float value;
+			memcpy(&value, pComponent, sizeof(value));
+			return(value);
+		}
+		case g_GLTFUnsignedByte:
+		{
+			float value = (float)*(const unsigned char*)pComponent;
+			return(accessor.bNormalized ? value / 255.0f : value);
+		}
+		case g_GLTFByte:
+		{
+			float value = (float)*(const signed char*)pComponent;
+			return(accessor.bNormalized ? std::max(value / 127.0f, -1.0f) : value);
+		}
+		case g_GLTFUnsignedShort:
+		{
+			uint16_t value;
+			memcpy(&value, pComponent, sizeof(value));
+			return(accessor.bNormalized ? (float)value / 65535.0f : (float)value);
+		}
+		case g_GLTFShort:
+		{
+			int16_t value;
+			memcpy(&value, pComponent, sizeof(value));
+			return(accessor.bNormalized ? std::max((float)value / 32767.0f, -1.0f) : (float)value);
+		}
+		default:
+		{
+			uint32_t value;
+			memcpy(&value, pComponent, sizeof(value));
+			return((float)value);
+		}
+		}
+	}
+
+	/***********************************************************
+	 *  ReadIndex()
+	 *
+	 *  Read one element of a glTF index accessor.
+	 ***********************************************************/
+	GLuint ReadIndex(const GLTF_ACCESSOR& accessor, int element)
+	{
+		const char* pElement = accessor.pData + (accessor.stride * (size_t)element);
+		switch (accessor.componentType)
+		{
+		case g_GLTFUnsignedByte:
+			return((GLuint)*(const unsigned char*)pElement);
+		case g_GLTFUnsignedShort:
+		{
+			uint16_t value;
+			memcpy(&value, pElement, sizeof(value));
+			return((GLuint)value);
+		}
+		default:
+		{
+			uint32_t value;
+			memcpy(&value, pElement, sizeof(value));
+			return((GLuint)value);
+		}
+		}
+	}
+
+	/***********************************************************
+	 *  DecodePrimitive()
+	 *
+	 *  Decode the positions, normals, first texture coordinates
+	 *  and indices of a glTF triangle list primitive.
+	 ***********************************************************/
+	bool DecodePrimitive(
+		const JsonDocument& document,
+		const std::vector<GLTF_BUFFER>& buffers,
+		int primitive,
+		MeshGeometry::MESH_DATA& mesh)
+	{
+		int attributes = document.GetMember(primitive, "attributes");
+		GLTF_ACCESSOR positions;
+		if (GetAccessor(document, buffers, document.GetInt(document.GetMember(attributes, "POSITION"), -1), positions) == false)
+		{
+			return(false);
+		}
+		GLTF_ACCESSOR normals;
+		bool bNormals = GetAccessor(document, buffers, document.GetInt(document.GetMember(attributes, "NORMAL"), -1), normals);
+		GLTF_ACCESSOR coordinates;
+		bool bCoordinates = GetAccessor(document, buffers, document.GetInt(document.GetMember(attributes, "TEXCOORD_0"), -1), coordinates);
+		if ((positions.components != 3) ||
+			((bNormals == true) && ((normals.components != 3) || (normals.count != positions.count))) ||
+			((bCoordinates == true) && ((coordinates.components != 2) || (coordinates.count != positions.count))))
+		{
+			return(false);
+		}
+
+		mesh.vertices.resize(positions.count);
+		for (int i = 0; i < positions.count; i++)
+		{
+			MeshGeometry::VERTEX& vertex = mesh.vertices[i];
+			vertex.textureCoordinate = glm::vec2(0.0f);
+			vertex.lightmapCoordinate = glm::vec2(0.0f);
+			for (int k = 0; k < 3; k++)
+			{
+				vertex.position[k] = ReadComponent(positions, i, k);
+				vertex.normal[k] = (bNormals == true) ? ReadComponent(normals, i, k) : 0.0f;
+			}
+			if (bCoordinates == true)
+			{
+				vertex.textureCoordinate = glm::vec2(ReadComponent(coordinates, i, 0), ReadComponent(coordinates, i, 1));
+			}
+		}
+
+		int indexAccessor = document.GetInt(document.GetMember(primitive, "indices"), -1);
+		if (indexAccessor >= 0)
+		{
+			GLTF_ACCESSOR indices;
+			if ((GetAccessor(document, buffers, indexAccessor, indices) == false) || (indices.components != 1))
+			{
+				return(false);
+			}
+			mesh.indices.resize(indices.count - (indices.count % 3));
+			for (size_t i = 0; i < mesh.indices.size(); i++)
+			{
+				mesh.indices[i] = ReadIndex(indices, (int)i);
+				if (mesh.indices[i] >= (GLuint)positions.count)
+				{
+					return(false);
+				}
+			}
+		}
+		else
+		{
+			mesh.indices.resize(positions.count - (positions.count % 3));
+			for (size_t i = 0; i < mesh.indices.size(); i++)
+			{
+				mesh.indices[i] = (GLuint)i;
+			}
+		}
+
+		if (bNormals == false)
+		{
+			AccumulateNormals(mesh, std::vector<bool>(mesh.vertices.size(), true));
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetNodeMatrix()
+	 *
+	 *  Build the local matrix of a glTF node from its matrix or
+	 *  from its translation, rotation and scale.
+	 ***********************************************************/
+	glm::mat4 GetNodeMatrix(const JsonDocument& document, int node)
+	{
+		glm::mat4 matrix(1.0f);
+
+		int values = document.GetMember(node, "matrix");
+		if (document.GetCount(values) == 16)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					matrix[column][row] = document.GetFloat(document.GetElement(values, (column * 4) + row), 0.0f);
+				}
+			}
+			return(matrix);
+		}
+
+		int translation = document.GetMember(node, "translation");
+		int rotation = document.GetMember(node, "rotation");
+		int scale = document.GetMember(node, "scale");
+
+		// rotation quaternion in x, y, z, w order
+		float x = document.GetFloat(document.GetElement(rotation, 0), 0.0f);
+		float y = document.GetFloat(document.GetElement(rotation, 1), 0.0f);
+		float z = document.GetFloat(document.GetElement(rotation, 2), 0.0f);
+		float w = document.GetFloat(document.GetElement(rotation, 3), 1.0f);
+		matrix[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f);
+		matrix[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f);
+		matrix[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f);
+
+		for (int k = 0; k < 3; k++)
+		{
+			matrix[k] *= document.GetFloat(document.GetElement(scale, k), 1.0f);
+		}
+		matrix[3] = glm::vec4(
+			document.GetFloat(document.GetElement(translation, 0), 0.0f),
+			document.GetFloat(document.GetElement(translation, 1), 0.0f),
+			document.GetFloat(document.GetElement(translation, 2), 0.0f),
+			1.0f);
+
+		return(matrix);
+	}
+}
+
+/***********************************************************
+ *  MeshImporter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshImporter::MeshImporter(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_statistics.fileBytes = 0;
+	m_statistics.milliseconds = 0.0;
+	m_statistics.vertexCount = 0;
+	m_statistics.triangleCount = 0;
+}
+
+/***********************************************************
+ *  ~MeshImporter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshImporter::~MeshImporter()
+{
+	m_pJobSystem = NULL;
+}
+
+/***********************************************************
+ *  Import()
+ *
+ *  This method maps a model file and imports it by the
+ *  format its extension names.  The time taken includes the
+ *  mapping and every stage up to the finished mesh.
+ ***********************************************************/
+bool MeshImporter::Import(const char* filename, MeshGeometry::MESH_DATA& mesh)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_statistics.fileBytes = 0;
+	m_statistics.milliseconds = 0.0;
+	m_statistics.vertexCount = 0;
+	m_statistics.triangleCount = 0;
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	std::string extension = filename;
+	size_t dot = extension.find_last_of('.');
+	extension = (dot == std::string::npos) ? "" : extension.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	if ((extension != "obj") && (extension != "gltf") && (extension != "glb"))
+	{
+		std::cout << "Unknown model format:" << filename << std::endl;
+		return(false);
+	}
+
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		return(false);
+	}
+	m_statistics.fileBytes = file.GetSize();
+
+	bool bImported = false;
+	if (extension == "obj")
+	{
+		bImported = ImportOBJ(file.GetData(), file.GetSize(), mesh);
+	}
+	else
+	{
+		bImported = ImportGLTF(filename, file.GetData(), file.GetSize(), mesh);
+	}
+	if ((bImported == false) || (mesh.indices.empty() == true))
+	{
+		std::cout << "Could not import model:" << filename << std::endl;
+		mesh.vertices.clear();
+		mesh.indices.clear();
+		return(false);
+	}
+
+	m_statistics.vertexCount = mesh.vertices.size();
+	m_statistics.triangleCount = mesh.indices.size() / 3;
+	m_statistics.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportOBJ()
+ *
+ *  This method cuts an OBJ file into chunks at line breaks
+ *  and parses them in parallel.  The counts of every chunk
+ *  then give the offsets of the next one's elements, so the
+ *  indices can be resolved and the corners with the same
+ *  three indices welded into one vertex.  The
+ *  vertices that come without a normal get the average of
+ *  the normals of their faces.
+ ***********************************************************/
+bool MeshImporter::ImportOBJ(const char* pData, size_t size, MeshGeometry::MESH_DATA& mesh)
+{
+	size_t chunkCount = std::max((size_t)1, size / g_OBJChunkBytes);
+	std::vector<OBJ_CHUNK> chunks(chunkCount);
+	const char* pEnd = pData + size;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* pBegin = pData + ((size * i) / chunkCount);
+		if (i > 0)
+		{
+			while ((pBegin < pEnd) && (pBegin[-1] != '\n'))
+			{
+				pBegin++;
+			}
+		}
+		chunks[i].pBegin = pBegin;
+		chunks[i].bError = false;
+		if (i > 0)
+		{
+			chunks[i - 1].pEnd = pBegin;
+		}
+	}
+	chunks[chunkCount - 1].pEnd = pEnd;
+
+	ParallelFor("Parse OBJ", (unsigned int)chunkCount, [&chunks](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				ParseOBJChunk(chunks[i]);
+			}
+		});
+
+	// offsets of each chunk's elements in the whole file
+	std::vector<int> firstElements(chunkCount * 3);
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec2> coordinates;
+	std::vector<glm::vec3> normals;
+	size_t cornerCount = 0;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		if (chunks[i].bError == true)
+		{
+			std::cout << "Malformed face in OBJ chunk " << i << std::endl;
+			return(false);
+		}
+		firstElements[i * 3] = (int)positions.size();
+		firstElements[i * 3 + 1] = (int)coordinates.size();
+		firstElements[i * 3 + 2] = (int)normals.size();
+		positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+		coordinates.insert(coordinates.end(), chunks[i].coordinates.begin(), chunks[i].coordinates.end());
+		normals.insert(normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+		cornerCount += chunks[i].corners.size();
+	}
+
+	// hash table from corner indices to vertices, hashed by the
+	// position alone - the corners on one position rarely have
+	// more than a few texture coordinates and normals, and the
+	// faces of a file mostly use nearby positions, so the
+	// buckets are looked up in order instead of all over memory
+	std::vector<int> bucketHeads(positions.size(), -1);
+	std::vector<int> nextInBucket;
+	std::vector<OBJ_CORNER> vertexCorners;
+	std::vector<bool> needsNormal;
+	int elementCounts[3] = { (int)positions.size(), (int)coordinates.size(), (int)normals.size() };
+	mesh.vertices.reserve(positions.size());
+	mesh.indices.reserve(cornerCount);
+
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const std::vector<OBJ_CORNER>& corners = chunks[i].corners;
+		for (size_t c = 0; c < corners.size(); c++)
+		{
+			OBJ_CORNER corner = corners[c];
+			for (int k = 0; k < 3; k++)
+			{
+				bool bRelative = ((corner.chunkRelative & (1u << k)) != 0);
+				if (bRelative == true)
+				{
+					corner.index[k] += firstElements[i * 3 + k];
+				}
+				if (((bRelative == true) || (corner.index[k] >= 0)) &&
+					((corner.index[k] < 0) || (corner.index[k] >= elementCounts[k])))
+				{
+					std::cout << "OBJ face refers to a missing vertex element" << std::endl;
+					return(false);
+				}
+			}
+			corner.chunkRelative = 0;
+
+			int vertexIndex = bucketHeads[corner.index[0]];
+			while ((vertexIndex >= 0) &&
+				((vertexCorners[vertexIndex].index[1] != corner.index[1]) ||
+				(vertexCorners[vertexIndex].index[2] != corner.index[2])))
+			{
+				vertexIndex = nextInBucket[vertexIndex];
+			}
+
+			if (vertexIndex < 0)
+			{
+				vertexIndex = (int)mesh.vertices.size();
+				nextInBucket.push_back(bucketHeads[corner.index[0]]);
+				bucketHeads[corner.index[0]] = vertexIndex;
+				vertexCorners.push_back(corner);
+
+				// OBJ texture coordinates start at the bottom of the
+				// image, the textures are loaded top row first
+				MeshGeometry::VERTEX vertex;
+				vertex.position = positions[corner.index[0]];
+				vertex.normal = (corner.index[2] >= 0) ? normals[corner.index[2]] : glm::vec3(0.0f);
+				vertex.textureCoordinate = (corner.index[1] >= 0) ? coordinates[corner.index[1]] : glm::vec2(0.0f);
+				vertex.textureCoordinate.y = 1.0f - vertex.textureCoordinate.y;
+				vertex.lightmapCoordinate = glm::vec2(0.0f);
+				mesh.vertices.push_back(vertex);
+				needsNormal.push_back(corner.index[2] < 0);
+			}
+			mesh.indices.push_back((GLuint)vertexIndex);
+		}
+	}
+
+	if (std::find(needsNormal.begin(), needsNormal.end(), true) != needsNormal.end())
+	{
+		AccumulateNormals(mesh, needsNormal);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportGLTF()
+ *
+ *  This method reads the JSON of a .gltf file, or of the
+ *  first chunk of a .glb file, maps the external buffers it
+ *  names and decodes the triangle primitives of the nodes of
+ *  the default scene in parallel.  Buffers embedded as data
+ *  URIs are not supported.
+ ***********************************************************/
+bool MeshImporter::ImportGLTF(const char* filename, const char* pData, size_t size, MeshGeometry::MESH_DATA& mesh)
+{
+	const char* pJson = pData;
+	size_t jsonSize = size;
+	GLTF_BUFFER binaryChunk = { NULL, 0 };
+
+	uint32_t magic = 0;
+	if (size >= 12)
+	{
+		memcpy(&magic, pData, sizeof(magic));
+	}
+	if (magic == g_GLBMagic)
+	{
+		// a 12 byte header, then chunks of a length, a type and
+		// the data, the JSON first and the binary buffer second
+		jsonSize = 0;
+		size_t offset = 12;
+		while (offset + 8 <= size)
+		{
+			uint32_t chunkHeader[2];
+			memcpy(chunkHeader, pData + offset, sizeof(chunkHeader));
+			offset += 8;
+			if (offset + chunkHeader[0] > size)
+			{
+				break;
+			}
+			if ((chunkHeader[1] == g_GLBChunkJSON) && (jsonSize == 0))
+			{
+				pJson = pData + offset;
+				jsonSize = chunkHeader[0];
+			}
+			else if ((chunkHeader[1] == g_GLBChunkBinary) && (NULL == binaryChunk.pData))
+			{
+				binaryChunk.pData = pData + offset;
+				binaryChunk.size = chunkHeader[0];
+			}
+			offset += chunkHeader[0];
+		}
+	}
+
+	JsonDocument document;
+	if ((jsonSize == 0) || (document.Parse(pJson, jsonSize) == false))
+	{
+		return(false);
+	}
+	int root = document.GetRoot();
+
+	// external buffers are named relative to the model file
+	std::string directory = filename;
+	size_t separator = directory.find_last_of("/\\");
+	directory = (separator == std::string::npos) ? "" : directory.substr(0, separator + 1);
+
+	int bufferList = document.GetMember(root, "buffers");
+	std::vector<GLTF_BUFFER> buffers(document.GetCount(bufferList));
+	std::vector<std::unique_ptr<MappedFile> > bufferFiles;
+	for (int i = 0; i < (int)buffers.size(); i++)
+	{
+		int buffer = document.GetElement(bufferList, i);
+		const char* uri = document.GetString(document.GetMember(buffer, "uri"), NULL);
+		if (NULL == uri)
+		{
+			buffers[i] = binaryChunk;
+		}
+		else if (strncmp(uri, "data:", 5) == 0)
+		{
+			std::cout << "glTF buffers embedded as data URIs are not supported" << std::endl;
+			return(false);
+		}
+		else
+		{
+			bufferFiles.push_back(std::unique_ptr<MappedFile>(new MappedFile()));
+			if (bufferFiles.back()->Open((directory + uri).c_str()) == false)
+			{
+				return(false);
+			}
+			buffers[i].pData = bufferFiles.back()->GetData();
+			buffers[i].size = bufferFiles.back()->GetSize();
+			m_statistics.fileBytes += buffers[i].size;
+		}
+	}
+
+	// the triangle primitives of every node of the default
+	// scene, with the world matrix of the node
+	std::vector<GLTF_PRIMITIVE> primitives;
+	int nodeList = document.GetMember(root, "nodes");
+	int meshList = document.GetMember(root, "meshes");
+	int scene = document.GetElement(document.GetMember(root, "scenes"), document.GetInt(document.GetMember(root, "scene"), 0));
+	std::vector<std::pair<int, glm::mat4> > nodeStack;
+	for (int i = 0; i < document.GetCount(document.GetMember(scene, "nodes")); i++)
+	{
+		nodeStack.push_back(std::make_pair(document.GetInt(document.GetElement(document.GetMember(scene, "nodes"), i), -1), glm::mat4(1.0f)));
+	}
+	// the nodes form a tree, the limit only guards against a
+	// broken file that has them in a loop
+	int visitLimit = document.GetCount(nodeList);
+	while ((nodeStack.empty() == false) && (visitLimit-- >= 0))
+	{
+		int node = document.GetElement(nodeList, nodeStack.back().first);
+		glm::mat4 model = nodeStack.back().second * GetNodeMatrix(document, node);
+		nodeStack.pop_back();
+
+		int nodeMesh = document.GetElement(meshList, document.GetInt(document.GetMember(node, "mesh"), -1));
+		int primitiveList = document.GetMember(nodeMesh, "primitives");
+		for (int p = 0; p < document.GetCount(primitiveList); p++)
+		{
+			GLTF_PRIMITIVE primitive;
+			primitive.primitive = document.GetElement(primitiveList, p);
+			primitive.model = model;
+			primitives.push_back(primitive);
+		}
+
+		int children = document.GetMember(node, "children");
+		for (int c = 0; c < document.GetCount(children); c++)
+		{
+			nodeStack.push_back(std::make_pair(document.GetInt(document.GetElement(children, c), -1), model));
+		}
+	}
+	// a file without scenes is taken as all of its meshes
+	if (scene < 0)
+	{
+		for (int m = 0; m < document.GetCount(meshList); m++)
+		{
+			int primitiveList = document.GetMember(document.GetElement(meshList, m), "primitives");
+			for (int p = 0; p < document.GetCount(primitiveList); p++)
+			{
+				GLTF_PRIMITIVE primitive;
+				primitive.primitive = document.GetElement(primitiveList, p);
+				primitive.model = glm::mat4(1.0f);
+				primitives.push_back(primitive);
+			}
+		}
+	}
+
+	std::vector<MeshGeometry::MESH_DATA> parts(primitives.size());
+	std::vector<char> decoded(primitives.size(), 0);
+	ParallelFor("Decode glTF", (unsigned int)primitives.size(), [&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				if (document.GetInt(document.GetMember(primitives[i].primitive, "mode"), g_GLTFTriangles) != g_GLTFTriangles)
+				{
+					continue;
+				}
+				MeshGeometry::MESH_DATA local;
+				if (DecodePrimitive(document, buffers, primitives[i].primitive, local) == true)
+				{
+					MeshGeometry::AppendTransformed(parts[i], local, primitives[i].model);
+					decoded[i] = 1;
+				}
+			}
+		});
+
+	size_t skipped = 0;
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		if (decoded[i] == 0)
+		{
+			skipped++;
+			continue;
+		}
+		GLuint baseVertex = (GLuint)mesh.vertices.size();
+		mesh.vertices.insert(mesh.vertices.end(), parts[i].vertices.begin(), parts[i].vertices.end());
+		for (size_t k = 0; k < parts[i].indices.size(); k++)
+		{
+			mesh.indices.push_back(baseVertex + parts[i].indices[k]);
+		}
+	}
+	if (skipped > 0)
+	{
+		std::cout << "Skipped " << skipped << " glTF primitives that are not valid triangle lists" << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method spreads a loop over the job system, one
+ *  element per job since every element is a large piece of
+ *  work, or runs it here without a job system.
+ ***********************************************************/
+void MeshImporter::ParallelFor(const char* name, unsigned int count, const std::function<void(unsigned int, unsigned int)>& body)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (NULL == m_pJobSystem)
+	{
+		body(0, count);
+		return;
+	}
+
+	m_pJobSystem->ParallelFor(name, count, 1, body);
+}
+
+/***********************************************************
+ *  GetStatistics()
+ *
+ *  This method returns the sizes and time of the last import.
+ ***********************************************************/
+const MeshImporter::IMPORT_STATISTICS& MeshImporter::GetStatistics() const
+{
+	return(m_statistics);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method prints the size of the last import and how
+ *  fast the file was read.
+ ***********************************************************/
+void MeshImporter::Report(const char* filename) const
+{
+	double megabytes = (double)m_statistics.fileBytes / (1024.0 * 1024.0);
+	double seconds = m_statistics.milliseconds / 1000.0;
+	std::cout << "INFO: Imported " << filename << ": " << megabytes << " MB in "
+		<< m_statistics.milliseconds << " ms (" << ((seconds > 0.0) ? megabytes / seconds : 0.0) << " MB/s), "
+		<< m_statistics.vertexCount << " vertices, " << m_statistics.triangleCount << " triangles" << std::endl;
+}
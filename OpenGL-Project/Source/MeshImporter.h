@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.h
+// ============
+// import OBJ and glTF models into meshes the scene can draw
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+#include "MeshGeometry.h"
+
+#include <cstddef>
+
+/***********************************************************
+ *  MeshImporter
+ *
+ *  This class reads a model file into one MeshGeometry mesh
+ *  with interleaved vertices and triangle indices, ready to
+ *  be added to a MeshGeometry like the basic shapes.  The
+ *  file is memory-mapped and parsed in place.  A Wavefront
+ *  OBJ is cut into chunks at line breaks that the job system
+ *  parses in parallel, and the corners of its faces are then
+ *  welded into shared vertices through a hash table.  A glTF
+ *  2.0 file, either a .gltf with external .bin buffers or a
+ *  binary .glb, has its primitives decoded in parallel and
+ *  moved by the transforms of their nodes.  Materials are not
+ *  imported, the scene object picks its own.
+ ***********************************************************/
+class MeshImporter
+{
+public:
+	struct IMPORT_STATISTICS
+	{
+		// bytes of the model file and any buffers it points to
+		size_t fileBytes;
+		double milliseconds;
+		size_t vertexCount;
+		size_t triangleCount;
+	};
+
+	// constructor - without a job system the file is parsed on
+	// the calling thread
+	MeshImporter(JobSystem* pJobSystem);
+	// destructor
+	~MeshImporter();
+
+	// import an .obj, .gltf or .glb file, picked by extension
+	bool Import(const char* filename, MeshGeometry::MESH_DATA& mesh);
+	// sizes and time of the last import
+	const IMPORT_STATISTICS& GetStatistics() const;
+	// print the size and throughput of the last import
+	void Report(const char* filename) const;
+
+private:
+	// pointer to job system used for parsing in parallel
+	JobSystem* m_pJobSystem;
+	IMPORT_STATISTICS m_statistics;
+
+	bool ImportOBJ(const char* pData, size_t size, MeshGeometry::MESH_DATA& mesh);
+	bool ImportGLTF(const char* filename, const char* pData, size_t size, MeshGeometry::MESH_DATA& mesh);
+	// run a loop over [0, count) on the job system if there is one
+	void ParallelFor(const char* name, unsigned int count, const std::function<void(unsigned int, unsigned int)>& body);
+};
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculling.cpp
+// ============
+// skip objects whose bounding box was hidden in the last frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCulling.h"
+#include "MeshGeometry.h"
+
+// declaration of global variables
+namespace
+{
+	// corners of the unit cube around the origin
+	const GLfloat g_CubeVertices[] =
+	{
+		-0.5f, -0.5f, -0.5f,
+		 0.5f, -0.5f, -0.5f,
+		 0.5f,  0.5f, -0.5f,
+		-0.5f,  0.5f, -0.5f,
+		-0.5f, -0.5f,  0.5f,
+		 0.5f, -0.5f,  0.5f,
+		 0.5f,  0.5f,  0.5f,
+		-0.5f,  0.5f,  0.5f
+	};
+
+	const GLushort g_CubeIndices[] =
+	{
+		0, 2, 1,  0, 3, 2,     // back
+		4, 5, 6,  4, 6, 7,     // front
+		0, 4, 7,  0, 7, 3,     // left
+		1, 2, 6,  1, 6, 5,     // right
+		0, 1, 5,  0, 5, 4,     // bottom
+		3, 7, 6,  3, 6, 2      // top
+	};
+}
+
+/***********************************************************
+ *  OcclusionCulling()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCulling::OcclusionCulling(GLStateCache* pStateCache, ShaderManager* pBoundsShader)
+{
+	m_pStateCache = pStateCache;
+	m_pBoundsShader = pBoundsShader;
+	m_testedCount = 0;
+	m_occludedCount = 0;
+
+	// the conservative query may report hidden boxes as visible,
+	// but is cheaper for the GPU to answer
+	m_queryTarget = GL_ANY_SAMPLES_PASSED;
+	if (GLEW_VERSION_4_3)
+	{
+		m_queryTarget = GL_ANY_SAMPLES_PASSED_CONSERVATIVE;
+	}
+
+	glGenVertexArrays(1, &m_cubeVertexArray);
+	glGenBuffers(1, &m_cubeVertexBuffer);
+	glGenBuffers(1, &m_cubeIndexBuffer);
+
+	m_pStateCache->BindVertexArray(m_cubeVertexArray);
+	glBindBuffer(GL_ARRAY_BUFFER, m_cubeVertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(g_CubeVertices), g_CubeVertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_cubeIndexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(g_CubeIndices), g_CubeIndices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void*)0);
+	m_pStateCache->BindVertexArray(0);
+}
+
+/***********************************************************
+ *  ~OcclusionCulling()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCulling::~OcclusionCulling()
+{
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		glDeleteQueries(1, &m_objects[i].query);
+	}
+	m_objects.clear();
+
+	glDeleteVertexArrays(1, &m_cubeVertexArray);
+	glDeleteBuffers(1, &m_cubeVertexBuffer);
+	glDeleteBuffers(1, &m_cubeIndexBuffer);
+
+	m_pStateCache = NULL;
+	m_pBoundsShader = NULL;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method reads the result of every query the GPU has
+ *  finished.  Objects whose query is still in flight keep
+ *  the visibility they had, and new objects start visible.
+ ***********************************************************/
+void OcclusionCulling::BeginFrame(int objectCount)
+{
+	while ((int)m_objects.size() < objectCount)
+	{
+		OBJECT_QUERY object;
+		glGenQueries(1, &object.query);
+		object.bPending = false;
+		object.bVisible = true;
+		m_objects.push_back(object);
+	}
+
+	m_testedCount = 0;
+	m_occludedCount = 0;
+
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		OBJECT_QUERY& object = m_objects[i];
+		if (object.bPending == true)
+		{
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available == GL_TRUE)
+			{
+				GLuint anySamples = 0;
+				glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &anySamples);
+				object.bVisible = (anySamples != 0);
+				object.bPending = false;
+			}
+		}
+
+		if (object.bVisible == false)
+		{
+			m_occludedCount++;
+		}
+	}
+}
+
+/***********************************************************
+ *  IsVisible()
+ *
+ *  This method returns whether the object's bounding box was
+ *  visible the last time it was tested.
+ ***********************************************************/
+bool OcclusionCulling::IsVisible(int objectIndex) const
+{
+	if ((objectIndex < 0) || (objectIndex >= (int)m_objects.size()))
+	{
+		return(true);
+	}
+
+	return(m_objects[objectIndex].bVisible);
+}
+
+/***********************************************************
+ *  BeginQueries()
+ *
+ *  This method sets up drawing of the bounding boxes - depth
+ *  tested but writing neither color nor depth.  Less or
+ *  equal is used so a box that lies exactly on a drawn
+ *  surface still counts as visible.
+ ***********************************************************/
+void OcclusionCulling::BeginQueries(const glm::mat4& view, const glm::mat4& projection)
+{
+	m_pStateCache->UseProgram(m_pBoundsShader->m_programID);
+	m_pBoundsShader->setMat4Value("view", view);
+	m_pBoundsShader->setMat4Value("projection", projection);
+	// the boxes are float vertices, whatever the scene drew last
+	MeshGeometry::SetFloatVertexUniforms(m_pBoundsShader);
+
+	m_pStateCache->BindVertexArray(m_cubeVertexArray);
+	m_pStateCache->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	m_pStateCache->DepthMask(GL_FALSE);
+	m_pStateCache->DepthFunc(GL_LEQUAL);
+	m_pStateCache->Disable(GL_BLEND);
+}
+
+/***********************************************************
+ *  QueryObject()
+ *
+ *  This method draws the bounding box of an object inside an
+ *  occlusion query.  A query the GPU has not answered yet is
+ *  left alone rather than restarted.
+ ***********************************************************/
+void OcclusionCulling::QueryObject(int objectIndex, const glm::mat4& boundsMatrix)
+{
+	if ((objectIndex < 0) || (objectIndex >= (int)m_objects.size()))
+	{
+		return;
+	}
+
+	OBJECT_QUERY& object = m_objects[objectIndex];
+	if (object.bPending == true)
+	{
+		return;
+	}
+
+	m_pBoundsShader->setMat4Value("model", boundsMatrix);
+
+	glBeginQuery(m_queryTarget, object.query);
+	glDrawElements(GL_TRIANGLES, sizeof(g_CubeIndices) / sizeof(g_CubeIndices[0]), GL_UNSIGNED_SHORT, NULL);
+	glEndQuery(m_queryTarget);
+
+	object.bPending = true;
+	m_testedCount++;
+}
+
+/***********************************************************
+ *  MarkVisible()
+ *
+ *  This method makes an object visible without a query, for
+ *  boxes the near plane would cut open.  The result of a
+ *  query still in flight is dropped, it could be wrong.
+ ***********************************************************/
+void OcclusionCulling::MarkVisible(int objectIndex)
+{
+	if ((objectIndex < 0) || (objectIndex >= (int)m_objects.size()))
+	{
+		return;
+	}
+
+	m_objects[objectIndex].bVisible = true;
+	m_objects[objectIndex].bPending = false;
+}
+
+/***********************************************************
+ *  EndQueries()
+ *
+ *  This method restores the color and depth writes.
+ ***********************************************************/
+void OcclusionCulling::EndQueries()
+{
+	m_pStateCache->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	m_pStateCache->DepthMask(GL_TRUE);
+	m_pStateCache->DepthFunc(GL_LESS);
+	m_pStateCache->BindVertexArray(0);
+}
+
+/***********************************************************
+ *  GetTestedCount()
+ *
+ *  This method returns the number of queries issued in the
+ *  current frame.
+ ***********************************************************/
+int OcclusionCulling::GetTestedCount() const
+{
+	return(m_testedCount);
+}
+
+/***********************************************************
+ *  GetOccludedCount()
+ *
+ *  This method returns the number of objects skipped in the
+ *  current frame because their box was hidden.
+ ***********************************************************/
+int OcclusionCulling::GetOccludedCount() const
+{
+	return(m_occludedCount);
+}
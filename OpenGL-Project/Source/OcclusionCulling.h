@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculling.h
+// ============
+// skip objects whose bounding box was hidden in the last frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCulling
+ *
+ *  This class draws the bounding boxes of the scene objects
+ *  against the finished depth buffer with an occlusion query
+ *  each.  The results are read in the following frame, and
+ *  only when the GPU already has them, so the CPU never
+ *  waits - an object that comes out from behind an occluder
+ *  therefore shows up one frame late.
+ ***********************************************************/
+class OcclusionCulling
+{
+public:
+	// constructor
+	OcclusionCulling(GLStateCache* pStateCache, ShaderManager* pBoundsShader);
+	// destructor
+	~OcclusionCulling();
+
+	// read the finished queries of earlier frames
+	void BeginFrame(int objectCount);
+	// whether an object passed its last occlusion test
+	bool IsVisible(int objectIndex) const;
+
+	// set up the state for drawing bounding boxes
+	void BeginQueries(const glm::mat4& view, const glm::mat4& projection);
+	// test the bounding box of an object, the matrix maps the
+	// unit cube around the origin onto the box
+	void QueryObject(int objectIndex, const glm::mat4& boundsMatrix);
+	// count an object as visible without testing it, used when
+	// the camera is inside its box
+	void MarkVisible(int objectIndex);
+	// restore the state changed for the bounding boxes
+	void EndQueries();
+
+	// statistics of the current frame
+	int GetTestedCount() const;
+	int GetOccludedCount() const;
+
+private:
+	struct OBJECT_QUERY
+	{
+		GLuint query;
+		bool bPending;
+		bool bVisible;
+	};
+
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	// depth-only program used for the bounding boxes
+	ShaderManager* m_pBoundsShader;
+	// unit cube drawn for every bounding box
+	GLuint m_cubeVertexArray;
+	GLuint m_cubeVertexBuffer;
+	GLuint m_cubeIndexBuffer;
+	// query target, conservative where the driver supports it
+	GLenum m_queryTarget;
+	// query state of every scene object
+	std::vector<OBJECT_QUERY> m_objects;
+
+	int m_testedCount;
+	int m_occludedCount;
+};
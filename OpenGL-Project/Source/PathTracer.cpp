@@ -0,0 +1,611 @@
+///////////////////////////////////////////////////////////////////////////////
+// pathtracer.cpp
+// ============
+// path trace high resolution reference images of the scene on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PathTracer.h"
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const float g_Pi = 3.14159265358979f;
+	// transparent surfaces a ray may pass before it is stopped
+	const int g_MaxPassThrough = 8;
+	// bounces that are always traced before paths may be ended
+	const int g_RouletteBounces = 2;
+
+	/***********************************************************
+	 *  HashSeed()
+	 *
+	 *  Scramble a pixel and sample number into a generator
+	 *  state, so every sample of every pixel is decorrelated
+	 *  and an image is the same on any number of threads.
+	 ***********************************************************/
+	unsigned int HashSeed(unsigned int value)
+	{
+		value = (value ^ 61u) ^ (value >> 16);
+		value *= 9u;
+		value ^= value >> 4;
+		value *= 0x27D4EB2Du;
+		value ^= value >> 15;
+
+		return((value != 0) ? value : 1u);
+	}
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  Advance a xorshift generator and return a number in
+	 *  [0, 1).
+	 ***********************************************************/
+	float NextRandom(unsigned int& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return((float)(state >> 8) * (1.0f / 16777216.0f));
+	}
+
+	/***********************************************************
+	 *  SampleHemisphere()
+	 *
+	 *  Return a direction around the normal, distributed by the
+	 *  cosine to it, which cancels the cosine of a diffuse
+	 *  surface out of the path throughput.
+	 ***********************************************************/
+	glm::vec3 SampleHemisphere(const glm::vec3& normal, unsigned int& randomState)
+	{
+		float angle = 2.0f * g_Pi * NextRandom(randomState);
+		float radius2 = NextRandom(randomState);
+		float radius = std::sqrt(radius2);
+
+		glm::vec3 helper = (std::fabs(normal.x) > 0.9f) ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(helper, normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		return(glm::normalize(
+			tangent * (radius * std::cos(angle)) +
+			bitangent * (radius * std::sin(angle)) +
+			normal * std::sqrt(std::max(0.0f, 1.0f - radius2))));
+	}
+}
+
+/***********************************************************
+ *  GetDefaultSettings()
+ *
+ *  This method returns settings for a full HD still that
+ *  converges in a few dozen passes.
+ ***********************************************************/
+PathTracer::TRACE_SETTINGS PathTracer::GetDefaultSettings()
+{
+	TRACE_SETTINGS settings;
+	settings.width = 1920;
+	settings.height = 1080;
+	settings.samplesPerPass = 4;
+	settings.maxBounces = 4;
+	settings.rayBias = 0.002f;
+
+	return(settings);
+}
+
+/***********************************************************
+ *  PathTracer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PathTracer::PathTracer(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_settings = GetDefaultSettings();
+	m_bTransparency = false;
+	m_inverseViewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_sampleCount = 0;
+	m_passCount = 0;
+	m_traceSeconds = 0.0;
+}
+
+/***********************************************************
+ *  ~PathTracer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PathTracer::~PathTracer()
+{
+	m_pJobSystem = NULL;
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method adds the triangles of an object in world
+ *  space, along with the normals and texture coordinates
+ *  they are shaded with.
+ ***********************************************************/
+void PathTracer::AddObject(
+	const MeshGeometry::MESH_DATA& mesh,
+	const glm::mat4& model,
+	const PATH_MATERIAL& material,
+	const SoftwareTexture* pTexture,
+	const glm::vec4& objectColor,
+	bool bTransparent)
+{
+	PATH_OBJECT object;
+	object.material = material;
+	object.pTexture = pTexture;
+	object.objectColor = objectColor;
+	object.bTransparent = bTransparent;
+	m_objects.push_back(object);
+
+	m_bTransparency = m_bTransparency || bTransparent;
+
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+	int objectIndex = (int)m_objects.size() - 1;
+
+	for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+	{
+		glm::vec3 corners[3];
+		SURFACE surface;
+		surface.object = objectIndex;
+
+		for (int c = 0; c < 3; c++)
+		{
+			const MeshGeometry::VERTEX& vertex = mesh.vertices[mesh.indices[t + c]];
+			corners[c] = glm::vec3(model * glm::vec4(vertex.position, 1.0f));
+			surface.normal[c] = normalMatrix * vertex.normal;
+			surface.uv[c] = vertex.textureCoordinate;
+		}
+
+		m_rayTracer.AddTriangle(corners[0], corners[1], corners[2]);
+		m_surfaces.push_back(surface);
+	}
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method sets the lights the scene is lit by.
+ ***********************************************************/
+void PathTracer::SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights)
+{
+	m_lights = lights;
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method sets the camera the image is seen from.  The
+ *  aspect of the projection should match the image size.
+ ***********************************************************/
+void PathTracer::SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	m_inverseViewProjection = glm::inverse(projection * view);
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method builds the bounding volume hierarchy over the
+ *  triangles of all the added objects.
+ ***********************************************************/
+void PathTracer::Build()
+{
+	std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+	m_rayTracer.Build();
+	double buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+	std::cout << "INFO: Path Tracer Scene: " << m_objects.size() << " objects, "
+		<< m_rayTracer.GetTriangleCount() << " triangles, built in "
+		<< buildMilliseconds << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method clears the image and the statistics and
+ *  starts again with new settings.
+ ***********************************************************/
+void PathTracer::Reset(const TRACE_SETTINGS& settings)
+{
+	m_settings = settings;
+	m_settings.width = std::max(m_settings.width, 1);
+	m_settings.height = std::max(m_settings.height, 1);
+	m_settings.samplesPerPass = std::max(m_settings.samplesPerPass, 1);
+	m_settings.maxBounces = std::max(m_settings.maxBounces, 0);
+
+	m_accumulation.assign((size_t)m_settings.width * m_settings.height, glm::vec3(0.0f));
+	m_sampleCount = 0;
+	m_passCount = 0;
+	m_traceSeconds = 0.0;
+}
+
+/***********************************************************
+ *  RenderPass()
+ *
+ *  This method adds one pass of samples to every pixel.  One
+ *  job per worker takes the tiles from a shared counter one
+ *  at a time, so the threads that finish cheap tiles early
+ *  keep taking more, and a large still does not need a job
+ *  for every tile.
+ ***********************************************************/
+void PathTracer::RenderPass()
+{
+	if (m_accumulation.empty() == true)
+	{
+		Reset(m_settings);
+	}
+
+	int tilesX = (m_settings.width + TILE_SIZE - 1) / TILE_SIZE;
+	int tilesY = (m_settings.height + TILE_SIZE - 1) / TILE_SIZE;
+	int tileCount = tilesX * tilesY;
+	std::atomic<int> nextTile(0);
+
+	std::chrono::steady_clock::time_point passStart = std::chrono::steady_clock::now();
+	m_pJobSystem->ParallelFor(
+		"TraceTiles",
+		m_pJobSystem->GetWorkerCount(),
+		1,
+		[this, tileCount, &nextTile](unsigned int, unsigned int)
+		{
+			for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+			{
+				TraceTile(tile);
+			}
+		});
+	m_traceSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - passStart).count();
+
+	m_sampleCount += m_settings.samplesPerPass;
+	m_passCount++;
+}
+
+/***********************************************************
+ *  TraceTile()
+ *
+ *  This method traces the samples of the current pass for
+ *  every pixel of a tile, jittered inside the pixel.  Each
+ *  pixel is written by exactly one tile, so no locks are
+ *  needed.
+ ***********************************************************/
+void PathTracer::TraceTile(int tile)
+{
+	int tilesX = (m_settings.width + TILE_SIZE - 1) / TILE_SIZE;
+	int minX = (tile % tilesX) * TILE_SIZE;
+	int minY = (tile / tilesX) * TILE_SIZE;
+	int maxX = std::min(minX + TILE_SIZE, m_settings.width);
+	int maxY = std::min(minY + TILE_SIZE, m_settings.height);
+
+	for (int y = minY; y < maxY; y++)
+	{
+		for (int x = minX; x < maxX; x++)
+		{
+			size_t pixel = (size_t)y * m_settings.width + x;
+			unsigned int randomState = HashSeed((unsigned int)pixel ^ HashSeed((unsigned int)m_passCount + 1u));
+			glm::vec3 color(0.0f);
+
+			for (int s = 0; s < m_settings.samplesPerPass; s++)
+			{
+				float pixelX = (float)x + NextRandom(randomState);
+				float pixelY = (float)y + NextRandom(randomState);
+				color += TracePath(pixelX, pixelY, randomState);
+			}
+
+			m_accumulation[pixel] += color;
+		}
+	}
+}
+
+/***********************************************************
+ *  TracePath()
+ *
+ *  This method follows one path from the camera.  Every
+ *  surface it reaches adds its direct light, the same Phong
+ *  terms the fragment shader uses but only from unshadowed
+ *  lights, and then reflects the path in a cosine weighted
+ *  direction.  The ambient term of the lights stands in for
+ *  light that is not traced, so it is only added where the
+ *  camera ray lands.
+ ***********************************************************/
+glm::vec3 PathTracer::TracePath(float pixelX, float pixelY, unsigned int& randomState) const
+{
+	float ndcX = (pixelX / (float)m_settings.width) * 2.0f - 1.0f;
+	float ndcY = 1.0f - (pixelY / (float)m_settings.height) * 2.0f;
+	glm::vec4 nearPoint = m_inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+	glm::vec4 farPoint = m_inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+	nearPoint /= nearPoint.w;
+	farPoint /= farPoint.w;
+
+	glm::vec3 origin = glm::vec3(nearPoint);
+	glm::vec3 direction = glm::normalize(glm::vec3(farPoint) - origin);
+	glm::vec3 throughput(1.0f);
+	glm::vec3 radiance(0.0f);
+
+	for (int bounce = 0; bounce <= m_settings.maxBounces; bounce++)
+	{
+		SURFACE_HIT surface;
+		if (FindSurface(origin, direction, surface, randomState) == false)
+		{
+			break;
+		}
+
+		glm::vec3 albedo = glm::vec3(surface.baseColor);
+		radiance += throughput * albedo * GatherDirectLight(surface, -direction, (bounce == 0), randomState);
+
+		throughput *= m_objects[surface.object].material.diffuseColor * albedo;
+		if (bounce >= g_RouletteBounces)
+		{
+			float survival = glm::clamp(std::max(throughput.x, std::max(throughput.y, throughput.z)), 0.05f, 1.0f);
+			if (NextRandom(randomState) >= survival)
+			{
+				break;
+			}
+			throughput /= survival;
+		}
+
+		origin = surface.position + (surface.faceNormal * m_settings.rayBias);
+		direction = SampleHemisphere(surface.normal, randomState);
+	}
+
+	return(radiance);
+}
+
+/***********************************************************
+ *  FindSurface()
+ *
+ *  This method finds the nearest surface along a ray.  A
+ *  transparent surface is hit with the probability of its
+ *  alpha and passed through otherwise, which on average
+ *  blends it with what is behind it.
+ ***********************************************************/
+bool PathTracer::FindSurface(const glm::vec3& origin, const glm::vec3& direction, SURFACE_HIT& surface, unsigned int& randomState) const
+{
+	glm::vec3 rayOrigin = origin;
+
+	for (int i = 0; i < g_MaxPassThrough; i++)
+	{
+		RayTracer::RAY_HIT hit;
+		if (m_rayTracer.Intersect(rayOrigin, direction, FLT_MAX, hit) == false)
+		{
+			return(false);
+		}
+
+		const SURFACE& triangle = m_surfaces[hit.triangle];
+		const PATH_OBJECT& object = m_objects[triangle.object];
+		float w = 1.0f - hit.u - hit.v;
+
+		glm::vec2 uv = (triangle.uv[0] * w) + (triangle.uv[1] * hit.u) + (triangle.uv[2] * hit.v);
+		glm::vec4 baseColor = object.objectColor;
+		if (NULL != object.pTexture)
+		{
+			baseColor *= object.pTexture->Sample(uv);
+		}
+
+		glm::vec3 position = rayOrigin + (direction * hit.distance);
+		if ((object.bTransparent == true) && (NextRandom(randomState) >= baseColor.a))
+		{
+			rayOrigin = position + (direction * m_settings.rayBias);
+			continue;
+		}
+
+		glm::vec3 faceNormal = glm::normalize(m_rayTracer.GetTriangleNormal(hit.triangle));
+		glm::vec3 normal = (triangle.normal[0] * w) + (triangle.normal[1] * hit.u) + (triangle.normal[2] * hit.v);
+		float normalLength = glm::length(normal);
+		normal = (normalLength > 0.0f) ? normal / normalLength : faceNormal;
+
+		// light both sides of a surface, like the planes of the scene
+		if (glm::dot(faceNormal, direction) > 0.0f)
+		{
+			faceNormal = -faceNormal;
+		}
+		if (glm::dot(normal, faceNormal) < 0.0f)
+		{
+			normal = -normal;
+		}
+
+		surface.position = position;
+		surface.normal = normal;
+		surface.faceNormal = faceNormal;
+		surface.baseColor = baseColor;
+		surface.object = triangle.object;
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IsShadowed()
+ *
+ *  This method checks whether a shadow ray is blocked before
+ *  it reaches the light.  Transparent surfaces only block it
+ *  with the probability of their alpha.
+ ***********************************************************/
+bool PathTracer::IsShadowed(const glm::vec3& origin, const glm::vec3& direction, float distance, unsigned int& randomState) const
+{
+	if (m_bTransparency == false)
+	{
+		return(m_rayTracer.IsOccluded(origin, direction, distance));
+	}
+
+	glm::vec3 rayOrigin = origin;
+	float remaining = distance;
+
+	for (int i = 0; i < g_MaxPassThrough; i++)
+	{
+		RayTracer::RAY_HIT hit;
+		if (m_rayTracer.Intersect(rayOrigin, direction, remaining, hit) == false)
+		{
+			return(false);
+		}
+
+		const SURFACE& triangle = m_surfaces[hit.triangle];
+		const PATH_OBJECT& object = m_objects[triangle.object];
+		if (object.bTransparent == false)
+		{
+			return(true);
+		}
+
+		float w = 1.0f - hit.u - hit.v;
+		glm::vec2 uv = (triangle.uv[0] * w) + (triangle.uv[1] * hit.u) + (triangle.uv[2] * hit.v);
+		float alpha = object.objectColor.a;
+		if (NULL != object.pTexture)
+		{
+			alpha *= object.pTexture->Sample(uv).a;
+		}
+		if (NextRandom(randomState) < alpha)
+		{
+			return(true);
+		}
+
+		rayOrigin += direction * (hit.distance + m_settings.rayBias);
+		remaining -= hit.distance + m_settings.rayBias;
+		if (remaining <= 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  GatherDirectLight()
+ *
+ *  This method adds up the light every source sends to a
+ *  surface point, with the same ambient, diffuse and
+ *  specular terms, range falloff and spot cone as
+ *  CalcLightSource() in the fragment shader.  The diffuse
+ *  and specular terms need a clear shadow ray.  The result
+ *  is still to be multiplied by the surface color.
+ ***********************************************************/
+glm::vec3 PathTracer::GatherDirectLight(const SURFACE_HIT& surface, const glm::vec3& viewDirection, bool bAmbient, unsigned int& randomState) const
+{
+	const PATH_MATERIAL& material = m_objects[surface.object].material;
+	glm::vec3 origin = surface.position + (surface.faceNormal * m_settings.rayBias);
+	glm::vec3 light(0.0f);
+
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		const ClusteredLighting::LIGHT_SOURCE& source = m_lights[i];
+		glm::vec3 offset = source.position - surface.position;
+		float distance = glm::length(offset);
+		if (distance <= 0.0f)
+		{
+			continue;
+		}
+		glm::vec3 lightDirection = offset / distance;
+
+		float attenuation = 1.0f;
+		if (source.range > 0.0f)
+		{
+			float falloff = glm::clamp(1.0f - std::pow(distance / source.range, 2.0f), 0.0f, 1.0f);
+			attenuation = falloff * falloff;
+		}
+		if (attenuation <= 0.0f)
+		{
+			continue;
+		}
+
+		if (bAmbient == true)
+		{
+			light += source.ambientColor * material.ambientStrength * material.ambientColor * attenuation;
+		}
+
+		float impact = std::max(glm::dot(surface.normal, lightDirection), 0.0f);
+		if ((impact <= 0.0f) || (glm::dot(surface.faceNormal, lightDirection) <= 0.0f))
+		{
+			continue;
+		}
+
+		float spotFactor = 1.0f;
+		if (source.outerConeCosine > -1.0f)
+		{
+			float theta = glm::dot(-lightDirection, glm::normalize(source.direction));
+			spotFactor = glm::smoothstep(source.outerConeCosine, source.innerConeCosine, theta);
+		}
+		if (spotFactor <= 0.0f)
+		{
+			continue;
+		}
+
+		if (IsShadowed(origin, lightDirection, distance - m_settings.rayBias, randomState) == true)
+		{
+			continue;
+		}
+
+		glm::vec3 diffuse = impact * source.diffuseColor * material.diffuseColor;
+		glm::vec3 reflectDirection = glm::reflect(-lightDirection, surface.normal);
+		float specularComponent = std::pow(std::max(glm::dot(viewDirection, reflectDirection), 0.0f), source.focalStrength);
+		glm::vec3 specular = source.specularIntensity * specularComponent * material.specularColor * source.specularColor;
+
+		light += (diffuse + specular) * spotFactor * attenuation;
+	}
+
+	return(light);
+}
+
+/***********************************************************
+ *  SaveImage()
+ *
+ *  This method averages the samples of every pixel, clamps
+ *  them the way the framebuffer does and writes the image
+ *  to an uncompressed 32-bit TGA file.
+ ***********************************************************/
+bool PathTracer::SaveImage(const char* filePath) const
+{
+	float scale = (m_sampleCount > 0) ? 1.0f / (float)m_sampleCount : 0.0f;
+	std::vector<unsigned int> pixels(m_accumulation.size());
+
+	for (size_t i = 0; i < m_accumulation.size(); i++)
+	{
+		glm::vec3 color = glm::clamp(m_accumulation[i] * scale, 0.0f, 1.0f);
+		pixels[i] =
+			(unsigned int)(color.r * 255.0f + 0.5f) |
+			((unsigned int)(color.g * 255.0f + 0.5f) << 8) |
+			((unsigned int)(color.b * 255.0f + 0.5f) << 16) |
+			(0xFFu << 24);
+	}
+
+	return(ImageWriter::WriteTGA(filePath, pixels, m_settings.width, m_settings.height));
+}
+
+/***********************************************************
+ *  GetSampleCount()
+ *
+ *  This method returns the number of samples every pixel
+ *  has received since the last reset.
+ ***********************************************************/
+int PathTracer::GetSampleCount() const
+{
+	return(m_sampleCount);
+}
+
+/***********************************************************
+ *  GetSamplesPerSecondPerCore()
+ *
+ *  This method returns how many camera samples, each with
+ *  all of its bounces and shadow rays, one worker thread
+ *  traced per second on average since the last reset.
+ ***********************************************************/
+double PathTracer::GetSamplesPerSecondPerCore() const
+{
+	if (m_traceSeconds <= 0.0)
+	{
+		return(0.0);
+	}
+
+	double samples = (double)m_accumulation.size() * (double)m_sampleCount;
+	return(samples / m_traceSeconds / (double)m_pJobSystem->GetWorkerCount());
+}
@@ -0,0 +1,156 @@
+///////////////////////////////////////////////////////////////////////////////
+// pathtracer.h
+// ============
+// path trace high resolution reference images of the scene on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "JobSystem.h"
+#include "MeshGeometry.h"
+#include "RayTracer.h"
+#include "SoftwareTexture.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  PathTracer
+ *
+ *  This class renders reference images of the same meshes,
+ *  textures, Phong materials and lights as the rasterized
+ *  paths, with shadows and diffuse interreflection.  Every
+ *  pass adds samples to each pixel, so the image converges
+ *  while it is saved after every pass.  The image is split
+ *  into square tiles that are traced on all the workers of
+ *  the job system, and the triangles are searched through
+ *  the bounding volume hierarchy of the ray tracer.
+ ***********************************************************/
+class PathTracer
+{
+public:
+	// the parts of an object's material the Phong model needs
+	struct PATH_MATERIAL
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	struct TRACE_SETTINGS
+	{
+		// size of the image in pixels
+		int width;
+		int height;
+		// samples added to every pixel by one pass
+		int samplesPerPass;
+		// diffuse bounces after the first hit
+		int maxBounces;
+		// offset along the normal that keeps rays off the surface
+		float rayBias;
+	};
+
+	// width and height of a traced tile in pixels
+	static const int TILE_SIZE = 32;
+
+	// settings for a full HD still
+	static TRACE_SETTINGS GetDefaultSettings();
+
+	// constructor
+	PathTracer(JobSystem* pJobSystem);
+	// destructor
+	~PathTracer();
+
+	// add an object that is seen, lit and casts shadows, a NULL
+	// texture uses the object color
+	void AddObject(
+		const MeshGeometry::MESH_DATA& mesh,
+		const glm::mat4& model,
+		const PATH_MATERIAL& material,
+		const SoftwareTexture* pTexture,
+		const glm::vec4& objectColor,
+		bool bTransparent);
+	// set the lights the scene is lit by
+	void SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights);
+	// set the camera the image is seen from
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	// build the hierarchy over the triangles of all the objects
+	void Build();
+
+	// clear the image and start again with new settings
+	void Reset(const TRACE_SETTINGS& settings);
+	// add one pass of samples to every pixel
+	void RenderPass();
+
+	// write the image converged so far as an uncompressed TGA file
+	bool SaveImage(const char* filePath) const;
+	// samples every pixel has received
+	int GetSampleCount() const;
+	// camera samples traced per second by each worker thread
+	double GetSamplesPerSecondPerCore() const;
+
+private:
+	struct PATH_OBJECT
+	{
+		PATH_MATERIAL material;
+		const SoftwareTexture* pTexture;
+		glm::vec4 objectColor;
+		bool bTransparent;
+	};
+
+	// world space shading data of a ray tracer triangle
+	struct SURFACE
+	{
+		glm::vec3 normal[3];
+		glm::vec2 uv[3];
+		int object;
+	};
+
+	// a surface point found by a ray
+	struct SURFACE_HIT
+	{
+		glm::vec3 position;
+		// interpolated and geometric normals facing the ray
+		glm::vec3 normal;
+		glm::vec3 faceNormal;
+		glm::vec4 baseColor;
+		int object;
+	};
+
+	// pointer to job system used to trace the tiles
+	JobSystem* m_pJobSystem;
+	TRACE_SETTINGS m_settings;
+
+	std::vector<PATH_OBJECT> m_objects;
+	std::vector<ClusteredLighting::LIGHT_SOURCE> m_lights;
+	RayTracer m_rayTracer;
+	// in the same order as the ray tracer triangles
+	std::vector<SURFACE> m_surfaces;
+	bool m_bTransparency;
+
+	glm::mat4 m_inverseViewProjection;
+	glm::vec3 m_viewPosition;
+
+	// sum of all the samples of every pixel, top row first
+	std::vector<glm::vec3> m_accumulation;
+	int m_sampleCount;
+	int m_passCount;
+	double m_traceSeconds;
+
+	// trace all the samples of one pass in one tile
+	void TraceTile(int tile);
+	// trace one camera path through a pixel position
+	glm::vec3 TracePath(float pixelX, float pixelY, unsigned int& randomState) const;
+	// find the nearest surface, passing through transparency
+	bool FindSurface(const glm::vec3& origin, const glm::vec3& direction, SURFACE_HIT& surface, unsigned int& randomState) const;
+	// check whether the light along a shadow ray is blocked
+	bool IsShadowed(const glm::vec3& origin, const glm::vec3& direction, float distance, unsigned int& randomState) const;
+	// direct light from every light source at a surface point
+	glm::vec3 GatherDirectLight(const SURFACE_HIT& surface, const glm::vec3& viewDirection, bool bAmbient, unsigned int& randomState) const;
+};
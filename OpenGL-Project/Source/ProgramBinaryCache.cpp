@@ -0,0 +1,288 @@
+///////////////////////////////////////////////////////////////////////////////
+// programbinarycache.cpp
+// ============
+// save linked shader programs to disk and reload them on the next start
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProgramBinaryCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// identifies a cache file and the layout of its header
+	const unsigned int g_CacheMagic = 0x42505347;   // "GSPB"
+	const unsigned int g_CacheVersion = 1;
+
+	struct CACHE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long driverHash;
+		unsigned long long sourceHash;
+		unsigned int binaryFormat;
+		unsigned int binaryLength;
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  64-bit FNV-1a hash, continued from the passed in value.
+	 ***********************************************************/
+	unsigned long long HashBytes(const char* data, size_t length, unsigned long long hash)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (unsigned char)data[i];
+			hash *= 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  HashGLString()
+	 *
+	 *  Add a driver string to the hash, the terminating zero
+	 *  is included so that neighbouring strings cannot run
+	 *  into each other.
+	 ***********************************************************/
+	unsigned long long HashGLString(GLenum name, unsigned long long hash)
+	{
+		const char* value = (const char*)glGetString(name);
+		if (NULL == value)
+		{
+			value = "";
+		}
+
+		return(HashBytes(value, strlen(value) + 1, hash));
+	}
+}
+
+/***********************************************************
+ *  ProgramBinaryCache()
+ *
+ *  The constructor for the class, needs a current GL context
+ *  to read the driver strings.
+ ***********************************************************/
+ProgramBinaryCache::ProgramBinaryCache(const char* cacheDirectory)
+{
+	m_cacheDirectory = cacheDirectory;
+	m_hits = 0;
+	m_misses = 0;
+
+	m_driverHash = 14695981039346656037ULL;
+	m_driverHash = HashGLString(GL_VENDOR, m_driverHash);
+	m_driverHash = HashGLString(GL_RENDERER, m_driverHash);
+	m_driverHash = HashGLString(GL_VERSION, m_driverHash);
+
+	// drivers may support the entry points but no binary formats
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	m_bSupported = (formatCount > 0);
+
+	if (m_bSupported == true)
+	{
+#ifdef _WIN32
+		_mkdir(m_cacheDirectory.c_str());
+#else
+		mkdir(m_cacheDirectory.c_str(), 0755);
+#endif
+	}
+	else
+	{
+		std::cout << "Program binaries are not supported by the driver" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ~ProgramBinaryCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ProgramBinaryCache::~ProgramBinaryCache()
+{
+}
+
+/***********************************************************
+ *  HashSource()
+ *
+ *  This method hashes the complete source of a program,
+ *  including any injected defines.
+ ***********************************************************/
+unsigned long long ProgramBinaryCache::HashSource(const std::string& source)
+{
+	return(HashBytes(source.data(), source.size(), 14695981039346656037ULL));
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method builds the cache file name for a source hash.
+ ***********************************************************/
+std::string ProgramBinaryCache::GetCachePath(unsigned long long sourceHash) const
+{
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "%016llx.bin", sourceHash);
+
+	return(m_cacheDirectory + "/" + fileName);
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method creates a program from the cached binary for
+ *  the passed in source hash.  It returns 0 when there is no
+ *  cached binary, it was made by another driver, or the
+ *  driver does not accept it any more.
+ ***********************************************************/
+GLuint ProgramBinaryCache::LoadProgram(unsigned long long sourceHash)
+{
+	if (m_bSupported == false)
+	{
+		return(0);
+	}
+
+	std::ifstream file(GetCachePath(sourceHash).c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		m_misses++;
+		return(0);
+	}
+
+	CACHE_HEADER header = {};
+	file.read((char*)&header, sizeof(header));
+
+	if ((!file) ||
+		(header.magic != g_CacheMagic) ||
+		(header.version != g_CacheVersion) ||
+		(header.driverHash != m_driverHash) ||
+		(header.sourceHash != sourceHash) ||
+		(header.binaryLength == 0))
+	{
+		m_misses++;
+		return(0);
+	}
+
+	std::vector<char> binary(header.binaryLength);
+	file.read(binary.data(), header.binaryLength);
+	if (!file)
+	{
+		m_misses++;
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	GLint status = GL_FALSE;
+
+	glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)header.binaryLength);
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+	// a driver update can reject a binary even with matching strings
+	if (status != GL_TRUE)
+	{
+		glDeleteProgram(program);
+		m_misses++;
+		return(0);
+	}
+
+	m_hits++;
+	return(program);
+}
+
+/***********************************************************
+ *  SaveProgram()
+ *
+ *  This method writes the binary of a linked program to the
+ *  cache.  The program should have been linked with the
+ *  GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+ ***********************************************************/
+bool ProgramBinaryCache::SaveProgram(unsigned long long sourceHash, GLuint program)
+{
+	if ((m_bSupported == false) || (program == 0))
+	{
+		return(false);
+	}
+
+	GLint binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return(false);
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	GLsizei writtenLength = 0;
+	glGetProgramBinary(program, binaryLength, &writtenLength, &binaryFormat, binary.data());
+	if (writtenLength <= 0)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header = {};
+	header.magic = g_CacheMagic;
+	header.version = g_CacheVersion;
+	header.driverHash = m_driverHash;
+	header.sourceHash = sourceHash;
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = (unsigned int)writtenLength;
+
+	std::ofstream file(GetCachePath(sourceHash).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write program binary:" << GetCachePath(sourceHash) << std::endl;
+		return(false);
+	}
+
+	file.write((const char*)&header, sizeof(header));
+	file.write(binary.data(), writtenLength);
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method returns whether the driver offers at least
+ *  one program binary format.
+ ***********************************************************/
+bool ProgramBinaryCache::IsSupported() const
+{
+	return(m_bSupported);
+}
+
+/***********************************************************
+ *  GetHitCount()
+ *
+ *  This method returns how many programs were loaded from
+ *  the cache.
+ ***********************************************************/
+int ProgramBinaryCache::GetHitCount() const
+{
+	return(m_hits);
+}
+
+/***********************************************************
+ *  GetMissCount()
+ *
+ *  This method returns how many programs had to be compiled
+ *  because no usable binary was cached.
+ ***********************************************************/
+int ProgramBinaryCache::GetMissCount() const
+{
+	return(m_misses);
+}
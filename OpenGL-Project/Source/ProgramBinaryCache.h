@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// programbinarycache.h
+// ============
+// save linked shader programs to disk and reload them on the next start
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+/***********************************************************
+ *  ProgramBinaryCache
+ *
+ *  This class stores the driver binary of linked programs in
+ *  a cache directory.  Each file is named after a hash of the
+ *  shader sources, and its header records the driver that
+ *  produced it, so a cached binary is only handed back to the
+ *  same vendor, renderer and version.  Anything that does not
+ *  match, or that the driver rejects, is treated as a miss
+ *  and the caller compiles the program from source.
+ ***********************************************************/
+class ProgramBinaryCache
+{
+public:
+	// constructor
+	ProgramBinaryCache(const char* cacheDirectory);
+	// destructor
+	~ProgramBinaryCache();
+
+	// hash the sources a program is built from
+	static unsigned long long HashSource(const std::string& source);
+
+	// create a program from a cached binary - returns 0 on a miss
+	GLuint LoadProgram(unsigned long long sourceHash);
+	// write the binary of a linked program to the cache
+	bool SaveProgram(unsigned long long sourceHash, GLuint program);
+
+	// whether the driver can return program binaries at all
+	bool IsSupported() const;
+
+	// cache statistics since startup
+	int GetHitCount() const;
+	int GetMissCount() const;
+
+private:
+	// directory the binaries are written to
+	std::string m_cacheDirectory;
+	// hash of the driver vendor, renderer and version strings
+	unsigned long long m_driverHash;
+	bool m_bSupported;
+	int m_hits;
+	int m_misses;
+
+	// build the file path for a source hash
+	std::string GetCachePath(unsigned long long sourceHash) const;
+};
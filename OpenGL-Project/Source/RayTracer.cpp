@@ -0,0 +1,356 @@
+///////////////////////////////////////////////////////////////////////////////
+// raytracer.cpp
+// ============
+// trace rays against the static scene triangles on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RayTracer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// largest number of triangles in a leaf
+	const int g_MaxLeafTriangles = 4;
+	// deepest hierarchy the traversal stack can hold
+	const int g_MaxTraversalDepth = 64;
+
+	/***********************************************************
+	 *  IntersectBounds()
+	 *
+	 *  Slab test of a ray against a box, returns the distance
+	 *  the ray enters the box or a negative value for a miss.
+	 ***********************************************************/
+	float IntersectBounds(
+		const glm::vec3& minimum,
+		const glm::vec3& maximum,
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		float maxDistance)
+	{
+		glm::vec3 t0 = (minimum - origin) * inverseDirection;
+		glm::vec3 t1 = (maximum - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+		return((enter <= exit) ? enter : -1.0f);
+	}
+}
+
+/***********************************************************
+ *  RayTracer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RayTracer::RayTracer()
+{
+}
+
+/***********************************************************
+ *  ~RayTracer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RayTracer::~RayTracer()
+{
+}
+
+/***********************************************************
+ *  AddTriangle()
+ *
+ *  This method adds a world space triangle.  Build() has to
+ *  be called before tracing against it.
+ ***********************************************************/
+int RayTracer::AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+	TRIANGLE triangle;
+	triangle.vertex = a;
+	triangle.edge1 = b - a;
+	triangle.edge2 = c - a;
+	m_triangles.push_back(triangle);
+
+	return((int)m_triangles.size() - 1);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method removes all the triangles.
+ ***********************************************************/
+void RayTracer::Clear()
+{
+	m_triangles.clear();
+	m_order.clear();
+	m_nodes.clear();
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method builds the hierarchy top down, splitting each
+ *  node at the median of its triangle centers along its
+ *  longest axis.
+ ***********************************************************/
+void RayTracer::Build()
+{
+	m_nodes.clear();
+	m_order.resize(m_triangles.size());
+
+	std::vector<glm::vec3> centroids(m_triangles.size());
+	for (size_t i = 0; i < m_triangles.size(); i++)
+	{
+		const TRIANGLE& triangle = m_triangles[i];
+		m_order[i] = (int)i;
+		centroids[i] = triangle.vertex + (triangle.edge1 + triangle.edge2) * (1.0f / 3.0f);
+	}
+
+	if (m_triangles.empty())
+	{
+		return;
+	}
+
+	NODE root;
+	root.first = 0;
+	root.count = (int)m_triangles.size();
+	m_nodes.reserve(m_triangles.size() * 2);
+	m_nodes.push_back(root);
+
+	Subdivide(0, centroids);
+}
+
+/***********************************************************
+ *  Subdivide()
+ *
+ *  This method fits the bounds of a node around its
+ *  triangles and splits it in two while it holds too many.
+ ***********************************************************/
+void RayTracer::Subdivide(int nodeIndex, std::vector<glm::vec3>& centroids)
+{
+	int first = m_nodes[nodeIndex].first;
+	int count = m_nodes[nodeIndex].count;
+
+	glm::vec3 minimum(1e30f);
+	glm::vec3 maximum(-1e30f);
+	glm::vec3 centroidMinimum(1e30f);
+	glm::vec3 centroidMaximum(-1e30f);
+
+	for (int i = first; i < first + count; i++)
+	{
+		const TRIANGLE& triangle = m_triangles[m_order[i]];
+		glm::vec3 b = triangle.vertex + triangle.edge1;
+		glm::vec3 c = triangle.vertex + triangle.edge2;
+
+		minimum = glm::min(minimum, glm::min(triangle.vertex, glm::min(b, c)));
+		maximum = glm::max(maximum, glm::max(triangle.vertex, glm::max(b, c)));
+		centroidMinimum = glm::min(centroidMinimum, centroids[m_order[i]]);
+		centroidMaximum = glm::max(centroidMaximum, centroids[m_order[i]]);
+	}
+
+	m_nodes[nodeIndex].boundsMinimum = minimum;
+	m_nodes[nodeIndex].boundsMaximum = maximum;
+
+	if (count <= g_MaxLeafTriangles)
+	{
+		return;
+	}
+
+	glm::vec3 extent = centroidMaximum - centroidMinimum;
+	int axis = 0;
+	if (extent.y > extent.x)
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	// all the centers in one spot can not be split any further
+	if (extent[axis] <= 0.0f)
+	{
+		return;
+	}
+
+	int half = count / 2;
+	std::nth_element(
+		m_order.begin() + first,
+		m_order.begin() + first + half,
+		m_order.begin() + first + count,
+		[&centroids, axis](int a, int b) { return(centroids[a][axis] < centroids[b][axis]); });
+
+	int leftIndex = (int)m_nodes.size();
+	NODE left;
+	left.first = first;
+	left.count = half;
+	NODE right;
+	right.first = first + half;
+	right.count = count - half;
+	m_nodes.push_back(left);
+	m_nodes.push_back(right);
+
+	m_nodes[nodeIndex].first = leftIndex;
+	m_nodes[nodeIndex].count = 0;
+
+	Subdivide(leftIndex, centroids);
+	Subdivide(leftIndex + 1, centroids);
+}
+
+/***********************************************************
+ *  Trace()
+ *
+ *  This method walks the hierarchy near child first and
+ *  tests the triangles of the leaves the ray reaches with
+ *  the Moller-Trumbore test.
+ ***********************************************************/
+bool RayTracer::Trace(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool bAnyHit, RAY_HIT& hit) const
+{
+	if (m_nodes.empty())
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection(
+		1.0f / ((direction.x != 0.0f) ? direction.x : 1e-20f),
+		1.0f / ((direction.y != 0.0f) ? direction.y : 1e-20f),
+		1.0f / ((direction.z != 0.0f) ? direction.z : 1e-20f));
+
+	bool bHit = false;
+	hit.distance = maxDistance;
+	hit.triangle = -1;
+	hit.u = 0.0f;
+	hit.v = 0.0f;
+
+	int stack[g_MaxTraversalDepth];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const NODE& node = m_nodes[stack[--stackSize]];
+
+		if (IntersectBounds(node.boundsMinimum, node.boundsMaximum, origin, inverseDirection, hit.distance) < 0.0f)
+		{
+			continue;
+		}
+
+		if (node.count == 0)
+		{
+			// visit the nearer child first by pushing it last
+			const NODE& left = m_nodes[node.first];
+			const NODE& right = m_nodes[node.first + 1];
+			float leftDistance = IntersectBounds(left.boundsMinimum, left.boundsMaximum, origin, inverseDirection, hit.distance);
+			float rightDistance = IntersectBounds(right.boundsMinimum, right.boundsMaximum, origin, inverseDirection, hit.distance);
+
+			if ((leftDistance >= 0.0f) && (rightDistance >= 0.0f))
+			{
+				bool bLeftFirst = (leftDistance <= rightDistance);
+				stack[stackSize++] = bLeftFirst ? (node.first + 1) : node.first;
+				stack[stackSize++] = bLeftFirst ? node.first : (node.first + 1);
+			}
+			else if (leftDistance >= 0.0f)
+			{
+				stack[stackSize++] = node.first;
+			}
+			else if (rightDistance >= 0.0f)
+			{
+				stack[stackSize++] = node.first + 1;
+			}
+			continue;
+		}
+
+		for (int i = node.first; i < node.first + node.count; i++)
+		{
+			const TRIANGLE& triangle = m_triangles[m_order[i]];
+
+			glm::vec3 p = glm::cross(direction, triangle.edge2);
+			float determinant = glm::dot(triangle.edge1, p);
+			if (std::fabs(determinant) < 1e-12f)
+			{
+				continue;
+			}
+
+			float inverseDeterminant = 1.0f / determinant;
+			glm::vec3 s = origin - triangle.vertex;
+			float u = glm::dot(s, p) * inverseDeterminant;
+			if ((u < 0.0f) || (u > 1.0f))
+			{
+				continue;
+			}
+
+			glm::vec3 q = glm::cross(s, triangle.edge1);
+			float v = glm::dot(direction, q) * inverseDeterminant;
+			if ((v < 0.0f) || (u + v > 1.0f))
+			{
+				continue;
+			}
+
+			float distance = glm::dot(triangle.edge2, q) * inverseDeterminant;
+			if ((distance > 0.0f) && (distance < hit.distance))
+			{
+				hit.distance = distance;
+				hit.triangle = m_order[i];
+				hit.u = u;
+				hit.v = v;
+				bHit = true;
+
+				if (bAnyHit == true)
+				{
+					return(true);
+				}
+			}
+		}
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method finds the nearest triangle along a ray.
+ ***********************************************************/
+bool RayTracer::Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const
+{
+	return(Trace(origin, direction, maxDistance, false, hit));
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method returns whether any triangle blocks a ray,
+ *  stopping at the first one found.
+ ***********************************************************/
+bool RayTracer::IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	RAY_HIT hit;
+
+	return(Trace(origin, direction, maxDistance, true, hit));
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method returns the number of added triangles.
+ ***********************************************************/
+int RayTracer::GetTriangleCount() const
+{
+	return((int)m_triangles.size());
+}
+
+/***********************************************************
+ *  GetTriangleNormal()
+ *
+ *  This method returns the geometric normal of a triangle,
+ *  facing the side its vertices wind counter-clockwise on.
+ ***********************************************************/
+glm::vec3 RayTracer::GetTriangleNormal(int triangle) const
+{
+	return(glm::cross(m_triangles[triangle].edge1, m_triangles[triangle].edge2));
+}
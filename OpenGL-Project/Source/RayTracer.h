@@ -0,0 +1,86 @@
+///////////////////////////////////////////////////////////////////////////////
+// raytracer.h
+// ============
+// trace rays against the static scene triangles on the CPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  RayTracer
+ *
+ *  This class holds world space triangles in a bounding
+ *  volume hierarchy and answers closest hit and occlusion
+ *  queries against them.  After Build() the structure is
+ *  only read, so any number of threads can trace at once.
+ ***********************************************************/
+class RayTracer
+{
+public:
+	// result of a closest hit query
+	struct RAY_HIT
+	{
+		float distance;
+		// index of the triangle in the order it was added
+		int triangle;
+		// barycentric weights of the second and third vertex
+		float u;
+		float v;
+	};
+
+	// constructor
+	RayTracer();
+	// destructor
+	~RayTracer();
+
+	// add a triangle, returns its index
+	int AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+	// build the hierarchy over all the added triangles
+	void Build();
+	// remove all the triangles
+	void Clear();
+
+	// find the nearest triangle hit by a ray within a distance
+	bool Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const;
+	// check whether anything blocks a ray within a distance
+	bool IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+	int GetTriangleCount() const;
+	// geometric normal of a triangle, not normalized
+	glm::vec3 GetTriangleNormal(int triangle) const;
+
+private:
+	struct TRIANGLE
+	{
+		glm::vec3 vertex;
+		glm::vec3 edge1;
+		glm::vec3 edge2;
+	};
+
+	// a node is a leaf when count is not zero, then first is its
+	// first triangle, otherwise first is its left child and the
+	// right child follows it
+	struct NODE
+	{
+		glm::vec3 boundsMinimum;
+		glm::vec3 boundsMaximum;
+		int first;
+		int count;
+	};
+
+	std::vector<TRIANGLE> m_triangles;
+	// triangle indices in the order the leaves reference them
+	std::vector<int> m_order;
+	std::vector<NODE> m_nodes;
+
+	// split the triangles of a node until the leaves are small
+	void Subdivide(int nodeIndex, std::vector<glm::vec3>& centroids);
+	// walk the hierarchy, stopping at the first hit if asked to
+	bool Trace(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool bAnyHit, RAY_HIT& hit) const;
+};
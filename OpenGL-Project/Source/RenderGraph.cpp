@@ -0,0 +1,826 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendergraph.cpp
+// ============
+// schedule the render passes of a frame and share their render targets
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// what the first writer of a texture clears it to
+	const GLfloat g_ClearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	const GLfloat g_ClearDepth = 1.0f;
+
+	// add an index to a list unless it is already there, false
+	// when the list is full
+	bool AddUnique(int* pList, int& count, int capacity, int value)
+	{
+		if (std::find(pList, pList + count, value) != pList + count)
+		{
+			return(true);
+		}
+		if (count >= capacity)
+		{
+			return(false);
+		}
+
+		pList[count++] = value;
+		return(true);
+	}
+
+	// bytes one texel of a format takes
+	int GetTexelBytes(GLenum format)
+	{
+		switch (format)
+		{
+		case GL_RGBA16F:
+			return(8);
+		case GL_RGBA32F:
+			return(16);
+		default:
+			return(4);
+		}
+	}
+}
+
+/***********************************************************
+ *  RenderGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderGraph::RenderGraph(GLStateCache* pStateCache, FrameArena* pArena)
+{
+	m_pStateCache = pStateCache;
+	m_pArena = pArena;
+	m_bDeclared = true;
+	m_bCompiled = false;
+}
+
+/***********************************************************
+ *  ~RenderGraph()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderGraph::~RenderGraph()
+{
+	DestroyFramebuffers();
+	for (size_t i = 0; i < m_physicalTextures.size(); i++)
+	{
+		glDeleteTextures(1, &m_physicalTextures[i].texture);
+	}
+	// GL hands the deleted names out again, so the cache must
+	// not take a new texture for one it thinks is still bound
+	if ((NULL != m_pStateCache) && (m_physicalTextures.empty() == false))
+	{
+		m_pStateCache->InvalidateTextures();
+	}
+	m_physicalTextures.clear();
+	m_pStateCache = NULL;
+	m_pArena = NULL;
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method starts the declaration of a new frame.  The
+ *  lists of the last frame were in the frame arena, which
+ *  has dropped them already.
+ ***********************************************************/
+void RenderGraph::Reset()
+{
+	m_textures.clear();
+	m_passes.clear();
+	m_schedule.clear();
+	m_bDeclared = true;
+	m_bCompiled = false;
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method declares a texture that is written and read
+ *  by the passes of this frame only.
+ ***********************************************************/
+int RenderGraph::CreateTexture(const char* name, const TEXTURE_DESC& desc)
+{
+	GRAPH_TEXTURE texture;
+	texture.name = name;
+	texture.desc = desc;
+	texture.bBackbuffer = false;
+	texture.physical = -1;
+	texture.firstUse = -1;
+	texture.lastUse = -1;
+	m_textures.push_back(texture);
+
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  ImportBackbuffer()
+ *
+ *  This method declares the color or the depth buffer of
+ *  the window.
+ ***********************************************************/
+int RenderGraph::ImportBackbuffer(const char* name, const TEXTURE_DESC& desc)
+{
+	int texture = CreateTexture(name, desc);
+	m_textures[texture].bBackbuffer = true;
+
+	return(texture);
+}
+
+/***********************************************************
+ *  AddPassCallback()
+ *
+ *  This method declares a pass.  Its reads and writes have
+ *  to be declared before the next pass is added, since the
+ *  declaration order decides the versions of the textures.
+ ***********************************************************/
+int RenderGraph::AddPassCallback(const char* name, void (*pRun)(void*), void* pCallable)
+{
+	GRAPH_PASS pass;
+	pass.name = name;
+	pass.pRun = pRun;
+	pass.pCallable = pCallable;
+	pass.pReads = m_pArena->AllocateArray<int>(MAX_PASS_TEXTURES);
+	pass.readCount = 0;
+	pass.pWrites = m_pArena->AllocateArray<int>(MAX_PASS_TEXTURES);
+	pass.writeCount = 0;
+	pass.viewportWidth = 0;
+	pass.viewportHeight = 0;
+	pass.bSideEffect = false;
+	pass.bCulled = false;
+	pass.pDataDependencies = NULL;
+	pass.dataDependencyCount = 0;
+	pass.pOrderDependencies = NULL;
+	pass.orderDependencyCount = 0;
+	pass.pClears = NULL;
+	pass.clearCount = 0;
+	m_passes.push_back(pass);
+
+	return((int)m_passes.size() - 1);
+}
+
+/***********************************************************
+ *  ReadTexture()
+ *
+ *  This method declares that a pass samples a texture.
+ ***********************************************************/
+void RenderGraph::ReadTexture(int pass, int texture)
+{
+	GRAPH_PASS& graphPass = m_passes[pass];
+	if (AddUnique(graphPass.pReads, graphPass.readCount, MAX_PASS_TEXTURES, texture) == false)
+	{
+		std::cout << "Render pass " << graphPass.name << " reads more than "
+			<< MAX_PASS_TEXTURES << " textures" << std::endl;
+		m_bDeclared = false;
+	}
+}
+
+/***********************************************************
+ *  WriteTexture()
+ *
+ *  This method declares that a pass renders into a texture.
+ ***********************************************************/
+void RenderGraph::WriteTexture(int pass, int texture)
+{
+	GRAPH_PASS& graphPass = m_passes[pass];
+	if (AddUnique(graphPass.pWrites, graphPass.writeCount, MAX_PASS_TEXTURES, texture) == false)
+	{
+		std::cout << "Render pass " << graphPass.name << " writes more than "
+			<< MAX_PASS_TEXTURES << " textures" << std::endl;
+		m_bDeclared = false;
+	}
+}
+
+/***********************************************************
+ *  SetViewport()
+ *
+ *  This method sets the size of the area of the attachments
+ *  the pass renders to.
+ ***********************************************************/
+void RenderGraph::SetViewport(int pass, int width, int height)
+{
+	m_passes[pass].viewportWidth = width;
+	m_passes[pass].viewportHeight = height;
+}
+
+/***********************************************************
+ *  SetSideEffect()
+ *
+ *  This method keeps a pass from being culled, for work like
+ *  queries that no other pass reads.
+ ***********************************************************/
+void RenderGraph::SetSideEffect(int pass)
+{
+	m_passes[pass].bSideEffect = true;
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method turns the declared passes into the schedule
+ *  that Execute() runs.
+ ***********************************************************/
+bool RenderGraph::Compile()
+{
+	m_schedule.clear();
+	m_bCompiled = false;
+
+	if ((m_bDeclared == false) || (FindDependencies() == false))
+	{
+		return(false);
+	}
+
+	CullPasses();
+	SchedulePasses();
+	AllocateTextures();
+
+	m_bCompiled = true;
+	return(true);
+}
+
+/***********************************************************
+ *  FindDependencies()
+ *
+ *  This method walks the passes in the order they were
+ *  declared.  A read depends on the last pass that wrote the
+ *  texture.  A write depends on the last writer too, since
+ *  it draws over what that pass left, and has to wait for
+ *  the passes that read the older version.  The attachments
+ *  of a pass have to be all window buffers or all textures,
+ *  with at most one depth buffer.  Every list has room for
+ *  all the passes, which no list can hold more of.
+ ***********************************************************/
+bool RenderGraph::FindDependencies()
+{
+	int passCount = (int)m_passes.size();
+	int textureCount = (int)m_textures.size();
+
+	// the readers since the last write of a texture are a row
+	// of passCount entries
+	int* pLastWriter = m_pArena->AllocateArray<int>(textureCount);
+	int* pReaders = m_pArena->AllocateArray<int>(textureCount * passCount);
+	int* pReaderCounts = m_pArena->AllocateArray<int>(textureCount);
+	for (int i = 0; i < textureCount; i++)
+	{
+		pLastWriter[i] = -1;
+		pReaderCounts[i] = 0;
+	}
+
+	for (int i = 0; i < passCount; i++)
+	{
+		GRAPH_PASS& pass = m_passes[i];
+		pass.pDataDependencies = m_pArena->AllocateArray<int>(passCount);
+		pass.dataDependencyCount = 0;
+		pass.pOrderDependencies = m_pArena->AllocateArray<int>(passCount);
+		pass.orderDependencyCount = 0;
+		pass.pClears = m_pArena->AllocateArray<int>(MAX_PASS_TEXTURES);
+		pass.clearCount = 0;
+		pass.bCulled = false;
+
+		for (int j = 0; j < pass.readCount; j++)
+		{
+			int texture = pass.pReads[j];
+			if (pLastWriter[texture] < 0)
+			{
+				std::cout << "Render pass " << pass.name << " reads " << m_textures[texture].name
+					<< " before any pass writes it" << std::endl;
+				return(false);
+			}
+			AddUnique(pass.pDataDependencies, pass.dataDependencyCount, passCount, pLastWriter[texture]);
+			pReaders[texture * passCount + pReaderCounts[texture]] = i;
+			pReaderCounts[texture]++;
+		}
+
+		int backbufferCount = 0;
+		int depthCount = 0;
+		for (int j = 0; j < pass.writeCount; j++)
+		{
+			int texture = pass.pWrites[j];
+			if (pLastWriter[texture] >= 0)
+			{
+				AddUnique(pass.pDataDependencies, pass.dataDependencyCount, passCount, pLastWriter[texture]);
+			}
+			for (int k = 0; k < pReaderCounts[texture]; k++)
+			{
+				int reader = pReaders[texture * passCount + k];
+				if (reader != i)
+				{
+					AddUnique(pass.pOrderDependencies, pass.orderDependencyCount, passCount, reader);
+				}
+			}
+			pLastWriter[texture] = i;
+			pReaderCounts[texture] = 0;
+
+			backbufferCount += (m_textures[texture].bBackbuffer == true) ? 1 : 0;
+			depthCount += (IsDepthFormat(m_textures[texture].desc.format) == true) ? 1 : 0;
+		}
+
+		if (((backbufferCount > 0) && (backbufferCount < pass.writeCount)) || (depthCount > 1))
+		{
+			std::cout << "Render pass " << pass.name << " mixes window and texture attachments" << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CullPasses()
+ *
+ *  This method keeps the passes that write the window or
+ *  have side effects, and every pass whose output they use,
+ *  and culls the rest.  Dependencies always point to passes
+ *  declared earlier, so one walk backwards finds them all.
+ ***********************************************************/
+void RenderGraph::CullPasses()
+{
+	bool* bNeeded = m_pArena->AllocateArray<bool>((int)m_passes.size());
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		bNeeded[i] = false;
+	}
+
+	for (int i = (int)m_passes.size() - 1; i >= 0; i--)
+	{
+		const GRAPH_PASS& pass = m_passes[i];
+		if (pass.bSideEffect == true)
+		{
+			bNeeded[i] = true;
+		}
+		for (int j = 0; j < pass.writeCount; j++)
+		{
+			if (m_textures[pass.pWrites[j]].bBackbuffer == true)
+			{
+				bNeeded[i] = true;
+			}
+		}
+
+		if (bNeeded[i] == true)
+		{
+			for (int j = 0; j < pass.dataDependencyCount; j++)
+			{
+				bNeeded[pass.pDataDependencies[j]] = true;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		m_passes[i].bCulled = !bNeeded[i];
+	}
+}
+
+/***********************************************************
+ *  SchedulePasses()
+ *
+ *  This method orders the passes that run so every pass
+ *  comes after the ones it depends on.  Of the passes that
+ *  are ready, the one that uses the most textures already in
+ *  use and starts the fewest new ones goes first, which
+ *  keeps the lifetimes short and lets more textures share
+ *  memory.  Ties go to the pass declared first.
+ ***********************************************************/
+void RenderGraph::SchedulePasses()
+{
+	bool* bScheduled = m_pArena->AllocateArray<bool>((int)m_passes.size());
+	bool* bStarted = m_pArena->AllocateArray<bool>((int)m_textures.size());
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		m_textures[i].firstUse = -1;
+		m_textures[i].lastUse = -1;
+		bStarted[i] = false;
+	}
+
+	int runCount = 0;
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		runCount += (m_passes[i].bCulled == false) ? 1 : 0;
+		bScheduled[i] = false;
+	}
+
+	while ((int)m_schedule.size() < runCount)
+	{
+		int bestPass = -1;
+		int bestScore = 0;
+		for (int i = 0; i < (int)m_passes.size(); i++)
+		{
+			const GRAPH_PASS& pass = m_passes[i];
+			if ((pass.bCulled == true) || (bScheduled[i] == true))
+			{
+				continue;
+			}
+
+			// culled passes never run, so they are not waited for
+			bool bReady = true;
+			for (int j = 0; (j < pass.dataDependencyCount) && (bReady == true); j++)
+			{
+				bReady = bScheduled[pass.pDataDependencies[j]];
+			}
+			for (int j = 0; (j < pass.orderDependencyCount) && (bReady == true); j++)
+			{
+				int dependency = pass.pOrderDependencies[j];
+				bReady = bScheduled[dependency] || m_passes[dependency].bCulled;
+			}
+			if (bReady == false)
+			{
+				continue;
+			}
+
+			int score = 0;
+			for (int j = 0; j < pass.readCount; j++)
+			{
+				score += (bStarted[pass.pReads[j]] == true) ? 1 : -1;
+			}
+			for (int j = 0; j < pass.writeCount; j++)
+			{
+				score += (bStarted[pass.pWrites[j]] == true) ? 1 : -1;
+			}
+			if ((bestPass < 0) || (score > bestScore))
+			{
+				bestPass = i;
+				bestScore = score;
+			}
+		}
+
+		int position = (int)m_schedule.size();
+		GRAPH_PASS& pass = m_passes[bestPass];
+		bScheduled[bestPass] = true;
+		m_schedule.push_back(bestPass);
+
+		for (int j = 0; j < pass.readCount; j++)
+		{
+			m_textures[pass.pReads[j]].lastUse = position;
+		}
+		for (int j = 0; j < pass.writeCount; j++)
+		{
+			GRAPH_TEXTURE& texture = m_textures[pass.pWrites[j]];
+			if (bStarted[pass.pWrites[j]] == false)
+			{
+				texture.firstUse = position;
+				pass.pClears[pass.clearCount++] = pass.pWrites[j];
+			}
+			texture.lastUse = position;
+			bStarted[pass.pWrites[j]] = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  AllocateTextures()
+ *
+ *  This method gives the frame textures GL textures in the
+ *  order they are first used.  A pooled texture of the same
+ *  size and format is taken once the last pass of the
+ *  texture it held has run.  Pooled textures this frame
+ *  does not need, like the ones of an old window size, are
+ *  freed.
+ ***********************************************************/
+void RenderGraph::AllocateTextures()
+{
+	for (size_t i = 0; i < m_physicalTextures.size(); i++)
+	{
+		m_physicalTextures[i].busyUntil = -1;
+		m_physicalTextures[i].bAssigned = false;
+	}
+
+	int* pOrder = m_pArena->AllocateArray<int>((int)m_textures.size());
+	int orderCount = 0;
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		m_textures[i].physical = -1;
+		if ((m_textures[i].bBackbuffer == false) && (m_textures[i].firstUse >= 0))
+		{
+			pOrder[orderCount++] = i;
+		}
+	}
+	std::sort(pOrder, pOrder + orderCount, [this](int first, int second)
+		{
+			return(m_textures[first].firstUse < m_textures[second].firstUse);
+		});
+
+	for (int i = 0; i < orderCount; i++)
+	{
+		GRAPH_TEXTURE& texture = m_textures[pOrder[i]];
+
+		int physical = -1;
+		for (int j = 0; (j < (int)m_physicalTextures.size()) && (physical < 0); j++)
+		{
+			if ((IsSameDesc(m_physicalTextures[j].desc, texture.desc) == true) &&
+				(m_physicalTextures[j].busyUntil < texture.firstUse))
+			{
+				physical = j;
+			}
+		}
+
+		if (physical < 0)
+		{
+			PHYSICAL_TEXTURE created;
+			created.desc = texture.desc;
+			created.busyUntil = -1;
+			created.bAssigned = false;
+
+			glGenTextures(1, &created.texture);
+			m_pStateCache->BindTexture(GL_TEXTURE_2D, created.texture);
+			glTexStorage2D(GL_TEXTURE_2D, 1, texture.desc.format, texture.desc.width, texture.desc.height);
+			GLint filter = (IsDepthFormat(texture.desc.format) == true) ? GL_NEAREST : GL_LINEAR;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			m_pStateCache->BindTexture(GL_TEXTURE_2D, 0);
+
+			m_physicalTextures.push_back(created);
+			physical = (int)m_physicalTextures.size() - 1;
+		}
+
+		m_physicalTextures[physical].busyUntil = texture.lastUse;
+		m_physicalTextures[physical].bAssigned = true;
+		texture.physical = physical;
+	}
+
+	// free the unneeded pool textures and renumber the rest,
+	// moving them down in place
+	int* pRemap = m_pArena->AllocateArray<int>((int)m_physicalTextures.size());
+	int keptCount = 0;
+	for (size_t i = 0; i < m_physicalTextures.size(); i++)
+	{
+		if (m_physicalTextures[i].bAssigned == true)
+		{
+			pRemap[i] = keptCount;
+			m_physicalTextures[keptCount++] = m_physicalTextures[i];
+		}
+		else
+		{
+			pRemap[i] = -1;
+			glDeleteTextures(1, &m_physicalTextures[i].texture);
+		}
+	}
+	if (keptCount != (int)m_physicalTextures.size())
+	{
+		// the deleted names may still be bound in the cache, and
+		// framebuffers of deleted textures lose their attachments
+		m_pStateCache->InvalidateTextures();
+		DestroyFramebuffers();
+		m_physicalTextures.resize(keptCount);
+		for (size_t i = 0; i < m_textures.size(); i++)
+		{
+			if (m_textures[i].physical >= 0)
+			{
+				m_textures[i].physical = pRemap[m_textures[i].physical];
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method runs the scheduled passes, each with its
+ *  attachments bound, its viewport set and the attachments
+ *  it writes first cleared, and leaves the window bound.
+ ***********************************************************/
+void RenderGraph::Execute()
+{
+	if (m_bCompiled == false)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_schedule.size(); i++)
+	{
+		const GRAPH_PASS& pass = m_passes[m_schedule[i]];
+
+		if (pass.writeCount > 0)
+		{
+			if (BindPassTargets(pass) == false)
+			{
+				continue;
+			}
+
+			const TEXTURE_DESC& desc = m_textures[pass.pWrites[0]].desc;
+			int width = (pass.viewportWidth > 0) ? pass.viewportWidth : desc.width;
+			int height = (pass.viewportHeight > 0) ? pass.viewportHeight : desc.height;
+			glViewport(0, 0, width, height);
+
+			ClearPassTargets(pass);
+		}
+
+		pass.pRun(pass.pCallable);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  BindPassTargets()
+ *
+ *  This method binds the window, or a framebuffer with the
+ *  pass's textures attached, made the first time those
+ *  textures are used together.
+ ***********************************************************/
+bool RenderGraph::BindPassTargets(const GRAPH_PASS& pass)
+{
+	if (m_textures[pass.pWrites[0]].bBackbuffer == true)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return(true);
+	}
+
+	FRAMEBUFFER_KEY key;
+	key.fill(0);
+	int colorCount = 0;
+	for (int i = 0; i < pass.writeCount; i++)
+	{
+		const GRAPH_TEXTURE& texture = m_textures[pass.pWrites[i]];
+		GLuint glTexture = m_physicalTextures[texture.physical].texture;
+		if (IsDepthFormat(texture.desc.format) == true)
+		{
+			key[MAX_PASS_TEXTURES] = glTexture;
+		}
+		else
+		{
+			key[colorCount++] = glTexture;
+		}
+	}
+	GLuint depthTexture = key[MAX_PASS_TEXTURES];
+
+	std::map<FRAMEBUFFER_KEY, GLuint>::const_iterator found = m_framebuffers.find(key);
+	if (found != m_framebuffers.end())
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, found->second);
+		return(true);
+	}
+
+	GLuint framebuffer = 0;
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	GLenum drawBuffers[MAX_PASS_TEXTURES];
+	for (int i = 0; i < colorCount; i++)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, key[i], 0);
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+	}
+	if (depthTexture != 0)
+	{
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+	}
+	if (colorCount > 0)
+	{
+		glDrawBuffers(colorCount, &drawBuffers[0]);
+	}
+	else
+	{
+		glDrawBuffer(GL_NONE);
+	}
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Render pass " << pass.name << " has an incomplete framebuffer" << std::endl;
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glDeleteFramebuffers(1, &framebuffer);
+		return(false);
+	}
+
+	m_framebuffers[key] = framebuffer;
+	return(true);
+}
+
+/***********************************************************
+ *  ClearPassTargets()
+ *
+ *  This method clears the attachments that get their first
+ *  write of the frame from this pass.  Pooled textures may
+ *  hold another texture's contents from earlier in the
+ *  frame, so they are never assumed to be empty.
+ ***********************************************************/
+void RenderGraph::ClearPassTargets(const GRAPH_PASS& pass)
+{
+	if (pass.clearCount == 0)
+	{
+		return;
+	}
+
+	// clears obey the write masks
+	m_pStateCache->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	m_pStateCache->DepthMask(GL_TRUE);
+
+	for (int i = 0; i < pass.clearCount; i++)
+	{
+		const GRAPH_TEXTURE& texture = m_textures[pass.pClears[i]];
+		if (IsDepthFormat(texture.desc.format) == true)
+		{
+			glClearBufferfv(GL_DEPTH, 0, &g_ClearDepth);
+			continue;
+		}
+
+		// the draw buffer index is the position among the colors
+		int drawBuffer = 0;
+		for (int j = 0; (j < pass.writeCount) && (pass.pWrites[j] != pass.pClears[i]); j++)
+		{
+			drawBuffer += (IsDepthFormat(m_textures[pass.pWrites[j]].desc.format) == false) ? 1 : 0;
+		}
+		glClearBufferfv(GL_COLOR, drawBuffer, g_ClearColor);
+	}
+}
+
+/***********************************************************
+ *  DestroyFramebuffers()
+ *
+ *  This method frees all the cached framebuffers.
+ ***********************************************************/
+void RenderGraph::DestroyFramebuffers()
+{
+	std::map<FRAMEBUFFER_KEY, GLuint>::iterator it;
+	for (it = m_framebuffers.begin(); it != m_framebuffers.end(); ++it)
+	{
+		glDeleteFramebuffers(1, &it->second);
+	}
+	m_framebuffers.clear();
+}
+
+/***********************************************************
+ *  GetTexture()
+ *
+ *  This method returns the GL texture a frame texture was
+ *  given, 0 for the window buffers.
+ ***********************************************************/
+GLuint RenderGraph::GetTexture(int texture) const
+{
+	int physical = m_textures[texture].physical;
+
+	return((physical >= 0) ? m_physicalTextures[physical].texture : 0);
+}
+
+/***********************************************************
+ *  GetTextureDesc()
+ *
+ *  This method returns the size and format of a texture.
+ ***********************************************************/
+const RenderGraph::TEXTURE_DESC& RenderGraph::GetTextureDesc(int texture) const
+{
+	return(m_textures[texture].desc);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method prints how many passes ran and were culled,
+ *  and how much memory the frame textures share.
+ ***********************************************************/
+void RenderGraph::Report() const
+{
+	int frameTextures = 0;
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		frameTextures += (m_textures[i].physical >= 0) ? 1 : 0;
+	}
+
+	double megabytes = 0.0;
+	for (size_t i = 0; i < m_physicalTextures.size(); i++)
+	{
+		const TEXTURE_DESC& desc = m_physicalTextures[i].desc;
+		megabytes += (double)desc.width * desc.height * GetTexelBytes(desc.format) / (1024.0 * 1024.0);
+	}
+
+	std::cout << "INFO: Render Graph: " << m_schedule.size() << " of " << m_passes.size() << " passes run (";
+	for (size_t i = 0; i < m_schedule.size(); i++)
+	{
+		std::cout << ((i > 0) ? ", " : "") << m_passes[m_schedule[i]].name;
+	}
+	std::cout << "), " << frameTextures << " frame textures in " << m_physicalTextures.size()
+		<< " GL textures, " << megabytes << " MB" << std::endl;
+}
+
+/***********************************************************
+ *  IsDepthFormat()
+ *
+ *  This method returns whether a format is a depth format.
+ ***********************************************************/
+bool RenderGraph::IsDepthFormat(GLenum format)
+{
+	return((format == GL_DEPTH_COMPONENT16) || (format == GL_DEPTH_COMPONENT24) ||
+		(format == GL_DEPTH_COMPONENT32F) || (format == GL_DEPTH24_STENCIL8));
+}
+
+/***********************************************************
+ *  IsSameDesc()
+ *
+ *  This method returns whether two textures can share one
+ *  GL texture.
+ ***********************************************************/
+bool RenderGraph::IsSameDesc(const TEXTURE_DESC& first, const TEXTURE_DESC& second)
+{
+	return((first.width == second.width) && (first.height == second.height) && (first.format == second.format));
+}
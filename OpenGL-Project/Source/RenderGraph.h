@@ -0,0 +1,202 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendergraph.h
+// ============
+// schedule the render passes of a frame and share their render targets
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FrameArena.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <array>
+#include <map>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/***********************************************************
+ *  RenderGraph
+ *
+ *  This class is rebuilt every frame from the passes of the
+ *  frame and the textures they read and write.  The order
+ *  the passes and their reads and writes are declared in
+ *  decides which version of a texture each pass sees.  When
+ *  the frame is compiled, passes that add nothing to the
+ *  window or to a pass with side effects are culled, the
+ *  rest are ordered by their dependencies, and textures
+ *  that only live inside the frame are given GL textures
+ *  from a pool.  Two such textures with the same size and
+ *  format whose lifetimes do not overlap share one GL
+ *  texture, so new passes only need new memory where their
+ *  targets are alive at the same time.  The first pass that
+ *  writes a texture clears it.  What is declared for a
+ *  frame, down to the callables of the passes, is kept in
+ *  the frame arena, so building the graph every frame does
+ *  not touch the heap.
+ ***********************************************************/
+class RenderGraph
+{
+public:
+	struct TEXTURE_DESC
+	{
+		int width;
+		int height;
+		// sized internal format, GL_DEPTH_COMPONENT24 makes a
+		// depth attachment
+		GLenum format;
+	};
+
+	// textures a pass may read, and write, at most
+	static const int MAX_PASS_TEXTURES = 8;
+
+	// constructor
+	RenderGraph(GLStateCache* pStateCache, FrameArena* pArena);
+	// destructor
+	~RenderGraph();
+
+	// forget the passes and textures of the last frame, the
+	// pooled GL textures are kept - the frame arena has to be
+	// in the frame that is declared next
+	void Reset();
+	// a texture that only lives inside the frame
+	int CreateTexture(const char* name, const TEXTURE_DESC& desc);
+	// the color or depth buffer of the window, which is what the
+	// frame is for, so its writers are never culled
+	int ImportBackbuffer(const char* name, const TEXTURE_DESC& desc);
+
+	// add a pass, run by Execute() with its attachments bound -
+	// the callable is copied into the frame arena and never
+	// destroyed, so it may only capture pointers and values
+	template <typename EXECUTE>
+	int AddPass(const char* name, const EXECUTE& execute)
+	{
+		static_assert(std::is_trivially_destructible<EXECUTE>::value, "render pass callables are never destroyed");
+
+		void* pCallable = new (m_pArena->Allocate(sizeof(EXECUTE), alignof(EXECUTE))) EXECUTE(execute);
+		return(AddPassCallback(name, &RunPass<EXECUTE>, pCallable));
+	}
+	// the pass samples a texture
+	void ReadTexture(int pass, int texture);
+	// the pass renders into a texture, which is bound as one of
+	// its attachments - attachments that are only tested
+	// against are declared here as well
+	void WriteTexture(int pass, int texture);
+	// size of the area the pass renders to, by default the size
+	// of its first attachment
+	void SetViewport(int pass, int width, int height);
+	// keep a pass whose work is not seen in any texture
+	void SetSideEffect(int pass);
+
+	// cull, order and allocate, false when the passes are wrong
+	bool Compile();
+	// run the compiled passes
+	void Execute();
+
+	// GL texture behind a texture of a compiled frame
+	GLuint GetTexture(int texture) const;
+	const TEXTURE_DESC& GetTextureDesc(int texture) const;
+	// print the passes run and the memory of the pooled textures
+	void Report() const;
+
+private:
+	struct GRAPH_TEXTURE
+	{
+		const char* name;
+		TEXTURE_DESC desc;
+		bool bBackbuffer;
+		// pool slot of a frame texture, -1 before Compile()
+		int physical;
+		// first and last positions in the schedule that use it
+		int firstUse;
+		int lastUse;
+	};
+
+	// the lists of a pass are arrays of the frame arena
+	struct GRAPH_PASS
+	{
+		const char* name;
+		// callable the pass was added with, and how to run it
+		void (*pRun)(void*);
+		void* pCallable;
+		// textures read and written, MAX_PASS_TEXTURES each
+		int* pReads;
+		int readCount;
+		int* pWrites;
+		int writeCount;
+		int viewportWidth;
+		int viewportHeight;
+		bool bSideEffect;
+		bool bCulled;
+		// passes whose output this pass uses
+		int* pDataDependencies;
+		int dataDependencyCount;
+		// passes that only have to run first, because they read
+		// a version of a texture this pass overwrites
+		int* pOrderDependencies;
+		int orderDependencyCount;
+		// written textures this pass is the first writer of
+		int* pClears;
+		int clearCount;
+	};
+
+	struct PHYSICAL_TEXTURE
+	{
+		TEXTURE_DESC desc;
+		GLuint texture;
+		// last position in the schedule it is taken until
+		int busyUntil;
+		bool bAssigned;
+	};
+
+	// GL textures attached to a framebuffer, the colors first
+	// and the depth attachment last, with 0 for the unused ones
+	typedef std::array<GLuint, MAX_PASS_TEXTURES + 1> FRAMEBUFFER_KEY;
+
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	// pointer to the memory of the frame that is declared
+	FrameArena* m_pArena;
+
+	// the vectors keep their size from frame to frame
+	std::vector<GRAPH_TEXTURE> m_textures;
+	std::vector<GRAPH_PASS> m_passes;
+	// indices of the passes that run, in order
+	std::vector<int> m_schedule;
+	// whether every pass was declared within the limits
+	bool m_bDeclared;
+	bool m_bCompiled;
+
+	std::vector<PHYSICAL_TEXTURE> m_physicalTextures;
+	std::map<FRAMEBUFFER_KEY, GLuint> m_framebuffers;
+
+	// add a pass that runs a callable of the frame arena
+	int AddPassCallback(const char* name, void (*pRun)(void*), void* pCallable);
+	// run a callable that AddPass() copied
+	template <typename EXECUTE>
+	static void RunPass(void* pCallable)
+	{
+		(*(EXECUTE*)pCallable)();
+	}
+
+	// find the passes each pass depends on
+	bool FindDependencies();
+	// mark the passes nothing needs as culled
+	void CullPasses();
+	// order the passes that run
+	void SchedulePasses();
+	// give the frame textures GL textures from the pool
+	void AllocateTextures();
+	// bind a framebuffer with the attachments of a pass
+	bool BindPassTargets(const GRAPH_PASS& pass);
+	// clear the attachments the pass writes first
+	void ClearPassTargets(const GRAPH_PASS& pass);
+	void DestroyFramebuffers();
+
+	static bool IsDepthFormat(GLenum format);
+	static bool IsSameDesc(const TEXTURE_DESC& first, const TEXTURE_DESC& second);
+};
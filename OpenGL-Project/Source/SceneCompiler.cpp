@@ -0,0 +1,571 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenecompiler.cpp
+// ============
+// compile an authored JSON scene into a scene file that maps in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneCompiler.h"
+#include "MappedFile.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// distance at which a composite object without one is
+	// drawn as an impostor
+	const float g_DefaultImpostorDistance = 25.0f;
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Round an offset up to the start of the next section.
+	 ***********************************************************/
+	size_t AlignOffset(size_t offset)
+	{
+		size_t alignment = SceneFile::SECTION_ALIGNMENT;
+		return((offset + alignment - 1) / alignment * alignment);
+	}
+}
+
+/***********************************************************
+ *  SceneCompiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneCompiler::SceneCompiler()
+{
+	m_sourcePath = NULL;
+}
+
+/***********************************************************
+ *  ~SceneCompiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneCompiler::~SceneCompiler()
+{
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method reads an authored scene and writes it as a
+ *  scene file.  The textures and materials are compiled
+ *  before the objects, which are checked against them.
+ ***********************************************************/
+bool SceneCompiler::Compile(const char* sourcePath, const char* scenePath)
+{
+	m_sourcePath = sourcePath;
+	m_textures.clear();
+	m_materials.clear();
+	m_lights.clear();
+	m_models.clear();
+	m_objects.clear();
+	m_composites.clear();
+	m_strings.clear();
+	m_stringOffsets.clear();
+	m_modelIndices.clear();
+
+	// offset zero is the empty string, for objects without a
+	// texture
+	AddString("");
+
+	MappedFile file;
+	if (file.Open(sourcePath) == false)
+	{
+		return(false);
+	}
+	if (m_document.Parse(file.GetData(), file.GetSize()) == false)
+	{
+		std::cout << "Could not parse scene:" << sourcePath << std::endl;
+		return(false);
+	}
+
+	int root = m_document.GetRoot();
+	if (m_document.GetType(root) != JsonDocument::JSON_OBJECT)
+	{
+		ReportError("scene", "has to be an object");
+		return(false);
+	}
+
+	if ((CompileTextures(m_document.GetMember(root, "textures")) == false) ||
+		(CompileMaterials(m_document.GetMember(root, "materials")) == false) ||
+		(CompileLights(m_document.GetMember(root, "lights")) == false) ||
+		(CompileObjects(m_document.GetMember(root, "objects")) == false))
+	{
+		return(false);
+	}
+
+	if (Write(scenePath) == false)
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileTextures()
+ *
+ *  This method compiles the texture list, the tag of every
+ *  texture and the image file it is loaded from.
+ ***********************************************************/
+bool SceneCompiler::CompileTextures(int list)
+{
+	if (m_document.GetCount(list) > MAX_TEXTURES)
+	{
+		ReportError("textures", "has more textures than the scene has slots for");
+		return(false);
+	}
+
+	for (int i = 0; i < m_document.GetCount(list); i++)
+	{
+		int value = m_document.GetElement(list, i);
+		const char* tag = m_document.GetString(m_document.GetMember(value, "tag"), NULL);
+		const char* file = m_document.GetString(m_document.GetMember(value, "file"), NULL);
+		if ((NULL == tag) || (NULL == file))
+		{
+			ReportError("textures", "need a tag and a file");
+			return(false);
+		}
+		if (IsTextureDefined(tag) == true)
+		{
+			ReportError(tag, "is defined twice");
+			return(false);
+		}
+
+		SceneFile::TEXTURE_RECORD texture;
+		texture.tag = AddString(tag);
+		texture.file = AddString(file);
+		m_textures.push_back(texture);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileMaterials()
+ *
+ *  This method compiles the material list.  Missing values
+ *  are black and dull, and materials are opaque unless they
+ *  are marked transparent.
+ ***********************************************************/
+bool SceneCompiler::CompileMaterials(int list)
+{
+	for (int i = 0; i < m_document.GetCount(list); i++)
+	{
+		int value = m_document.GetElement(list, i);
+		const char* tag = m_document.GetString(m_document.GetMember(value, "tag"), NULL);
+		if (NULL == tag)
+		{
+			ReportError("materials", "need a tag");
+			return(false);
+		}
+		if (IsMaterialDefined(tag) == true)
+		{
+			ReportError(tag, "is defined twice");
+			return(false);
+		}
+
+		SceneFile::MATERIAL_RECORD material;
+		if ((ReadVector(value, "ambientColor", glm::vec3(0.0f), material.ambientColor, tag) == false) ||
+			(ReadVector(value, "diffuseColor", glm::vec3(0.0f), material.diffuseColor, tag) == false) ||
+			(ReadVector(value, "specularColor", glm::vec3(0.0f), material.specularColor, tag) == false))
+		{
+			return(false);
+		}
+		material.ambientStrength = m_document.GetFloat(m_document.GetMember(value, "ambientStrength"), 0.0f);
+		material.shininess = m_document.GetFloat(m_document.GetMember(value, "shininess"), 1.0f);
+		material.bTransparent = m_document.GetBool(m_document.GetMember(value, "transparent"), false) ? 1 : 0;
+		material.tag = AddString(tag);
+		m_materials.push_back(material);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileLights()
+ *
+ *  This method compiles the light list.  A light is a point
+ *  light unless its type is "spot", and a range of zero
+ *  lights the whole scene, as with AddPointLight().
+ ***********************************************************/
+bool SceneCompiler::CompileLights(int list)
+{
+	for (int i = 0; i < m_document.GetCount(list); i++)
+	{
+		int value = m_document.GetElement(list, i);
+		std::string name = "light " + std::to_string(i);
+
+		SceneFile::LIGHT_RECORD light;
+		if ((ReadVector(value, "position", glm::vec3(0.0f), light.position, name.c_str()) == false) ||
+			(ReadVector(value, "direction", glm::vec3(0.0f, -1.0f, 0.0f), light.direction, name.c_str()) == false) ||
+			(ReadVector(value, "ambientColor", glm::vec3(0.0f), light.ambientColor, name.c_str()) == false) ||
+			(ReadVector(value, "diffuseColor", glm::vec3(0.0f), light.diffuseColor, name.c_str()) == false) ||
+			(ReadVector(value, "specularColor", glm::vec3(0.0f), light.specularColor, name.c_str()) == false))
+		{
+			return(false);
+		}
+		light.range = m_document.GetFloat(m_document.GetMember(value, "range"), 0.0f);
+		light.focalStrength = m_document.GetFloat(m_document.GetMember(value, "focalStrength"), 1.0f);
+		light.specularIntensity = m_document.GetFloat(m_document.GetMember(value, "specularIntensity"), 0.0f);
+
+		const char* type = m_document.GetString(m_document.GetMember(value, "type"), "point");
+		if (strcmp(type, "spot") == 0)
+		{
+			if (glm::length(light.direction) <= 0.0f)
+			{
+				ReportError(name.c_str(), "needs a direction");
+				return(false);
+			}
+			light.direction = glm::normalize(light.direction);
+			light.innerConeCosine = cos(glm::radians(m_document.GetFloat(m_document.GetMember(value, "innerConeDegrees"), 15.0f)));
+			light.outerConeCosine = cos(glm::radians(m_document.GetFloat(m_document.GetMember(value, "outerConeDegrees"), 30.0f)));
+		}
+		else if (strcmp(type, "point") == 0)
+		{
+			light.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+			light.innerConeCosine = -1.0f;
+			light.outerConeCosine = -1.0f;
+		}
+		else
+		{
+			ReportError(name.c_str(), "has an unknown type");
+			return(false);
+		}
+
+		m_lights.push_back(light);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileObjects()
+ *
+ *  This method compiles the object list.  An entry with
+ *  "parts" is a composite object, its parts are compiled
+ *  one after another and grouped under one impostor.
+ ***********************************************************/
+bool SceneCompiler::CompileObjects(int list)
+{
+	for (int i = 0; i < m_document.GetCount(list); i++)
+	{
+		int value = m_document.GetElement(list, i);
+		std::string name = "object " + std::to_string(i);
+
+		int parts = m_document.GetMember(value, "parts");
+		if (parts < 0)
+		{
+			if (CompileObject(value, name.c_str()) == false)
+			{
+				return(false);
+			}
+			continue;
+		}
+
+		SceneFile::COMPOSITE_RECORD composite;
+		composite.firstObject = (unsigned int)m_objects.size();
+		composite.objectCount = (unsigned int)m_document.GetCount(parts);
+		composite.impostorDistance = m_document.GetFloat(m_document.GetMember(value, "impostorDistance"), g_DefaultImpostorDistance);
+		if (composite.objectCount == 0)
+		{
+			ReportError(name.c_str(), "has no parts");
+			return(false);
+		}
+
+		for (int j = 0; j < m_document.GetCount(parts); j++)
+		{
+			int part = m_document.GetElement(parts, j);
+			std::string partName = name + " part " + std::to_string(j);
+			if (m_document.GetMember(part, "parts") >= 0)
+			{
+				ReportError(partName.c_str(), "can not have parts of its own");
+				return(false);
+			}
+			if (CompileObject(part, partName.c_str()) == false)
+			{
+				return(false);
+			}
+		}
+
+		m_composites.push_back(composite);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompileObject()
+ *
+ *  This method compiles one object, drawn with either a
+ *  basic shape by name or a model file.  Objects are static
+ *  unless they are marked otherwise.
+ ***********************************************************/
+bool SceneCompiler::CompileObject(int value, const char* name)
+{
+	SceneFile::OBJECT_RECORD object;
+	object.shape = -1;
+	object.model = -1;
+
+	const char* shape = m_document.GetString(m_document.GetMember(value, "mesh"), NULL);
+	const char* model = m_document.GetString(m_document.GetMember(value, "model"), NULL);
+	if ((NULL != shape) && (NULL == model))
+	{
+		for (int i = 0; i < SceneFile::SHAPE_COUNT; i++)
+		{
+			if (strcmp(shape, SceneFile::GetShapeName(i)) == 0)
+			{
+				object.shape = i;
+			}
+		}
+		if (object.shape < 0)
+		{
+			ReportError(name, "has an unknown mesh");
+			return(false);
+		}
+	}
+	else if ((NULL == shape) && (NULL != model))
+	{
+		std::map<std::string, int>::const_iterator found = m_modelIndices.find(model);
+		if (found == m_modelIndices.end())
+		{
+			SceneFile::MODEL_RECORD record;
+			record.file = AddString(model);
+			found = m_modelIndices.insert(std::make_pair(std::string(model), (int)m_models.size())).first;
+			m_models.push_back(record);
+		}
+		object.model = found->second;
+	}
+	else
+	{
+		ReportError(name, "needs either a mesh or a model");
+		return(false);
+	}
+
+	if ((ReadVector(value, "scale", glm::vec3(1.0f), object.scaleXYZ, name) == false) ||
+		(ReadVector(value, "rotation", glm::vec3(0.0f), object.rotationDegrees, name) == false) ||
+		(ReadVector(value, "position", glm::vec3(0.0f), object.positionXYZ, name) == false))
+	{
+		return(false);
+	}
+
+	const char* texture = m_document.GetString(m_document.GetMember(value, "texture"), "");
+	const char* material = m_document.GetString(m_document.GetMember(value, "material"), NULL);
+	if ((texture[0] != '\0') && (IsTextureDefined(texture) == false))
+	{
+		ReportError(name, "uses a texture that is not defined");
+		return(false);
+	}
+	if ((NULL == material) || (IsMaterialDefined(material) == false))
+	{
+		ReportError(name, "needs a defined material");
+		return(false);
+	}
+	object.textureTag = AddString(texture);
+	object.materialTag = AddString(material);
+
+	object.flags = 0;
+	if (m_document.GetBool(m_document.GetMember(value, "static"), true) == true)
+	{
+		object.flags |= SceneFile::OBJECT_STATIC;
+	}
+
+	m_objects.push_back(object);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method lays the sections out one after another
+ *  behind the header, each on an aligned offset so its
+ *  records can be read in place, and writes the file.
+ ***********************************************************/
+bool SceneCompiler::Write(const char* scenePath) const
+{
+	const void* sources[SceneFile::SECTION_COUNT] =
+	{
+		m_textures.data(),
+		m_materials.data(),
+		m_lights.data(),
+		m_models.data(),
+		m_objects.data(),
+		m_composites.data(),
+		m_strings.data()
+	};
+	size_t counts[SceneFile::SECTION_COUNT] =
+	{
+		m_textures.size(),
+		m_materials.size(),
+		m_lights.size(),
+		m_models.size(),
+		m_objects.size(),
+		m_composites.size(),
+		m_strings.size()
+	};
+	SceneFile::SCENE_HEADER header = {};
+	header.magic = SceneFile::MAGIC;
+	header.version = SceneFile::VERSION;
+
+	size_t offset = AlignOffset(sizeof(header));
+	for (int i = 0; i < SceneFile::SECTION_COUNT; i++)
+	{
+		header.sections[i].offset = (unsigned int)offset;
+		header.sections[i].count = (unsigned int)counts[i];
+		offset = AlignOffset(offset + counts[i] * SceneFile::GetRecordSize((SceneFile::SECTION_TYPE)i));
+	}
+	header.fileSize = (unsigned int)offset;
+
+	// the padding between the sections is written as zeros
+	std::vector<char> blob(offset, 0);
+	memcpy(blob.data(), &header, sizeof(header));
+	for (int i = 0; i < SceneFile::SECTION_COUNT; i++)
+	{
+		if (counts[i] > 0)
+		{
+			memcpy(blob.data() + header.sections[i].offset, sources[i], counts[i] * SceneFile::GetRecordSize((SceneFile::SECTION_TYPE)i));
+		}
+	}
+
+	std::ofstream file(scenePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cout << "Could not write scene:" << scenePath << std::endl;
+		return(false);
+	}
+	file.write(blob.data(), blob.size());
+	if (!file.good())
+	{
+		std::cout << "Could not write scene:" << scenePath << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Scene Compiled: " << scenePath << ", "
+		<< m_objects.size() << " objects, "
+		<< m_materials.size() << " materials, "
+		<< m_lights.size() << " lights, "
+		<< m_textures.size() << " textures, "
+		<< blob.size() << " bytes" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddString()
+ *
+ *  This method returns the offset of a string in the string
+ *  table, adding it the first time, so a tag used by many
+ *  objects is stored once.
+ ***********************************************************/
+unsigned int SceneCompiler::AddString(const char* text)
+{
+	std::map<std::string, unsigned int>::const_iterator found = m_stringOffsets.find(text);
+	if (found != m_stringOffsets.end())
+	{
+		return(found->second);
+	}
+
+	unsigned int offset = (unsigned int)m_strings.size();
+	m_strings.insert(m_strings.end(), text, text + strlen(text) + 1);
+	m_stringOffsets[text] = offset;
+
+	return(offset);
+}
+
+/***********************************************************
+ *  IsTextureDefined()
+ *
+ *  This method returns whether a texture was compiled with
+ *  the passed in tag.
+ ***********************************************************/
+bool SceneCompiler::IsTextureDefined(const char* tag) const
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (strcmp(&m_strings[m_textures[i].tag], tag) == 0)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IsMaterialDefined()
+ *
+ *  This method returns whether a material was compiled with
+ *  the passed in tag.
+ ***********************************************************/
+bool SceneCompiler::IsMaterialDefined(const char* tag) const
+{
+	for (size_t i = 0; i < m_materials.size(); i++)
+	{
+		if (strcmp(&m_strings[m_materials[i].tag], tag) == 0)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ReadVector()
+ *
+ *  This method reads a member that is an array of three
+ *  numbers.  A missing member gives the fallback, anything
+ *  else than three numbers is an error.
+ ***********************************************************/
+bool SceneCompiler::ReadVector(int object, const char* member, const glm::vec3& fallback, glm::vec3& vector, const char* name)
+{
+	int value = m_document.GetMember(object, member);
+	if (value < 0)
+	{
+		vector = fallback;
+		return(true);
+	}
+
+	if ((m_document.GetType(value) != JsonDocument::JSON_ARRAY) || (m_document.GetCount(value) != 3))
+	{
+		std::string message = "needs three numbers for ";
+		message += member;
+		ReportError(name, message.c_str());
+		return(false);
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		int element = m_document.GetElement(value, i);
+		if (m_document.GetType(element) != JsonDocument::JSON_NUMBER)
+		{
+			std::string message = "needs three numbers for ";
+			message += member;
+			ReportError(name, message.c_str());
+			return(false);
+		}
+		vector[i] = m_document.GetFloat(element, 0.0f);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReportError()
+ *
+ *  This method prints an error of the scene being compiled
+ *  with the part of the scene it was found in.
+ ***********************************************************/
+void SceneCompiler::ReportError(const char* name, const char* message) const
+{
+	std::cout << "Scene error in " << m_sourcePath << ": " << name << " " << message << std::endl;
+}
@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenecompiler.h
+// ============
+// compile an authored JSON scene into a scene file that maps in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JsonDocument.h"
+#include "SceneFile.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneCompiler
+ *
+ *  This class turns a JSON description of the textures,
+ *  materials, lights and objects of a scene into the binary
+ *  layout of SceneFile.  Everything that would otherwise be
+ *  looked up or worked out while the scene loads is done
+ *  here once - names become offsets into one string table,
+ *  spot cone angles become cosines, model files are shared
+ *  between the objects drawn with them, and every texture
+ *  and material an object names has to exist.  Errors are
+ *  printed with the object they were found in.
+ ***********************************************************/
+class SceneCompiler
+{
+public:
+	// textures the scene manager has slots for
+	static const int MAX_TEXTURES = 16;
+
+	// constructor
+	SceneCompiler();
+	// destructor
+	~SceneCompiler();
+
+	// compile an authored scene and write the scene file
+	bool Compile(const char* sourcePath, const char* scenePath);
+
+private:
+	JsonDocument m_document;
+	const char* m_sourcePath;
+
+	// records of the sections, in the order they are written
+	std::vector<SceneFile::TEXTURE_RECORD> m_textures;
+	std::vector<SceneFile::MATERIAL_RECORD> m_materials;
+	std::vector<SceneFile::LIGHT_RECORD> m_lights;
+	std::vector<SceneFile::MODEL_RECORD> m_models;
+	std::vector<SceneFile::OBJECT_RECORD> m_objects;
+	std::vector<SceneFile::COMPOSITE_RECORD> m_composites;
+	// string table, and the offset of every string in it
+	std::vector<char> m_strings;
+	std::map<std::string, unsigned int> m_stringOffsets;
+	// index of every model file in the models
+	std::map<std::string, int> m_modelIndices;
+
+	bool CompileTextures(int list);
+	bool CompileMaterials(int list);
+	bool CompileLights(int list);
+	bool CompileObjects(int list);
+	bool CompileObject(int value, const char* name);
+	// write the header, sections and string table
+	bool Write(const char* scenePath) const;
+
+	// offset of a string in the string table, added if needed
+	unsigned int AddString(const char* text);
+	// whether a texture or material tag was defined
+	bool IsTextureDefined(const char* tag) const;
+	bool IsMaterialDefined(const char* tag) const;
+	// read a member of three numbers, the fallback if missing
+	bool ReadVector(int object, const char* member, const glm::vec3& fallback, glm::vec3& vector, const char* name);
+	void ReportError(const char* name, const char* message) const;
+};
@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// map a compiled scene file and read its records in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names of the basic shapes in authored scenes
+	const char* g_ShapeNames[SceneFile::SHAPE_COUNT] =
+	{
+		"plane",
+		"box",
+		"cylinder",
+		"cone",
+		"sphere",
+		"taperedCylinder",
+		"torus"
+	};
+
+	// size of one record of every section, one byte for the
+	// string table
+	const size_t g_RecordSizes[SceneFile::SECTION_COUNT] =
+	{
+		sizeof(SceneFile::TEXTURE_RECORD),
+		sizeof(SceneFile::MATERIAL_RECORD),
+		sizeof(SceneFile::LIGHT_RECORD),
+		sizeof(SceneFile::MODEL_RECORD),
+		sizeof(SceneFile::OBJECT_RECORD),
+		sizeof(SceneFile::COMPOSITE_RECORD),
+		1
+	};
+}
+
+// the records are read straight from the file, so their
+// layout must not depend on the compiler
+static_assert(sizeof(SceneFile::SCENE_HEADER) == 72, "scene header layout changed");
+static_assert(sizeof(SceneFile::MATERIAL_RECORD) == 52, "material record layout changed");
+static_assert(sizeof(SceneFile::LIGHT_RECORD) == 80, "light record layout changed");
+static_assert(sizeof(SceneFile::OBJECT_RECORD) == 56, "object record layout changed");
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pHeader = NULL;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method maps a compiled scene and checks it.  Nothing
+ *  is copied out of the file, the records are used where
+ *  they were mapped.
+ ***********************************************************/
+bool SceneFile::Open(const char* filename)
+{
+	Close();
+
+	if (m_file.Open(filename) == false)
+	{
+		return(false);
+	}
+
+	if (m_file.GetSize() < sizeof(SCENE_HEADER))
+	{
+		std::cout << "Not a compiled scene file:" << filename << std::endl;
+		Close();
+		return(false);
+	}
+
+	m_pHeader = (const SCENE_HEADER*)m_file.GetData();
+	if (Validate(filename) == false)
+	{
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Validate()
+ *
+ *  This method checks that the header matches the file and
+ *  that every section, string offset and index stays inside
+ *  the file, so a damaged or foreign file is rejected before
+ *  any of it is used.
+ ***********************************************************/
+bool SceneFile::Validate(const char* filename) const
+{
+	if ((m_pHeader->magic != MAGIC) || (m_pHeader->version != VERSION))
+	{
+		std::cout << "Scene file was compiled for another version:" << filename << std::endl;
+		return(false);
+	}
+	if (m_pHeader->fileSize != m_file.GetSize())
+	{
+		std::cout << "Scene file is truncated:" << filename << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		const SECTION& section = m_pHeader->sections[i];
+		unsigned long long end = (unsigned long long)section.offset +
+			(unsigned long long)section.count * g_RecordSizes[i];
+		if (((section.offset % SECTION_ALIGNMENT) != 0) ||
+			(section.offset < sizeof(SCENE_HEADER)) ||
+			(end > m_file.GetSize()))
+		{
+			std::cout << "Scene file has a damaged section:" << filename << std::endl;
+			return(false);
+		}
+	}
+
+	// every string has to end inside the table
+	const SECTION& strings = m_pHeader->sections[SECTION_STRINGS];
+	if ((strings.count == 0) || (m_file.GetData()[strings.offset + strings.count - 1] != '\0'))
+	{
+		std::cout << "Scene file has a damaged string table:" << filename << std::endl;
+		return(false);
+	}
+
+	bool bValid = true;
+	for (int i = 0; i < GetCount(SECTION_TEXTURES); i++)
+	{
+		bValid = bValid && IsStringValid(GetTextures()[i].tag) && IsStringValid(GetTextures()[i].file);
+	}
+	for (int i = 0; i < GetCount(SECTION_MATERIALS); i++)
+	{
+		bValid = bValid && IsStringValid(GetMaterials()[i].tag);
+	}
+	for (int i = 0; i < GetCount(SECTION_MODELS); i++)
+	{
+		bValid = bValid && IsStringValid(GetModels()[i].file);
+	}
+	for (int i = 0; i < GetCount(SECTION_OBJECTS); i++)
+	{
+		const OBJECT_RECORD& object = GetObjects()[i];
+		bool bShape = (object.shape >= 0) && (object.shape < SHAPE_COUNT) && (object.model == -1);
+		bool bModel = (object.shape == -1) && (object.model >= 0) && (object.model < GetCount(SECTION_MODELS));
+		bValid = bValid && (bShape || bModel) &&
+			IsStringValid(object.textureTag) && IsStringValid(object.materialTag);
+	}
+	for (int i = 0; i < GetCount(SECTION_COMPOSITES); i++)
+	{
+		const COMPOSITE_RECORD& composite = GetComposites()[i];
+		bValid = bValid &&
+			((unsigned long long)composite.firstObject + composite.objectCount <= (unsigned long long)GetCount(SECTION_OBJECTS));
+	}
+
+	if (bValid == false)
+	{
+		std::cout << "Scene file has a damaged record:" << filename << std::endl;
+	}
+
+	return(bValid);
+}
+
+/***********************************************************
+ *  IsStringValid()
+ *
+ *  This method returns whether an offset points into the
+ *  string table, which ends with a terminator.
+ ***********************************************************/
+bool SceneFile::IsStringValid(unsigned int offset) const
+{
+	return(offset < m_pHeader->sections[SECTION_STRINGS].count);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method unmaps the scene.  The records and strings
+ *  handed out before must not be used afterwards.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	m_file.Close();
+	m_pHeader = NULL;
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method returns whether a checked scene is mapped.
+ ***********************************************************/
+bool SceneFile::IsOpen() const
+{
+	return(NULL != m_pHeader);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method returns the size of the mapped scene.
+ ***********************************************************/
+size_t SceneFile::GetSize() const
+{
+	return(m_file.GetSize());
+}
+
+/***********************************************************
+ *  GetSection()
+ *
+ *  This method returns the first byte of a section, NULL
+ *  while no scene is open.
+ ***********************************************************/
+const void* SceneFile::GetSection(SECTION_TYPE section) const
+{
+	if (NULL == m_pHeader)
+	{
+		return(NULL);
+	}
+
+	return(m_file.GetData() + m_pHeader->sections[section].offset);
+}
+
+/***********************************************************
+ *  GetCount()
+ *
+ *  This method returns the number of records of a section,
+ *  or the bytes of the string table.
+ ***********************************************************/
+int SceneFile::GetCount(SECTION_TYPE section) const
+{
+	if (NULL == m_pHeader)
+	{
+		return(0);
+	}
+
+	return((int)m_pHeader->sections[section].count);
+}
+
+/***********************************************************
+ *  GetTextures()
+ *
+ *  This method returns the first texture record.
+ ***********************************************************/
+const SceneFile::TEXTURE_RECORD* SceneFile::GetTextures() const
+{
+	return((const TEXTURE_RECORD*)GetSection(SECTION_TEXTURES));
+}
+
+/***********************************************************
+ *  GetMaterials()
+ *
+ *  This method returns the first material record.
+ ***********************************************************/
+const SceneFile::MATERIAL_RECORD* SceneFile::GetMaterials() const
+{
+	return((const MATERIAL_RECORD*)GetSection(SECTION_MATERIALS));
+}
+
+/***********************************************************
+ *  GetLights()
+ *
+ *  This method returns the first light record.
+ ***********************************************************/
+const SceneFile::LIGHT_RECORD* SceneFile::GetLights() const
+{
+	return((const LIGHT_RECORD*)GetSection(SECTION_LIGHTS));
+}
+
+/***********************************************************
+ *  GetModels()
+ *
+ *  This method returns the first model record.
+ ***********************************************************/
+const SceneFile::MODEL_RECORD* SceneFile::GetModels() const
+{
+	return((const MODEL_RECORD*)GetSection(SECTION_MODELS));
+}
+
+/***********************************************************
+ *  GetObjects()
+ *
+ *  This method returns the first object record.
+ ***********************************************************/
+const SceneFile::OBJECT_RECORD* SceneFile::GetObjects() const
+{
+	return((const OBJECT_RECORD*)GetSection(SECTION_OBJECTS));
+}
+
+/***********************************************************
+ *  GetComposites()
+ *
+ *  This method returns the first composite record.
+ ***********************************************************/
+const SceneFile::COMPOSITE_RECORD* SceneFile::GetComposites() const
+{
+	return((const COMPOSITE_RECORD*)GetSection(SECTION_COMPOSITES));
+}
+
+/***********************************************************
+ *  GetString()
+ *
+ *  This method returns the string at an offset into the
+ *  string table, which Open() has checked.
+ ***********************************************************/
+const char* SceneFile::GetString(unsigned int offset) const
+{
+	return((const char*)GetSection(SECTION_STRINGS) + offset);
+}
+
+/***********************************************************
+ *  GetRecordSize()
+ *
+ *  This method returns the size of one record of a section.
+ ***********************************************************/
+size_t SceneFile::GetRecordSize(SECTION_TYPE section)
+{
+	return(g_RecordSizes[section]);
+}
+
+/***********************************************************
+ *  GetShapeName()
+ *
+ *  This method returns the name a basic shape is given in
+ *  authored scenes.
+ ***********************************************************/
+const char* SceneFile::GetShapeName(int shape)
+{
+	if ((shape < 0) || (shape >= SHAPE_COUNT))
+	{
+		return(NULL);
+	}
+
+	return(g_ShapeNames[shape]);
+}
@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// map a compiled scene file and read its records in place
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "MappedFile.h"
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class maps a scene compiled by SceneCompiler and
+ *  hands out its records straight from the mapping.  The
+ *  file is a header followed by one array of fixed size
+ *  records per section and a table of zero terminated
+ *  strings.  Records point at strings and at each other by
+ *  offset and index only, never by address, so the file can
+ *  be mapped anywhere and used without being unpacked.  Open()
+ *  checks every offset and index once, after which nothing
+ *  in the file has to be checked again.  The records are
+ *  little-endian, which is what the scene is built for.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	enum SECTION_TYPE
+	{
+		SECTION_TEXTURES,
+		SECTION_MATERIALS,
+		SECTION_LIGHTS,
+		SECTION_MODELS,
+		SECTION_OBJECTS,
+		SECTION_COMPOSITES,
+		SECTION_STRINGS,
+		SECTION_COUNT
+	};
+
+	// where a section starts in the file, and how many records
+	// it has - bytes for the string table
+	struct SECTION
+	{
+		unsigned int offset;
+		unsigned int count;
+	};
+
+	struct SCENE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned int fileSize;
+		unsigned int reserved;
+		SECTION sections[SECTION_COUNT];
+	};
+
+	// the strings are offsets into the string table
+	struct TEXTURE_RECORD
+	{
+		unsigned int tag;
+		unsigned int file;
+	};
+
+	struct MATERIAL_RECORD
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		float shininess;
+		glm::vec3 specularColor;
+		unsigned int bTransparent;
+		unsigned int tag;
+	};
+
+	// lights are stored as they are handed to the shader, with
+	// the cone angles already turned into cosines
+	typedef ClusteredLighting::LIGHT_SOURCE LIGHT_RECORD;
+
+	// model file imported as a mesh, shared by the objects that
+	// are drawn with it
+	struct MODEL_RECORD
+	{
+		unsigned int file;
+	};
+
+	struct OBJECT_RECORD
+	{
+		// basic shape the object is drawn with, or -1 for a
+		// model, which is then an index into the models
+		int shape;
+		int model;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		unsigned int textureTag;
+		unsigned int materialTag;
+		unsigned int flags;
+	};
+
+	// objects drawn as one baked impostor from far away, the
+	// objects of a composite follow one another
+	struct COMPOSITE_RECORD
+	{
+		unsigned int firstObject;
+		unsigned int objectCount;
+		float impostorDistance;
+	};
+
+	// object flags
+	static const unsigned int OBJECT_STATIC = 1;
+
+	// identifies a scene file and the layout of its records
+	static const unsigned int MAGIC = 0x454E4353;   // "SCNE"
+	static const unsigned int VERSION = 1;
+	// sections start on this many bytes
+	static const unsigned int SECTION_ALIGNMENT = 16;
+	// basic shapes, in the order of the mesh types of the scene
+	// manager
+	static const int SHAPE_COUNT = 7;
+
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// map and check a compiled scene, closing any scene opened
+	// before - errors are printed and return false
+	bool Open(const char* filename);
+	// unmap the scene, which ends the life of all its records
+	void Close();
+	bool IsOpen() const;
+	// size of the mapped file in bytes
+	size_t GetSize() const;
+
+	// number of records of a section, zero while no scene is
+	// open
+	int GetCount(SECTION_TYPE section) const;
+	// first record of every section
+	const TEXTURE_RECORD* GetTextures() const;
+	const MATERIAL_RECORD* GetMaterials() const;
+	const LIGHT_RECORD* GetLights() const;
+	const MODEL_RECORD* GetModels() const;
+	const OBJECT_RECORD* GetObjects() const;
+	const COMPOSITE_RECORD* GetComposites() const;
+	// string at an offset into the string table
+	const char* GetString(unsigned int offset) const;
+
+	// size of one record of a section, one byte for the string
+	// table
+	static size_t GetRecordSize(SECTION_TYPE section);
+	// name of a basic shape in an authored scene, NULL past the
+	// last one
+	static const char* GetShapeName(int shape);
+
+private:
+	MappedFile m_file;
+	const SCENE_HEADER* m_pHeader;
+
+	// first byte of a section
+	const void* GetSection(SECTION_TYPE section) const;
+	// check every section, offset and index of the file
+	bool Validate(const char* filename) const;
+	// whether an offset points into the string table
+	bool IsStringValid(unsigned int offset) const;
+};
@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "MeshImporter.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,6 +17,11 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
 // declaration of global variables
 namespace
 { 
@@ -24,20 +30,84 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_VertexShaderPath = "Shaders/vertexShader.glsl";
+	const char* g_FragmentShaderPath = "Shaders/fragmentShader.glsl";
+	const char* g_DepthVertexShaderPath = "Shaders/depthVertexShader.glsl";
+	const char* g_DepthFragmentShaderPath = "Shaders/depthFragmentShader.glsl";
+	const char* g_CullingComputeShaderPath = "Shaders/cullingComputeShader.glsl";
+	const char* g_LightmapPath = "Lightmaps/scene.lightmap";
+	const char* g_LightmapTextureName = "lightmapTexture";
+	// texture unit the lightmap is bound to, the object
+	// textures use unit 0
+	const int g_LightmapTextureUnit = 1;
+	// names set every frame that do not fit in a short string
+	// are made once, so setting them takes nothing from the heap
+	const std::string g_MaterialAmbientColorName = "material.ambientColor";
+	const std::string g_MaterialAmbientStrengthName = "material.ambientStrength";
+	const std::string g_MaterialDiffuseColorName = "material.diffuseColor";
+	const std::string g_MaterialSpecularColorName = "material.specularColor";
+	const std::string g_MaterialShininessName = "material.shininess";
+	// layout of the vertex buffers the scene builds, the
+	// compact one halves the vertex fetch of every draw
+	const MeshGeometry::VERTEX_FORMAT g_SceneVertexFormat = MeshGeometry::VERTEX_FORMAT_COMPACT;
+	// slices around the round basic shapes, and the most a
+	// cluster of triangles may add to the cache miss ratio when
+	// they are reordered against overdraw
+	const int g_DefaultTessellation = 32;
+	const float g_OverdrawThreshold = 1.05f;
 }
 
+// scene files name the basic shapes by their mesh type
+static_assert(SceneManager::MESH_IMPORTED == SceneFile::SHAPE_COUNT, "scene file shapes do not match the mesh types");
+
 /***********************************************************
  *  SceneManager()
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(ShaderManager *pShaderManager, JobSystem *pJobSystem, GLStateCache *pStateCache)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pJobSystem = pJobSystem;
+	m_pStateCache = pStateCache;
+	m_pLighting = new ClusteredLighting(pJobSystem);
+	m_pShaderVariants = NULL;
+	m_pDepthShader = NULL;
+	m_bDepthPrepass = false;
+	m_bPrepassRendered = false;
+	m_pPrepassTimer = NULL;
+	m_pOpaqueTimer = NULL;
+	m_pTransparentTimer = NULL;
+	m_pOcclusion = NULL;
+	m_bOcclusionCulling = true;
+	m_pMeshGeometry = NULL;
+	m_tessellation = g_DefaultTessellation;
+	m_pGpuCulling = NULL;
+	m_bGpuCulling = false;
+	m_pLightmapGeometry = NULL;
+	m_lightmapTexture = 0;
+	m_bLightmaps = true;
+	m_pStaticGeometry = NULL;
+	m_bStaticBatching = true;
+	m_pImpostors = NULL;
+	m_bImpostors = true;
+	m_bSoftware = false;
 	m_loadedTextures = 0;
-
-	InitializeShadowMapping();  // Call the method to initialize shadow mapping
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_viewportWidth = 1;
+	m_viewportHeight = 1;
+
+	// without a state cache there is no OpenGL context and the
+	// scene can only be rendered in software
+	if (NULL != pStateCache)
+	{
+		m_pShaderVariants = new ShaderVariants(pShaderManager, pStateCache);
+		m_pPrepassTimer = new GpuTimer();
+		m_pOpaqueTimer = new GpuTimer();
+		m_pTransparentTimer = new GpuTimer();
+	}
 
 	// Set up lighting, materials, or other initial configurations
 
@@ -64,31 +134,37 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-
-	glDeleteTextures(1, &shadowMap);  // Clean up texture
-	glDeleteFramebuffers(1, &shadowMapFBO);  // Clean up framebuffer
-
-
-}
-void SceneManager::InitializeShadowMapping()
-{
-	glGenFramebuffers(1, &shadowMapFBO);
-	glGenTextures(1, &shadowMap);
-	glBindTexture(GL_TEXTURE_2D, shadowMap);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT,
-		1024, 1024, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFBO);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, shadowMap, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	m_pJobSystem = NULL;
+	m_pStateCache = NULL;
+	delete m_pLighting;
+	m_pLighting = NULL;
+	delete m_pShaderVariants;
+	m_pShaderVariants = NULL;
+	delete m_pDepthShader;
+	m_pDepthShader = NULL;
+	delete m_pPrepassTimer;
+	m_pPrepassTimer = NULL;
+	delete m_pOpaqueTimer;
+	m_pOpaqueTimer = NULL;
+	delete m_pTransparentTimer;
+	m_pTransparentTimer = NULL;
+	delete m_pOcclusion;
+	m_pOcclusion = NULL;
+	delete m_pGpuCulling;
+	m_pGpuCulling = NULL;
+	delete m_pMeshGeometry;
+	m_pMeshGeometry = NULL;
+	delete m_pLightmapGeometry;
+	m_pLightmapGeometry = NULL;
+	delete m_pStaticGeometry;
+	m_pStaticGeometry = NULL;
+	delete m_pImpostors;
+	m_pImpostors = NULL;
+	if (m_lightmapTexture != 0)
+	{
+		glDeleteTextures(1, &m_lightmapTexture);
+	}
+	m_softwareTextures.clear();
 }
 
 
@@ -100,7 +176,7 @@ void SceneManager::InitializeShadowMapping()
  *  generating the mipmaps, and loading the read texture into
  *  the next available texture slot in memory.
  ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+bool SceneManager::CreateGLTexture(const char* filename, const char* tag)
 {
 	int width = 0;
 	int height = 0;
@@ -119,7 +195,7 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
 
 		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		m_pStateCache->BindTexture(GL_TEXTURE_2D, textureID);
 
 		// set the texture wrapping parameters
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -145,7 +221,7 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 
 		// free the image data from local memory
 		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		m_pStateCache->BindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
 
 		// register the loaded texture and associate it with the special tag string
 		m_textureIDs[m_loadedTextures].ID = textureID;
@@ -161,6 +237,59 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	return false;
 }
 
+/***********************************************************
+ *  CreateSoftwareTexture()
+ *
+ *  This method is used for loading a texture image for the
+ *  CPU renderers, registered under the passed in tag like
+ *  the OpenGL textures.
+ ***********************************************************/
+bool SceneManager::CreateSoftwareTexture(const char* filename, const char* tag)
+{
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	stbi_set_flip_vertically_on_load(false);
+	unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, 0);
+	if (!image)
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return false;
+	}
+
+	SoftwareTexture texture;
+	bool bCreated = texture.Create(image, width, height, colorChannels);
+	stbi_image_free(image);
+	if (bCreated == false)
+	{
+		return false;
+	}
+
+	m_textureIDs[m_loadedTextures].ID = (uint32_t)m_softwareTextures.size();
+	m_softwareTextures.push_back(texture);
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_loadedTextures++;
+
+	return true;
+}
+
+/***********************************************************
+ *  CreateSceneTexture()
+ *
+ *  This method loads a texture for whichever renderer the
+ *  scene was prepared for.
+ ***********************************************************/
+bool SceneManager::CreateSceneTexture(const char* filename, const char* tag)
+{
+	if (m_bSoftware == true)
+	{
+		return(CreateSoftwareTexture(filename, tag));
+	}
+
+	return(CreateGLTexture(filename, tag));
+}
+
 /***********************************************************
  *  BindGLTextures()
  *
@@ -172,8 +301,7 @@ void SceneManager::BindGLTextures()
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
 		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		m_pStateCache->BindTextureUnit(i, GL_TEXTURE_2D, m_textureIDs[i].ID);
 	}
 }
 
@@ -197,7 +325,7 @@ void SceneManager::DestroyGLTextures()
  *  This method is used for getting an ID for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+int SceneManager::FindTextureID(const char* tag)
 {
 	int textureID = -1;
 	int index = 0;
@@ -205,7 +333,7 @@ int SceneManager::FindTextureID(std::string tag)
 
 	while ((index < m_loadedTextures) && (bFound == false))
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		if (strcmp(m_textureIDs[index].tag, tag) == 0)
 		{
 			textureID = m_textureIDs[index].ID;
 			bFound = true;
@@ -217,13 +345,30 @@ int SceneManager::FindTextureID(std::string tag)
 	return(textureID);
 }
 
+/***********************************************************
+ *  FindSoftwareTexture()
+ *
+ *  This method is used for getting the texture loaded for
+ *  the CPU renderers under the passed in tag.
+ ***********************************************************/
+const SoftwareTexture* SceneManager::FindSoftwareTexture(const char* tag)
+{
+	int textureID = (tag[0] == '\0') ? -1 : FindTextureID(tag);
+	if ((textureID < 0) || (textureID >= (int)m_softwareTextures.size()))
+	{
+		return(NULL);
+	}
+
+	return(&m_softwareTextures[textureID]);
+}
+
 /***********************************************************
  *  FindTextureSlot()
  *
  *  This method is used for getting a slot index for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const char* tag)
 {
 	int textureSlot = -1;
 	int index = 0;
@@ -231,7 +376,7 @@ int SceneManager::FindTextureSlot(std::string tag)
 
 	while ((index < m_loadedTextures) && (bFound == false))
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		if (strcmp(m_textureIDs[index].tag, tag) == 0)
 		{
 			textureSlot = index;
 			bFound = true;
@@ -248,8 +393,10 @@ int SceneManager::FindTextureSlot(std::string tag)
  *
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
+ *  It returns false, leaving the material untouched, when no
+ *  material has the tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const char* tag, OBJECT_MATERIAL& material)
 {
 	if (m_objectMaterials.size() == 0)
 	{
@@ -260,7 +407,7 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 	bool bFound = false;
 	while ((index < m_objectMaterials.size()) && (bFound == false))
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		if (strcmp(m_objectMaterials[index].tag, tag) == 0)
 		{
 			bFound = true;
 			material.ambientColor = m_objectMaterials[index].ambientColor;
@@ -268,6 +415,7 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 			material.diffuseColor = m_objectMaterials[index].diffuseColor;
 			material.specularColor = m_objectMaterials[index].specularColor;
 			material.shininess = m_objectMaterials[index].shininess;
+			material.bTransparent = m_objectMaterials[index].bTransparent;
 		}
 		else
 		{
@@ -275,16 +423,17 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 		}
 	}
 
-	return(true);
+	return(bFound);
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  BuildModelMatrix()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for calculating the model matrix
+ *  from the passed in transformation values.  It does not
+ *  touch any GL state, so it is safe to call from any thread.
  ***********************************************************/
-void SceneManager::SetTransformations(
+glm::mat4 SceneManager::BuildModelMatrix(
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
@@ -292,7 +441,6 @@ void SceneManager::SetTransformations(
 	glm::vec3 positionXYZ)
 {
 	// variables for this method
-	glm::mat4 modelView;
 	glm::mat4 scale;
 	glm::mat4 rotationX;
 	glm::mat4 rotationY;
@@ -308,7 +456,28 @@ void SceneManager::SetTransformations(
 	// set the translation value in the transform buffer
 	translation = glm::translate(positionXYZ);
 
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
+	return(translation * rotationX * rotationY * rotationZ * scale);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	glm::mat4 modelView = BuildModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
 
 	if (NULL != m_pShaderManager)
 	{
@@ -316,6 +485,57 @@ void SceneManager::SetTransformations(
 	}
 }
 
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for adding an object to the list of
+ *  objects that are drawn when the scene is rendered.
+ ***********************************************************/
+void SceneManager::AddSceneObject(
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	const char* textureTag,
+	const char* materialTag)
+{
+	SCENE_OBJECT object;
+	object.mesh = mesh;
+	object.scaleXYZ = scaleXYZ;
+	object.XrotationDegrees = XrotationDegrees;
+	object.YrotationDegrees = YrotationDegrees;
+	object.ZrotationDegrees = ZrotationDegrees;
+	object.positionXYZ = positionXYZ;
+	object.textureTag = textureTag;
+	object.materialTag = materialTag;
+	object.modelMatrix = glm::mat4(1.0f);
+	object.lightmapMesh = -1;
+	// nothing in the scene moves, an object that does has to be
+	// marked dynamic before PrepareScene() builds the batches
+	object.bStatic = true;
+	object.staticBatch = -1;
+	object.composite = -1;
+
+	// the material decides which pass draws the object
+	OBJECT_MATERIAL material;
+	object.bTransparent = false;
+	if (FindMaterial(materialTag, material) == true)
+	{
+		object.bTransparent = material.bTransparent;
+	}
+
+	// every object is lit, only textured objects sample a texture
+	object.shaderFeatures = ShaderVariants::FEATURE_LIT;
+	if (textureTag[0] != '\0')
+	{
+		object.shaderFeatures |= ShaderVariants::FEATURE_TEXTURED;
+	}
+
+	m_sceneObjects.push_back(object);
+}
+
 /***********************************************************
  *  SetShaderColor()
  *
@@ -350,7 +570,7 @@ void SceneManager::SetShaderColor(
  *  associated with the passed in ID into the shader.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
-	std::string textureTag)
+	const char* textureTag)
 {
 	if (NULL != m_pShaderManager)
 	{
@@ -383,7 +603,7 @@ void SceneManager::SetTextureUVScale(float u, float v)
  *  into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	const char* materialTag)
 {
 	if (m_objectMaterials.size() > 0)
 	{
@@ -393,11 +613,11 @@ void SceneManager::SetShaderMaterial(
 		bReturn = FindMaterial(materialTag, material);
 		if (bReturn == true)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_pShaderManager->setVec3Value(g_MaterialAmbientColorName, material.ambientColor);
+			m_pShaderManager->setFloatValue(g_MaterialAmbientStrengthName, material.ambientStrength);
+			m_pShaderManager->setVec3Value(g_MaterialDiffuseColorName, material.diffuseColor);
+			m_pShaderManager->setVec3Value(g_MaterialSpecularColorName, material.specularColor);
+			m_pShaderManager->setFloatValue(g_MaterialShininessName, material.shininess);
 		}
 	}
 }
@@ -415,6 +635,7 @@ void SceneManager::DefineObjectMaterials()
 	goldMaterial.specularColor = glm::vec3(0.5f, 0.45f, 0.35f);
 	goldMaterial.shininess = 30.0;
 	goldMaterial.tag = "gold";
+	goldMaterial.bTransparent = false;
 	m_objectMaterials.push_back(goldMaterial);
 
 	OBJECT_MATERIAL cementMaterial;
@@ -424,6 +645,7 @@ void SceneManager::DefineObjectMaterials()
 	cementMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
 	cementMaterial.shininess = 0.3;
 	cementMaterial.tag = "cement";
+	cementMaterial.bTransparent = false;
 	m_objectMaterials.push_back(cementMaterial);
 
 	OBJECT_MATERIAL woodMaterial;
@@ -433,6 +655,7 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.specularColor = glm::vec3(0.01f, 0.01f, 0.01f);
 	woodMaterial.shininess =0.01;
 	woodMaterial.tag = "wood";
+	woodMaterial.bTransparent = false;
 	m_objectMaterials.push_back(woodMaterial);
 
 	OBJECT_MATERIAL tileMaterial;
@@ -442,6 +665,7 @@ void SceneManager::DefineObjectMaterials()
 	tileMaterial.specularColor = glm::vec3(0.5f, 0.4f, 0.3f);  
 	tileMaterial.shininess = 15.0;
 	tileMaterial.tag = "tile";
+	tileMaterial.bTransparent = false;
 	m_objectMaterials.push_back(tileMaterial);
 
 	OBJECT_MATERIAL glassMaterial;
@@ -451,6 +675,7 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
 	glassMaterial.shininess = 20.0;
 	glassMaterial.tag = "glass";
+	glassMaterial.bTransparent = true;
 	m_objectMaterials.push_back(glassMaterial);
 
 	OBJECT_MATERIAL clayMaterial;
@@ -460,6 +685,7 @@ void SceneManager::DefineObjectMaterials()
 	clayMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.6f);
 	clayMaterial.shininess = 5.0;
 	clayMaterial.tag = "clay";
+	clayMaterial.bTransparent = false;
 	m_objectMaterials.push_back(clayMaterial);
 
 	OBJECT_MATERIAL clothMaterial;
@@ -469,6 +695,7 @@ void SceneManager::DefineObjectMaterials()
 	clothMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);  // very low specular highlights
 	clothMaterial.shininess = 0.1;  // low shininess for a matte finish
 	clothMaterial.tag = "cloth";  
+	clothMaterial.bTransparent = false;
 	m_objectMaterials.push_back(clothMaterial);  
 
 	OBJECT_MATERIAL paperMaterial;
@@ -478,6 +705,7 @@ void SceneManager::DefineObjectMaterials()
 	paperMaterial.specularColor = glm::vec3(0.3f, 0.1f, 0.1f);  // very subtle specular highlights
 	paperMaterial.shininess = 0.5;  // very low shininess for a nearly matte finish
 	paperMaterial.tag = "paper";  
+	paperMaterial.bTransparent = false;
 	m_objectMaterials.push_back(paperMaterial);  
 
 
@@ -494,43 +722,81 @@ void SceneManager::SetupSceneLights()
 	// the 3D scene with custom lighting, if no light sources have
 	// been added then the display window will be black 
 
-	/*** STUDENTS - add the code BELOW for setting up light sources ***/
-	/*** Up to four light sources can be defined. Refer to the code ***/
-	/*** in the OpenGL Sample for help  **/
-	
+	m_pLighting->ClearLights();
+
+	/*** Any number of point and spot lights can be added. They ***/
+	/*** are binned into view-space clusters every frame, so a  ***/
+	/*** fragment only pays for the lights within their range.  ***/
+	/*** A range of zero lights the whole scene.                ***/
+
 	// Main Light (Brighter and more diffuse)
-	m_pShaderManager->setVec3Value("lightSources[0].position", -8.0f, 30.0f, 30.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.5f, 0.5f, 0.1f); // Brighter diffuse light
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.7f, 0.6f, 0.5f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 2.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.05f);
+	m_pLighting->AddPointLight(
+		glm::vec3(-8.0f, 30.0f, 30.0f),   // position
+		glm::vec3(0.2f, 0.2f, 0.2f),      // ambient color
+		glm::vec3(0.5f, 0.5f, 0.1f),      // diffuse color - Brighter diffuse light
+		glm::vec3(0.7f, 0.6f, 0.5f),      // specular color
+		2.0f,                             // focal strength
+		0.05f,                            // specular intensity
+		0.0f);                            // range
 
 	// Additional Soft Fill Light (inside the flower vase)
-	m_pShaderManager->setVec3Value("lightSources[1].position", 20.0f, 20.0f, -5.0f);
-	//m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.1f, 0.1f, 0.1f);
-	//m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.3f, 0.3f, 0.3f); // Softer light
-	//m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.5f, 0.5f, 0.5f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 0.001f);
-	//m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.3f);
+	m_pLighting->AddPointLight(
+		glm::vec3(20.0f, 20.0f, -5.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.1f
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.3f
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.5f
+		0.001f,
+		0.0f,                             // softer alternative: 0.3f
+		0.0f);
 
 	// Overhead Soft Light
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0f, 0.0f, 10.0f);
-	//m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.2f, 0.2f, 0.2f);
-	//m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.2f, 0.2f, 0.2f);
-	//m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 0.03f);
-	//m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.4f);
+	m_pLighting->AddPointLight(
+		glm::vec3(0.0f, 0.0f, 10.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.2f
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.2f
+		glm::vec3(0.0f, 0.0f, 0.0f),      // softer alternative: 0.8f
+		0.03f,
+		0.0f,                             // softer alternative: 0.4f
+		0.0f);
 
 	// FOURTH LIGHT SOURCE
-	m_pShaderManager->setVec3Value("lightSources[3].position", -10.0f, -5.0f, 10.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.3f, 0.3f, 0.3f);
-	//m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.1f, 0.1f, 0.1f);
-	//m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.1f, 0.1f, 0.1f);  // Reduced to very soft highlights
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 0.01f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.1f);  // Minimized glare
-	
-	m_pShaderManager->setBoolValue("bUseLighting", true);
+	m_pLighting->AddPointLight(
+		glm::vec3(-10.0f, -5.0f, 10.0f),
+		glm::vec3(0.3f, 0.3f, 0.3f),
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		glm::vec3(0.0f, 0.0f, 0.0f),      // Reduced to very soft highlights
+		0.01f,
+		0.1f,                             // Minimized glare
+		0.0f);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue("bUseLighting", true);
+	}
+}
+
+/***********************************************************
+ *  LoadSceneTextures()
+ *
+ *  This method loads the texture images of the scene, into
+ *  OpenGL textures or into the software rasterizer when the
+ *  scene is rendered without a GPU.
+ ***********************************************************/
+void SceneManager::LoadSceneTextures()
+{
+	CreateSceneTexture("Resourses\\knife_handle.jpg", "floor");
+	CreateSceneTexture("Resourses\\body3.jpg", "candelbase");
+	CreateSceneTexture("Resourses\\body3.jpg", "candelbody");
+	CreateSceneTexture("Resourses\\silverbase.jpg", "base");
+	CreateSceneTexture("Resourses\\silverbase.jpg", "top");
+	CreateSceneTexture("Resourses\\vase.jpg", "vase");
+	CreateSceneTexture("Resourses\\alexa.jpg", "alexa");
+	CreateSceneTexture("Resourses\\harddrive.jpg", "drive");
+	CreateSceneTexture("Resourses\\bookcover.png", "book");
+	CreateSceneTexture("Resourses\\stainless_end.jpg", "basering");
+	CreateSceneTexture("Resourses\\stainless_end.jpg", "topring");
+	CreateSceneTexture("Resourses\\backdrop.jpg", "backdrop");
+	CreateSceneTexture("Resourses\\drywall.jpg", "drywall");
 }
 
 /***********************************************************
@@ -542,775 +808,2094 @@ void SceneManager::SetupSceneLights()
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	
-	// add and define the light sources for the scene
-	SetupSceneLights();
-	// define the materials for objects in the scene
-	DefineObjectMaterials();
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-
-	
-	// Load the texture
-	glEnable(GL_TEXTURE_2D);
-	CreateGLTexture("Resourses\\knife_handle.jpg", "floor");
-	CreateGLTexture("Resourses\\body3.jpg", "candelbase");
-	CreateGLTexture("Resourses\\body3.jpg", "candelbody");
-	CreateGLTexture("Resourses\\silverbase.jpg", "base");
-	CreateGLTexture("Resourses\\silverbase.jpg", "top");
-	CreateGLTexture("Resourses\\vase.jpg", "vase");
-	CreateGLTexture("Resourses\\alexa.jpg", "alexa");
-	CreateGLTexture("Resourses\\harddrive.jpg", "drive");
-	CreateGLTexture("Resourses\\bookcover.png", "book");
-	CreateGLTexture("Resourses\\stainless_end.jpg", "basering");
-	CreateGLTexture("Resourses\\stainless_end.jpg", "topring");
-	CreateGLTexture("Resourses\\backdrop.jpg", "backdrop");
-	CreateGLTexture("Resourses\\drywall.jpg", "drywall");
+	// add the lights, materials, textures and objects drawn in
+	// the scene
+	DefineSceneContent();
+
+	// the lightmap needs the lights and objects defined above
+	BuildMeshGeometry();
+	BuildLightmaps();
+	// the batches take the unwrapped meshes of the lightmap
+	BuildStaticBatches();
+
+	size_t vertexBytes = 0;
+	size_t floatVertexBytes = 0;
+	MeshGeometry* geometries[3] = { m_pMeshGeometry, m_pLightmapGeometry, m_pStaticGeometry };
+	for (int i = 0; i < 3; i++)
+	{
+		if (NULL != geometries[i])
+		{
+			vertexBytes += geometries[i]->GetVertexBufferBytes();
+			floatVertexBytes += geometries[i]->GetFloatVertexBytes();
+		}
+	}
+	std::cout << "INFO: Scene Vertex Buffers: " << vertexBytes / 1024 << " KB ("
+		<< floatVertexBytes / 1024 << " KB with float vertices)" << std::endl;
+
+	// the specialized shader variants are built from the same
+	// sources as the program loaded by the shader manager, all
+	// of them are started now and finish while frames render
+	if (m_pShaderVariants->LoadSources(g_VertexShaderPath, g_FragmentShaderPath) == true)
+	{
+		for (size_t i = 0; i < m_sceneObjects.size(); i++)
+		{
+			m_pShaderVariants->RequestVariant(GetObjectShaderKey(m_sceneObjects[i]));
+			// the lightmap can be turned off at runtime, so both
+			// variants of a lightmapped object are built
+			if (m_sceneObjects[i].lightmapMesh >= 0)
+			{
+				m_pShaderVariants->RequestVariant(ShaderVariants::MakeKey(
+					m_sceneObjects[i].shaderFeatures,
+					(unsigned int)m_pLighting->GetLightCount()));
+			}
+		}
+	}
+
+	// the depth pre-pass only needs the vertex positions
+	m_pDepthShader = new ShaderManager();
+	m_pDepthShader->LoadShaders(g_DepthVertexShaderPath, g_DepthFragmentShaderPath);
 
+	// the bounding boxes are drawn with the same depth-only program
+	if (m_pDepthShader->m_programID != 0)
+	{
+		m_pOcclusion = new OcclusionCulling(m_pStateCache, m_pDepthShader);
+	}
+
+	// the compute shader culling needs OpenGL 4.3
+	if (GpuCulling::IsSupported() == true)
+	{
+		BuildGpuScene();
+	}
+
+	// the impostors are rendered with the finished variants
+	BuildImpostors();
 }
 /***********************************************************
- *  RenderScene()
+ *  DefineSceneObjects()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for defining the objects that make
+ *  up the 3D scene - the basic shape, transformations,
+ *  texture and material for each one.
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::DefineSceneObjects()
 {
-	glEnable(GL_LIGHTING); // Enable lighting for 3D rendering
-
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
 	/*****************************************************/
 	//background back-plane
 	/*****************************************************/
+	AddSceneObject(
+		MESH_PLANE,
+		glm::vec3(50.0f, 30.0f, 50.0f),
+		90.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.0f, -10.0f),
+		"backdrop",
+		"paper");
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(50.0f, 30.0f, 50.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, -10.0f);
+	/*****************************************************/
+	//background right-plane
+	/*****************************************************/
+	AddSceneObject(
+		MESH_PLANE,
+		glm::vec3(50.0f, 30.0f, 50.0f),
+		90.0f, 0.0f, 90.0f,
+		glm::vec3(30.0f, 0.0f, 0.0f),
+		"drywall",
+		"paper");
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	/*****************************************************/
+	//ground plane "base"
+	/*****************************************************/
+	AddSceneObject(
+		MESH_PLANE,
+		glm::vec3(30.0f, 3.5f, 10.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(0.0f, 0.0f, 0.0f),
+		"floor",
+		"wood");
+
+	// the six parts of the candle holder are one composite
+	// object, drawn as an impostor from far away
+	int candleObject = (int)m_sceneObjects.size();
 
-	// set the color values into the shader
-	//SetShaderColor(0.3, 0.4, 0.1, 1);
-	// set the texture for the mesh
-	SetShaderTexture("backdrop");
+	/****************************************************************/
+	// Torus mesh Candle-Bottom- ring
+	/****************************************************************/
+	AddSceneObject(
+		MESH_TORUS,
+		glm::vec3(0.3f, 0.5f, 1.5f),
+		85.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 0.2f, 5.0f),
+		"basering",
+		"wood");
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	/****************************************************************/
+	// Tapered Cylinder mesh candel lowerbody
+	/****************************************************************/
+	AddSceneObject(
+		MESH_TAPERED_CYLINDER,
+		glm::vec3(0.6f, 1.5f, 0.8f),
+		180.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 1.8f, 5.0f),
+		"candelbase",
+		"glass");
 
-	// Retrieve the texture ID using its tag
-	int backdropID = FindTextureID("backdrop");
+	/****************************************************************/
+	// Cylinder mesh candel base
+	/****************************************************************/
+	AddSceneObject(
+		MESH_CYLINDER,
+		glm::vec3(1.0f, 0.1f, 1.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 0.0f, 5.0f),
+		"base",
+		"clay");
 
-	// Check if the texture ID was found
-	if (backdropID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, backdropID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // Assuming this sets the texture sampler uniform to 0
-	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
-	}
+	/****************************************************************/
+	// Tapered Cylinder mesh candel upperbody
+	/****************************************************************/
+	AddSceneObject(
+		MESH_TAPERED_CYLINDER,
+		glm::vec3(0.6f, 3.0f, 0.8f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 1.8f, 5.0f),
+		"candelbase",
+		"glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	/****************************************************************/
+	// Torus mesh-Candle Top ring
+	/****************************************************************/
+	AddSceneObject(
+		MESH_TORUS,
+		glm::vec3(0.3f, 0.5f, 2.0f),
+		90.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 4.8f, 5.0f),
+		"topring",
+		"glass");
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	/****************************************************************/
+	//  Cylinder mesh Top
+	/****************************************************************/
+	AddSceneObject(
+		MESH_CYLINDER,
+		glm::vec3(1.0f, 0.1f, 1.0f),
+		0.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 4.9f, 5.0f),
+		"top",
+		"clay");
 
-	/*****************************************************/
-	//background right-plane
-	/*****************************************************/
+	AddCompositeObject(candleObject, (int)m_sceneObjects.size() - candleObject, 25.0f);
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(50.0f, 30.0f, 50.0f);
+	/****************************************************************/
+	// Tapered Cylinder flower vase
+	/****************************************************************/
+	AddSceneObject(
+		MESH_TAPERED_CYLINDER,
+		glm::vec3(5.0f, 20.0f, 1.0f),
+		-180.0f, 0.0f, 0.0f,
+		glm::vec3(20.0f, 20.0f, -5.0f),
+		"vase",
+		"glass");
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 90.0f;
+	/****************************************************************/
+	// Torus mesh white sphere  
+	/****************************************************************/
+	AddSceneObject(
+		MESH_SPHERE,
+		glm::vec3(1.0f, 1.0f, 1.0f),
+		210.0f, 0.0f, 110.0f,
+		glm::vec3(7.0f, 1.0f, 5.0f),
+		"alexa",
+		"cloth");
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(30.0f, 0.0f, 0.0f);
+	/****************************************************************/
+	//  Box1 Mesh black Hrad drive
+	/****************************************************************/
+	AddSceneObject(
+		MESH_BOX,
+		glm::vec3(3.5f, 3.5f, 0.5f),
+		0.0f, 0.0f, 180.0f,
+		glm::vec3(7.0f, 1.75f, 3.0f),
+		"drive",
+		"glass");
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	//***************************************************************/
+	//  Box#2 Mesh the book
+	/****************************************************************/
+	AddSceneObject(
+		MESH_BOX,
+		glm::vec3(4.0f, 5.0f, 0.5f),
+		-90.0f, 0.0f, 0.0f,
+		glm::vec3(-2.0f, 0.25f, 3.0f),
+		"book",
+		"paper");
+}
 
-	// set the color values into the shader
-	//SetShaderColor(1.0, 0.5, 0.3, 1);
+/***********************************************************
+ *  DefineSceneContent()
+ *
+ *  This method defines the lights, materials, textures and
+ *  objects of the scene, from the scene file when one was
+ *  loaded and otherwise with the methods above, and then
+ *  places the model files added on the command line.
+ ***********************************************************/
+void SceneManager::DefineSceneContent()
+{
+	if (m_sceneFile.IsOpen() == true)
+	{
+		DefineSceneFromFile();
+	}
+	else
+	{
+		// add and define the light sources for the scene
+		SetupSceneLights();
+		// define the materials for objects in the scene
+		DefineObjectMaterials();
+		// Load the texture
+		LoadSceneTextures();
+		// define the objects drawn in the scene
+		DefineSceneObjects();
+	}
 
-	//SetShaderMaterial("cloth");
-	// set the texture for the mesh
-	SetShaderTexture("drywall");
+	AddModelObjects();
+}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+/***********************************************************
+ *  AddModelObjects()
+ *
+ *  This method imports the model files added on the command
+ *  line and places them in a row on the left of the table.
+ ***********************************************************/
+void SceneManager::AddModelObjects()
+{
+	for (size_t i = 0; i < m_modelFiles.size(); i++)
+	{
+		MESH_TYPE model;
+		if (ImportMesh(m_modelFiles[i].c_str(), model) == true)
+		{
+			AddSceneObject(
+				model,
+				glm::vec3(2.0f, 2.0f, 2.0f),
+				0.0f, 0.0f, 0.0f,
+				glm::vec3(-12.0f - (6.0f * (float)i), 0.0f, 5.0f),
+				"base",
+				"clay");
+		}
+	}
+}
 
-	// Retrieve the texture ID using its tag
-	int drywallID = FindTextureID("drywall");
+/***********************************************************
+ *  LoadSceneFile()
+ *
+ *  This method maps a compiled scene that PrepareScene() then
+ *  builds the scene from, in place of the lights, materials,
+ *  textures and objects defined in code.  The models of the
+ *  scene are imported here, so a scene that can not be built
+ *  is rejected before anything is prepared.
+ ***********************************************************/
+bool SceneManager::LoadSceneFile(const char* filename)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-	// Check if the texture ID was found
-	if (drywallID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, drywallID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // Assuming this sets the texture sampler uniform to 0
+	if (m_sceneFile.Open(filename) == false)
+	{
+		return(false);
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	if (m_sceneFile.GetCount(SceneFile::SECTION_TEXTURES) > (int)(sizeof(m_textureIDs) / sizeof(m_textureIDs[0])))
+	{
+		std::cout << "Scene file has more textures than there are slots:" << filename << std::endl;
+		m_sceneFile.Close();
+		return(false);
 	}
-	
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
 
-	/*****************************************************/
-	//ground plane "base"
-	/*****************************************************/
+	std::cout << "INFO: Scene File Mapped: " << filename << ", " << m_sceneFile.GetSize() << " bytes in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+		<< " ms" << std::endl;
 
-	/****************************************************************/
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(30.0f, 3.5f, 10.0f);
+	const SceneFile::MODEL_RECORD* models = m_sceneFile.GetModels();
+	m_sceneModels.resize(m_sceneFile.GetCount(SceneFile::SECTION_MODELS));
+	for (size_t i = 0; i < m_sceneModels.size(); i++)
+	{
+		if (ImportMesh(m_sceneFile.GetString(models[i].file), m_sceneModels[i]) == false)
+		{
+			m_sceneFile.Close();
+			return(false);
+		}
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	return(true);
+}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+/***********************************************************
+ *  DefineSceneFromFile()
+ *
+ *  This method builds the lights, materials and objects of
+ *  the scene straight from the records of the scene file.
+ *  The lights are copied in one block in the layout of the
+ *  light buffer, and the materials and objects into lists
+ *  sized once, so defining the scene costs no more than
+ *  copying its records.  The textures are loaded last.
+ ***********************************************************/
+void SceneManager::DefineSceneFromFile()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	m_pLighting->SetLights(m_sceneFile.GetLights(), m_sceneFile.GetCount(SceneFile::SECTION_LIGHTS));
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	}
 
-		
-	// set the color values into the shader
-	//SetShaderColor(0.4, 0.3, 0.4, 1);
-	
-	SetShaderMaterial("wood");
+	const SceneFile::MATERIAL_RECORD* materials = m_sceneFile.GetMaterials();
+	int materialCount = m_sceneFile.GetCount(SceneFile::SECTION_MATERIALS);
+	m_objectMaterials.reserve(m_objectMaterials.size() + materialCount);
+	for (int i = 0; i < materialCount; i++)
+	{
+		OBJECT_MATERIAL material;
+		material.ambientColor = materials[i].ambientColor;
+		material.ambientStrength = materials[i].ambientStrength;
+		material.diffuseColor = materials[i].diffuseColor;
+		material.specularColor = materials[i].specularColor;
+		material.shininess = materials[i].shininess;
+		material.bTransparent = (materials[i].bTransparent != 0);
+		material.tag = m_sceneFile.GetString(materials[i].tag);
+		m_objectMaterials.push_back(material);
+	}
 
-	// set the texture for the mesh
-	SetShaderTexture("floor");
+	const SceneFile::OBJECT_RECORD* objects = m_sceneFile.GetObjects();
+	int objectCount = m_sceneFile.GetCount(SceneFile::SECTION_OBJECTS);
+	int firstObject = (int)m_sceneObjects.size();
+	m_sceneObjects.reserve(firstObject + objectCount + m_modelFiles.size());
+	for (int i = 0; i < objectCount; i++)
+	{
+		const SceneFile::OBJECT_RECORD& object = objects[i];
+		MESH_TYPE mesh = (object.shape >= 0) ? (MESH_TYPE)object.shape : m_sceneModels[object.model];
+		AddSceneObject(
+			mesh,
+			object.scaleXYZ,
+			object.rotationDegrees.x,
+			object.rotationDegrees.y,
+			object.rotationDegrees.z,
+			object.positionXYZ,
+			m_sceneFile.GetString(object.textureTag),
+			m_sceneFile.GetString(object.materialTag));
+		m_sceneObjects.back().bStatic = ((object.flags & SceneFile::OBJECT_STATIC) != 0);
+	}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	const SceneFile::COMPOSITE_RECORD* composites = m_sceneFile.GetComposites();
+	for (int i = 0; i < m_sceneFile.GetCount(SceneFile::SECTION_COMPOSITES); i++)
+	{
+		AddCompositeObject(
+			firstObject + (int)composites[i].firstObject,
+			(int)composites[i].objectCount,
+			composites[i].impostorDistance);
+	}
 
-	// Retrieve the texture ID using its tag
-	int floorID = FindTextureID("floor");
+	std::cout << "INFO: Scene Defined From File: " << objectCount << " objects, "
+		<< materialCount << " materials, "
+		<< m_sceneFile.GetCount(SceneFile::SECTION_LIGHTS) << " lights in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+		<< " ms" << std::endl;
 
-	// Check if the texture ID was found
-	if (floorID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, floorID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // Assuming this sets the texture sampler uniform to 0
-	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+	const SceneFile::TEXTURE_RECORD* textures = m_sceneFile.GetTextures();
+	for (int i = 0; i < m_sceneFile.GetCount(SceneFile::SECTION_TEXTURES); i++)
+	{
+		CreateSceneTexture(m_sceneFile.GetString(textures[i].file), m_sceneFile.GetString(textures[i].tag));
 	}
+}
 
-	// draw the mesh with transformation values - this plane is used for the base
-	m_basicMeshes->DrawPlaneMesh();
+/***********************************************************
+ *  ImportMesh()
+ *
+ *  This method imports a model file as the next mesh after
+ *  the basic shapes.  The model is moved and scaled to stand
+ *  on the origin within the box from -1 to 1, the size of
+ *  the basic shapes, so objects scale it like any of them
+ *  and the compact vertices, which are fractions of the
+ *  bounds of all the meshes, keep their precision.
+ ***********************************************************/
+bool SceneManager::ImportMesh(const char* filename, MESH_TYPE& mesh)
+{
+	if (NULL != m_pMeshGeometry)
+	{
+		std::cout << "Models can only be imported before the mesh geometry is built:" << filename << std::endl;
+		return(false);
+	}
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	MeshGeometry::MESH_DATA data;
+	MeshImporter importer(m_pJobSystem);
+	if (importer.Import(filename, data) == false)
+	{
+		return(false);
+	}
+	importer.Report(filename);
+
+	glm::vec3 minimum;
+	glm::vec3 maximum;
+	MeshGeometry::ComputeBounds(data, minimum, maximum);
+	glm::vec3 size = maximum - minimum;
+	float largestSize = std::max(size.x, std::max(size.y, size.z));
+	float scale = (largestSize > 0.0f) ? 2.0f / largestSize : 1.0f;
+	glm::vec3 base((minimum.x + maximum.x) * 0.5f, minimum.y, (minimum.z + maximum.z) * 0.5f);
+	for (size_t i = 0; i < data.vertices.size(); i++)
+	{
+		data.vertices[i].position = (data.vertices[i].position - base) * scale;
+	}
 
+	mesh = (MESH_TYPE)(MESH_IMPORTED + (int)m_importedMeshes.size());
+	m_importedMeshes.push_back(MeshGeometry::MESH_DATA());
+	m_importedMeshes.back().vertices.swap(data.vertices);
+	m_importedMeshes.back().indices.swap(data.indices);
 
-	/****************************************************************/
-	// Torus mesh Candle-Bottom- ring
-	/****************************************************************/
+	return(true);
+}
 
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.3f, 0.5f, 1.5f);
+/***********************************************************
+ *  AddModelFile()
+ *
+ *  This method adds a model file to import and place in the
+ *  scene when it is prepared.
+ ***********************************************************/
+void SceneManager::AddModelFile(const char* filename)
+{
+	m_modelFiles.push_back(filename);
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 85.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  AddCompositeObject()
+ *
+ *  This method groups scene objects that were added one
+ *  after another into a composite object.  Up close its
+ *  parts are drawn as usual, beyond the passed in distance
+ *  from the camera a baked impostor is drawn instead.
+ ***********************************************************/
+void SceneManager::AddCompositeObject(int firstObject, int objectCount, float impostorDistance)
+{
+	COMPOSITE_OBJECT composite;
+	composite.impostorDistance = impostorDistance;
+	composite.center = glm::vec3(0.0f);
+	composite.halfSize = 0.0f;
+	composite.bImpostor = false;
+	composite.viewDepth = 0.0f;
+
+	for (int i = firstObject; i < firstObject + objectCount; i++)
+	{
+		m_sceneObjects[i].composite = (int)m_compositeObjects.size();
+		composite.objects.push_back(i);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 0.2f, 5.0f);
+	m_compositeObjects.push_back(composite);
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+/***********************************************************
+ *  UpdateTransformations()
+ *
+ *  This method recalculates the model matrix of every scene
+ *  object, spreading the work over the job system workers.
+ ***********************************************************/
+void SceneManager::UpdateTransformations()
+{
+	std::vector<SCENE_OBJECT>& objects = m_sceneObjects;
 
-	// set the color values into the shader
-	//SetShaderColor(1, 1, 0, 1);
+	m_pJobSystem->ParallelFor(
+		"UpdateTransformations",
+		(unsigned int)objects.size(),
+		64,
+		[&objects](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				objects[i].modelMatrix = BuildModelMatrix(
+					objects[i].scaleXYZ,
+					objects[i].XrotationDegrees,
+					objects[i].YrotationDegrees,
+					objects[i].ZrotationDegrees,
+					objects[i].positionXYZ);
+			}
+		});
+}
 
+/***********************************************************
+ *  BindObjectTexture()
+ *
+ *  This method is used for binding the texture associated
+ *  with the passed in tag to texture unit 0 for the next
+ *  draw command.
+ ***********************************************************/
+void SceneManager::BindObjectTexture(const char* textureTag)
+{
 	// set the texture for the mesh
-	SetShaderTexture("basering");
-
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	SetShaderTexture(textureTag);
 
 	// Retrieve the texture ID using its tag
-	int baseringID = FindTextureID("basering");
+	int textureID = FindTextureID(textureTag);
 
 	// Check if the texture ID was found
-	if (baseringID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, baseringID);
+	if (textureID != -1) {
+		// Bind the texture to unit 0, skipped when it is already bound
+		m_pStateCache->BindTextureUnit(0, GL_TEXTURE_2D, textureID);
 		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
 	}
 	else {
 		std::cerr << "texture not found!" << std::endl;
 		// Handling the error 
 	}
+}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
-
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
-	
-	/****************************************************************/
-	// Tapered Cylinder mesh candel lowerbody
-	/****************************************************************/
-	
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.6f, 1.5f, 0.8f);
+/***********************************************************
+ *  SortSceneObjects()
+ *
+ *  This method splits the scene objects into the opaque and
+ *  transparent passes by their material, leaving out those
+ *  that were found to be hidden, then sorts the
+ *  opaque ones front to back and the transparent ones back
+ *  to front by the view depth of their origin.
+ ***********************************************************/
+void SceneManager::SortSceneObjects()
+{
+	m_opaqueOrder.clear();
+	m_transparentOrder.clear();
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 180.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	bool bOcclusion = (m_bOcclusionCulling == true) && (NULL != m_pOcclusion);
+	if (bOcclusion == true)
+	{
+		m_pOcclusion->BeginFrame((int)m_sceneObjects.size());
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 1.8f, 5.0f);
+	// far composite objects are drawn as their impostors, in
+	// place of all their parts
+	bool bImpostors = IsImpostorReady();
+	m_impostorOrder.clear();
+	for (size_t i = 0; i < m_compositeObjects.size(); i++)
+	{
+		COMPOSITE_OBJECT& composite = m_compositeObjects[i];
+		composite.bImpostor = (bImpostors == true) &&
+			(glm::length(m_viewPosition - composite.center) > composite.impostorDistance);
+		composite.viewDepth = -(m_viewMatrix * glm::vec4(composite.center, 1.0f)).z;
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	// a batch is drawn when any of its objects is visible
+	bool bBatching = IsStaticBatchingReady();
+	m_staticBatchOrder.clear();
+	for (size_t i = 0; i < m_staticBatches.size(); i++)
+	{
+		m_staticBatches[i].bVisible = false;
+	}
 
-	// set the color values into the shader
-	//SetShaderColor(1, 0.2, 0, 1);
+	for (int i = 0; i < (int)m_sceneObjects.size(); i++)
+	{
+		// objects whose box was hidden last frame are left out
+		if ((bOcclusion == true) && (m_pOcclusion->IsVisible(i) == false))
+		{
+			continue;
+		}
 
-	SetShaderMaterial("glass");
+		int composite = m_sceneObjects[i].composite;
+		if ((composite >= 0) && (m_compositeObjects[composite].bImpostor == true))
+		{
+			// the impostor is drawn once, when any part is visible
+			if (std::find(m_impostorOrder.begin(), m_impostorOrder.end(), composite) == m_impostorOrder.end())
+			{
+				m_impostorOrder.push_back(composite);
+			}
+			continue;
+		}
 
-	// set the texture for the mesh
-	SetShaderTexture("candelbase");
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
-	// Retrieve the texture ID using its tag
-	int candelbaseID = FindTextureID("candelbase");
+		if ((bBatching == true) && (m_sceneObjects[i].staticBatch >= 0))
+		{
+			STATIC_BATCH& batch = m_staticBatches[m_sceneObjects[i].staticBatch];
+			float depth = -(m_viewMatrix * m_sceneObjects[i].modelMatrix[3]).z;
+			if ((batch.bVisible == false) || (depth < batch.viewDepth))
+			{
+				batch.viewDepth = depth;
+			}
+			if (batch.bVisible == false)
+			{
+				batch.bVisible = true;
+				m_staticBatchOrder.push_back(m_sceneObjects[i].staticBatch);
+			}
+			continue;
+		}
 
-	// Check if the texture ID was found
-	if (candelbaseID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, candelbaseID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
-	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+		if (m_sceneObjects[i].bTransparent == true)
+		{
+			m_transparentOrder.push_back(i);
+		}
+		else
+		{
+			m_opaqueOrder.push_back(i);
+		}
 	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTaperedCylinderMesh();
-
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
-	
+	// distance in front of the camera of every object's origin
+	const std::vector<SCENE_OBJECT>& objects = m_sceneObjects;
+	const glm::mat4& view = m_viewMatrix;
+	auto viewDepth = [&objects, &view](int index)
+	{
+		return(-(view * objects[index].modelMatrix[3]).z);
+	};
+
+	std::sort(m_opaqueOrder.begin(), m_opaqueOrder.end(),
+		[&viewDepth](int a, int b) { return(viewDepth(a) < viewDepth(b)); });
+	std::sort(m_transparentOrder.begin(), m_transparentOrder.end(),
+		[&viewDepth](int a, int b) { return(viewDepth(a) > viewDepth(b)); });
+
+	// the batches go front to back by their nearest object
+	const std::vector<STATIC_BATCH>& batches = m_staticBatches;
+	std::sort(m_staticBatchOrder.begin(), m_staticBatchOrder.end(),
+		[&batches](int a, int b) { return(batches[a].viewDepth < batches[b].viewDepth); });
+
+	const std::vector<COMPOSITE_OBJECT>& composites = m_compositeObjects;
+	std::sort(m_impostorOrder.begin(), m_impostorOrder.end(),
+		[&composites](int a, int b) { return(composites[a].viewDepth > composites[b].viewDepth); });
+}
 
-	/****************************************************************/
-	// Cylinder mesh candel base
-	/****************************************************************/
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method selects the shader, sets the transformation,
+ *  material and texture of a scene object, and draws it.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(const SCENE_OBJECT& object)
+{
+	UseObjectShader(object);
 
-	// set the XYZ scale for the1mesh
-	scaleXYZ = glm::vec3(1.0f, 0.1f, 1.0f);
+	// set the transformations into memory to be used on the drawn meshes
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(g_ModelName, object.modelMatrix);
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	SetShaderMaterial(object.materialTag);
+	BindObjectTexture(object.textureTag);
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 0.0f, 5.0f);
+	if (IsObjectLightmapped(object) == true)
+	{
+		m_pStateCache->BindTextureUnit(g_LightmapTextureUnit, GL_TEXTURE_2D, m_lightmapTexture);
+		m_pShaderManager->setSampler2DValue(g_LightmapTextureName, g_LightmapTextureUnit);
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	// draw the mesh with transformation values
+	DrawObjectGeometry(object, m_pShaderManager);
+}
 
-	// set the color values into the shader
-	//SetShaderColor(0.1, 0.4, 0.3, 1);
-	SetShaderMaterial("clay");
+/***********************************************************
+ *  DrawObjectGeometry()
+ *
+ *  This method draws the geometry of a scene object - the
+ *  unwrapped copy of its shape when it uses the lightmap,
+ *  otherwise its mesh in the mesh geometry, which holds the
+ *  basic shapes at the scene's tessellation next to the
+ *  imported meshes - telling the vertex shader of the passed
+ *  in program how its vertices are stored.
+ ***********************************************************/
+void SceneManager::DrawObjectGeometry(const SCENE_OBJECT& object, const ShaderManager* pShader)
+{
+	if (IsObjectLightmapped(object) == true)
+	{
+		m_pLightmapGeometry->SetVertexUniforms(pShader);
+		m_pStateCache->BindVertexArray(m_pLightmapGeometry->GetVertexArray());
+		m_pLightmapGeometry->Draw(object.lightmapMesh);
+	}
+	else
+	{
+		m_pMeshGeometry->SetVertexUniforms(pShader);
+		m_pStateCache->BindVertexArray(m_pMeshGeometry->GetVertexArray());
+		m_pMeshGeometry->Draw(object.mesh);
+	}
+}
 
-	// set the texture for the mesh
-	SetShaderTexture("base");
+/***********************************************************
+ *  RenderDepthPrepass()
+ *
+ *  This method draws the opaque objects front to back into
+ *  the depth buffer only, with a program that reads nothing
+ *  but the vertex positions and has no fragment work.
+ ***********************************************************/
+void SceneManager::RenderDepthPrepass()
+{
+	m_pPrepassTimer->Begin();
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	m_pStateCache->UseProgram(m_pDepthShader->m_programID);
+	m_pDepthShader->setMat4Value("view", m_viewMatrix);
+	m_pDepthShader->setMat4Value("projection", m_projectionMatrix);
 
-	// Retrieve the texture ID using its tag
-	int baseID = FindTextureID("base");
+	m_pStateCache->ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	m_pStateCache->DepthFunc(GL_LESS);
+	m_pStateCache->DepthMask(GL_TRUE);
 
-	// Check if the texture ID was found
-	if (candelbaseID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, baseID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
+	// the static batches are already in world space
+	m_pDepthShader->setMat4Value(g_ModelName, glm::mat4(1.0f));
+	for (size_t i = 0; i < m_staticBatchOrder.size(); i++)
+	{
+		DrawStaticBatchGeometry(m_staticBatchOrder[i], m_pDepthShader);
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	for (size_t i = 0; i < m_opaqueOrder.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[m_opaqueOrder[i]];
+
+		m_pDepthShader->setMat4Value(g_ModelName, object.modelMatrix);
+		DrawObjectGeometry(object, m_pDepthShader);
 	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pStateCache->ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
 
+	m_pPrepassTimer->End();
+}
 
-	/****************************************************************/
-	// Tapered Cylinder mesh candel upperbody
-	/****************************************************************/
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method returns the bounding box of a basic shape in
+ *  its own space.  The boxes err on the large side, since a
+ *  box that is too small could hide a visible object.  The
+ *  imported meshes have their bounds measured.
+ ***********************************************************/
+void SceneManager::GetMeshBounds(MESH_TYPE mesh, glm::vec3& minimum, glm::vec3& maximum) const
+{
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		minimum = glm::vec3(-1.0f, 0.0f, -1.0f);
+		maximum = glm::vec3(1.0f, 0.0f, 1.0f);
+		break;
+	case MESH_BOX:
+		minimum = glm::vec3(-0.5f);
+		maximum = glm::vec3(0.5f);
+		break;
+	case MESH_CYLINDER:
+	case MESH_CONE:
+	case MESH_TAPERED_CYLINDER:
+		minimum = glm::vec3(-1.0f, 0.0f, -1.0f);
+		maximum = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	case MESH_SPHERE:
+		minimum = glm::vec3(-1.0f);
+		maximum = glm::vec3(1.0f);
+		break;
+	case MESH_TORUS:
+		// ring plus tube radius, in any orientation
+		minimum = glm::vec3(-1.3f);
+		maximum = glm::vec3(1.3f);
+		break;
+	default:
+		// imported meshes are scaled into the box of the shapes
+		minimum = glm::vec3(-1.0f, 0.0f, -1.0f);
+		maximum = glm::vec3(1.0f, 2.0f, 1.0f);
+		if ((NULL != m_pMeshGeometry) && ((int)mesh < m_pMeshGeometry->GetMeshCount()))
+		{
+			minimum = m_pMeshGeometry->GetMesh(mesh).boundsMinimum;
+			maximum = m_pMeshGeometry->GetMesh(mesh).boundsMaximum;
+		}
+		break;
+	}
+}
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.6f, 3.0f, 0.8f);
+/***********************************************************
+ *  IssueOcclusionQueries()
+ *
+ *  This method tests the bounding box of every object except
+ *  the planes, which are the large occluders of the scene and
+ *  almost always visible.  The boxes are grown a little so
+ *  that they do not hide behind the object's own surface.
+ ***********************************************************/
+void SceneManager::IssueOcclusionQueries()
+{
+	m_pOcclusion->BeginQueries(m_viewMatrix, m_projectionMatrix);
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	for (int i = 0; i < (int)m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if (object.mesh == MESH_PLANE)
+		{
+			continue;
+		}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 1.8f, 5.0f);
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+		GetMeshBounds(object.mesh, minimum, maximum);
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+		glm::vec3 center = (minimum + maximum) * 0.5f;
+		glm::vec3 size = (maximum - minimum) * 1.02f + glm::vec3(0.01f);
 
-	// set the color values into the shader
-	//SetShaderColor(0, 0, 1, 1);
+		// the near plane would cut open a box around the camera,
+		// so that object can not be tested
+		glm::vec3 localCamera = glm::vec3(glm::inverse(object.modelMatrix) * glm::vec4(m_viewPosition, 1.0f));
+		glm::vec3 offset = glm::abs(localCamera - center);
+		if ((offset.x <= size.x * 0.5f + 0.1f) &&
+			(offset.y <= size.y * 0.5f + 0.1f) &&
+			(offset.z <= size.z * 0.5f + 0.1f))
+		{
+			m_pOcclusion->MarkVisible(i);
+			continue;
+		}
 
-	SetShaderMaterial("glass");
-	// set the texture for the mesh
-	SetShaderTexture("candelbase");
+		glm::mat4 boundsMatrix = object.modelMatrix * glm::translate(center) * glm::scale(size);
+		m_pOcclusion->QueryObject(i, boundsMatrix);
+	}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	m_pOcclusion->EndQueries();
+}
 
-	// Retrieve the texture ID using its tag
-	int candelbaseyID = FindTextureID("candelbase");
+/***********************************************************
+ *  SetOcclusionCulling()
+ *
+ *  This method turns the occlusion culling on or off.
+ ***********************************************************/
+void SceneManager::SetOcclusionCulling(bool bEnable)
+{
+	m_bOcclusionCulling = bEnable;
+}
 
-	// Check if the texture ID was found
-	if (candelbaseID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, candelbaseID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
+/***********************************************************
+ *  ReportCullingStatistics()
+ *
+ *  This method prints how many objects were tested and how
+ *  many were skipped as hidden in the last frame, and how
+ *  many survived the GPU frustum culling.
+ ***********************************************************/
+void SceneManager::ReportCullingStatistics() const
+{
+	if ((m_bOcclusionCulling == false) || (NULL == m_pOcclusion))
+	{
+		std::cout << "INFO: Occlusion Culling: off" << std::endl;
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+	else
+	{
+		std::cout << "INFO: Occlusion Culling: " << m_pOcclusion->GetOccludedCount() << " of "
+			<< m_sceneObjects.size() << " objects hidden, "
+			<< m_pOcclusion->GetTestedCount() << " queries issued" << std::endl;
 	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTaperedCylinderMesh();
+	if ((m_bGpuCulling == true) && (NULL != m_pGpuCulling))
+	{
+		std::cout << "INFO: GPU Culling: " << m_pGpuCulling->GetVisibleCount() << " of "
+			<< m_pGpuCulling->GetObjectCount() << " opaque objects drawn in "
+			<< m_pGpuCulling->GetGroupCount() << " indirect draws" << std::endl;
+	}
+}
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
-	
+/***********************************************************
+ *  SetTessellation()
+ *
+ *  This method sets how many slices the round basic shapes
+ *  are built with, the stacks of the sphere and the sides of
+ *  the torus are half as many.  It only has an effect before
+ *  the scene is prepared.
+ ***********************************************************/
+void SceneManager::SetTessellation(int slices)
+{
+	m_tessellation = (slices < 4) ? 4 : slices;
+}
 
-	/****************************************************************/
-	// Torus mesh-Candle Top ring
-	/****************************************************************/
+/***********************************************************
+ *  BuildMeshGeometry()
+ *
+ *  This method builds the basic shapes on the CPU into one
+ *  set of buffers, added in the order of MESH_TYPE so the
+ *  mesh type is also the mesh index.
+ ***********************************************************/
+void SceneManager::BuildMeshGeometry()
+{
+	const char* meshNames[] = { "Plane", "Box", "Cylinder", "Cone", "Sphere", "Tapered Cylinder", "Torus" };
+	int slices = m_tessellation;
+	int stacks = m_tessellation / 2;
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(0.3f, 0.5f, 2.0f);
+	MeshGeometry::MESH_DATA mesh;
+	m_pMeshGeometry = new MeshGeometry();
+	for (int meshType = MESH_PLANE; meshType <= MESH_TORUS; meshType++)
+	{
+		switch (meshType)
+		{
+		case MESH_PLANE:
+			MeshGeometry::BuildPlane(mesh);
+			break;
+		case MESH_BOX:
+			MeshGeometry::BuildBox(mesh);
+			break;
+		case MESH_CYLINDER:
+			MeshGeometry::BuildCylinder(mesh, slices);
+			break;
+		case MESH_CONE:
+			MeshGeometry::BuildCone(mesh, slices);
+			break;
+		case MESH_SPHERE:
+			MeshGeometry::BuildSphere(mesh, slices, stacks);
+			break;
+		case MESH_TAPERED_CYLINDER:
+			MeshGeometry::BuildTaperedCylinder(mesh, slices, 0.5f);
+			break;
+		default:
+			MeshGeometry::BuildTorus(mesh, slices, stacks, 1.0f, 0.2f);
+			break;
+		}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+		OptimizeTriangleOrder(mesh, meshNames[meshType]);
+		m_pMeshGeometry->AddMesh(mesh);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 4.8f, 5.0f);
+	// the imported meshes follow in the order of MESH_TYPE, the
+	// mesh geometry keeps the only CPU copy of them
+	for (size_t i = 0; i < m_importedMeshes.size(); i++)
+	{
+		OptimizeTriangleOrder(m_importedMeshes[i], "Imported Mesh");
+		m_pMeshGeometry->AddMesh(m_importedMeshes[i]);
+	}
+	m_importedMeshes.clear();
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	// the software rasterizer reads the meshes on the CPU
+	if (NULL != m_pStateCache)
+	{
+		m_pMeshGeometry->SetVertexFormat(g_SceneVertexFormat);
+		m_pMeshGeometry->Upload(m_pStateCache);
+	}
+}
 
-	// set the color values into the shader
-	//SetShaderColor(1, 0.5, 0, 1);
+/***********************************************************
+ *  OptimizeTriangleOrder()
+ *
+ *  This method reorders the triangles of a basic shape for
+ *  the post-transform vertex cache, keeping the generated
+ *  order when it is already as good, as it is for the side
+ *  of a cylinder, and then sorts runs of the triangles to
+ *  draw the ones facing outwards first.  The cache miss
+ *  ratio before and after is printed for every shape.
+ ***********************************************************/
+void SceneManager::OptimizeTriangleOrder(MeshGeometry::MESH_DATA& mesh, const char* meshName)
+{
+	float generatedRatio = MeshGeometry::ComputeACMR(mesh, MeshGeometry::VERTEX_CACHE_SIZE);
 
-	// set the texture for the mesh
-	SetShaderTexture("topring");
+	MeshGeometry::MESH_DATA optimized = mesh;
+	MeshGeometry::OptimizeVertexCache(optimized);
+	if (MeshGeometry::ComputeACMR(optimized, MeshGeometry::VERTEX_CACHE_SIZE) < generatedRatio)
+	{
+		mesh.indices.swap(optimized.indices);
+	}
+	MeshGeometry::OptimizeOverdraw(mesh, g_OverdrawThreshold);
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	std::cout << "INFO: " << meshName << " ACMR: " << generatedRatio << " -> "
+		<< MeshGeometry::ComputeACMR(mesh, MeshGeometry::VERTEX_CACHE_SIZE)
+		<< " (" << mesh.indices.size() / 3 << " triangles)" << std::endl;
+}
 
-	// Retrieve the texture ID using its tag
-	int topringID = FindTextureID("topring");
+/***********************************************************
+ *  BuildLightmaps()
+ *
+ *  This method lays out the lightmap of the opaque objects
+ *  and loads it when it was baked for the same scene before,
+ *  otherwise it bakes and saves it.  The transparent objects
+ *  keep their per-fragment lighting and do not block light.
+ *  So do the imported models, which would need an atlas of
+ *  their own for their many triangles.
+ ***********************************************************/
+void SceneManager::BuildLightmaps()
+{
+	LightmapBaker baker(m_pJobSystem);
 
-	// Check if the texture ID was found
-	if (topringID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, topringID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
-	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+	std::vector<ClusteredLighting::LIGHT_SOURCE> lights;
+	for (int i = 0; i < m_pLighting->GetLightCount(); i++)
+	{
+		lights.push_back(m_pLighting->GetLight(i));
 	}
+	baker.SetLights(lights);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
-
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	std::vector<int> bakedObjects;
+	for (int i = 0; i < (int)m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if ((object.bTransparent == true) || (object.mesh >= MESH_IMPORTED))
+		{
+			continue;
+		}
 
+		LightmapBaker::BAKE_MATERIAL bakeMaterial;
+		bakeMaterial.ambientColor = glm::vec3(0.0f);
+		bakeMaterial.ambientStrength = 0.0f;
+		bakeMaterial.diffuseColor = glm::vec3(0.0f);
 
-	/****************************************************************/
-	//  Cylinder mesh Top
-	/****************************************************************/
+		OBJECT_MATERIAL material;
+		if (FindMaterial(object.materialTag, material) == true)
+		{
+			bakeMaterial.ambientColor = material.ambientColor;
+			bakeMaterial.ambientStrength = material.ambientStrength;
+			bakeMaterial.diffuseColor = material.diffuseColor;
+		}
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 0.1f, 1.0f);
+		// the model matrices are not built until the first frame
+		glm::mat4 model = BuildModelMatrix(
+			object.scaleXYZ,
+			object.XrotationDegrees,
+			object.YrotationDegrees,
+			object.ZrotationDegrees,
+			object.positionXYZ);
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+		baker.AddObject(m_pMeshGeometry->GetMeshData(object.mesh), model, bakeMaterial);
+		bakedObjects.push_back(i);
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 4.9f, 5.0f);
+	if (baker.Layout(LightmapBaker::GetDefaultSettings()) == false)
+	{
+		return;
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	if (baker.Load(g_LightmapPath) == true)
+	{
+		std::cout << "INFO: Lightmap loaded from " << g_LightmapPath << std::endl;
+	}
+	else
+	{
+		baker.Bake();
+		baker.Save(g_LightmapPath);
+	}
 
-	// set the color values into the shader
-	//SetShaderColor(0.1, 0.4, 0.4, 1);
-	
-	SetShaderMaterial("clay");
+	m_lightmapTexture = baker.CreateTexture(m_pStateCache);
+	if (m_lightmapTexture == 0)
+	{
+		return;
+	}
 
-	// set the texture for the mesh
-	SetShaderTexture("top");
+	m_pLightmapGeometry = new MeshGeometry();
+	for (size_t i = 0; i < bakedObjects.size(); i++)
+	{
+		m_sceneObjects[bakedObjects[i]].lightmapMesh = m_pLightmapGeometry->AddMesh(baker.GetLightmapMesh((int)i));
+	}
+	m_pLightmapGeometry->SetVertexFormat(g_SceneVertexFormat);
+	m_pLightmapGeometry->Upload(m_pStateCache);
+}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+/***********************************************************
+ *  IsObjectLightmapped()
+ *
+ *  This method returns whether an object is drawn with the
+ *  baked lightmap this frame.
+ ***********************************************************/
+bool SceneManager::IsObjectLightmapped(const SCENE_OBJECT& object) const
+{
+	return((m_bLightmaps == true) && (m_lightmapTexture != 0) && (object.lightmapMesh >= 0));
+}
 
-	// Retrieve the texture ID using its tag
-	int topID = FindTextureID("top");
+/***********************************************************
+ *  SetLightmaps()
+ *
+ *  This method turns drawing with the baked lightmap on or
+ *  off.  Off, the static objects are lit per fragment again,
+ *  which shows changes to the lights without a new bake.
+ ***********************************************************/
+void SceneManager::SetLightmaps(bool bEnable)
+{
+	m_bLightmaps = bEnable;
+}
 
-	// Check if the texture ID was found
-	if (topID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, topID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
+/***********************************************************
+ *  IsLightmapEnabled()
+ *
+ *  This method returns whether the lightmap is used.
+ ***********************************************************/
+bool SceneManager::IsLightmapEnabled() const
+{
+	return(m_bLightmaps);
+}
+
+/***********************************************************
+ *  BuildStaticBatches()
+ *
+ *  This method merges the opaque static objects that share a
+ *  texture, a material and shader features, and are not part
+ *  of a composite object, into one mesh in
+ *  world space, so each of those groups is one draw with an
+ *  identity model matrix.  Lightmapped objects are merged
+ *  from their unwrapped meshes and never with unlit ones.
+ *  The transparent objects stay on their own, since they are
+ *  drawn back to front one by one, and so do the imported
+ *  models, which are large enough to be a draw of their own.
+ ***********************************************************/
+void SceneManager::BuildStaticBatches()
+{
+	std::vector<MeshGeometry::MESH_DATA> batchMeshes;
+
+	for (int i = 0; i < (int)m_sceneObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		// the parts of composite objects are swapped for their
+		// impostors, so they can not share a batch
+		if ((object.bStatic == false) || (object.bTransparent == true) ||
+			(object.composite >= 0) || (object.mesh >= MESH_IMPORTED))
+		{
+			continue;
+		}
+
+		bool bUnwrapped = (NULL != m_pLightmapGeometry) && (object.lightmapMesh >= 0);
+
+		int batch = 0;
+		while (batch < (int)m_staticBatches.size())
+		{
+			const SCENE_OBJECT& first = m_sceneObjects[m_staticBatches[batch].objects[0]];
+			if ((strcmp(first.textureTag, object.textureTag) == 0) &&
+				(strcmp(first.materialTag, object.materialTag) == 0) &&
+				(first.shaderFeatures == object.shaderFeatures) &&
+				((first.lightmapMesh >= 0) == (object.lightmapMesh >= 0)))
+			{
+				break;
+			}
+			batch++;
+		}
+		if (batch == (int)m_staticBatches.size())
+		{
+			STATIC_BATCH newBatch;
+			newBatch.mesh = batch;
+			newBatch.viewDepth = 0.0f;
+			newBatch.bVisible = false;
+			m_staticBatches.push_back(newBatch);
+			batchMeshes.push_back(MeshGeometry::MESH_DATA());
+		}
+
+		// the model matrices are not built until the first frame
+		glm::mat4 model = BuildModelMatrix(
+			object.scaleXYZ,
+			object.XrotationDegrees,
+			object.YrotationDegrees,
+			object.ZrotationDegrees,
+			object.positionXYZ);
+
+		MeshGeometry::AppendTransformed(
+			batchMeshes[batch],
+			(bUnwrapped == true) ? m_pLightmapGeometry->GetMeshData(object.lightmapMesh) : m_pMeshGeometry->GetMeshData(object.mesh),
+			model);
+
+		m_staticBatches[batch].objects.push_back(i);
+		object.staticBatch = batch;
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	if (m_staticBatches.empty())
+	{
+		return;
 	}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pStaticGeometry = new MeshGeometry();
+	for (size_t i = 0; i < batchMeshes.size(); i++)
+	{
+		m_pStaticGeometry->AddMesh(batchMeshes[i]);
+	}
+	m_pStaticGeometry->SetVertexFormat(g_SceneVertexFormat);
+	m_pStaticGeometry->Upload(m_pStateCache);
+}
 
+/***********************************************************
+ *  IsStaticBatchingReady()
+ *
+ *  This method returns whether the opaque static objects are
+ *  drawn with their batches.
+ ***********************************************************/
+bool SceneManager::IsStaticBatchingReady() const
+{
+	return((m_bStaticBatching == true) && (NULL != m_pStaticGeometry));
+}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+/***********************************************************
+ *  DrawStaticBatchGeometry()
+ *
+ *  This method draws the merged mesh of a static batch with
+ *  the passed in program.
+ ***********************************************************/
+void SceneManager::DrawStaticBatchGeometry(int batch, const ShaderManager* pShader)
+{
+	m_pStaticGeometry->SetVertexUniforms(pShader);
+	m_pStateCache->BindVertexArray(m_pStaticGeometry->GetVertexArray());
+	m_pStaticGeometry->Draw(m_staticBatches[batch].mesh);
+}
 
-	/****************************************************************/
-	// Tapered Cylinder flower vase
-	/****************************************************************/
-	
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(5.0f, 20.0f, 1.0f);
+/***********************************************************
+ *  DrawStaticBatch()
+ *
+ *  This method sets up a static batch the way the first of
+ *  its objects would be, since they all share a texture,
+ *  material and shader, but with an identity model matrix.
+ ***********************************************************/
+void SceneManager::DrawStaticBatch(int batch)
+{
+	const SCENE_OBJECT& object = m_sceneObjects[m_staticBatches[batch].objects[0]];
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = -180.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	UseObjectShader(object);
+	m_pShaderManager->setMat4Value(g_ModelName, glm::mat4(1.0f));
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(20.0f, 20.0f, -5.0f);
+	SetShaderMaterial(object.materialTag);
+	BindObjectTexture(object.textureTag);
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	if (IsObjectLightmapped(object) == true)
+	{
+		m_pStateCache->BindTextureUnit(g_LightmapTextureUnit, GL_TEXTURE_2D, m_lightmapTexture);
+		m_pShaderManager->setSampler2DValue(g_LightmapTextureName, g_LightmapTextureUnit);
+	}
 
-	// set the color values into the shader
-	//SetShaderColor(1, 0.2, 0, 1);
+	DrawStaticBatchGeometry(batch, m_pShaderManager);
+}
 
-	SetShaderMaterial("glass");
-	// set the texture for the mesh
-	SetShaderTexture("vase");
+/***********************************************************
+ *  SetStaticBatching()
+ *
+ *  This method switches the opaque static objects between
+ *  their batches and one draw per object.
+ ***********************************************************/
+void SceneManager::SetStaticBatching(bool bEnable)
+{
+	m_bStaticBatching = bEnable;
+}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+/***********************************************************
+ *  IsStaticBatchingEnabled()
+ *
+ *  This method returns whether the static batches are used.
+ ***********************************************************/
+bool SceneManager::IsStaticBatchingEnabled() const
+{
+	return(m_bStaticBatching);
+}
 
-	// Retrieve the texture ID using its tag
-	int vaseID = FindTextureID("vase");
+/***********************************************************
+ *  ReportBatchingStatistics()
+ *
+ *  This method prints how many static objects the visible
+ *  batches of the last frame held and how many draws they
+ *  took, and how many composite objects were impostors.
+ ***********************************************************/
+void SceneManager::ReportBatchingStatistics() const
+{
+	if (IsStaticBatchingReady() == false)
+	{
+		std::cout << "INFO: Static Batching: off" << std::endl;
+	}
+	else
+	{
+		size_t objectCount = 0;
+		for (size_t i = 0; i < m_staticBatchOrder.size(); i++)
+		{
+			objectCount += m_staticBatches[m_staticBatchOrder[i]].objects.size();
+		}
 
-	// Check if the texture ID was found
-	if (vaseID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, vaseID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
+		std::cout << "INFO: Static Batching: " << objectCount << " static objects in "
+			<< m_staticBatchOrder.size() << " draws, "
+			<< m_opaqueOrder.size() << " opaque objects drawn alone" << std::endl;
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	if (IsImpostorReady() == true)
+	{
+		std::cout << "INFO: Impostors: " << m_impostorOrder.size() << " of "
+			<< m_compositeObjects.size() << " composite objects drawn as impostors" << std::endl;
 	}
+}
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTaperedCylinderMesh();
+/***********************************************************
+ *  BuildImpostors()
+ *
+ *  This method fits a square around the parts of every
+ *  composite object and renders them into each view of its
+ *  impostor with the lit scene shaders, the opaque parts
+ *  first and then the glass back to front.  The variants of
+ *  the parts are waited for, since the bake happens once.
+ ***********************************************************/
+void SceneManager::BuildImpostors()
+{
+	if ((m_compositeObjects.empty()) || (NULL == m_pShaderVariants))
+	{
+		return;
+	}
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pImpostors = new ImpostorAtlas(m_pStateCache);
+	if (m_pImpostors->Create((int)m_compositeObjects.size(), ImpostorAtlas::GetDefaultSettings()) == false)
+	{
+		delete m_pImpostors;
+		m_pImpostors = NULL;
+		return;
+	}
 
-	/****************************************************************/
-	// Torus mesh white sphere  
-	/****************************************************************/
+	UpdateTransformations();
+	for (size_t i = 0; i < m_compositeObjects.size(); i++)
+	{
+		for (size_t j = 0; j < m_compositeObjects[i].objects.size(); j++)
+		{
+			m_pShaderVariants->GetProgram(GetObjectShaderKey(m_sceneObjects[m_compositeObjects[i].objects[j]]));
+		}
+	}
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(1.0f, 1.0f, 1.0f);
+	// the bake cameras replace the view of the first frame
+	glm::mat4 frameView = m_viewMatrix;
+	glm::mat4 frameProjection = m_projectionMatrix;
+	glm::vec3 framePosition = m_viewPosition;
+	int frameWidth = m_viewportWidth;
+	int frameHeight = m_viewportHeight;
+	int cellSize = m_pImpostors->GetCellSize();
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 210.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 110.0f;
+	for (int c = 0; c < (int)m_compositeObjects.size(); c++)
+	{
+		COMPOSITE_OBJECT& composite = m_compositeObjects[c];
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(7.0f, 1.0f, 5.0f);
+		// world bounds of the corners of every part
+		std::vector<glm::vec3> corners;
+		glm::vec3 minimum = glm::vec3(0.0f);
+		glm::vec3 maximum = glm::vec3(0.0f);
+		for (size_t i = 0; i < composite.objects.size(); i++)
+		{
+			const SCENE_OBJECT& object = m_sceneObjects[composite.objects[i]];
+			glm::vec3 meshMinimum;
+			glm::vec3 meshMaximum;
+			GetMeshBounds(object.mesh, meshMinimum, meshMaximum);
+
+			for (int k = 0; k < 8; k++)
+			{
+				glm::vec3 corner = glm::vec3(
+					((k & 1) != 0) ? meshMaximum.x : meshMinimum.x,
+					((k & 2) != 0) ? meshMaximum.y : meshMinimum.y,
+					((k & 4) != 0) ? meshMaximum.z : meshMinimum.z);
+				corner = glm::vec3(object.modelMatrix * glm::vec4(corner, 1.0f));
+
+				minimum = (corners.empty()) ? corner : glm::min(minimum, corner);
+				maximum = (corners.empty()) ? corner : glm::max(maximum, corner);
+				corners.push_back(corner);
+			}
+		}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+		// the views turn around the vertical axis, so the square
+		// has to hold the widest turn of the parts
+		composite.center = (minimum + maximum) * 0.5f;
+		float radius = 0.0f;
+		for (size_t i = 0; i < corners.size(); i++)
+		{
+			radius = std::max(radius, glm::length(glm::vec2(corners[i].x - composite.center.x, corners[i].z - composite.center.z)));
+		}
+		composite.halfSize = std::max(radius, (maximum.y - minimum.y) * 0.5f) * 1.02f;
 
-	// set the color values into the shader
-	//SetShaderColor(1, 1, 1, 1);
+		for (int view = 0; view < m_pImpostors->GetViewCount(); view++)
+		{
+			glm::mat4 bakeView;
+			glm::mat4 bakeProjection;
+			glm::vec3 bakePosition;
+			m_pImpostors->GetBakeCamera(view, composite.center, composite.halfSize, bakeView, bakeProjection, bakePosition);
+
+			SetViewParameters(bakeView, bakeProjection, bakePosition, cellSize, cellSize);
+			m_pLighting->UpdateClusters(m_viewMatrix, m_projectionMatrix, cellSize, cellSize);
+			m_pShaderVariants->BeginFrame();
+			m_pImpostors->BeginBake(c, view);
+
+			std::vector<int> parts = composite.objects;
+			const std::vector<SCENE_OBJECT>& objects = m_sceneObjects;
+			std::sort(parts.begin(), parts.end(), [&objects, &bakeView](int a, int b)
+				{
+					if (objects[a].bTransparent != objects[b].bTransparent)
+					{
+						return(objects[b].bTransparent);
+					}
+					return((bakeView * objects[a].modelMatrix[3]).z < (bakeView * objects[b].modelMatrix[3]).z);
+				});
+
+			for (size_t i = 0; i < parts.size(); i++)
+			{
+				DrawSceneObject(m_sceneObjects[parts[i]]);
+			}
+		}
+	}
 
+	m_pImpostors->EndBake();
+	m_pShaderVariants->UseBaseProgram();
+	SetViewParameters(frameView, frameProjection, framePosition, frameWidth, frameHeight);
+}
 
-	SetShaderMaterial("cloth");
+/***********************************************************
+ *  IsImpostorReady()
+ *
+ *  This method returns whether far composite objects are
+ *  drawn as their impostors.
+ ***********************************************************/
+bool SceneManager::IsImpostorReady() const
+{
+	return((m_bImpostors == true) && (NULL != m_pImpostors));
+}
 
-	// set the texture for the mesh
-	SetShaderTexture("alexa");
+/***********************************************************
+ *  RenderImpostors()
+ *
+ *  This method draws the impostors of the frame.
+ ***********************************************************/
+void SceneManager::RenderImpostors()
+{
+	m_pImpostors->BeginDraws(m_viewMatrix, m_projectionMatrix);
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 
+	for (size_t i = 0; i < m_impostorOrder.size(); i++)
+	{
+		const COMPOSITE_OBJECT& composite = m_compositeObjects[m_impostorOrder[i]];
+		m_pImpostors->Draw(m_impostorOrder[i], composite.center, composite.halfSize, m_viewPosition);
+	}
+}
 
-	// Retrieve the texture ID using its tag
-	int alexaID = FindTextureID("alexa");
+/***********************************************************
+ *  SetImpostors()
+ *
+ *  This method switches the far composite objects between
+ *  their impostors and their parts.
+ ***********************************************************/
+void SceneManager::SetImpostors(bool bEnable)
+{
+	m_bImpostors = bEnable;
+}
 
-	// Check if the texture ID was found
-	if (alexaID != -1) {
-		// Bind the wood texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, alexaID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // this sets the texture sampler uniform to 0
+/***********************************************************
+ *  IsImpostorEnabled()
+ *
+ *  This method returns whether the impostors are used.
+ ***********************************************************/
+bool SceneManager::IsImpostorEnabled() const
+{
+	return(m_bImpostors);
+}
+
+/***********************************************************
+ *  BuildGpuScene()
+ *
+ *  This method puts every opaque object into the object
+ *  buffer of the culling pass, with one draw group for each
+ *  texture.  The transparent objects stay on the sorted path
+ *  since their draw order matters, and so do the parts of
+ *  composite objects, which may be swapped for impostors.
+ ***********************************************************/
+void SceneManager::BuildGpuScene()
+{
+	m_pGpuCulling = new GpuCulling(m_pStateCache, m_pMeshGeometry);
+	if (m_pGpuCulling->Initialize(g_CullingComputeShaderPath) == false)
+	{
+		delete m_pGpuCulling;
+		m_pGpuCulling = NULL;
+		return;
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	m_gpuObjectIndices.clear();
+	m_gpuGroupTextures.clear();
+	m_gpuObjects.clear();
+
+	for (int i = 0; i < (int)m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if ((object.bTransparent == true) || (object.composite >= 0))
+		{
+			continue;
+		}
+
+		// objects sharing a texture share a draw group
+		int group = 0;
+		while ((group < (int)m_gpuGroupTextures.size()) && (strcmp(m_gpuGroupTextures[group], object.textureTag) != 0))
+		{
+			group++;
+		}
+		if (group == (int)m_gpuGroupTextures.size())
+		{
+			m_gpuGroupTextures.push_back(object.textureTag);
+		}
+
+		const MeshGeometry::MESH_RANGE& range = m_pMeshGeometry->GetMesh(object.mesh);
+
+		GpuCulling::OBJECT_DATA data;
+		data.model = object.modelMatrix;
+		data.boundsMinimum = glm::vec4(range.boundsMinimum, 1.0f);
+		data.boundsMaximum = glm::vec4(range.boundsMaximum, 1.0f);
+		data.drawInfo[0] = (GLuint)object.mesh;
+		data.drawInfo[1] = (GLuint)group;
+		data.drawInfo[2] = 0;
+		data.drawInfo[3] = 0;
+		data.objectColor = glm::vec4(1.0f);
+		data.ambientColor = glm::vec4(0.0f);
+		data.diffuseColor = glm::vec4(0.0f);
+		data.specularColor = glm::vec4(0.0f);
+		data.textureScale = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+
+		OBJECT_MATERIAL material;
+		if (FindMaterial(object.materialTag, material) == true)
+		{
+			data.ambientColor = glm::vec4(material.ambientColor, material.ambientStrength);
+			data.diffuseColor = glm::vec4(material.diffuseColor, 0.0f);
+			data.specularColor = glm::vec4(material.specularColor, material.shininess);
+		}
+
+		m_gpuObjectIndices.push_back(i);
+		m_gpuObjects.push_back(data);
 	}
-	
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_pGpuCulling->SetObjects(m_gpuObjects, (int)m_gpuGroupTextures.size());
 
-	/****************************************************************/
-	//  Box1 Mesh black Hrad drive
-	/****************************************************************/
+	// the object buffer variants compile along with the others
+	for (int group = 0; group < (int)m_gpuGroupTextures.size(); group++)
+	{
+		m_pShaderVariants->RequestVariant(GetGroupShaderKey(group));
+	}
+}
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(3.5f, 3.5f, 0.5f);
+/***********************************************************
+ *  GetGroupShaderKey()
+ *
+ *  This method returns the shader variant key for the draws
+ *  of a GPU culling draw group.
+ ***********************************************************/
+unsigned int SceneManager::GetGroupShaderKey(int group) const
+{
+	unsigned int features = ShaderVariants::FEATURE_LIT | ShaderVariants::FEATURE_OBJECT_BUFFER;
+	if (m_gpuGroupTextures[group][0] != '\0')
+	{
+		features |= ShaderVariants::FEATURE_TEXTURED;
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 180.0f;
+	return(ShaderVariants::MakeKey(features, (unsigned int)m_pLighting->GetLightCount()));
+}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(7.0f, 1.75f, 3.0f);
+/***********************************************************
+ *  IsGpuCullingReady()
+ *
+ *  This method returns whether the GPU culling path is on
+ *  and can draw.  The base program can not read the object
+ *  buffer, so every group's variant has to be built first.
+ ***********************************************************/
+bool SceneManager::IsGpuCullingReady() const
+{
+	if ((m_bGpuCulling == false) || (NULL == m_pGpuCulling))
+	{
+		return(false);
+	}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	for (int group = 0; group < (int)m_gpuGroupTextures.size(); group++)
+	{
+		if (m_pShaderVariants->IsVariantReady(GetGroupShaderKey(group)) == false)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
 
-	//SetShaderColor(1, 1, 1, 1);
+/***********************************************************
+ *  WaitForShaderVariants()
+ *
+ *  This method builds the variants of every scene object and
+ *  GPU culling group now instead of over the next frames.
+ ***********************************************************/
+void SceneManager::WaitForShaderVariants()
+{
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		m_pShaderVariants->GetProgram(GetObjectShaderKey(m_sceneObjects[i]));
+	}
 
-	SetShaderMaterial("glass");
+	for (int group = 0; group < (int)m_gpuGroupTextures.size(); group++)
+	{
+		m_pShaderVariants->GetProgram(GetGroupShaderKey(group));
+	}
+}
 
-	// set the texture for the mesh
-	SetShaderTexture("drive");
+/***********************************************************
+ *  RenderGpuCulledObjects()
+ *
+ *  This method uploads the model matrices of the frame, lets
+ *  the compute shader cull the opaque objects against the
+ *  view frustum and draws each group with one indirect call.
+ ***********************************************************/
+void SceneManager::RenderGpuCulledObjects()
+{
+	for (size_t i = 0; i < m_gpuObjects.size(); i++)
+	{
+		m_gpuObjects[i].model = m_sceneObjects[m_gpuObjectIndices[i]].modelMatrix;
+	}
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 as an example
+	m_pGpuCulling->UpdateObjects(m_gpuObjects);
+	m_pGpuCulling->Cull(m_projectionMatrix * m_viewMatrix);
+	m_pGpuCulling->BeginDraws();
 
-	// Retrieve the texture ID using its tag
-	int driveID = FindTextureID("drive");
+	for (int group = 0; group < (int)m_gpuGroupTextures.size(); group++)
+	{
+		UseShaderKey(GetGroupShaderKey(group));
+		if (m_gpuGroupTextures[group][0] != '\0')
+		{
+			BindObjectTexture(m_gpuGroupTextures[group]);
+		}
+		m_pMeshGeometry->SetVertexUniforms(m_pShaderManager);
 
-	// Check if the texture ID was found
-	if (driveID != -1) {
-		// Bind the texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, driveID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // Assuming this sets the texture sampler uniform to 0
+		m_pGpuCulling->DrawGroup(group);
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+}
+
+/***********************************************************
+ *  SetGpuCulling()
+ *
+ *  This method switches the opaque pass between the sorted
+ *  per-object draws and the compute shader culled draws.
+ ***********************************************************/
+void SceneManager::SetGpuCulling(bool bEnable)
+{
+	m_bGpuCulling = bEnable;
+}
+
+/***********************************************************
+ *  IsGpuCullingEnabled()
+ *
+ *  This method returns whether the GPU culling path is on.
+ ***********************************************************/
+bool SceneManager::IsGpuCullingEnabled() const
+{
+	return(m_bGpuCulling);
+}
+
+/***********************************************************
+ *  SetDepthPrepass()
+ *
+ *  This method turns the depth pre-pass on or off.  It pays
+ *  off when objects overlap a lot and the lit shading is
+ *  expensive, and costs a second geometry pass otherwise.
+ ***********************************************************/
+void SceneManager::SetDepthPrepass(bool bEnable)
+{
+	m_bDepthPrepass = bEnable;
+}
+
+/***********************************************************
+ *  IsDepthPrepassEnabled()
+ *
+ *  This method returns whether the depth pre-pass is on.
+ ***********************************************************/
+bool SceneManager::IsDepthPrepassEnabled() const
+{
+	return(m_bDepthPrepass);
+}
+
+/***********************************************************
+ *  ReportPassTimings()
+ *
+ *  This method prints the smoothed GPU time of each pass.
+ ***********************************************************/
+void SceneManager::ReportPassTimings() const
+{
+	std::cout << "INFO: GPU Pass Times: depth pre-pass ";
+	if (m_bDepthPrepass == true)
+	{
+		std::cout << m_pPrepassTimer->GetAverageMilliseconds() << " ms";
 	}
+	else
+	{
+		std::cout << "off";
+	}
+	std::cout << ", opaque " << m_pOpaqueTimer->GetAverageMilliseconds() << " ms"
+		<< ", transparent " << m_pTransparentTimer->GetAverageMilliseconds() << " ms" << std::endl;
+}
 
-	m_basicMeshes->DrawBoxMesh();
+/***********************************************************
+ *  GetGpuFrameMilliseconds()
+ *
+ *  This method returns the sum of the latest GPU times of
+ *  the passes the last frame rendered, a few frames behind
+ *  the frame being drawn.
+ ***********************************************************/
+double SceneManager::GetGpuFrameMilliseconds() const
+{
+	if (NULL == m_pOpaqueTimer)
+	{
+		return(0.0);
+	}
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	double milliseconds = m_pOpaqueTimer->GetMilliseconds() + m_pTransparentTimer->GetMilliseconds();
+	if (m_bPrepassRendered == true)
+	{
+		milliseconds += m_pPrepassTimer->GetMilliseconds();
+	}
 
+	return(milliseconds);
+}
 
-	//***************************************************************/
-	//  Box#2 Mesh the book
-	/****************************************************************/
+/***********************************************************
+ *  GetObjectShaderKey()
+ *
+ *  This method returns the shader variant key for an object.
+ *  While the scene has no more lights than a variant can
+ *  hold, the light loop is compiled for the exact count
+ *  instead of walking the cluster lists.
+ ***********************************************************/
+unsigned int SceneManager::GetObjectShaderKey(const SCENE_OBJECT& object) const
+{
+	unsigned int lightCount = (unsigned int)m_pLighting->GetLightCount();
+	unsigned int features = object.shaderFeatures;
 
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(4.0f, 5.0f, 0.5f);
+	// baked objects sample the lightmap instead of the lights
+	if (IsObjectLightmapped(object) == true)
+	{
+		features = (features & ~ShaderVariants::FEATURE_LIT) | ShaderVariants::FEATURE_LIGHTMAP;
+	}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = -90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+	return(ShaderVariants::MakeKey(features, lightCount));
+}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(-2.0f, 0.25f, 3.0f);
+/***********************************************************
+ *  UseObjectShader()
+ *
+ *  This method makes the shader variant that matches the
+ *  features of the passed in object current.  The first time
+ *  a variant is used in a frame it gets the camera and light
+ *  grid uniforms.
+ ***********************************************************/
+void SceneManager::UseObjectShader(const SCENE_OBJECT& object)
+{
+	UseShaderKey(GetObjectShaderKey(object));
+}
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+/***********************************************************
+ *  UseShaderKey()
+ *
+ *  This method makes the shader variant for a key current,
+ *  setting the camera and light grid uniforms the first time
+ *  it is used in a frame.
+ ***********************************************************/
+void SceneManager::UseShaderKey(unsigned int key)
+{
+	if (m_pShaderVariants->UseVariant(key) == true)
+	{
+		m_pShaderManager->setMat4Value("view", m_viewMatrix);
+		m_pShaderManager->setMat4Value("projection", m_projectionMatrix);
+		m_pShaderManager->setVec3Value("viewPosition", m_viewPosition);
+		m_pLighting->BindToShader(m_pShaderManager);
+	}
+}
 
-	//SetShaderColor(1, 1, 1, 1);
-	SetShaderMaterial("paper");
+/***********************************************************
+ *  SetViewParameters()
+ *
+ *  This method is used for passing the camera and viewport
+ *  of the next frame to the scene, which needs them for
+ *  binning the lights into clusters.
+ ***********************************************************/
+void SceneManager::SetViewParameters(
+	glm::mat4 view,
+	glm::mat4 projection,
+	glm::vec3 viewPosition,
+	int viewportWidth,
+	int viewportHeight)
+{
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+	m_viewPosition = viewPosition;
+	m_viewportWidth = viewportWidth;
+	m_viewportHeight = viewportHeight;
+}
 
-	// set the texture for the mesh
-	SetShaderTexture("book");
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes into the
+ *  bound framebuffer, without a render graph
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	BeginSceneFrame();
 
-	// Activating the texture 
-	glActiveTexture(GL_TEXTURE0);  // Using texture unit 0 as an example
+	if (m_bPrepassRendered == true)
+	{
+		RenderDepthPrepass();
+	}
+	RenderOpaquePass();
 
-	// Retrieve the texture ID using its tag
-	int bookID = FindTextureID("book");
+	// the depth buffer now holds every opaque surface, which is
+	// what the bounding boxes are tested against
+	if ((m_bOcclusionCulling == true) && (NULL != m_pOcclusion))
+	{
+		IssueOcclusionQueries();
+	}
 
-	// Check if the texture ID was found
-	if (bookID != -1) {
-		// Bind the texture
-		glActiveTexture(GL_TEXTURE0); // Using texture unit 0
-		glBindTexture(GL_TEXTURE_2D, bookID);
-		m_pShaderManager->setIntValue(g_TextureValueName, 0); // Assuming this sets the texture sampler uniform to 0
+	RenderTransparentPass();
+}
+
+/***********************************************************
+ *  AddScenePasses()
+ *
+ *  This method declares the passes of the scene in a render
+ *  graph.  The transforms, light clusters and draw order are
+ *  updated right away, since every pass needs them.
+ ***********************************************************/
+void SceneManager::AddScenePasses(RenderGraph* pGraph, int colorTarget, int depthTarget, int width, int height)
+{
+	BeginSceneFrame();
+
+	if (m_bPrepassRendered == true)
+	{
+		int pass = pGraph->AddPass("DepthPrepass", [this]() { RenderDepthPrepass(); });
+		pGraph->WriteTexture(pass, depthTarget);
+		pGraph->SetViewport(pass, width, height);
 	}
-	else {
-		std::cerr << "texture not found!" << std::endl;
-		// Handling the error 
+
+	int opaquePass = pGraph->AddPass("Opaque", [this]() { RenderOpaquePass(); });
+	pGraph->WriteTexture(opaquePass, colorTarget);
+	pGraph->WriteTexture(opaquePass, depthTarget);
+	pGraph->SetViewport(opaquePass, width, height);
+
+	// the bounding boxes are tested against the opaque depth,
+	// which is bound but not written, and nothing reads the
+	// queries within the frame
+	if ((m_bOcclusionCulling == true) && (NULL != m_pOcclusion))
+	{
+		int pass = pGraph->AddPass("Occlusion", [this]() { IssueOcclusionQueries(); });
+		pGraph->WriteTexture(pass, depthTarget);
+		pGraph->SetViewport(pass, width, height);
+		pGraph->SetSideEffect(pass);
+	}
+
+	int transparentPass = pGraph->AddPass("Transparent", [this]() { RenderTransparentPass(); });
+	pGraph->WriteTexture(transparentPass, colorTarget);
+	pGraph->WriteTexture(transparentPass, depthTarget);
+	pGraph->SetViewport(transparentPass, width, height);
+}
+
+/***********************************************************
+ *  BeginSceneFrame()
+ *
+ *  This method does the work every pass of a frame depends
+ *  on and decides whether the depth pre-pass runs.
+ ***********************************************************/
+void SceneManager::BeginSceneFrame()
+{
+	// the model matrices do not depend on any GL state, so
+	// they are calculated in parallel before drawing
+	UpdateTransformations();
+
+	// bin the lights into the clusters of the current view
+	m_pLighting->UpdateClusters(m_viewMatrix, m_projectionMatrix, m_viewportWidth, m_viewportHeight);
+	m_pLighting->BindToShader(m_pShaderManager);
+
+	m_pShaderVariants->BeginFrame();
+
+	SortSceneObjects();
+
+	// the GPU culled draws read their transforms from the object
+	// buffer, which the depth-only program does not, so they go
+	// without the pre-pass
+	m_bPrepassRendered = (m_bDepthPrepass == true) && (IsGpuCullingReady() == false) &&
+		(NULL != m_pDepthShader) && (m_pDepthShader->m_programID != 0);
+}
+
+/***********************************************************
+ *  RenderOpaquePass()
+ *
+ *  This method draws the opaque objects front to back
+ *  without blending, so the nearest surfaces fill the depth
+ *  buffer first and hidden fragments are rejected before
+ *  they are shaded.
+ ***********************************************************/
+void SceneManager::RenderOpaquePass()
+{
+	m_pStateCache->Disable(GL_BLEND);
+
+	// with the pre-pass the depth buffer already holds the
+	// nearest surfaces, so only fragments at exactly that
+	// depth are shaded and nothing needs to be written
+	if (m_bPrepassRendered == true)
+	{
+		m_pStateCache->DepthFunc(GL_EQUAL);
+		m_pStateCache->DepthMask(GL_FALSE);
+	}
+	else
+	{
+		m_pStateCache->DepthFunc(GL_LESS);
+		m_pStateCache->DepthMask(GL_TRUE);
+	}
+
+	m_pOpaqueTimer->Begin();
+	if (IsGpuCullingReady() == true)
+	{
+		RenderGpuCulledObjects();
+
+		// the parts of composite objects are not in the object
+		// buffer, the sorted list holds those still drawn
+		for (size_t i = 0; i < m_opaqueOrder.size(); i++)
+		{
+			if (m_sceneObjects[m_opaqueOrder[i]].composite >= 0)
+			{
+				DrawSceneObject(m_sceneObjects[m_opaqueOrder[i]]);
+			}
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < m_staticBatchOrder.size(); i++)
+		{
+			DrawStaticBatch(m_staticBatchOrder[i]);
+		}
+		for (size_t i = 0; i < m_opaqueOrder.size(); i++)
+		{
+			DrawSceneObject(m_sceneObjects[m_opaqueOrder[i]]);
+		}
+	}
+	m_pOpaqueTimer->End();
+
+	m_pStateCache->DepthFunc(GL_LESS);
+	m_pStateCache->DepthMask(GL_TRUE);
+}
+
+/***********************************************************
+ *  RenderTransparentPass()
+ *
+ *  This method draws the impostors and then the transparent
+ *  objects back to front with blending - depth writes stay
+ *  on because the glass pieces of the candle holder
+ *  intersect each other and are mostly solid.
+ ***********************************************************/
+void SceneManager::RenderTransparentPass()
+{
+	m_pTransparentTimer->Begin();
+
+	// the impostors are beyond the objects drawn in full, so
+	// they are blended under the transparent ones
+	if (m_impostorOrder.empty() == false)
+	{
+		RenderImpostors();
+	}
+
+	m_pStateCache->Enable(GL_BLEND);
+	m_pStateCache->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	for (size_t i = 0; i < m_transparentOrder.size(); i++)
+	{
+		DrawSceneObject(m_sceneObjects[m_transparentOrder[i]]);
+	}
+	m_pTransparentTimer->End();
+
+	// the basic shape meshes bind their own vertex arrays
+	m_pStateCache->InvalidateVertexArray();
+
+	// leave the program the view manager sets its uniforms on
+	m_pShaderVariants->UseBaseProgram();
+}
+
+/***********************************************************
+ *  PrepareSoftwareScene()
+ *
+ *  This method prepares the same lights, materials, textures
+ *  and objects as PrepareScene() for the CPU renderers,
+ *  without touching OpenGL.
+ ***********************************************************/
+void SceneManager::PrepareSoftwareScene()
+{
+	m_bSoftware = true;
+
+	DefineSceneContent();
+	BuildMeshGeometry();
+}
+
+/***********************************************************
+ *  RenderSoftwareScene()
+ *
+ *  This method renders the scene with the software
+ *  rasterizer, in the same passes and order as RenderScene().
+ ***********************************************************/
+void SceneManager::RenderSoftwareScene(SoftwareRasterizer* pRasterizer)
+{
+	if ((m_bSoftware == false) || (NULL == pRasterizer))
+	{
+		return;
 	}
 
-	m_basicMeshes->DrawBoxMesh();
+	UpdateTransformations();
+	SortSceneObjects();
 
-	// Unbind the texture to avoid affecting other meshes
-	glBindTexture(GL_TEXTURE_2D, 0);
+	std::vector<ClusteredLighting::LIGHT_SOURCE> lights;
+	for (int i = 0; i < m_pLighting->GetLightCount(); i++)
+	{
+		lights.push_back(m_pLighting->GetLight(i));
+	}
+	pRasterizer->SetLights(lights);
+
+	pRasterizer->SetFrameSize(m_viewportWidth, m_viewportHeight);
+	pRasterizer->SetViewParameters(m_viewMatrix, m_projectionMatrix, m_viewPosition);
+	pRasterizer->BeginFrame(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const std::vector<int>& order = (pass == 0) ? m_opaqueOrder : m_transparentOrder;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			const SCENE_OBJECT& object = m_sceneObjects[order[i]];
+
+			SoftwareRasterizer::DRAW_MATERIAL drawMaterial;
+			drawMaterial.ambientColor = glm::vec3(0.0f);
+			drawMaterial.ambientStrength = 0.0f;
+			drawMaterial.diffuseColor = glm::vec3(0.0f);
+			drawMaterial.specularColor = glm::vec3(0.0f);
+			drawMaterial.shininess = 0.0f;
+
+			OBJECT_MATERIAL material;
+			if (FindMaterial(object.materialTag, material) == true)
+			{
+				drawMaterial.ambientColor = material.ambientColor;
+				drawMaterial.ambientStrength = material.ambientStrength;
+				drawMaterial.diffuseColor = material.diffuseColor;
+				drawMaterial.specularColor = material.specularColor;
+				drawMaterial.shininess = material.shininess;
+			}
+
+			pRasterizer->DrawMesh(
+				m_pMeshGeometry->GetMeshData(object.mesh),
+				object.modelMatrix,
+				FindSoftwareTexture(object.textureTag),
+				drawMaterial,
+				glm::vec4(1.0f),
+				glm::vec2(1.0f, 1.0f),
+				object.bTransparent);
+		}
+	}
+
+	pRasterizer->EndFrame();
+}
+
+/***********************************************************
+ *  BuildPathTracedScene()
+ *
+ *  This method hands the objects, materials, textures and
+ *  lights prepared by PrepareSoftwareScene() to the path
+ *  tracer, along with the current camera.
+ ***********************************************************/
+void SceneManager::BuildPathTracedScene(PathTracer* pPathTracer)
+{
+	if ((m_bSoftware == false) || (NULL == pPathTracer))
+	{
+		return;
+	}
+
+	UpdateTransformations();
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+
+		PathTracer::PATH_MATERIAL pathMaterial;
+		pathMaterial.ambientColor = glm::vec3(0.0f);
+		pathMaterial.ambientStrength = 0.0f;
+		pathMaterial.diffuseColor = glm::vec3(0.0f);
+		pathMaterial.specularColor = glm::vec3(0.0f);
+		pathMaterial.shininess = 0.0f;
 
+		OBJECT_MATERIAL material;
+		if (FindMaterial(object.materialTag, material) == true)
+		{
+			pathMaterial.ambientColor = material.ambientColor;
+			pathMaterial.ambientStrength = material.ambientStrength;
+			pathMaterial.diffuseColor = material.diffuseColor;
+			pathMaterial.specularColor = material.specularColor;
+			pathMaterial.shininess = material.shininess;
+		}
 
-	//std::cout << "Debug: I got here" << std::endl;
-	// Disable lighting after drawing all objects
-	glDisable(GL_LIGHTING);
+		pPathTracer->AddObject(
+			m_pMeshGeometry->GetMeshData(object.mesh),
+			object.modelMatrix,
+			pathMaterial,
+			FindSoftwareTexture(object.textureTag),
+			glm::vec4(1.0f),
+			object.bTransparent);
+	}
+
+	std::vector<ClusteredLighting::LIGHT_SOURCE> lights;
+	for (int i = 0; i < m_pLighting->GetLightCount(); i++)
+	{
+		lights.push_back(m_pLighting->GetLight(i));
+	}
+	pPathTracer->SetLights(lights);
+	pPathTracer->SetCamera(m_viewMatrix, m_projectionMatrix, m_viewPosition);
+	pPathTracer->Build();
 }
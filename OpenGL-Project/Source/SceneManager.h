@@ -10,7 +10,21 @@
 #pragma once
 
 #include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "JobSystem.h"
+#include "ClusteredLighting.h"
+#include "ShaderVariants.h"
+#include "GLStateCache.h"
+#include "GpuTimer.h"
+#include "OcclusionCulling.h"
+#include "MeshGeometry.h"
+#include "GpuCulling.h"
+#include "ImpostorAtlas.h"
+#include "LightmapBaker.h"
+#include "PathTracer.h"
+#include "RenderGraph.h"
+#include "SceneFile.h"
+#include "SoftwareRasterizer.h"
+#include "SoftwareTexture.h"
 
 #include <string>
 #include <vector>
@@ -25,13 +39,17 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(ShaderManager *pShaderManager, JobSystem *pJobSystem, GLStateCache *pStateCache);
 	// destructor
 	~SceneManager();
 
+	// the tags of textures, materials and objects point at string
+	// literals or into the string table of the mapped scene file,
+	// which both outlive the scene, so they are never copied
+
 	struct TEXTURE_INFO
 	{
-		std::string tag;
+		const char* tag;
 		uint32_t ID;
 	};
 
@@ -42,12 +60,89 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
-		std::string tag;
+		const char* tag;
+		// drawn after the opaque objects with blending on
+		bool bTransparent;
 
 		// Add light properties
 		glm::vec3 lightPosition;
 		glm::vec3 lightColor;
 	};
+	// basic shapes that a scene object can be drawn with, the
+	// meshes imported from model files follow them in the order
+	// they were imported
+	enum MESH_TYPE : int
+	{
+		MESH_PLANE,
+		MESH_BOX,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_IMPORTED
+	};
+
+	struct SCENE_OBJECT
+	{
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		float XrotationDegrees;
+		float YrotationDegrees;
+		float ZrotationDegrees;
+		glm::vec3 positionXYZ;
+		const char* textureTag;
+		const char* materialTag;
+		// shader features the object needs, see ShaderVariants
+		unsigned int shaderFeatures;
+		// taken from the material, selects the render pass
+		bool bTransparent;
+		// unwrapped mesh drawn with the baked lightmap, -1 for
+		// objects that are lit per fragment
+		int lightmapMesh;
+		// static objects never move after they are defined, so
+		// they can be merged into a static batch
+		bool bStatic;
+		// static batch the object is drawn with, -1 for objects
+		// drawn on their own
+		int staticBatch;
+		// composite object the object is a part of, -1 for
+		// objects that stand on their own
+		int composite;
+
+		// model matrix, rebuilt every frame from the values above
+		glm::mat4 modelMatrix;
+	};
+
+	// static objects with the same texture, material and shader
+	// features, merged in world space and drawn as one mesh
+	struct STATIC_BATCH
+	{
+		// scene objects merged into the batch, the first one
+		// stands in for all of them when the batch is drawn
+		std::vector<int> objects;
+		// mesh of the batch in the static batch geometry
+		int mesh;
+		// view depth of the nearest visible object this frame
+		float viewDepth;
+		bool bVisible;
+	};
+
+	// objects that make up one prop, replaced as a whole by a
+	// baked impostor beyond a distance
+	struct COMPOSITE_OBJECT
+	{
+		std::vector<int> objects;
+		float impostorDistance;
+		// square around the parts that the impostor covers
+		glm::vec3 center;
+		float halfSize;
+		// whether the impostor is drawn in place of the parts
+		// this frame, and the view depth of its center
+		bool bImpostor;
+		float viewDepth;
+	};
+
 	// Light properties
 	struct Light {
 		glm::vec3 position;
@@ -59,28 +154,117 @@ public:
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
+	// pointer to job system used for the per-object loops
+	JobSystem* m_pJobSystem;
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	// pointer to the clustered light list
+	ClusteredLighting* m_pLighting;
+	// pointer to the cache of specialized shader programs
+	ShaderVariants* m_pShaderVariants;
+	// depth-only program and switch for the depth pre-pass
+	ShaderManager* m_pDepthShader;
+	bool m_bDepthPrepass;
+	// whether the last frame rendered the pre-pass
+	bool m_bPrepassRendered;
+	// GPU time of each render pass
+	GpuTimer* m_pPrepassTimer;
+	GpuTimer* m_pOpaqueTimer;
+	GpuTimer* m_pTransparentTimer;
+	// bounding box queries that skip hidden objects
+	OcclusionCulling* m_pOcclusion;
+	bool m_bOcclusionCulling;
+	// opaque objects culled by a compute shader and drawn with
+	// one indirect multi-draw per texture
+	MeshGeometry* m_pMeshGeometry;
+	// slices around the round basic shapes
+	int m_tessellation;
+	// meshes imported from model files, until they are added to
+	// the mesh geometry, and the model files placed in the scene
+	std::vector<MeshGeometry::MESH_DATA> m_importedMeshes;
+	std::vector<std::string> m_modelFiles;
+	// compiled scene the lights, materials, textures and objects
+	// are read from when one is loaded, and the meshes its
+	// models were imported as - it stays mapped for as long as
+	// the scene, since the tags point into its string table
+	SceneFile m_sceneFile;
+	std::vector<MESH_TYPE> m_sceneModels;
+	GpuCulling* m_pGpuCulling;
+	bool m_bGpuCulling;
+	// scene object and texture tag behind every GPU object and
+	// draw group
+	std::vector<int> m_gpuObjectIndices;
+	std::vector<const char*> m_gpuGroupTextures;
+	std::vector<GpuCulling::OBJECT_DATA> m_gpuObjects;
+	// static lighting baked into a lightmap atlas
+	MeshGeometry* m_pLightmapGeometry;
+	GLuint m_lightmapTexture;
+	bool m_bLightmaps;
+	// opaque static objects merged into one draw per texture
+	// and material
+	MeshGeometry* m_pStaticGeometry;
+	std::vector<STATIC_BATCH> m_staticBatches;
+	bool m_bStaticBatching;
+	// composite props and the impostors baked from them
+	std::vector<COMPOSITE_OBJECT> m_compositeObjects;
+	ImpostorAtlas* m_pImpostors;
+	bool m_bImpostors;
+	// whether the scene was prepared for the CPU renderers, the
+	// texture IDs are then indices into the software textures
+	bool m_bSoftware;
+	std::vector<SoftwareTexture> m_softwareTextures;
+	// view parameters of the frame being rendered
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+	int m_viewportWidth;
+	int m_viewportHeight;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// objects drawn in the 3D scene
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// object indices of the opaque and transparent passes,
+	// sorted by view depth every frame
+	std::vector<int> m_opaqueOrder;
+	std::vector<int> m_transparentOrder;
+	// visible static batches, sorted front to back
+	std::vector<int> m_staticBatchOrder;
+	// composite objects drawn as impostors, back to front
+	std::vector<int> m_impostorOrder;
 
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	bool FindMaterial(const char* tag, OBJECT_MATERIAL& material);
 	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
+	bool CreateGLTexture(const char* filename, const char* tag);
+	// load texture images for the CPU renderers
+	bool CreateSoftwareTexture(const char* filename, const char* tag);
+	// load a texture image for the renderer in use
+	bool CreateSceneTexture(const char* filename, const char* tag);
+	// load all the texture images of the scene
+	void LoadSceneTextures();
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureID(const char* tag);
+	int FindTextureSlot(const char* tag);
+	// find a texture loaded for the CPU renderers, NULL if none
+	const SoftwareTexture* FindSoftwareTexture(const char* tag);
 	
 
+	// calculate the model matrix from the transformation values
+	static glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
 	// set the transformation values 
 	// into the transform buffer
 	void SetTransformations(
@@ -99,7 +283,7 @@ private:
 
 	// set the texture data into the shader
 	void SetShaderTexture(
-		std::string textureTag);
+		const char* textureTag);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
@@ -107,24 +291,166 @@ private:
 
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
-
-	GLuint shadowMap;  // OpenGL ID for the shadow map texture
-	GLuint shadowMapFBO;  // Framebuffer object for shadow mapping
+		const char* materialTag);
 
-	void InitializeShadowMapping();  // Method to initialize shadow mapping resources
+	// add an object to the list of objects drawn in the scene
+	void AddSceneObject(
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		const char* textureTag,
+		const char* materialTag);
+	// import a model file as a mesh scene objects can be drawn
+	// with, before the mesh geometry is built
+	bool ImportMesh(const char* filename, MESH_TYPE& mesh);
+	// place the model files added on the command line
+	void AddModelObjects();
+	// define the lights, materials, textures and objects, from
+	// the scene file when one is loaded
+	void DefineSceneContent();
+	// define the scene from the records of the scene file
+	void DefineSceneFromFile();
+	// group the objects added last into one composite object,
+	// drawn as an impostor beyond the passed in distance
+	void AddCompositeObject(int firstObject, int objectCount, float impostorDistance);
+	// recalculate the model matrices of all the scene objects
+	void UpdateTransformations();
+	// bind the texture for the next draw command
+	void BindObjectTexture(const char* textureTag);
+	// draw an object's geometry, unwrapped if it is lightmapped
+	void DrawObjectGeometry(const SCENE_OBJECT& object, const ShaderManager* pShader);
+	// shader variant key matching the features of an object
+	unsigned int GetObjectShaderKey(const SCENE_OBJECT& object) const;
+	// make the shader variant for an object current
+	void UseObjectShader(const SCENE_OBJECT& object);
+	// make a shader variant current and set its frame uniforms
+	void UseShaderKey(unsigned int key);
+	// split the objects into passes and sort them by view depth
+	void SortSceneObjects();
+	// set up and draw a single scene object
+	void DrawSceneObject(const SCENE_OBJECT& object);
+	// update the transforms, lights and draw order of a frame
+	void BeginSceneFrame();
+	// fill the depth buffer with the opaque objects
+	void RenderDepthPrepass();
+	// draw the opaque objects, over the pre-pass when it is on
+	void RenderOpaquePass();
+	// draw the transparent objects back to front
+	void RenderTransparentPass();
+	// test the bounding boxes against the opaque depth
+	void IssueOcclusionQueries();
+	// build the basic shapes into one set of shared buffers
+	void BuildMeshGeometry();
+	// order the triangles of a basic shape for the vertex cache
+	// and overdraw, and print the cache miss ratios
+	static void OptimizeTriangleOrder(MeshGeometry::MESH_DATA& mesh, const char* meshName);
+	// build the shared meshes and object buffer for GPU culling
+	void BuildGpuScene();
+	// load or bake the lightmap of the static objects
+	void BuildLightmaps();
+	// whether an object is drawn with the baked lightmap
+	bool IsObjectLightmapped(const SCENE_OBJECT& object) const;
+	// merge the opaque static objects into the static batches
+	void BuildStaticBatches();
+	// whether the static objects are drawn with their batches
+	bool IsStaticBatchingReady() const;
+	// draw the geometry of a static batch, the model matrix of
+	// the program has to be the identity
+	void DrawStaticBatchGeometry(int batch, const ShaderManager* pShader);
+	// set up and draw a static batch
+	void DrawStaticBatch(int batch);
+	// render the composite objects into the impostor atlas
+	void BuildImpostors();
+	// whether far composite objects are drawn as impostors
+	bool IsImpostorReady() const;
+	// draw the impostors of the frame back to front
+	void RenderImpostors();
+	// shader variant key of a GPU culling draw group
+	unsigned int GetGroupShaderKey(int group) const;
+	// whether the GPU culling path can draw this frame
+	bool IsGpuCullingReady() const;
+	// cull and draw the opaque objects on the GPU
+	void RenderGpuCulledObjects();
+	// bounds of a basic shape or imported mesh in its own space
+	void GetMeshBounds(MESH_TYPE mesh, glm::vec3& minimum, glm::vec3& maximum) const;
 
 public:
 
+	// slices around the cylinders, cones, sphere and torus the
+	// scene is built with, set before PrepareScene()
+	void SetTessellation(int slices);
+	// place an .obj, .gltf or .glb model in the scene, before
+	// PrepareScene()
+	void AddModelFile(const char* filename);
+	// build the scene from a file compiled by SceneCompiler in
+	// place of the methods below, once before PrepareScene()
+	bool LoadSceneFile(const char* filename);
+
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
 	void RenderScene();
+	// declare the depth pre-pass, opaque, occlusion and
+	// transparent passes, which render into the color and depth
+	// targets at the passed in size
+	void AddScenePasses(RenderGraph* pGraph, int colorTarget, int depthTarget, int width, int height);
+	// build every shader variant the scene draws with right away,
+	// so timed frames do not wait on the background compiles
+	void WaitForShaderVariants();
+
+	// prepare and render the scene on the CPU, without OpenGL -
+	// the scene manager has to be created without a state cache
+	void PrepareSoftwareScene();
+	void RenderSoftwareScene(SoftwareRasterizer* pRasterizer);
+	// hand the prepared scene to a path tracer
+	void BuildPathTracedScene(PathTracer* pPathTracer);
+
+	// set the camera and viewport used for the next rendered frame
+	void SetViewParameters(
+		glm::mat4 view,
+		glm::mat4 projection,
+		glm::vec3 viewPosition,
+		int viewportWidth,
+		int viewportHeight);
+
 
+	// turn the depth pre-pass before the lit opaque pass on or off
+	void SetDepthPrepass(bool bEnable);
+	bool IsDepthPrepassEnabled() const;
+	// print the GPU time of every render pass
+	void ReportPassTimings() const;
+	// latest GPU time of all the passes of a frame
+	double GetGpuFrameMilliseconds() const;
+	// turn culling of hidden objects on or off
+	void SetOcclusionCulling(bool bEnable);
+	// print how many objects were hidden in the last frame
+	void ReportCullingStatistics() const;
+	// turn the compute shader culling of opaque objects on or off
+	void SetGpuCulling(bool bEnable);
+	bool IsGpuCullingEnabled() const;
+	// switch the static objects between the baked lightmap and
+	// per-fragment lighting
+	void SetLightmaps(bool bEnable);
+	bool IsLightmapEnabled() const;
+	// switch the opaque static objects between their merged
+	// batches and one draw each
+	void SetStaticBatching(bool bEnable);
+	bool IsStaticBatchingEnabled() const;
+	// print how many draws the static objects took last frame
+	void ReportBatchingStatistics() const;
+	// switch the far composite objects between their impostors
+	// and their parts
+	void SetImpostors(bool bEnable);
+	bool IsImpostorEnabled() const;
 
 	// pre-set light sources for 3D scene
 	void SetupSceneLights();
 	// pre-define the object materials for lighting
 	void DefineObjectMaterials();
+	// define the objects that make up the 3D scene
+	void DefineSceneObjects();
 
 };
\ No newline at end of file
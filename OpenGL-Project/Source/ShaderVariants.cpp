@@ -0,0 +1,631 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compile and cache specialized permutations of the scene shaders
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// the light count is stored above the feature bits
+	const unsigned int LIGHT_COUNT_SHIFT = 8;
+	const unsigned int FEATURE_MASK = (1 << LIGHT_COUNT_SHIFT) - 1;
+
+	// directory the linked variant binaries are cached in
+	const char* g_ProgramCacheDirectory = "ShaderCache";
+
+	/***********************************************************
+	 *  ReadSourceFile()
+	 *
+	 *  Read a whole text file into the passed in string.
+	 ***********************************************************/
+	bool ReadSourceFile(const char* filePath, std::string& source)
+	{
+		std::ifstream file(filePath, std::ios::in | std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open shader source:" << filePath << std::endl;
+			return(false);
+		}
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		source = stream.str();
+
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  MakeKey()
+ *
+ *  This method combines the feature flags and light count
+ *  into the key the variants are cached by.
+ ***********************************************************/
+unsigned int ShaderVariants::MakeKey(unsigned int features, unsigned int lightCount)
+{
+	if (lightCount > MAX_VARIANT_LIGHTS)
+	{
+		lightCount = 0;
+	}
+
+	return((features & FEATURE_MASK) | (lightCount << LIGHT_COUNT_SHIFT));
+}
+
+/***********************************************************
+ *  ShaderVariants()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderVariants::ShaderVariants(ShaderManager* pShaderManager, GLStateCache* pStateCache)
+{
+	m_pShaderManager = pShaderManager;
+	m_pStateCache = pStateCache;
+	m_baseProgram = 0;
+	m_currentProgram = 0;
+	m_frameIndex = 1;
+	m_baseProgramFrame = 0;
+	m_programSwitches = 0;
+	m_bStartupReported = true;
+	m_startTime = std::chrono::steady_clock::now();
+	m_pBinaryCache = new ProgramBinaryCache(g_ProgramCacheDirectory);
+
+	// let the driver compile on as many threads as it likes
+	m_bParallelCompile = false;
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		m_bParallelCompile = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		m_bParallelCompile = true;
+	}
+
+	if (NULL != m_pShaderManager)
+	{
+		m_baseProgram = m_pShaderManager->m_programID;
+		m_currentProgram = m_baseProgram;
+	}
+}
+
+/***********************************************************
+ *  ~ShaderVariants()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderVariants::~ShaderVariants()
+{
+	std::map<unsigned int, VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); it++)
+	{
+		DeleteStages(it->second);
+		if (it->second.program != 0)
+		{
+			glDeleteProgram(it->second.program);
+		}
+	}
+	m_variants.clear();
+
+	delete m_pBinaryCache;
+	m_pBinaryCache = NULL;
+	m_pShaderManager = NULL;
+	m_pStateCache = NULL;
+}
+
+/***********************************************************
+ *  LoadSources()
+ *
+ *  This method reads the GLSL files that every variant is
+ *  built from.  These should be the same files the shader
+ *  manager loaded for its base program.
+ ***********************************************************/
+bool ShaderVariants::LoadSources(const char* vertexFilePath, const char* fragmentFilePath)
+{
+	if ((ReadSourceFile(vertexFilePath, m_vertexSource) == false) ||
+		(ReadSourceFile(fragmentFilePath, m_fragmentSource) == false))
+	{
+		return(false);
+	}
+
+	m_startTime = std::chrono::steady_clock::now();
+	m_bStartupReported = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  BuildDefines()
+ *
+ *  This method builds the block of #defines that switches
+ *  the shader features for the passed in key.
+ ***********************************************************/
+std::string ShaderVariants::BuildDefines(unsigned int key)
+{
+	std::stringstream defines;
+
+	defines << "#define SHADER_VARIANT 1\n";
+	defines << "#define USE_TEXTURE " << ((key & FEATURE_TEXTURED) ? 1 : 0) << "\n";
+	defines << "#define USE_LIGHTING " << ((key & FEATURE_LIT) ? 1 : 0) << "\n";
+	defines << "#define USE_OBJECT_BUFFER " << ((key & FEATURE_OBJECT_BUFFER) ? 1 : 0) << "\n";
+	defines << "#define USE_LIGHTMAP " << ((key & FEATURE_LIGHTMAP) ? 1 : 0) << "\n";
+	defines << "#define LIGHT_COUNT " << (key >> LIGHT_COUNT_SHIFT) << "\n";
+
+	return(defines.str());
+}
+
+/***********************************************************
+ *  InjectDefines()
+ *
+ *  This method inserts the defines right after the #version
+ *  line, which has to stay the first statement of the shader.
+ ***********************************************************/
+std::string ShaderVariants::InjectDefines(const std::string& source, const std::string& defines)
+{
+	size_t versionPosition = source.find("#version");
+	if (versionPosition == std::string::npos)
+	{
+		return(defines + source);
+	}
+
+	size_t lineEnd = source.find('\n', versionPosition);
+	if (lineEnd == std::string::npos)
+	{
+		return(source + "\n" + defines);
+	}
+
+	return(source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1));
+}
+
+/***********************************************************
+ *  CheckStage()
+ *
+ *  This method checks the compile status of one shader stage
+ *  and prints the compile log when it failed.
+ ***********************************************************/
+bool ShaderVariants::CheckStage(GLuint shader, unsigned int key)
+{
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE)
+	{
+		GLint logLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+
+		std::vector<char> log(logLength + 1, 0);
+		glGetShaderInfoLog(shader, logLength, NULL, log.data());
+		std::cout << "Shader variant " << key << " failed to compile:" << std::endl << log.data() << std::endl;
+
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DeleteStages()
+ *
+ *  This method releases the shader objects of a variant,
+ *  they are no longer needed once the program is linked.
+ ***********************************************************/
+void ShaderVariants::DeleteStages(VARIANT& variant)
+{
+	if ((variant.program != 0) && (variant.vertexShader != 0))
+	{
+		glDetachShader(variant.program, variant.vertexShader);
+	}
+	if ((variant.program != 0) && (variant.fragmentShader != 0))
+	{
+		glDetachShader(variant.program, variant.fragmentShader);
+	}
+
+	glDeleteShader(variant.vertexShader);
+	glDeleteShader(variant.fragmentShader);
+	variant.vertexShader = 0;
+	variant.fragmentShader = 0;
+}
+
+/***********************************************************
+ *  IsStageComplete()
+ *
+ *  This method returns whether the driver has finished
+ *  compiling a shader or linking a program.  Without the
+ *  parallel compile extension there is no way to ask, so
+ *  the stage counts as complete and the following status
+ *  query waits for it.
+ ***********************************************************/
+bool ShaderVariants::IsStageComplete(GLuint object, bool bProgram) const
+{
+	if (m_bParallelCompile == false)
+	{
+		return(true);
+	}
+
+	GLint complete = GL_FALSE;
+	if (bProgram == true)
+	{
+		glGetProgramiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+	}
+	else
+	{
+		glGetShaderiv(object, GL_COMPLETION_STATUS_KHR, &complete);
+	}
+
+	return(complete == GL_TRUE);
+}
+
+/***********************************************************
+ *  StartVariant()
+ *
+ *  This method starts building the program for one key.  A
+ *  binary saved by an earlier run is used right away when
+ *  the driver still accepts it, otherwise both stages are
+ *  handed to the compiler without waiting for the result.
+ ***********************************************************/
+void ShaderVariants::StartVariant(unsigned int key, VARIANT& variant)
+{
+	variant.program = 0;
+	variant.lastUsedFrame = 0;
+	variant.state = VARIANT_FAILED;
+	variant.vertexShader = 0;
+	variant.fragmentShader = 0;
+	variant.sourceHash = 0;
+	variant.bFromCache = false;
+	variant.stageStart = std::chrono::steady_clock::now();
+	variant.compileMilliseconds = 0.0;
+	variant.linkMilliseconds = 0.0;
+
+	if (m_vertexSource.empty() || m_fragmentSource.empty())
+	{
+		return;
+	}
+
+	std::string defines = BuildDefines(key);
+	std::string vertexSource = InjectDefines(m_vertexSource, defines);
+	std::string fragmentSource = InjectDefines(m_fragmentSource, defines);
+
+	// the zero keeps the two stages from hashing like one string
+	variant.sourceHash = ProgramBinaryCache::HashSource(
+		vertexSource + std::string(1, '\0') + fragmentSource);
+
+	variant.program = m_pBinaryCache->LoadProgram(variant.sourceHash);
+	if (variant.program != 0)
+	{
+		variant.bFromCache = true;
+		variant.state = VARIANT_READY;
+		variant.linkMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - variant.stageStart).count();
+		std::cout << "Shader variant " << key << " loaded from cache: "
+			<< variant.linkMilliseconds << " ms" << std::endl;
+		return;
+	}
+
+	const char* vertexText = vertexSource.c_str();
+	const char* fragmentText = fragmentSource.c_str();
+
+	variant.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(variant.vertexShader, 1, &vertexText, NULL);
+	glCompileShader(variant.vertexShader);
+
+	variant.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(variant.fragmentShader, 1, &fragmentText, NULL);
+	glCompileShader(variant.fragmentShader);
+
+	variant.state = VARIANT_COMPILING;
+}
+
+/***********************************************************
+ *  AdvanceVariant()
+ *
+ *  This method moves a variant from compiling to linking and
+ *  from linking to ready once the driver has finished the
+ *  current stage.  With bWait set it goes through all the
+ *  remaining stages, waiting on the driver as needed.  It
+ *  returns false when the variant is still being built.
+ ***********************************************************/
+bool ShaderVariants::AdvanceVariant(unsigned int key, VARIANT& variant, bool bWait)
+{
+	if (variant.state == VARIANT_COMPILING)
+	{
+		if ((bWait == false) &&
+			((IsStageComplete(variant.vertexShader, false) == false) ||
+			 (IsStageComplete(variant.fragmentShader, false) == false)))
+		{
+			return(false);
+		}
+
+		bool bCompiled = CheckStage(variant.vertexShader, key);
+		bCompiled = CheckStage(variant.fragmentShader, key) && bCompiled;
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		variant.compileMilliseconds = std::chrono::duration<double, std::milli>(now - variant.stageStart).count();
+
+		if (bCompiled == false)
+		{
+			DeleteStages(variant);
+			variant.state = VARIANT_FAILED;
+			return(true);
+		}
+
+		variant.program = glCreateProgram();
+		glProgramParameteri(variant.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glAttachShader(variant.program, variant.vertexShader);
+		glAttachShader(variant.program, variant.fragmentShader);
+		glLinkProgram(variant.program);
+
+		variant.stageStart = now;
+		variant.state = VARIANT_LINKING;
+	}
+
+	if (variant.state == VARIANT_LINKING)
+	{
+		if ((bWait == false) && (IsStageComplete(variant.program, true) == false))
+		{
+			return(false);
+		}
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(variant.program, GL_LINK_STATUS, &status);
+
+		variant.linkMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - variant.stageStart).count();
+		DeleteStages(variant);
+
+		if (status != GL_TRUE)
+		{
+			GLint logLength = 0;
+			glGetProgramiv(variant.program, GL_INFO_LOG_LENGTH, &logLength);
+
+			std::vector<char> log(logLength + 1, 0);
+			glGetProgramInfoLog(variant.program, logLength, NULL, log.data());
+			std::cout << "Shader variant " << key << " failed to link:" << std::endl << log.data() << std::endl;
+
+			glDeleteProgram(variant.program);
+			variant.program = 0;
+			variant.state = VARIANT_FAILED;
+			return(true);
+		}
+
+		m_pBinaryCache->SaveProgram(variant.sourceHash, variant.program);
+		variant.state = VARIANT_READY;
+
+		std::cout << "Shader variant " << key << " ready: compile "
+			<< variant.compileMilliseconds << " ms, link "
+			<< variant.linkMilliseconds << " ms" << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  RequestVariant()
+ *
+ *  This method starts building the variant for the passed in
+ *  key if it has not been requested before.  It returns
+ *  without waiting, so all the variants a scene needs can be
+ *  compiled side by side.
+ ***********************************************************/
+void ShaderVariants::RequestVariant(unsigned int key)
+{
+	if (m_variants.find(key) == m_variants.end())
+	{
+		VARIANT variant;
+		StartVariant(key, variant);
+
+		m_variants.insert(std::make_pair(key, variant));
+	}
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method returns the program for the passed in key,
+ *  waiting for it to be built if needed.  A variant that
+ *  fails to build is remembered so it is not retried, and
+ *  the base program is returned in its place.
+ ***********************************************************/
+GLuint ShaderVariants::GetProgram(unsigned int key)
+{
+	RequestVariant(key);
+
+	std::map<unsigned int, VARIANT>::iterator it = m_variants.find(key);
+	AdvanceVariant(key, it->second, true);
+
+	if (it->second.state != VARIANT_READY)
+	{
+		return(m_baseProgram);
+	}
+
+	return(it->second.program);
+}
+
+/***********************************************************
+ *  UseVariant()
+ *
+ *  This method makes the variant for the passed in key the
+ *  current program and points the shader manager at it, or
+ *  the base program while the variant is not ready yet.
+ *  It returns true when the program is used for the first
+ *  time in the current frame, so the caller knows to set
+ *  the per-frame uniforms such as the view matrix.
+ ***********************************************************/
+bool ShaderVariants::UseVariant(unsigned int key)
+{
+	GLuint program = m_baseProgram;
+	unsigned int* lastUsedFrame = &m_baseProgramFrame;
+
+	// a variant that is still being built is drawn with the
+	// base program, which branches on uniforms instead
+	RequestVariant(key);
+	std::map<unsigned int, VARIANT>::iterator it = m_variants.find(key);
+	if (it->second.state == VARIANT_READY)
+	{
+		program = it->second.program;
+		lastUsedFrame = &it->second.lastUsedFrame;
+	}
+
+	// other passes may have bound their own program, so the
+	// state cache decides whether the bind is needed
+	m_pStateCache->UseProgram(program);
+	if (program != m_currentProgram)
+	{
+		m_currentProgram = program;
+		m_programSwitches++;
+
+		if (NULL != m_pShaderManager)
+		{
+			m_pShaderManager->m_programID = program;
+		}
+	}
+
+	bool bFirstUse = (*lastUsedFrame != m_frameIndex);
+	*lastUsedFrame = m_frameIndex;
+
+	return(bFirstUse);
+}
+
+/***********************************************************
+ *  UseBaseProgram()
+ *
+ *  This method switches back to the program that the shader
+ *  manager loaded, so code outside the scene keeps setting
+ *  its uniforms on the program it expects.
+ ***********************************************************/
+void ShaderVariants::UseBaseProgram()
+{
+	m_pStateCache->UseProgram(m_baseProgram);
+	m_currentProgram = m_baseProgram;
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->m_programID = m_baseProgram;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method starts a new frame, so every variant will
+ *  report its first use again.  Variants that are still
+ *  being built are moved on as far as the driver allows -
+ *  without the parallel compile extension each step waits,
+ *  so only one variant is finished per frame.
+ ***********************************************************/
+void ShaderVariants::BeginFrame()
+{
+	m_frameIndex++;
+	m_programSwitches = 0;
+
+	int pendingCount = 0;
+	bool bAdvanced = false;
+
+	std::map<unsigned int, VARIANT>::iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); it++)
+	{
+		VARIANT& variant = it->second;
+		if ((variant.state != VARIANT_COMPILING) && (variant.state != VARIANT_LINKING))
+		{
+			continue;
+		}
+
+		if ((m_bParallelCompile == false) && (bAdvanced == true))
+		{
+			pendingCount++;
+			continue;
+		}
+
+		bAdvanced = true;
+		if (AdvanceVariant(it->first, variant, false) == false)
+		{
+			pendingCount++;
+		}
+	}
+
+	if ((pendingCount == 0) && (m_bStartupReported == false))
+	{
+		m_bStartupReported = true;
+		std::cout << "INFO: " << GetVariantCount() << " shader variants ready after "
+			<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count()
+			<< " ms (" << m_pBinaryCache->GetHitCount() << " from cache)" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  IsVariantReady()
+ *
+ *  This method returns whether the variant for a key can be
+ *  used.  Draws that only work with the variant's features,
+ *  and not with the base program, check this first.
+ ***********************************************************/
+bool ShaderVariants::IsVariantReady(unsigned int key) const
+{
+	std::map<unsigned int, VARIANT>::const_iterator it = m_variants.find(key);
+
+	return((it != m_variants.end()) && (it->second.state == VARIANT_READY));
+}
+
+/***********************************************************
+ *  GetVariantCount()
+ *
+ *  This method returns the number of variants that have been
+ *  compiled successfully.
+ ***********************************************************/
+int ShaderVariants::GetVariantCount() const
+{
+	int count = 0;
+
+	std::map<unsigned int, VARIANT>::const_iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); it++)
+	{
+		if (it->second.state == VARIANT_READY)
+		{
+			count++;
+		}
+	}
+
+	return(count);
+}
+
+/***********************************************************
+ *  GetPendingCount()
+ *
+ *  This method returns the number of variants that are still
+ *  being compiled or linked.
+ ***********************************************************/
+int ShaderVariants::GetPendingCount() const
+{
+	int count = 0;
+
+	std::map<unsigned int, VARIANT>::const_iterator it;
+	for (it = m_variants.begin(); it != m_variants.end(); it++)
+	{
+		if ((it->second.state == VARIANT_COMPILING) || (it->second.state == VARIANT_LINKING))
+		{
+			count++;
+		}
+	}
+
+	return(count);
+}
+
+/***********************************************************
+ *  GetProgramSwitchCount()
+ *
+ *  This method returns how often the program was changed
+ *  since the start of the frame.
+ ***********************************************************/
+int ShaderVariants::GetProgramSwitchCount() const
+{
+	return(m_programSwitches);
+}
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compile and cache specialized permutations of the scene shaders
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ProgramBinaryCache.h"
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+
+/***********************************************************
+ *  ShaderVariants
+ *
+ *  This class builds variants of the scene shaders with the
+ *  feature switches injected as #defines, so that every
+ *  fragment only runs the code its draw actually needs.
+ *  Variants are compiled in the background once requested
+ *  and cached by their key - until a variant is ready, draws
+ *  fall back to the program the shader manager loaded.
+ *  While a variant is in use the shader manager is pointed
+ *  at its program, so all of the existing uniform setters
+ *  keep working.
+ ***********************************************************/
+class ShaderVariants
+{
+public:
+	// features that can be compiled into a variant
+	enum FEATURE_FLAGS
+	{
+		FEATURE_TEXTURED = 1 << 0,
+		FEATURE_LIT = 1 << 1,
+		// model and material read from the object buffer of the
+		// GPU culling pass instead of from uniforms
+		FEATURE_OBJECT_BUFFER = 1 << 2,
+		// static lighting read from the baked lightmap
+		FEATURE_LIGHTMAP = 1 << 3
+	};
+
+	// the largest light count that can be compiled into a variant
+	static const unsigned int MAX_VARIANT_LIGHTS = 8;
+
+	// build the cache key for a set of features and a light count,
+	// a light count of zero selects the clustered light lookup
+	static unsigned int MakeKey(unsigned int features, unsigned int lightCount);
+
+	// constructor
+	ShaderVariants(ShaderManager* pShaderManager, GLStateCache* pStateCache);
+	// destructor
+	~ShaderVariants();
+
+	// read the GLSL sources the variants are built from
+	bool LoadSources(const char* vertexFilePath, const char* fragmentFilePath);
+	// start building a variant without waiting for it
+	void RequestVariant(unsigned int key);
+	// get the program for a key, waiting for it to be built
+	GLuint GetProgram(unsigned int key);
+	// make the variant current - returns true when it is used for
+	// the first time this frame and needs its frame uniforms set
+	bool UseVariant(unsigned int key);
+	// whether the variant for a key has finished building
+	bool IsVariantReady(unsigned int key) const;
+	// go back to the program the shader manager loaded
+	void UseBaseProgram();
+	// start a new frame of variant usage and advance the
+	// variants that are still being built
+	void BeginFrame();
+
+	// number of compiled variants
+	int GetVariantCount() const;
+	// number of variants that are still being built
+	int GetPendingCount() const;
+	// number of program changes in the current frame
+	int GetProgramSwitchCount() const;
+
+private:
+	enum VARIANT_STATE
+	{
+		VARIANT_COMPILING,
+		VARIANT_LINKING,
+		VARIANT_READY,
+		VARIANT_FAILED
+	};
+
+	struct VARIANT
+	{
+		GLuint program;
+		unsigned int lastUsedFrame;
+		VARIANT_STATE state;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		unsigned long long sourceHash;
+		bool bFromCache;
+		// timing of the compile and link stages
+		std::chrono::steady_clock::time_point stageStart;
+		double compileMilliseconds;
+		double linkMilliseconds;
+	};
+
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to the filter for redundant GL state changes
+	GLStateCache* m_pStateCache;
+	// program loaded by the shader manager, used as fallback
+	GLuint m_baseProgram;
+	// program that is currently bound
+	GLuint m_currentProgram;
+	// GLSL sources the variants are built from
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	// linked programs saved from earlier runs
+	ProgramBinaryCache* m_pBinaryCache;
+	// compiled variants by key
+	std::map<unsigned int, VARIANT> m_variants;
+	// frame counter used to detect first use in a frame
+	unsigned int m_frameIndex;
+	unsigned int m_baseProgramFrame;
+	int m_programSwitches;
+	// whether the driver compiles on its own threads and can
+	// be polled for completion without blocking
+	bool m_bParallelCompile;
+	// time the variant sources were loaded, for startup timing
+	std::chrono::steady_clock::time_point m_startTime;
+	bool m_bStartupReported;
+
+	// build the #define block for a key
+	static std::string BuildDefines(unsigned int key);
+	// insert the defines right after the #version line
+	static std::string InjectDefines(const std::string& source, const std::string& defines);
+	// issue the compiles of one variant, or load it from the cache
+	void StartVariant(unsigned int key, VARIANT& variant);
+	// move a variant on to its next stage once the driver is done,
+	// returns false when the stage is still busy
+	bool AdvanceVariant(unsigned int key, VARIANT& variant, bool bWait);
+	// whether the driver has finished with a shader or program
+	bool IsStageComplete(GLuint object, bool bProgram) const;
+	// check the compile status of one shader stage
+	static bool CheckStage(GLuint shader, unsigned int key);
+	// release the shaders of a variant
+	static void DeleteStages(VARIANT& variant);
+};
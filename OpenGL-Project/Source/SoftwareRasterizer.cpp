@@ -0,0 +1,713 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.cpp
+// ============
+// render the scene meshes on the CPU for hosts without a GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareRasterizer.h"
+#include "ImageWriter.h"
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// clip space outcodes of a vertex
+	const unsigned int g_OutsideLeft = 1;
+	const unsigned int g_OutsideRight = 2;
+	const unsigned int g_OutsideBottom = 4;
+	const unsigned int g_OutsideTop = 8;
+	const unsigned int g_OutsideNear = 16;
+	const unsigned int g_OutsideFar = 32;
+
+	/***********************************************************
+	 *  PackColor()
+	 *
+	 *  Clamp a color and pack it into RGBA8, red in the low byte.
+	 ***********************************************************/
+	unsigned int PackColor(const glm::vec4& color)
+	{
+		unsigned int r = (unsigned int)(glm::clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+		unsigned int g = (unsigned int)(glm::clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+		unsigned int b = (unsigned int)(glm::clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
+		unsigned int a = (unsigned int)(glm::clamp(color.a, 0.0f, 1.0f) * 255.0f + 0.5f);
+
+		return(r | (g << 8) | (b << 16) | (a << 24));
+	}
+
+	/***********************************************************
+	 *  UnpackColor()
+	 *
+	 *  Unpack an RGBA8 color into floats.
+	 ***********************************************************/
+	glm::vec4 UnpackColor(unsigned int color)
+	{
+		return(glm::vec4(
+			(float)(color & 0xFF),
+			(float)((color >> 8) & 0xFF),
+			(float)((color >> 16) & 0xFF),
+			(float)(color >> 24)) * (1.0f / 255.0f));
+	}
+
+	/***********************************************************
+	 *  ComputeOutcode()
+	 *
+	 *  Flag the clip space planes a vertex lies outside of.
+	 ***********************************************************/
+	unsigned int ComputeOutcode(const glm::vec4& clip)
+	{
+		unsigned int outcode = 0;
+		outcode |= (clip.x < -clip.w) ? g_OutsideLeft : 0;
+		outcode |= (clip.x > clip.w) ? g_OutsideRight : 0;
+		outcode |= (clip.y < -clip.w) ? g_OutsideBottom : 0;
+		outcode |= (clip.y > clip.w) ? g_OutsideTop : 0;
+		outcode |= (clip.z < -clip.w) ? g_OutsideNear : 0;
+		outcode |= (clip.z > clip.w) ? g_OutsideFar : 0;
+
+		return(outcode);
+	}
+
+	/***********************************************************
+	 *  CalcLightSource()
+	 *
+	 *  Same ambient, diffuse and specular terms, range falloff
+	 *  and spot cone as CalcLightSource() in the fragment shader.
+	 ***********************************************************/
+	glm::vec3 CalcLightSource(
+		const ClusteredLighting::LIGHT_SOURCE& light,
+		const SoftwareRasterizer::DRAW_MATERIAL& material,
+		const glm::vec3& lightNormal,
+		const glm::vec3& vertexPosition,
+		const glm::vec3& viewDirection)
+	{
+		glm::vec3 lightOffset = light.position - vertexPosition;
+		glm::vec3 lightDirection = glm::normalize(lightOffset);
+
+		glm::vec3 ambient = light.ambientColor * material.ambientStrength * material.ambientColor;
+
+		float impact = std::max(glm::dot(lightNormal, lightDirection), 0.0f);
+		glm::vec3 diffuse = impact * light.diffuseColor * material.diffuseColor;
+
+		glm::vec3 reflectDirection = glm::reflect(-lightDirection, lightNormal);
+		float specularComponent = std::pow(std::max(glm::dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+		glm::vec3 specular = light.specularIntensity * specularComponent * material.specularColor * light.specularColor;
+
+		float attenuation = 1.0f;
+		float spotFactor = 1.0f;
+
+		if (light.range > 0.0f)
+		{
+			float distance = glm::length(lightOffset) / light.range;
+			float falloff = glm::clamp(1.0f - distance * distance, 0.0f, 1.0f);
+			attenuation = falloff * falloff;
+		}
+
+		if (light.outerConeCosine > -1.0f)
+		{
+			float theta = glm::dot(-lightDirection, glm::normalize(light.direction));
+			spotFactor = glm::smoothstep(light.outerConeCosine, light.innerConeCosine, theta);
+		}
+
+		return((ambient + ((diffuse + specular) * spotFactor)) * attenuation);
+	}
+}
+
+/***********************************************************
+ *  SoftwareRasterizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareRasterizer::SoftwareRasterizer(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_width = 0;
+	m_height = 0;
+	m_stride = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
+	m_viewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_clearColor = 0;
+	m_triangleCount = 0;
+}
+
+/***********************************************************
+ *  ~SoftwareRasterizer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	m_pJobSystem = NULL;
+}
+
+/***********************************************************
+ *  SetFrameSize()
+ *
+ *  This method sizes the color and depth buffers and the
+ *  tile grid for the rendered image.
+ ***********************************************************/
+void SoftwareRasterizer::SetFrameSize(int width, int height)
+{
+	if ((width == m_width) && (height == m_height))
+	{
+		return;
+	}
+
+	m_width = width;
+	m_height = height;
+	// whole groups of four pixels keep the SIMD loads in the row
+	m_stride = (width + 3) & ~3;
+	m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+	m_colorBuffer.assign((size_t)m_stride * height, 0);
+	m_depthBuffer.assign((size_t)m_stride * height, 1.0f);
+	m_image.assign((size_t)width * height, 0);
+	m_tileBins.resize((size_t)m_tilesX * m_tilesY);
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method sets the lights every pixel is lit by.
+ ***********************************************************/
+void SoftwareRasterizer::SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights)
+{
+	m_lights = lights;
+}
+
+/***********************************************************
+ *  SetViewParameters()
+ *
+ *  This method sets the camera of the next frame.
+ ***********************************************************/
+void SoftwareRasterizer::SetViewParameters(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	m_viewProjection = projection * view;
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method starts recording the draws of a frame.  The
+ *  buffers are cleared tile by tile when the frame renders.
+ ***********************************************************/
+void SoftwareRasterizer::BeginFrame(const glm::vec4& clearColor)
+{
+	m_draws.clear();
+	m_clearColor = PackColor(clearColor);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method records a mesh draw with its transform,
+ *  texture and material.  Blended draws are mixed into the
+ *  image with the source alpha, like the transparent pass.
+ ***********************************************************/
+void SoftwareRasterizer::DrawMesh(
+	const MeshGeometry::MESH_DATA& mesh,
+	const glm::mat4& model,
+	const SoftwareTexture* pTexture,
+	const DRAW_MATERIAL& material,
+	const glm::vec4& objectColor,
+	const glm::vec2& uvScale,
+	bool bBlend)
+{
+	DRAW draw;
+	draw.pMesh = &mesh;
+	draw.model = model;
+	draw.normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+	draw.pTexture = pTexture;
+	draw.material = material;
+	draw.objectColor = objectColor;
+	draw.uvScale = uvScale;
+	draw.bBlend = bBlend;
+	draw.firstTriangle = 0;
+	draw.triangleCount = 0;
+
+	m_draws.push_back(draw);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method renders the recorded draws.  Every draw gets
+ *  room for twice its triangles, the most near plane
+ *  clipping can turn them into, so the draws are set up in
+ *  parallel without sharing anything.
+ ***********************************************************/
+void SoftwareRasterizer::EndFrame()
+{
+	unsigned int triangleSlots = 0;
+	for (size_t i = 0; i < m_draws.size(); i++)
+	{
+		m_draws[i].firstTriangle = triangleSlots;
+		triangleSlots += (unsigned int)(m_draws[i].pMesh->indices.size() / 3) * 2;
+	}
+	if (m_triangles.size() < triangleSlots)
+	{
+		m_triangles.resize(triangleSlots);
+	}
+
+	m_pJobSystem->ParallelFor(
+		"SetupDraws",
+		(unsigned int)m_draws.size(),
+		1,
+		[this](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				SetupDraw((int)i);
+			}
+		});
+
+	BinTriangles();
+
+	m_pJobSystem->ParallelFor(
+		"RasterizeTiles",
+		(unsigned int)(m_tilesX * m_tilesY),
+		1,
+		[this](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; i++)
+			{
+				RasterizeTile((int)i);
+			}
+		});
+
+	for (int y = 0; y < m_height; y++)
+	{
+		std::copy(
+			m_colorBuffer.begin() + (size_t)y * m_stride,
+			m_colorBuffer.begin() + (size_t)y * m_stride + m_width,
+			m_image.begin() + (size_t)y * m_width);
+	}
+}
+
+/***********************************************************
+ *  SetupDraw()
+ *
+ *  This method runs the vertex stage of a draw, drops the
+ *  triangles that are entirely outside one clip plane and
+ *  clips the ones crossing the near plane, which are the
+ *  only ones that can not be projected.  The other planes
+ *  are left to the screen bounds of each triangle.
+ ***********************************************************/
+void SoftwareRasterizer::SetupDraw(int drawIndex)
+{
+	const DRAW& draw = m_draws[drawIndex];
+	const MeshGeometry::MESH_DATA& mesh = *draw.pMesh;
+
+	std::vector<SHADE_VERTEX> vertices(mesh.vertices.size());
+	std::vector<unsigned int> outcodes(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		glm::vec4 world = draw.model * glm::vec4(mesh.vertices[i].position, 1.0f);
+		vertices[i].clip = m_viewProjection * world;
+		vertices[i].position = glm::vec3(world);
+		vertices[i].normal = draw.normalMatrix * mesh.vertices[i].normal;
+		vertices[i].uv = mesh.vertices[i].textureCoordinate;
+		outcodes[i] = ComputeOutcode(vertices[i].clip);
+	}
+
+	auto lerpVertex = [](const SHADE_VERTEX& a, const SHADE_VERTEX& b, float t)
+	{
+		SHADE_VERTEX vertex;
+		vertex.clip = a.clip + (b.clip - a.clip) * t;
+		vertex.position = a.position + (b.position - a.position) * t;
+		vertex.normal = a.normal + (b.normal - a.normal) * t;
+		vertex.uv = a.uv + (b.uv - a.uv) * t;
+		return(vertex);
+	};
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		unsigned int index0 = mesh.indices[i];
+		unsigned int index1 = mesh.indices[i + 1];
+		unsigned int index2 = mesh.indices[i + 2];
+
+		if ((outcodes[index0] & outcodes[index1] & outcodes[index2]) != 0)
+		{
+			continue;
+		}
+
+		if (((outcodes[index0] | outcodes[index1] | outcodes[index2]) & g_OutsideNear) == 0)
+		{
+			AddTriangle(drawIndex, vertices[index0], vertices[index1], vertices[index2]);
+			continue;
+		}
+
+		// keep the part in front of the near plane, at most four
+		// corners that are drawn as a fan
+		const SHADE_VERTEX* corners[3] = { &vertices[index0], &vertices[index1], &vertices[index2] };
+		SHADE_VERTEX polygon[4];
+		int polygonSize = 0;
+		for (int j = 0; j < 3; j++)
+		{
+			const SHADE_VERTEX& a = *corners[j];
+			const SHADE_VERTEX& b = *corners[(j + 1) % 3];
+			float distanceA = a.clip.z + a.clip.w;
+			float distanceB = b.clip.z + b.clip.w;
+
+			if (distanceA >= 0.0f)
+			{
+				polygon[polygonSize++] = a;
+			}
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			{
+				polygon[polygonSize++] = lerpVertex(a, b, distanceA / (distanceA - distanceB));
+			}
+		}
+
+		for (int j = 1; j + 1 < polygonSize; j++)
+		{
+			AddTriangle(drawIndex, polygon[0], polygon[j], polygon[j + 1]);
+		}
+	}
+}
+
+/***********************************************************
+ *  AddTriangle()
+ *
+ *  This method projects a triangle to the screen and sets up
+ *  its edge functions.  Each edge is built from its two end
+ *  points in a fixed order and only then negated, so the
+ *  triangles on both sides of an edge evaluate exactly
+ *  opposite values and no pixel falls in between.
+ ***********************************************************/
+void SoftwareRasterizer::AddTriangle(int drawIndex, const SHADE_VERTEX& v0, const SHADE_VERTEX& v1, const SHADE_VERTEX& v2)
+{
+	DRAW& draw = m_draws[drawIndex];
+	const SHADE_VERTEX* vertices[3] = { &v0, &v1, &v2 };
+
+	TRIANGLE triangle;
+	float x[3];
+	float y[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& clip = vertices[i]->clip;
+		triangle.inverseW[i] = 1.0f / clip.w;
+		x[i] = (clip.x * triangle.inverseW[i] * 0.5f + 0.5f) * (float)m_width;
+		y[i] = (0.5f - clip.y * triangle.inverseW[i] * 0.5f) * (float)m_height;
+		triangle.depth[i] = clip.z * triangle.inverseW[i] * 0.5f + 0.5f;
+		triangle.vertex[i] = *vertices[i];
+	}
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (!(std::fabs(area) > 1e-8f))
+	{
+		return;
+	}
+
+	// the bounds are clamped as floats, triangles reaching far
+	// past the sides would overflow an integer
+	float minX = std::max(std::min(x[0], std::min(x[1], x[2])), 0.0f);
+	float minY = std::max(std::min(y[0], std::min(y[1], y[2])), 0.0f);
+	float maxX = std::min(std::max(x[0], std::max(x[1], x[2])), (float)(m_width - 1));
+	float maxY = std::min(std::max(y[0], std::max(y[1], y[2])), (float)(m_height - 1));
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+
+	triangle.minX = (int)minX;
+	triangle.minY = (int)minY;
+	triangle.maxX = (int)maxX;
+	triangle.maxY = (int)maxY;
+
+	float orientation = (area > 0.0f) ? 1.0f : -1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		int k = (i + 2) % 3;
+		bool bSwapped = (x[k] < x[j]) || ((x[k] == x[j]) && (y[k] < y[j]));
+		int first = bSwapped ? k : j;
+		int second = bSwapped ? j : k;
+
+		float a = -(y[second] - y[first]);
+		float b = x[second] - x[first];
+		float c = -(a * x[first] + b * y[first]);
+		float sign = bSwapped ? -orientation : orientation;
+
+		triangle.edgeA[i] = a * sign;
+		triangle.edgeB[i] = b * sign;
+		triangle.edgeC[i] = c * sign;
+		// only one of two triangles sharing an edge owns the pixels
+		// exactly on it
+		triangle.bInclusive[i] = (triangle.edgeA[i] > 0.0f) ||
+			((triangle.edgeA[i] == 0.0f) && (triangle.edgeB[i] > 0.0f));
+	}
+
+	triangle.inverseArea = 1.0f / std::fabs(area);
+	triangle.draw = drawIndex;
+
+	m_triangles[draw.firstTriangle + draw.triangleCount] = triangle;
+	draw.triangleCount++;
+}
+
+/***********************************************************
+ *  BinTriangles()
+ *
+ *  This method adds every set up triangle to the bins of
+ *  the tiles its screen bounds touch.  The draws are walked
+ *  in order, so each tile sees its triangles in draw order
+ *  and blending stays correct.
+ ***********************************************************/
+void SoftwareRasterizer::BinTriangles()
+{
+	for (size_t i = 0; i < m_tileBins.size(); i++)
+	{
+		m_tileBins[i].clear();
+	}
+
+	m_triangleCount = 0;
+	for (size_t i = 0; i < m_draws.size(); i++)
+	{
+		const DRAW& draw = m_draws[i];
+		for (unsigned int t = draw.firstTriangle; t < draw.firstTriangle + draw.triangleCount; t++)
+		{
+			const TRIANGLE& triangle = m_triangles[t];
+			for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; tileY++)
+			{
+				for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; tileX++)
+				{
+					m_tileBins[tileY * m_tilesX + tileX].push_back(t);
+				}
+			}
+		}
+		m_triangleCount += (int)draw.triangleCount;
+	}
+}
+
+/***********************************************************
+ *  RasterizeTile()
+ *
+ *  This method clears one tile and draws its triangles.  No
+ *  other worker touches the pixels of the tile.
+ ***********************************************************/
+void SoftwareRasterizer::RasterizeTile(int tile)
+{
+	int tileMinX = (tile % m_tilesX) * TILE_SIZE;
+	int tileMinY = (tile / m_tilesX) * TILE_SIZE;
+	int tileMaxX = std::min(tileMinX + TILE_SIZE, m_width) - 1;
+	int tileMaxY = std::min(tileMinY + TILE_SIZE, m_height) - 1;
+
+	for (int y = tileMinY; y <= tileMaxY; y++)
+	{
+		size_t row = (size_t)y * m_stride;
+		std::fill(m_colorBuffer.begin() + row + tileMinX, m_colorBuffer.begin() + row + tileMaxX + 1, m_clearColor);
+		std::fill(m_depthBuffer.begin() + row + tileMinX, m_depthBuffer.begin() + row + tileMaxX + 1, 1.0f);
+	}
+
+	const std::vector<unsigned int>& bin = m_tileBins[tile];
+	for (size_t i = 0; i < bin.size(); i++)
+	{
+		RasterizeTriangle(m_triangles[bin[i]], tileMinX, tileMinY, tileMaxX, tileMaxY);
+	}
+}
+
+/***********************************************************
+ *  RasterizeTriangle()
+ *
+ *  This method walks the part of a triangle's bounds inside
+ *  a tile four pixels at a time.  The edge functions and the
+ *  depth are evaluated and tested for all four with SSE2,
+ *  and only the pixels that pass both are shaded.
+ ***********************************************************/
+void SoftwareRasterizer::RasterizeTriangle(const TRIANGLE& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+{
+	// the tiles start on multiples of four, so the aligned start
+	// never leaves the tile
+	int startX = std::max(triangle.minX, tileMinX) & ~3;
+	int endX = std::min(triangle.maxX, tileMaxX);
+	int startY = std::max(triangle.minY, tileMinY);
+	int endY = std::min(triangle.maxY, tileMaxY);
+	if ((startX > endX) || (startY > endY))
+	{
+		return;
+	}
+
+	const DRAW& draw = m_draws[triangle.draw];
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 rowEnd = _mm_set1_ps((float)endX + 1.0f);
+	const __m128 inverseArea = _mm_set1_ps(triangle.inverseArea);
+	__m128 edgeA[3];
+	__m128 depth[3];
+	for (int i = 0; i < 3; i++)
+	{
+		edgeA[i] = _mm_set1_ps(triangle.edgeA[i]);
+		depth[i] = _mm_set1_ps(triangle.depth[i]);
+	}
+
+	for (int y = startY; y <= endY; y++)
+	{
+		float pixelY = (float)y + 0.5f;
+		__m128 rowEdge[3];
+		for (int i = 0; i < 3; i++)
+		{
+			rowEdge[i] = _mm_set1_ps(triangle.edgeB[i] * pixelY + triangle.edgeC[i]);
+		}
+
+		float* depthRow = &m_depthBuffer[(size_t)y * m_stride];
+		unsigned int* colorRow = &m_colorBuffer[(size_t)y * m_stride];
+
+		for (int x = startX; x <= endX; x += 4)
+		{
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+			__m128 mask = _mm_cmplt_ps(pixelX, rowEnd);
+			__m128 edge[3];
+			for (int i = 0; i < 3; i++)
+			{
+				edge[i] = _mm_add_ps(_mm_mul_ps(edgeA[i], pixelX), rowEdge[i]);
+				__m128 inside = (triangle.bInclusive[i] == true) ? _mm_cmpge_ps(edge[i], zero) : _mm_cmpgt_ps(edge[i], zero);
+				mask = _mm_and_ps(mask, inside);
+			}
+			if (_mm_movemask_ps(mask) == 0)
+			{
+				continue;
+			}
+
+			__m128 b0 = _mm_mul_ps(edge[0], inverseArea);
+			__m128 b1 = _mm_mul_ps(edge[1], inverseArea);
+			__m128 b2 = _mm_mul_ps(edge[2], inverseArea);
+			__m128 z = _mm_add_ps(
+				_mm_mul_ps(depth[0], b0),
+				_mm_add_ps(_mm_mul_ps(depth[1], b1), _mm_mul_ps(depth[2], b2)));
+
+			__m128 storedDepth = _mm_loadu_ps(depthRow + x);
+			mask = _mm_and_ps(mask, _mm_cmplt_ps(z, storedDepth));
+			int laneMask = _mm_movemask_ps(mask);
+			if (laneMask == 0)
+			{
+				continue;
+			}
+
+			// both passes write depth, as they do on the GPU
+			_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, storedDepth)));
+
+			float weights[3][4];
+			_mm_storeu_ps(weights[0], b0);
+			_mm_storeu_ps(weights[1], b1);
+			_mm_storeu_ps(weights[2], b2);
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if ((laneMask & (1 << lane)) == 0)
+				{
+					continue;
+				}
+
+				glm::vec4 color = ShadePixel(triangle, weights[0][lane], weights[1][lane], weights[2][lane]);
+				color = glm::clamp(color, 0.0f, 1.0f);
+				if (draw.bBlend == true)
+				{
+					glm::vec4 destination = UnpackColor(colorRow[x + lane]);
+					color = color * color.a + destination * (1.0f - color.a);
+				}
+				colorRow[x + lane] = PackColor(color);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ShadePixel()
+ *
+ *  This method interpolates the vertex outputs with
+ *  perspective correction and lights the pixel with every
+ *  light, like the fragment shader.
+ ***********************************************************/
+glm::vec4 SoftwareRasterizer::ShadePixel(const TRIANGLE& triangle, float b0, float b1, float b2) const
+{
+	const DRAW& draw = m_draws[triangle.draw];
+
+	float w0 = b0 * triangle.inverseW[0];
+	float w1 = b1 * triangle.inverseW[1];
+	float w2 = b2 * triangle.inverseW[2];
+	float normalize = 1.0f / (w0 + w1 + w2);
+	w0 *= normalize;
+	w1 *= normalize;
+	w2 *= normalize;
+
+	const SHADE_VERTEX* vertex = triangle.vertex;
+	glm::vec3 position = vertex[0].position * w0 + vertex[1].position * w1 + vertex[2].position * w2;
+	glm::vec3 normal = glm::normalize(vertex[0].normal * w0 + vertex[1].normal * w1 + vertex[2].normal * w2);
+	glm::vec2 uv = vertex[0].uv * w0 + vertex[1].uv * w1 + vertex[2].uv * w2;
+
+	glm::vec4 baseColor = draw.objectColor;
+	if (NULL != draw.pTexture)
+	{
+		baseColor = draw.pTexture->Sample(uv * draw.uvScale);
+	}
+
+	glm::vec3 viewDirection = glm::normalize(m_viewPosition - position);
+	glm::vec3 phongResult(0.0f);
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		phongResult += CalcLightSource(m_lights[i], draw.material, normal, position, viewDirection);
+	}
+
+	return(glm::vec4(phongResult * glm::vec3(baseColor), baseColor.a));
+}
+
+/***********************************************************
+ *  SaveImage()
+ *
+ *  This method writes the last rendered image to an
+ *  uncompressed 32-bit TGA file.
+ ***********************************************************/
+bool SoftwareRasterizer::SaveImage(const char* filePath) const
+{
+	return(ImageWriter::WriteTGA(filePath, m_image, m_width, m_height));
+}
+
+/***********************************************************
+ *  GetColorBuffer()
+ *
+ *  This method returns the pixels of the last rendered frame.
+ ***********************************************************/
+const std::vector<unsigned int>& SoftwareRasterizer::GetColorBuffer() const
+{
+	return(m_image);
+}
+
+/***********************************************************
+ *  GetWidth()
+ *
+ *  This method returns the width of the rendered image.
+ ***********************************************************/
+int SoftwareRasterizer::GetWidth() const
+{
+	return(m_width);
+}
+
+/***********************************************************
+ *  GetHeight()
+ *
+ *  This method returns the height of the rendered image.
+ ***********************************************************/
+int SoftwareRasterizer::GetHeight() const
+{
+	return(m_height);
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method returns the number of triangles that were
+ *  set up for the tiles in the last frame.
+ ***********************************************************/
+int SoftwareRasterizer::GetTriangleCount() const
+{
+	return(m_triangleCount);
+}
@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.h
+// ============
+// render the scene meshes on the CPU for hosts without a GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ClusteredLighting.h"
+#include "JobSystem.h"
+#include "MeshGeometry.h"
+#include "SoftwareTexture.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  SoftwareRasterizer
+ *
+ *  This class draws the same meshes, transforms, textures
+ *  and Phong materials as the OpenGL path into an image in
+ *  memory.  Draws are only recorded until EndFrame(), which
+ *  transforms and clips the triangles of all the draws in
+ *  parallel, bins them into screen tiles in draw order and
+ *  then rasterizes every tile on its own worker.  Coverage
+ *  and depth are tested four pixels at a time with SSE2 and
+ *  the textures are sampled from cache friendly 4x4 blocks.
+ ***********************************************************/
+class SoftwareRasterizer
+{
+public:
+	// the parts of an object's material the Phong model needs
+	struct DRAW_MATERIAL
+	{
+		glm::vec3 ambientColor;
+		float ambientStrength;
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// width and height of a screen tile in pixels
+	static const int TILE_SIZE = 64;
+
+	// constructor
+	SoftwareRasterizer(JobSystem* pJobSystem);
+	// destructor
+	~SoftwareRasterizer();
+
+	// size of the rendered image
+	void SetFrameSize(int width, int height);
+	// set the lights the scene is lit by
+	void SetLights(const std::vector<ClusteredLighting::LIGHT_SOURCE>& lights);
+	// set the camera of the next frame
+	void SetViewParameters(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+
+	// start recording the draws of a frame
+	void BeginFrame(const glm::vec4& clearColor);
+	// record a mesh draw, the mesh and texture have to stay alive
+	// until EndFrame(), a NULL texture draws the object color
+	void DrawMesh(
+		const MeshGeometry::MESH_DATA& mesh,
+		const glm::mat4& model,
+		const SoftwareTexture* pTexture,
+		const DRAW_MATERIAL& material,
+		const glm::vec4& objectColor,
+		const glm::vec2& uvScale,
+		bool bBlend);
+	// render all the recorded draws into the image
+	void EndFrame();
+
+	// write the image as an uncompressed TGA file
+	bool SaveImage(const char* filePath) const;
+	// RGBA8 pixels, top row first
+	const std::vector<unsigned int>& GetColorBuffer() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	// triangles that reached the tiles in the last frame
+	int GetTriangleCount() const;
+
+private:
+	struct DRAW
+	{
+		const MeshGeometry::MESH_DATA* pMesh;
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+		const SoftwareTexture* pTexture;
+		DRAW_MATERIAL material;
+		glm::vec4 objectColor;
+		glm::vec2 uvScale;
+		bool bBlend;
+		// first triangle slot and number of triangles set up
+		unsigned int firstTriangle;
+		unsigned int triangleCount;
+	};
+
+	// a vertex after the vertex stage
+	struct SHADE_VERTEX
+	{
+		glm::vec4 clip;
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	// a clipped screen space triangle ready for the tiles
+	struct TRIANGLE
+	{
+		// edge functions a*x + b*y + c, positive inside, the edge
+		// i is the one across from vertex i
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		// whether pixel centers exactly on an edge are covered
+		bool bInclusive[3];
+		float inverseArea;
+		// window depth and 1/w of the vertices
+		float depth[3];
+		float inverseW[3];
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		int draw;
+		SHADE_VERTEX vertex[3];
+	};
+
+	// pointer to job system used for the vertices and tiles
+	JobSystem* m_pJobSystem;
+
+	int m_width;
+	int m_height;
+	// row length of the buffers, a multiple of four pixels
+	int m_stride;
+	int m_tilesX;
+	int m_tilesY;
+	std::vector<unsigned int> m_colorBuffer;
+	std::vector<float> m_depthBuffer;
+	// the image in rows of exactly the frame width
+	std::vector<unsigned int> m_image;
+
+	std::vector<ClusteredLighting::LIGHT_SOURCE> m_lights;
+
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_viewPosition;
+	unsigned int m_clearColor;
+
+	std::vector<DRAW> m_draws;
+	std::vector<TRIANGLE> m_triangles;
+	// triangle indices of every tile, in draw order
+	std::vector<std::vector<unsigned int> > m_tileBins;
+	int m_triangleCount;
+
+	// transform, clip and set up the triangles of one draw
+	void SetupDraw(int drawIndex);
+	// add a clipped triangle to the draw's triangle slots
+	void AddTriangle(int drawIndex, const SHADE_VERTEX& v0, const SHADE_VERTEX& v1, const SHADE_VERTEX& v2);
+	// put every set up triangle into the bins of its tiles
+	void BinTriangles();
+	// clear one tile and rasterize its bin
+	void RasterizeTile(int tile);
+	// rasterize one triangle inside a tile rectangle
+	void RasterizeTriangle(const TRIANGLE& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+	// light and color one covered pixel
+	glm::vec4 ShadePixel(const TRIANGLE& triangle, float b0, float b1, float b2) const;
+};
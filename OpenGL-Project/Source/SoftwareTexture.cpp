@@ -0,0 +1,138 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwaretexture.cpp
+// ============
+// texture images sampled on the CPU by the software renderers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareTexture.h"
+
+#include <cmath>
+#include <iostream>
+
+/***********************************************************
+ *  SoftwareTexture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareTexture::SoftwareTexture()
+{
+	m_width = 0;
+	m_height = 0;
+	m_blocksPerRow = 0;
+}
+
+/***********************************************************
+ *  ~SoftwareTexture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareTexture::~SoftwareTexture()
+{
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method copies an image into the 4x4 texel blocks,
+ *  padding the last blocks of a row or column.
+ ***********************************************************/
+bool SoftwareTexture::Create(const unsigned char* pixels, int width, int height, int channels)
+{
+	if ((channels != 3) && (channels != 4))
+	{
+		std::cout << "Software texture with " << channels << " channels is not handled" << std::endl;
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+	m_blocksPerRow = (width + 3) / 4;
+	m_texels.assign((size_t)m_blocksPerRow * ((height + 3) / 4) * 16, 0);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			const unsigned char* pixel = pixels + ((size_t)y * width + x) * channels;
+			unsigned int alpha = (channels == 4) ? pixel[3] : 0xFF;
+			unsigned int texel = pixel[0] | (pixel[1] << 8) | (pixel[2] << 16) | (alpha << 24);
+
+			size_t index = ((size_t)(y >> 2) * m_blocksPerRow + (x >> 2)) * 16 + ((y & 3) << 2) + (x & 3);
+			m_texels[index] = texel;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method blends the four texels around a coordinate,
+ *  repeating the texture outside of [0, 1].
+ ***********************************************************/
+glm::vec4 SoftwareTexture::Sample(glm::vec2 uv) const
+{
+	if (m_texels.empty())
+	{
+		return(glm::vec4(1.0f));
+	}
+
+	float u = (uv.x - std::floor(uv.x)) * (float)m_width - 0.5f;
+	float v = (uv.y - std::floor(uv.y)) * (float)m_height - 0.5f;
+	float floorU = std::floor(u);
+	float floorV = std::floor(v);
+	float fractionU = u - floorU;
+	float fractionV = v - floorV;
+
+	int x0 = (int)floorU;
+	int y0 = (int)floorV;
+	x0 = (x0 < 0) ? x0 + m_width : x0;
+	y0 = (y0 < 0) ? y0 + m_height : y0;
+	int x1 = (x0 + 1 < m_width) ? x0 + 1 : 0;
+	int y1 = (y0 + 1 < m_height) ? y0 + 1 : 0;
+
+	glm::vec4 top = glm::mix(Fetch(x0, y0), Fetch(x1, y0), fractionU);
+	glm::vec4 bottom = glm::mix(Fetch(x0, y1), Fetch(x1, y1), fractionU);
+
+	return(glm::mix(top, bottom, fractionV));
+}
+
+/***********************************************************
+ *  Fetch()
+ *
+ *  This method reads one texel from its block.
+ ***********************************************************/
+glm::vec4 SoftwareTexture::Fetch(int x, int y) const
+{
+	size_t index = ((size_t)(y >> 2) * m_blocksPerRow + (x >> 2)) * 16 + ((y & 3) << 2) + (x & 3);
+	unsigned int texel = m_texels[index];
+
+	return(glm::vec4(
+		(float)(texel & 0xFF),
+		(float)((texel >> 8) & 0xFF),
+		(float)((texel >> 16) & 0xFF),
+		(float)(texel >> 24)) * (1.0f / 255.0f));
+}
+
+/***********************************************************
+ *  GetWidth()
+ *
+ *  This method returns the width of the image in texels.
+ ***********************************************************/
+int SoftwareTexture::GetWidth() const
+{
+	return(m_width);
+}
+
+/***********************************************************
+ *  GetHeight()
+ *
+ *  This method returns the height of the image in texels.
+ ***********************************************************/
+int SoftwareTexture::GetHeight() const
+{
+	return(m_height);
+}
@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwaretexture.h
+// ============
+// texture images sampled on the CPU by the software renderers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  SoftwareTexture
+ *
+ *  This class holds an RGBA8 image in 4x4 texel blocks.  A
+ *  block is 64 bytes, one cache line, and covers a square
+ *  footprint instead of a sliver of one row, so the four
+ *  texels of a bilinear fetch are usually in the same line.
+ *  Sampling only reads the texels, so any number of threads
+ *  can sample at once.
+ ***********************************************************/
+class SoftwareTexture
+{
+public:
+	// constructor
+	SoftwareTexture();
+	// destructor
+	~SoftwareTexture();
+
+	// copy an image with 3 or 4 channels into the blocks
+	bool Create(const unsigned char* pixels, int width, int height, int channels);
+	// bilinear fetch with repeat wrapping, like GL_LINEAR and
+	// GL_REPEAT
+	glm::vec4 Sample(glm::vec2 uv) const;
+
+	int GetWidth() const;
+	int GetHeight() const;
+
+private:
+	int m_width;
+	int m_height;
+	int m_blocksPerRow;
+	// RGBA8 texels in row after row of 4x4 blocks
+	std::vector<unsigned int> m_texels;
+
+	// read one texel as floats
+	glm::vec4 Fetch(int x, int y) const;
+};
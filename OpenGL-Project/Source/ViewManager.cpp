@@ -1,291 +1,465 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-#include "SceneManager.h"
-
-// GLM Math Header inclusions
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1080;
-	const int WINDOW_HEIGHT = 960;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-
-	//Defining Projection Matrices
-	perspectiveProjection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 80.0f);
-	orthographicProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 80.0f);  // Adjusted to scene
-
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(8.0f, 5.0f,17.0f);
-	g_pCamera->Front = glm::vec3(0.0f, 0.0f, -6.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 5.0f, 0.0f);
-	g_pCamera->Zoom = 90;
-
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-
-	/** Set the initial viewport
-	int width, height;
-	glfwGetFramebufferSize(window, &width, &height);  // Get the window size
-	glViewport(0, 0, width, height);  // Set the viewport to cover the entire window
-
-	// Define the framebuffer size callback as a lambda function or a separate static member function
-	auto framebuffer_size_callback = [](GLFWwindow* window, int width, int height) {
-		glViewport(0, 0, width, height);  // Adjust the viewport when the window size changes
-		};
-
-	// Set the callback
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-	// tell GLFW to capture all mouse events
-	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);*/
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/**GLFWwindow* ViewManager::getWindow() const {
-	//return m_pWindow;  // Return the GLFW window instance
-//}*/
-
-void ViewManager::toggleProjectionMode() {
-	usePerspective = !usePerspective;  // Toggle between true (perspective) and false (orthographic)
-	// You might need to update the projection matrix here as well
-}
-
-void ViewManager::setProjectionMode(bool perspective) {
-	usePerspective = perspective;  // Set based on input
-	// Again, consider updating the projection matrix here
-}
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	// when the first mouse move event is received, this needs to be recorded so that
-		// all subsequent mouse moves can correctly calculate the X position offset and Y
-		// position offset for proper operation
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-	}
-
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
-
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-}
-
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// Close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// If the camera object is null, then exit this method
-	if (NULL == g_pCamera)
-	{
-		return;
-	}
-
-
-	// Process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// Process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-
-
-	// Toggle projection modes with 'P' and 'O' keys
-	static bool pKeyPressedLastFrame = false;
-	static bool oKeyPressedLastFrame = false;
-
-	bool pKeyPressedThisFrame = glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS;
-	bool oKeyPressedThisFrame = glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS;
-
-	// Switch to perspective projection
-	if (pKeyPressedThisFrame && !pKeyPressedLastFrame) {
-		setProjectionMode(true);
-	}
-
-	// Switch to orthographic projection
-	if (oKeyPressedThisFrame && !oKeyPressedLastFrame) {
-		setProjectionMode(false);
-	}
-
-	pKeyPressedLastFrame = pKeyPressedThisFrame;
-	oKeyPressedLastFrame = oKeyPressedThisFrame;
-
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
-}
\ No newline at end of file
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+#include "SceneManager.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for window width and height
+	const int WINDOW_WIDTH = 1080;
+	const int WINDOW_HEIGHT = 960;
+	const char* g_ViewName = "view";
+	const char* g_ProjectionName = "projection";
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// change of the camera movement speed per scroll step, and
+	// the slowest the camera can move
+	const float SCROLL_SPEED_STEP = 0.5f;
+	const float MIN_MOVEMENT_SPEED = 0.5f;
+
+	// time between current frame and last frame
+	float gDeltaTime = 0.0f; 
+	float gLastFrame = 0.0f;
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(ShaderManager *pShaderManager)
+{
+	// initialize the member variables
+	m_pShaderManager = pShaderManager;
+	m_pWindow = NULL;
+	m_pInputRecorder = NULL;
+	g_pCamera = new Camera();
+
+	//Defining Projection Matrices
+	perspectiveProjection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 80.0f);
+	orthographicProjection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 80.0f);  // Adjusted to scene
+	m_viewMatrix = glm::mat4(1.0f);
+	m_viewportWidth = WINDOW_WIDTH;
+	m_viewportHeight = WINDOW_HEIGHT;
+	m_projectionMatrix = perspectiveProjection;
+
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(8.0f, 5.0f,17.0f);
+	g_pCamera->Front = glm::vec3(0.0f, 0.0f, -6.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 5.0f, 0.0f);
+	g_pCamera->Zoom = 90;
+
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderManager = NULL;
+	m_pWindow = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+
+	/** Set the initial viewport
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);  // Get the window size
+	glViewport(0, 0, width, height);  // Set the viewport to cover the entire window
+
+	// Define the framebuffer size callback as a lambda function or a separate static member function
+	auto framebuffer_size_callback = [](GLFWwindow* window, int width, int height) {
+		glViewport(0, 0, width, height);  // Adjust the viewport when the window size changes
+		};
+
+	// Set the callback
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+	// tell GLFW to capture all mouse events
+	//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);*/
+
+	// the mouse callbacks are installed by the input recorder,
+	// which passes the events on once per frame
+
+	// blending for tranparent rendering is turned on by the
+	// scene manager only for the pass that needs it
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/**GLFWwindow* ViewManager::getWindow() const {
+	//return m_pWindow;  // Return the GLFW window instance
+//}*/
+
+void ViewManager::toggleProjectionMode() {
+	usePerspective = !usePerspective;  // Toggle between true (perspective) and false (orthographic)
+	// You might need to update the projection matrix here as well
+}
+
+void ViewManager::setProjectionMode(bool perspective) {
+	usePerspective = perspective;  // Set based on input
+	// Again, consider updating the projection matrix here
+}
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	// when the first mouse move event is received, this needs to be recorded so that
+		// all subsequent mouse moves can correctly calculate the X position offset and Y
+		// position offset for proper operation
+	if (gFirstMouse)
+	{
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+	}
+
+	// calculate the X offset and Y offset values for moving the 3D camera accordingly
+	float xOffset = xMousePos - gLastX;
+	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+
+	// set the current positions into the last position variables
+	gLastX = xMousePos;
+	gLastY = yMousePos;
+
+	// move the 3D camera according to the calculated offsets
+	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+}
+
+/***********************************************************
+ *  Mouse_Scroll_Callback()
+ *
+ *  This method is called whenever the mouse wheel is
+ *  scrolled, and speeds the camera movement up or down.
+ ***********************************************************/
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset)
+{
+	if (NULL == g_pCamera)
+	{
+		return;
+	}
+
+	g_pCamera->MovementSpeed += (float)yOffset * SCROLL_SPEED_STEP;
+	if (g_pCamera->MovementSpeed < MIN_MOVEMENT_SPEED)
+	{
+		g_pCamera->MovementSpeed = MIN_MOVEMENT_SPEED;
+	}
+}
+
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	// Close the window if the escape key has been pressed
+	if (IsKeyDown(GLFW_KEY_ESCAPE) == true)
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// If the camera object is null, then exit this method
+	if (NULL == g_pCamera)
+	{
+		return;
+	}
+
+
+	// Process camera zooming in and out
+	if (IsKeyDown(GLFW_KEY_W) == true)
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_S) == true)
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+	}
+
+	// Process camera panning left and right
+	if (IsKeyDown(GLFW_KEY_A) == true)
+	{
+		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_D) == true)
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_Q) == true)
+	{
+		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_E) == true)
+	{
+		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+	}
+
+
+	// Toggle projection modes with 'P' and 'O' keys
+	static bool pKeyPressedLastFrame = false;
+	static bool oKeyPressedLastFrame = false;
+
+	bool pKeyPressedThisFrame = IsKeyDown(GLFW_KEY_P);
+	bool oKeyPressedThisFrame = IsKeyDown(GLFW_KEY_O);
+
+	// Switch to perspective projection
+	if (pKeyPressedThisFrame && !pKeyPressedLastFrame) {
+		setProjectionMode(true);
+	}
+
+	// Switch to orthographic projection
+	if (oKeyPressedThisFrame && !oKeyPressedLastFrame) {
+		setProjectionMode(false);
+	}
+
+	pKeyPressedLastFrame = pKeyPressedThisFrame;
+	oKeyPressedLastFrame = oKeyPressedThisFrame;
+
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// per-frame timing, fixed steps when input is replayed
+	if (NULL != m_pInputRecorder)
+	{
+		gDeltaTime = m_pInputRecorder->GetDeltaTime();
+	}
+	else
+	{
+		float currentFrame = glfwGetTime();
+		gDeltaTime = currentFrame - gLastFrame;
+		gLastFrame = currentFrame;
+	}
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	ProcessKeyboardEvents();
+
+	// get the current view and projection matrices from the camera
+	UpdateViewMatrices();
+	view = m_viewMatrix;
+	projection = m_projectionMatrix;
+
+	// if the shader manager object is valid
+	if (NULL != m_pShaderManager)
+	{
+		// set the view matrix into the shader for proper rendering
+		m_pShaderManager->setMat4Value(g_ViewName, view);
+		// set the view matrix into the shader for proper rendering
+		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		// set the view position of the camera into the shader for proper rendering
+		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+	}
+}
+
+/***********************************************************
+ *  UpdateViewMatrices()
+ *
+ *  This method calculates the view and projection matrices
+ *  from the camera without reading any input or touching the
+ *  shader, which is all a render without a window needs.
+ ***********************************************************/
+void ViewManager::UpdateViewMatrices()
+{
+	// get the current view matrix from the camera
+	m_viewMatrix = g_pCamera->GetViewMatrix();
+
+	// define the current projection matrix
+	m_projectionMatrix = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)m_viewportWidth / (GLfloat)m_viewportHeight, 0.1f, 100.0f);
+}
+
+/***********************************************************
+ *  SetViewportSize()
+ *
+ *  This method sets the size of the image the projection is
+ *  calculated for, so images rendered off the screen at any
+ *  resolution keep their aspect.
+ ***********************************************************/
+void ViewManager::SetViewportSize(int width, int height)
+{
+	if ((width > 0) && (height > 0))
+	{
+		m_viewportWidth = width;
+		m_viewportHeight = height;
+	}
+}
+
+/***********************************************************
+ *  SetInputRecorder()
+ *
+ *  This method makes the keyboard handling and the frame
+ *  time come from the input recorder instead of GLFW.
+ ***********************************************************/
+void ViewManager::SetInputRecorder(InputRecorder* pInputRecorder)
+{
+	m_pInputRecorder = pInputRecorder;
+}
+
+/***********************************************************
+ *  IsKeyDown()
+ *
+ *  This method returns whether a key is held, from the input
+ *  recorder when there is one.
+ ***********************************************************/
+bool ViewManager::IsKeyDown(int key) const
+{
+	if (NULL != m_pInputRecorder)
+	{
+		return(m_pInputRecorder->IsKeyDown(key));
+	}
+
+	return(glfwGetKey(m_pWindow, key) == GLFW_PRESS);
+}
+
+/***********************************************************
+ *  GetCamera()
+ *
+ *  This method reads the placement and zoom of the camera.
+ ***********************************************************/
+void ViewManager::GetCamera(glm::vec3& position, glm::vec3& front, glm::vec3& up, float& zoom) const
+{
+	position = g_pCamera->Position;
+	front = g_pCamera->Front;
+	up = g_pCamera->Up;
+	zoom = g_pCamera->Zoom;
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method places the camera and sets its zoom.  The
+ *  next UpdateViewMatrices() or PrepareSceneView() sees the
+ *  scene from there.
+ ***********************************************************/
+void ViewManager::SetCamera(const glm::vec3& position, const glm::vec3& front, const glm::vec3& up, float zoom)
+{
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Up = up;
+	g_pCamera->Zoom = zoom;
+}
+
+/***********************************************************
+ *  GetViewMatrix()
+ *
+ *  This method returns the view matrix that was calculated
+ *  by the last call to PrepareSceneView().
+ ***********************************************************/
+glm::mat4 ViewManager::GetViewMatrix() const
+{
+	return(m_viewMatrix);
+}
+
+/***********************************************************
+ *  GetProjectionMatrix()
+ *
+ *  This method returns the projection matrix that was
+ *  calculated by the last call to PrepareSceneView().
+ ***********************************************************/
+glm::mat4 ViewManager::GetProjectionMatrix() const
+{
+	return(m_projectionMatrix);
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method returns the world position of the camera.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	return(g_pCamera->Position);
+}
+
+/***********************************************************
+ *  GetViewportWidth()
+ *
+ *  This method returns the width of the rendered viewport.
+ ***********************************************************/
+int ViewManager::GetViewportWidth() const
+{
+	return(m_viewportWidth);
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method returns the height of the rendered viewport.
+ ***********************************************************/
+int ViewManager::GetViewportHeight() const
+{
+	return(m_viewportHeight);
+}
@@ -1,60 +1,93 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "camera.h"
-
-// GLFW library
-#include "GLFW/glfw3.h" 
-
-class ViewManager
-{
-public:
-	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
-	// destructor
-	~ViewManager();
-
-	//GLFWwindow* getWindow() const;  // Declare the getter for the GLFW window
-
-
-
-	// New methods to toggle and set the projection mode
-	void toggleProjectionMode();
-	void setProjectionMode(bool perspective);
-
-	// Constructor, destructor, and other members...
-	bool usePerspective = true;  // Default to perspective view
-
-	// mouse position callback for mouse interaction with the 3D scene
-	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
-
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
-
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// active OpenGL display window
-	GLFWwindow* m_pWindow;  // This is the member variable holding the GLFW window instance
-
-	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
-
-	// Projections
-	glm::mat4 perspectiveProjection;
-	glm::mat4 orthographicProjection;
-
-};
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "InputRecorder.h"
+#include "ShaderManager.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderManager* pShaderManager);
+	// destructor
+	~ViewManager();
+
+	//GLFWwindow* getWindow() const;  // Declare the getter for the GLFW window
+
+
+
+	// New methods to toggle and set the projection mode
+	void toggleProjectionMode();
+	void setProjectionMode(bool perspective);
+
+	// Constructor, destructor, and other members...
+	bool usePerspective = true;  // Default to perspective view
+
+	// mouse position callback for mouse interaction with the 3D scene
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// mouse scroll callback for changing the camera movement speed
+	static void Mouse_Scroll_Callback(GLFWwindow* window, double xOffset, double yOffset);
+
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+
+	// prepare the conversion from 3D object display to 2D scene display
+	void PrepareSceneView();
+	// calculate the view and projection from the camera only
+	void UpdateViewMatrices();
+	// size of the image the projection is made for, the window
+	// size by default
+	void SetViewportSize(int width, int height);
+
+	// read and place the camera, for recording and playing back
+	// camera paths
+	void GetCamera(glm::vec3& position, glm::vec3& front, glm::vec3& up, float& zoom) const;
+	void SetCamera(const glm::vec3& position, const glm::vec3& front, const glm::vec3& up, float zoom);
+	// read keys and frame time through a recorder, so recorded
+	// input can be replayed
+	void SetInputRecorder(InputRecorder* pInputRecorder);
+
+	// view parameters calculated by the last PrepareSceneView()
+	glm::mat4 GetViewMatrix() const;
+	glm::mat4 GetProjectionMatrix() const;
+	glm::vec3 GetCameraPosition() const;
+	int GetViewportWidth() const;
+	int GetViewportHeight() const;
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;  // This is the member variable holding the GLFW window instance
+	// source of key state and frame time, NULL reads GLFW
+	InputRecorder* m_pInputRecorder;
+
+	// process keyboard events for interaction with the 3D scene
+	void ProcessKeyboardEvents();
+	// whether a key is held, live or replayed
+	bool IsKeyDown(int key) const;
+
+	// Projections
+	glm::mat4 perspectiveProjection;
+	glm::mat4 orthographicProjection;
+
+	// matrices passed to the shader for the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	int m_viewportWidth;
+	int m_viewportHeight;
+
+};